@@ -0,0 +1,404 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "jpeg_backend_cmodel.h"
+#ifdef JPEG_BACKEND_SIM
+#include "jpeg_backend_sim.h"
+
+double sc_time_stamp() { return 0; }
+#endif
+
+//-----------------------------------------------------------------------------
+// backend_bench: Throughput / latency of a decode backend (jpeg_backend.h)
+// for a given queue depth, number of buffers in flight and batch size.
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    std::string          name;
+    std::vector<uint8_t> data;
+    int                  width;
+    int                  height;
+    std::vector<uint8_t> ref;       // Synchronous C model output (-v)
+} t_image;
+
+typedef struct
+{
+    int      image;
+    uint8_t *buf;
+    bool     busy;
+} t_slot;
+
+typedef struct
+{
+    std::vector<t_image> *images;
+    std::vector<t_slot>   slots;
+    std::vector<double>   latency;
+    std::vector<double>   wait;
+    t_jpeg_pix_format     format;
+    bool                  verify;
+    int                   completed;
+    int                   failed;
+    int                   mismatched;
+    int                   max_diff;
+    uint64_t              pixels;
+    uint64_t              cycles;
+} t_bench;
+
+static const char *m_status_name[] = { "ok", "error", "unsupported", "buffer too small" };
+
+//-----------------------------------------------------------------------------
+// LoadFile: Whole file, or a list of files (one per line) for @list
+//-----------------------------------------------------------------------------
+static bool LoadFile(const char *filename, std::vector<t_image> &images)
+{
+    if (filename[0] == '@')
+    {
+        FILE *f = fopen(filename + 1, "r");
+        if (!f)
+        {
+            fprintf(stderr, "ERROR: Could not open list %s\n", filename + 1);
+            return false;
+        }
+
+        char line[1024];
+        bool ok = true;
+        while (ok && fgets(line, sizeof(line), f))
+        {
+            line[strcspn(line, "\r\n")] = 0;
+            if (line[0] && line[0] != '#')
+                ok = LoadFile(line, images);
+        }
+        fclose(f);
+        return ok;
+    }
+
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+    {
+        fprintf(stderr, "ERROR: Could not open %s\n", filename);
+        return false;
+    }
+
+    t_image img;
+    img.name   = filename;
+    img.width  = 0;
+    img.height = 0;
+    fseek(f, 0, SEEK_END);
+    img.data.resize(ftell(f));
+    rewind(f);
+    size_t len = fread(img.data.data(), 1, img.data.size(), f);
+    fclose(f);
+    if (len != img.data.size())
+        return false;
+
+    images.push_back(img);
+    return true;
+}
+//-----------------------------------------------------------------------------
+// OnRefHeader: Reference decode - allocate the frame for the image
+//-----------------------------------------------------------------------------
+static t_jpeg_output_desc m_ref_desc;
+static t_jpeg_pix_format  m_ref_format;
+
+static void OnRefHeader(void *ctx, jpeg_decoder *dec)
+{
+    t_image *img = (t_image *)ctx;
+
+    img->width  = dec->width();
+    img->height = dec->height();
+    img->ref.resize(jpeg_output::frame_size(m_ref_format, img->width, img->height, 0));
+    jpeg_output::desc_init(&m_ref_desc, m_ref_format, img->ref.data(), img->width, img->height, 0);
+    dec->set_output(&m_ref_desc);
+}
+//-----------------------------------------------------------------------------
+// Reference: Decode each image synchronously (frame size, and the expected
+//            output if verifying, colour converted as the RTL if 'fixed')
+//-----------------------------------------------------------------------------
+static void Reference(std::vector<t_image> &images, t_jpeg_pix_format format, bool keep, bool fixed)
+{
+    jpeg_decoder *dec = new jpeg_decoder();
+
+    dec->set_verbose(false);
+    dec->set_fixed_colour(fixed);
+    m_ref_format = format;
+    for (size_t i=0;i<images.size();i++)
+    {
+        dec->reset();
+        dec->set_callbacks(OnRefHeader, NULL, &images[i]);
+        dec->feed(images[i].data.data(), (int)images[i].data.size());
+        if (!dec->finish())
+            images[i].ref.clear();
+        if (!keep)
+            std::vector<uint8_t>().swap(images[i].ref);
+    }
+
+    delete dec;
+}
+//-----------------------------------------------------------------------------
+// OnComplete: Job done (poll() context) - check and release the buffer
+//-----------------------------------------------------------------------------
+static void OnComplete(void *ctx, const t_jpeg_job *job, const t_jpeg_job_result *res)
+{
+    t_bench *b    = (t_bench *)ctx;
+    t_slot  *slot = (t_slot *)job->user;
+    t_image &img  = (*b->images)[slot->image];
+
+    b->completed++;
+    b->latency.push_back(res->end_time - res->submit_time);
+    b->wait.push_back(res->start_time - res->submit_time);
+    b->cycles += res->cycles;
+
+    if (res->status != JPEG_JOB_OK)
+    {
+        if (b->failed++ < 10)
+            fprintf(stderr, "%s: %s\n", img.name.c_str(), m_status_name[res->status]);
+    }
+    else
+    {
+        b->pixels += (uint64_t)res->width * res->height;
+
+        if (b->verify && !img.ref.empty())
+        {
+            int diff = 0;
+            for (size_t i=0;i<img.ref.size();i++)
+                diff = std::max(diff, abs((int)img.ref[i] - (int)job->buf[i]));
+            if (diff)
+                b->mismatched++;
+            b->max_diff = std::max(b->max_diff, diff);
+        }
+    }
+
+    slot->busy = false;
+}
+//-----------------------------------------------------------------------------
+// Percentile:
+//-----------------------------------------------------------------------------
+static double Percentile(std::vector<double> &v, double pct)
+{
+    if (v.empty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    size_t idx = (size_t)(pct / 100.0 * (v.size() - 1) + 0.5);
+    return v[idx];
+}
+//-----------------------------------------------------------------------------
+// usage:
+//-----------------------------------------------------------------------------
+static int usage(void)
+{
+    printf("./backend_bench [options] image.jpg|@list [...]\n");
+#ifdef JPEG_BACKEND_SIM
+    printf("  -b cmodel|sim   Backend (default cmodel)\n");
+    printf("  -c MHz          Core clock for device time (sim, default 75)\n");
+#else
+    printf("  -b cmodel       Backend (default cmodel)\n");
+#endif
+    printf("  -t threads      C model worker threads (default 1)\n");
+    printf("  -q depth        Submission queue depth (default 4)\n");
+    printf("  -o buffers      Output buffers, i.e. jobs in flight (default depth + threads)\n");
+    printf("  -B batch        Submit in batches, waiting for each to drain (default 0: streaming)\n");
+    printf("  -n count        Jobs to run, cycling through the images (default one per image)\n");
+    printf("  -f format       rgb, rgba, bgra, rgb565, i420, nv12, yuv444p (default rgb)\n");
+    printf("  -v              Compare every frame with a synchronous C model decode\n");
+    return 2;
+}
+//-----------------------------------------------------------------------------
+// main:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    const char *      backend_name = "cmodel";
+    int               threads      = 1;
+    int               depth        = 4;
+    int               buffers      = 0;
+    int               batch        = 0;
+    int               count        = 0;
+    double            clock_mhz    = 75.0;
+    t_jpeg_pix_format format       = JPEG_PIX_RGB24;
+    bool              verify       = false;
+    int c;
+
+    while ((c = getopt(argc, argv, "b:c:t:q:o:B:n:f:v")) != -1)
+    {
+        switch (c)
+        {
+            case 'b':
+                backend_name = optarg;
+                break;
+            case 'c':
+                clock_mhz = atof(optarg);
+                break;
+            case 't':
+                threads = atoi(optarg);
+                break;
+            case 'q':
+                depth = atoi(optarg);
+                break;
+            case 'o':
+                buffers = atoi(optarg);
+                break;
+            case 'B':
+                batch = atoi(optarg);
+                break;
+            case 'n':
+                count = atoi(optarg);
+                break;
+            case 'f':
+                if (!strcmp(optarg, "rgb"))
+                    format = JPEG_PIX_RGB24;
+                else if (!strcmp(optarg, "rgba"))
+                    format = JPEG_PIX_RGBA32;
+                else if (!strcmp(optarg, "bgra"))
+                    format = JPEG_PIX_BGRA32;
+                else if (!strcmp(optarg, "rgb565"))
+                    format = JPEG_PIX_RGB565;
+                else if (!strcmp(optarg, "i420"))
+                    format = JPEG_PIX_I420;
+                else if (!strcmp(optarg, "nv12"))
+                    format = JPEG_PIX_NV12;
+                else if (!strcmp(optarg, "yuv444p"))
+                    format = JPEG_PIX_YUV444P;
+                else
+                    return usage();
+                break;
+            case 'v':
+                verify = true;
+                break;
+            default:
+                return usage();
+        }
+    }
+
+    if (optind >= argc || depth < 1)
+        return usage();
+
+    std::vector<t_image> images;
+    for (int i=optind;i<argc;i++)
+        if (!LoadFile(argv[i], images))
+            return 1;
+
+    jpeg_backend *backend = NULL;
+    if (!strcmp(backend_name, "cmodel"))
+        backend = new jpeg_backend_cmodel(threads, depth);
+#ifdef JPEG_BACKEND_SIM
+    else if (!strcmp(backend_name, "sim"))
+    {
+        backend = new jpeg_backend_sim(depth);
+        threads = 1;
+    }
+#endif
+    else
+        return usage();
+
+    // Frame sizes (and reference output)
+    Reference(images, format, verify, strcmp(backend_name, "cmodel") != 0);
+
+    int frame_size = 0;
+    for (size_t i=0;i<images.size();i++)
+        frame_size = std::max(frame_size, jpeg_output::frame_size(format, images[i].width, images[i].height, 0));
+
+    if (count <= 0)
+        count = (int)images.size();
+    if (buffers <= 0)
+        buffers = depth + threads;
+
+    t_bench b;
+    b.images     = &images;
+    b.format     = format;
+    b.verify     = verify;
+    b.completed  = 0;
+    b.failed     = 0;
+    b.mismatched = 0;
+    b.max_diff   = 0;
+    b.pixels     = 0;
+    b.cycles     = 0;
+    b.slots.resize(buffers);
+    for (int i=0;i<buffers;i++)
+    {
+        if (posix_memalign((void**)&b.slots[i].buf, 64, frame_size ? frame_size : 64) != 0)
+            return 1;
+        b.slots[i].busy = false;
+    }
+
+    backend->set_callback(OnComplete, &b);
+
+    // Keep as many jobs in flight as there are free buffers (and queue space)
+    double start     = jpeg_backend::now();
+    int    submitted = 0;
+    int    rejected  = 0;
+    while (submitted < count)
+    {
+        t_slot *slot = NULL;
+        for (int i=0;i<buffers && !slot;i++)
+            if (!b.slots[i].busy)
+                slot = &b.slots[i];
+
+        if (slot)
+        {
+            t_image &img = images[submitted % images.size()];
+
+            t_jpeg_job job;
+            job.data     = img.data.data();
+            job.len      = (int)img.data.size();
+            job.format   = format;
+            job.buf      = slot->buf;
+            job.buf_size = frame_size;
+            job.stride   = 0;
+            job.user     = slot;
+
+            if (backend->submit(&job))
+            {
+                slot->image = submitted % images.size();
+                slot->busy  = true;
+                submitted++;
+
+                if (batch > 0 && (submitted % batch) == 0)
+                    backend->drain();
+                else
+                    backend->poll(0);
+                continue;
+            }
+            rejected++;
+        }
+
+        // No buffer / queue full - wait for a completion
+        backend->poll(-1);
+    }
+    backend->drain();
+    double elapsed = jpeg_backend::now() - start;
+
+    delete backend;
+
+    double mean = 0;
+    for (size_t i=0;i<b.latency.size();i++)
+        mean += b.latency[i];
+    mean /= b.latency.size() ? b.latency.size() : 1;
+
+    double mean_wait = 0;
+    for (size_t i=0;i<b.wait.size();i++)
+        mean_wait += b.wait[i];
+    mean_wait /= b.wait.size() ? b.wait.size() : 1;
+
+    printf("Backend:    %s (threads %d, queue depth %d, buffers %d, batch %d)\n", backend_name, threads, depth, buffers, batch);
+    printf("Jobs:       %d (%d failed, %d submits rejected)\n", b.completed, b.failed, rejected);
+    printf("Time:       %.3f s\n", elapsed);
+    printf("Throughput: %.2f images/s, %.2f MPixel/s\n", b.completed / elapsed, b.pixels / elapsed / 1e6);
+    printf("Latency:    mean %.3f ms, p50 %.3f ms, p99 %.3f ms (queue wait mean %.3f ms)\n",
+           mean * 1e3, Percentile(b.latency, 50) * 1e3, Percentile(b.latency, 99) * 1e3, mean_wait * 1e3);
+    if (b.cycles)
+        printf("Device:     %llu cycles, %.2f images/s at %.0f MHz\n", (unsigned long long)b.cycles,
+               b.completed / (b.cycles / (clock_mhz * 1e6)), clock_mhz);
+    if (verify)
+        printf("Verify:     %d frames differ from the C model (max diff %d)\n", b.mismatched, b.max_diff);
+
+    for (int i=0;i<buffers;i++)
+        free(b.slots[i].buf);
+
+    return (b.failed || (verify && b.mismatched && !strcmp(backend_name, "cmodel"))) ? 1 : 0;
+}
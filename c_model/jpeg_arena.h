@@ -0,0 +1,120 @@
+#ifndef JPEG_ARENA_H
+#define JPEG_ARENA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#define dprintf
+
+#define JPEG_ARENA_ALIGN 64
+
+//-----------------------------------------------------------------------------
+// jpeg_arena: Resettable bump allocator for per-image buffers.
+// Allocations are released all at once with reset(). If an image needs more
+// than the current block, overflow blocks are chained on, and the next reset()
+// replaces them with a single block sized to the high water mark - so batch
+// decoding reaches a steady state with no heap allocations per image.
+//-----------------------------------------------------------------------------
+class jpeg_arena
+{
+public:
+    jpeg_arena()
+    {
+        m_block      = NULL;
+        m_size       = 0;
+        m_used       = 0;
+        m_overflow   = NULL;
+        m_high_water = 0;
+        m_sys_allocs = 0;
+    }
+    ~jpeg_arena()
+    {
+        free_overflow();
+        free(m_block);
+    }
+
+    //-------------------------------------------------------------------------
+    // alloc: Allocate 'size' bytes (JPEG_ARENA_ALIGN aligned, not cleared)
+    //-------------------------------------------------------------------------
+    void *alloc(int size)
+    {
+        size = align(size);
+
+        if (m_used + size <= m_size)
+        {
+            void *p = m_block + m_used;
+            m_used += size;
+            return p;
+        }
+
+        // Overflow: chain a dedicated block (header keeps the chain aligned)
+        uint8_t *p = sys_alloc(JPEG_ARENA_ALIGN + size);
+        if (!p)
+            return NULL;
+
+        *(uint8_t**)p = m_overflow;
+        m_overflow    = p;
+        m_high_water += size;
+        return p + JPEG_ARENA_ALIGN;
+    }
+
+    //-------------------------------------------------------------------------
+    // reset: Release all allocations (memory is retained for reuse)
+    //-------------------------------------------------------------------------
+    void reset(void)
+    {
+        if (m_overflow)
+        {
+            free_overflow();
+
+            int size = align(m_used + m_high_water);
+            free(m_block);
+            m_block = sys_alloc(size);
+            m_size  = m_block ? size : 0;
+        }
+
+        m_used       = 0;
+        m_high_water = 0;
+    }
+
+    int      capacity(void)   { return m_size; }
+    int      used(void)       { return m_used + m_high_water; }
+
+    // Number of times memory was requested from the system
+    int      sys_allocs(void) { return m_sys_allocs; }
+
+private:
+    static int align(int size) { return (size + JPEG_ARENA_ALIGN - 1) & ~(JPEG_ARENA_ALIGN - 1); }
+
+    uint8_t *sys_alloc(int size)
+    {
+        void *p = NULL;
+        if (posix_memalign(&p, JPEG_ARENA_ALIGN, size) != 0)
+            return NULL;
+        m_sys_allocs++;
+        return (uint8_t*)p;
+    }
+
+    void free_overflow(void)
+    {
+        while (m_overflow)
+        {
+            uint8_t *next = *(uint8_t**)m_overflow;
+            free(m_overflow);
+            m_overflow = next;
+        }
+    }
+
+private:
+    uint8_t *m_block;
+    int      m_size;
+    int      m_used;
+    uint8_t *m_overflow;
+    int      m_high_water; // bytes allocated from overflow blocks
+    int      m_sys_allocs;
+};
+
+#endif
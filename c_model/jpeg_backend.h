@@ -0,0 +1,219 @@
+#ifndef JPEG_BACKEND_H
+#define JPEG_BACKEND_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "jpeg_image.h"
+#include "jpeg_output.h"
+
+//-----------------------------------------------------------------------------
+// Decode job: JPEG in, frame out. Both buffers are owned by the caller and
+// must stay valid until the job's completion callback has run.
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    const uint8_t    *data;         // JPEG file
+    int               len;
+    t_jpeg_pix_format format;
+    uint8_t          *buf;          // Contiguous frame (see jpeg_output::desc_init)
+    int               buf_size;
+    int               stride;       // Plane 0 row stride in bytes (<= 0: packed)
+    void             *user;
+} t_jpeg_job;
+
+typedef enum eJpgJobStatus
+{
+    JPEG_JOB_OK,
+    JPEG_JOB_ERROR,                 // Decode failed
+    JPEG_JOB_UNSUPPORTED,           // Image or output format not supported by the backend
+    JPEG_JOB_BUFFER_SMALL           // Frame does not fit in buf_size
+} t_jpeg_job_status;
+
+typedef struct
+{
+    t_jpeg_job_status status;
+    uint64_t          id;           // Submission order
+    int               width;
+    int               height;
+    t_jpeg_mode       mode;
+    double            submit_time;  // Seconds (jpeg_backend::now)
+    double            start_time;
+    double            end_time;
+    uint64_t          cycles;       // Core clock cycles (hardware / Verilated backends, else 0)
+} t_jpeg_job_result;
+
+typedef void (*t_jpeg_job_cb)(void *ctx, const t_jpeg_job *job, const t_jpeg_job_result *res);
+
+//-----------------------------------------------------------------------------
+// jpeg_backend: Asynchronous decode interface shared by the C model, the
+// Verilated core and the device driver.
+//   submit() queues a job (false if queue_depth jobs are already queued and
+//   not yet started). Jobs may complete in any order. Completion callbacks
+//   run on the thread calling poll(), never on a backend thread.
+//
+// Implementations start their workers in the constructor, take jobs with
+// next_job() and hand them back with complete().
+//-----------------------------------------------------------------------------
+class jpeg_backend
+{
+public:
+    jpeg_backend(int queue_depth): m_queue_depth(queue_depth), m_cb(NULL), m_cb_ctx(NULL),
+                                   m_next_id(0), m_outstanding(0), m_stop(false) { }
+    virtual ~jpeg_backend() { }
+
+    virtual const char *name(void) = 0;
+
+    void set_callback(t_jpeg_job_cb cb, void *ctx)
+    {
+        m_cb     = cb;
+        m_cb_ctx = ctx;
+    }
+
+    //-------------------------------------------------------------------------
+    // submit: Queue a job. Returns false if the submission queue is full.
+    //-------------------------------------------------------------------------
+    bool submit(const t_jpeg_job *job)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if ((int)m_pending.size() >= m_queue_depth)
+            return false;
+
+        t_entry e;
+        memset(&e.res, 0, sizeof(e.res));
+        e.job             = *job;
+        e.res.id          = m_next_id++;
+        e.res.submit_time = now();
+        m_pending.push_back(e);
+        m_outstanding++;
+        m_work_cv.notify_one();
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // poll: Run the callbacks of completed jobs on this thread.
+    //       timeout_ms: 0 = return immediately, < 0 = wait for at least one.
+    //       Returns the number of completions delivered.
+    //-------------------------------------------------------------------------
+    int poll(int timeout_ms)
+    {
+        std::deque<t_entry> done;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_done.empty() && timeout_ms != 0 && m_outstanding)
+            {
+                if (timeout_ms < 0)
+                    m_done_cv.wait(lock, [this] { return !m_done.empty(); });
+                else
+                    m_done_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return !m_done.empty(); });
+            }
+            done.swap(m_done);
+            m_outstanding -= (int)done.size();
+        }
+
+        for (size_t i=0;i<done.size();i++)
+            if (m_cb)
+                m_cb(m_cb_ctx, &done[i].job, &done[i].res);
+        return (int)done.size();
+    }
+
+    // Wait for every submitted job to complete
+    int drain(void)
+    {
+        int n = 0;
+        while (outstanding())
+            n += poll(-1);
+        return n;
+    }
+
+    // Submitted and not yet returned by poll()
+    int outstanding(void)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_outstanding;
+    }
+
+    int queue_depth(void) { return m_queue_depth; }
+
+    static double now(void)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+protected:
+    typedef struct
+    {
+        t_jpeg_job        job;
+        t_jpeg_job_result res;
+    } t_entry;
+
+    //-------------------------------------------------------------------------
+    // next_job: Worker side - block until a job is queued (false on shutdown)
+    //-------------------------------------------------------------------------
+    bool next_job(t_entry *e)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_work_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+        if (m_pending.empty())
+            return false;
+
+        *e = m_pending.front();
+        m_pending.pop_front();
+        e->res.start_time = now();
+        return true;
+    }
+
+    void complete(t_entry *e, t_jpeg_job_status status)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        e->res.status   = status;
+        e->res.end_time = now();
+        m_done.push_back(*e);
+        m_done_cv.notify_all();
+    }
+
+    // Stop the workers (call from the derived destructor, then join them)
+    void stop(void)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_work_cv.notify_all();
+    }
+
+    //-------------------------------------------------------------------------
+    // bind_output: Describe the job's frame buffer for a width x height image
+    //-------------------------------------------------------------------------
+    static t_jpeg_job_status bind_output(const t_jpeg_job *job, int width, int height, t_jpeg_output_desc *desc)
+    {
+        if (job->stride > 0 && job->stride < width * jpeg_output::pixel_bytes(job->format))
+            return JPEG_JOB_BUFFER_SMALL;
+        if (jpeg_output::frame_size(job->format, width, height, job->stride) > job->buf_size)
+            return JPEG_JOB_BUFFER_SMALL;
+
+        jpeg_output::desc_init(desc, job->format, job->buf, width, height, job->stride);
+        return JPEG_JOB_OK;
+    }
+
+private:
+    int                     m_queue_depth;
+    t_jpeg_job_cb           m_cb;
+    void                   *m_cb_ctx;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    std::deque<t_entry>     m_pending;
+    std::deque<t_entry>     m_done;
+    uint64_t                m_next_id;
+    int                     m_outstanding;
+    bool                    m_stop;
+};
+
+#endif
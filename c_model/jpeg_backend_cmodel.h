@@ -0,0 +1,105 @@
+#ifndef JPEG_BACKEND_CMODEL_H
+#define JPEG_BACKEND_CMODEL_H
+
+#include <thread>
+#include <vector>
+
+#include "jpeg_backend.h"
+#include "jpeg_decoder.h"
+
+//-----------------------------------------------------------------------------
+// jpeg_backend_cmodel: C model decoder on a pool of worker threads, each
+// owning its own jpeg_decoder instance.
+//-----------------------------------------------------------------------------
+class jpeg_backend_cmodel: public jpeg_backend
+{
+public:
+    jpeg_backend_cmodel(int threads, int queue_depth): jpeg_backend(queue_depth)
+    {
+        if (threads < 1)
+            threads = 1;
+
+        for (int i=0;i<threads;i++)
+            m_workers.push_back(std::thread(&jpeg_backend_cmodel::worker, this));
+    }
+
+    virtual ~jpeg_backend_cmodel()
+    {
+        stop();
+        for (size_t i=0;i<m_workers.size();i++)
+            m_workers[i].join();
+    }
+
+    virtual const char *name(void) { return "cmodel"; }
+
+    int threads(void) { return (int)m_workers.size(); }
+
+private:
+    typedef struct
+    {
+        t_entry            *entry;
+        t_jpeg_output_desc  desc;
+        t_jpeg_job_status   status;
+    } t_bind;
+
+    //-------------------------------------------------------------------------
+    // on_header: Frame header parsed - bind the job's frame buffer
+    //-------------------------------------------------------------------------
+    static void on_header(void *ctx, jpeg_decoder *dec)
+    {
+        t_bind *b = (t_bind *)ctx;
+
+        b->entry->res.width  = dec->width();
+        b->entry->res.height = dec->height();
+        b->entry->res.mode   = dec->mode();
+
+        b->status = bind_output(&b->entry->job, dec->width(), dec->height(), &b->desc);
+        if (b->status == JPEG_JOB_OK && !dec->set_output(&b->desc))
+            b->status = JPEG_JOB_UNSUPPORTED;
+    }
+
+    //-------------------------------------------------------------------------
+    // worker: Decode jobs until the backend is destroyed
+    //-------------------------------------------------------------------------
+    void worker(void)
+    {
+        // Decoder state is large (segment / scan buffers) - keep it off the stack
+        jpeg_decoder *dec = new jpeg_decoder();
+        t_entry       e;
+        t_bind        b;
+
+        dec->set_verbose(false);
+
+        while (next_job(&e))
+        {
+            b.entry  = &e;
+            b.status = JPEG_JOB_ERROR;
+
+            e.res.mode = JPEG_UNSUPPORTED;
+            dec->reset();
+            dec->set_callbacks(on_header, NULL, &b);
+            dec->feed(e.job.data, e.job.len);
+
+            bool ok = dec->finish();
+
+            // Header callback not reached (not baseline / unsupported sampling)
+            if (e.res.width == 0 && dec->width() != 0)
+            {
+                e.res.width  = dec->width();
+                e.res.height = dec->height();
+                b.status     = JPEG_JOB_UNSUPPORTED;
+            }
+            else if (b.status == JPEG_JOB_OK && !ok)
+                b.status = JPEG_JOB_ERROR;
+
+            complete(&e, b.status);
+        }
+
+        delete dec;
+    }
+
+private:
+    std::vector<std::thread> m_workers;
+};
+
+#endif
@@ -17,6 +17,9 @@
 #define TEST_HOOKS_BITBUFFER_DECL
 #endif
 
+// Bytes readable past the write pointer by read_word (always zero)
+#define JPEG_BIT_BUFFER_SLACK 8
+
 //-----------------------------------------------------------------------------
 // jpeg_bit_buffer:
 //-----------------------------------------------------------------------------
@@ -25,28 +28,57 @@ class jpeg_bit_buffer
 public:
     jpeg_bit_buffer() 
     {
-        m_buffer = NULL;
+        m_buffer    = NULL;
+        m_capacity  = 0;
+        m_external  = false;
+        m_dirty     = 0;
         reset(-1);
     }
 
-    void reset(int max_size = -1)
+    // Use caller owned storage of (max_size + JPEG_BIT_BUFFER_SLACK) bytes
+    jpeg_bit_buffer(uint8_t *buf, int max_size)
     {
-        if (m_buffer)
-        {
+        m_buffer    = buf;
+        m_capacity  = max_size;
+        m_external  = true;
+        memset(m_buffer, 0, m_capacity + JPEG_BIT_BUFFER_SLACK);
+        m_dirty     = 0;
+        reset(max_size);
+    }
+
+    ~jpeg_bit_buffer()
+    {
+        if (!m_external)
             delete [] m_buffer;
-            m_buffer = NULL;
-        }
+    }
 
+    void reset(int max_size = -1)
+    {
         if (max_size <= 0)
-            m_max_size = 1 << 20;
+            max_size = m_external ? m_capacity : (1 << 20);
+
+        // Existing storage is large enough: only clear what was written
+        if (m_buffer && max_size <= m_capacity)
+            memset(m_buffer, 0, m_dirty);
         else
-            m_max_size = max_size;
+        {
+            assert(!m_external);
+            if (m_buffer)
+                delete [] m_buffer;
 
-        m_buffer = new uint8_t[m_max_size];
-        memset(m_buffer, 0, m_max_size);
+            m_capacity = max_size;
+            m_buffer   = new uint8_t[m_capacity + JPEG_BIT_BUFFER_SLACK];
+            memset(m_buffer, 0, m_capacity + JPEG_BIT_BUFFER_SLACK);
+        }
+
+        m_max_size  = max_size;
+        m_dirty     = 0;
         m_wr_offset = 0;
         m_last      = 0;
         m_rd_offset = 0;
+        m_mark      = 0;
+        m_final     = true;
+        m_underrun  = false;
     }
 
     // Push byte into stream (return false if marker found)
@@ -68,6 +100,8 @@ public:
         {
             assert(m_wr_offset < m_max_size);
             m_buffer[m_wr_offset++] = b;
+            if (m_wr_offset > m_dirty)
+                m_dirty = m_wr_offset;
         }
 
         m_last = b;
@@ -75,14 +109,60 @@ public:
         return true;
     }
 
+    //-------------------------------------------------------------------------
+    // Streaming support: the buffer holds a window of the scan. Until the
+    // scan is marked final, a read which looks past the buffered data sets
+    // the underrun flag so the caller can rewind to its last mark and wait.
+    //-------------------------------------------------------------------------
+    void set_final(bool final) { m_final = final; }
+    bool underrun(void)        { return m_underrun; }
+
+    bool space(void)           { return m_wr_offset < m_max_size; }
+
+    void mark(void)            { m_mark = m_rd_offset; m_underrun = false; }
+    void rewind(void)          { m_rd_offset = m_mark; m_underrun = false; }
+
+    // compact: Discard fully consumed bytes (read position must be marked)
+    void compact(void)
+    {
+        int drop = m_mark / 8;
+        if (drop == 0)
+            return;
+
+        memmove(m_buffer, m_buffer + drop, m_wr_offset - drop);
+        memset(m_buffer + m_wr_offset - drop, 0, drop);
+        m_wr_offset -= drop;
+        m_rd_offset -= drop * 8;
+        m_mark      -= drop * 8;
+    }
+
+    // discard: Drop all buffered data (marker detection state is retained)
+    void discard(void)
+    {
+        memset(m_buffer, 0, m_dirty);
+        m_dirty     = 0;
+        m_wr_offset = 0;
+        m_rd_offset = 0;
+        m_mark      = 0;
+    }
+
     // Read upto 32-bit (aligned to MSB)
     uint32_t read_word(void)
     {
         if (eof())
+        {
+            m_underrun |= !m_final;
             return 0;
+        }
 
         int byte   = m_rd_offset / 8;
         int bit    = m_rd_offset % 8; // 0 - 7
+
+        // Not enough data buffered yet for a full word (the last buffered
+        // byte may yet turn out to be the 0xFF of a marker)
+        if (!m_final && (byte + 5) >= m_wr_offset)
+            m_underrun = true;
+
         uint64_t w = 0;
         for (int x=0;x<5;x++)
         {
@@ -101,7 +181,7 @@ public:
 
     bool eof(void)
     {
-        return (((m_rd_offset+7) / 8) >= m_wr_offset);
+        return m_rd_offset >= (m_wr_offset * 8);
     }
 
     TEST_HOOKS_BITBUFFER_DECL;
@@ -109,9 +189,15 @@ public:
 private:
     uint8_t *m_buffer;
     uint8_t  m_last;
+    int      m_capacity;
+    bool     m_external;
     int      m_max_size;
     int      m_wr_offset;
+    int      m_dirty;     // bytes which may be non-zero
     int      m_rd_offset; // in bits
+    int      m_mark;      // in bits
+    bool     m_final;
+    bool     m_underrun;
 };
 
 #endif
@@ -0,0 +1,199 @@
+#ifndef JPEG_COEFF_H
+#define JPEG_COEFF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "jpeg_image.h"
+#include "jpeg_arena.h"
+#include "jpeg_dqt.h"
+#include "jpeg_dht.h"
+#include "jpeg_mcu_block.h"
+
+#define dprintf
+
+#define JPEG_COEFF_MAX_COMPS 3
+
+//-----------------------------------------------------------------------------
+// jpeg_coeff_planes: Per-component DCT coefficient planes.
+// Each plane is a raster of 8x8 blocks, each block holding 64 coefficients
+// in natural (row-major, de-zigzagged) order. Blocks in a block row are
+// contiguous, so a plane can be consumed one block row at a time.
+//-----------------------------------------------------------------------------
+class jpeg_coeff_planes
+{
+public:
+    jpeg_coeff_planes()
+    {
+        m_num_comps = 0;
+        m_arena     = NULL;
+        for (int i=0;i<JPEG_COEFF_MAX_COMPS;i++)
+        {
+            m_plane[i]    = NULL;
+            m_blocks_w[i] = 0;
+            m_blocks_h[i] = 0;
+        }
+    }
+    ~jpeg_coeff_planes() { release(); }
+
+    //-------------------------------------------------------------------------
+    // init: Size (and zero) planes for an image of the specified mode.
+    //       If 'arena' is given the planes are drawn from it, and are only
+    //       valid until the arena is next reset.
+    //-------------------------------------------------------------------------
+    bool init(t_jpeg_mode mode, int width, int height, jpeg_arena *arena = NULL)
+    {
+        release();
+
+        if (mode == JPEG_UNSUPPORTED)
+            return false;
+
+        m_arena = arena;
+
+        int mcu_w  = jpeg_mcu_width(mode);
+        int mcu_h  = jpeg_mcu_height(mode);
+        int mcus_x = (width  + mcu_w - 1) / mcu_w;
+        int mcus_y = (height + mcu_h - 1) / mcu_h;
+
+        m_num_comps = (mode == JPEG_MONOCHROME) ? 1 : 3;
+        for (int c=0;c<m_num_comps;c++)
+        {
+            // Luma in 4:2:0 has 2x2 blocks per MCU, 4:2:2 2x1, everything else 1
+            int scale_x   = ((mode == JPEG_YCBCR_420 || mode == JPEG_YCBCR_422) && c == 0) ? 2 : 1;
+            int scale_y   = (mode == JPEG_YCBCR_420 && c == 0) ? 2 : 1;
+            m_blocks_w[c] = mcus_x * scale_x;
+            m_blocks_h[c] = mcus_y * scale_y;
+
+            int size   = m_blocks_w[c] * m_blocks_h[c] * 64;
+            m_plane[c] = arena ? (int16_t*)arena->alloc(size * sizeof(int16_t)) : new int16_t[size];
+            if (!m_plane[c])
+            {
+                release();
+                return false;
+            }
+            memset(m_plane[c], 0, size * sizeof(int16_t));
+        }
+
+        return true;
+    }
+
+    void release(void)
+    {
+        for (int i=0;i<JPEG_COEFF_MAX_COMPS;i++)
+        {
+            if (m_plane[i] && !m_arena)
+                delete [] m_plane[i];
+            m_plane[i]    = NULL;
+            m_blocks_w[i] = 0;
+            m_blocks_h[i] = 0;
+        }
+        m_num_comps = 0;
+        m_arena     = NULL;
+    }
+
+    int      num_comps(void)                   { return m_num_comps; }
+    int      blocks_w(int comp)                { return m_blocks_w[comp]; }
+    int      blocks_h(int comp)                { return m_blocks_h[comp]; }
+
+    // Number of coefficients between the start of adjacent block rows
+    int      row_stride(int comp)              { return m_blocks_w[comp] * 64; }
+    int16_t *block_row(int comp, int by)       { return m_plane[comp] + (by * row_stride(comp)); }
+    int16_t *block(int comp, int bx, int by)   { return block_row(comp, by) + (bx * 64); }
+
+private:
+    int      m_num_comps;
+    int      m_blocks_w[JPEG_COEFF_MAX_COMPS];
+    int      m_blocks_h[JPEG_COEFF_MAX_COMPS];
+    int16_t *m_plane[JPEG_COEFF_MAX_COMPS];
+    jpeg_arena *m_arena; // Planes owned by an arena (not freed here)
+};
+
+//-----------------------------------------------------------------------------
+// jpeg_coeff_decoder: Entropy decode a scan into coefficient planes, without
+//                     running the IDCT or colour conversion.
+//-----------------------------------------------------------------------------
+class jpeg_coeff_decoder
+{
+public:
+    jpeg_coeff_decoder(jpeg_mcu_block *mcu_dec, jpeg_dqt *dqt)
+    {
+        m_mcu_dec    = mcu_dec;
+        m_dqt        = dqt;
+    }
+
+    //-------------------------------------------------------------------------
+    // decode_mcu: Decode a single MCU at (mx, my) using / updating the DC
+    //             predictors dc_pred[Y, Cb, Cr].
+    //-------------------------------------------------------------------------
+    bool decode_mcu(t_jpeg_mode mode, const uint8_t *dqt_table, bool dequantize,
+                    int mx, int my, int16_t *dc_pred, jpeg_coeff_planes *planes)
+    {
+        m_dequantize = dequantize;
+
+        // [Y0 Y1 Y2 Y3 Cb Cr] x N
+        if (mode == JPEG_YCBCR_420)
+        {
+            decode_block(DHT_TABLE_Y_DC_IDX,  dc_pred[0], dqt_table[0], planes->block(0, (mx*2)+0, (my*2)+0));
+            decode_block(DHT_TABLE_Y_DC_IDX,  dc_pred[0], dqt_table[0], planes->block(0, (mx*2)+1, (my*2)+0));
+            decode_block(DHT_TABLE_Y_DC_IDX,  dc_pred[0], dqt_table[0], planes->block(0, (mx*2)+0, (my*2)+1));
+            decode_block(DHT_TABLE_Y_DC_IDX,  dc_pred[0], dqt_table[0], planes->block(0, (mx*2)+1, (my*2)+1));
+            decode_block(DHT_TABLE_CX_DC_IDX, dc_pred[1], dqt_table[1], planes->block(1, mx, my));
+            decode_block(DHT_TABLE_CX_DC_IDX, dc_pred[2], dqt_table[2], planes->block(2, mx, my));
+        }
+        // [Y0 Y1 Cb Cr] x N
+        else if (mode == JPEG_YCBCR_422)
+        {
+            decode_block(DHT_TABLE_Y_DC_IDX,  dc_pred[0], dqt_table[0], planes->block(0, (mx*2)+0, my));
+            decode_block(DHT_TABLE_Y_DC_IDX,  dc_pred[0], dqt_table[0], planes->block(0, (mx*2)+1, my));
+            decode_block(DHT_TABLE_CX_DC_IDX, dc_pred[1], dqt_table[1], planes->block(1, mx, my));
+            decode_block(DHT_TABLE_CX_DC_IDX, dc_pred[2], dqt_table[2], planes->block(2, mx, my));
+        }
+        // [Y Cb Cr] x N
+        else if (mode == JPEG_YCBCR_444)
+        {
+            decode_block(DHT_TABLE_Y_DC_IDX,  dc_pred[0], dqt_table[0], planes->block(0, mx, my));
+            decode_block(DHT_TABLE_CX_DC_IDX, dc_pred[1], dqt_table[1], planes->block(1, mx, my));
+            decode_block(DHT_TABLE_CX_DC_IDX, dc_pred[2], dqt_table[2], planes->block(2, mx, my));
+        }
+        // [Y] x N
+        else if (mode == JPEG_MONOCHROME)
+            decode_block(DHT_TABLE_Y_DC_IDX,  dc_pred[0], dqt_table[0], planes->block(0, mx, my));
+        else
+            return false;
+
+        return true;
+    }
+
+private:
+    //-------------------------------------------------------------------------
+    // decode_block: Huffman decode one block and scatter it (de-zigzagged)
+    //-------------------------------------------------------------------------
+    void decode_block(int table_idx, int16_t &olddccoeff, int quant_table, int16_t *block_out)
+    {
+        int count = m_mcu_dec->decode(table_idx, olddccoeff, m_samples);
+
+        memset(block_out, 0, 64 * sizeof(int16_t));
+        for (int i=0;i<count;i++)
+        {
+            int16_t smpl = (int16_t)(m_samples[i] & 0xFFFF);
+            int     idx  = (m_samples[i] >> 16);
+
+            if (m_dequantize)
+                smpl = smpl * m_dqt->lookup(quant_table, idx);
+
+            dprintf("COEFF: %d: %d @ %d\n", idx, smpl, m_zigzag_table[idx]);
+            block_out[m_zigzag_table[idx]] = smpl;
+        }
+    }
+
+private:
+    jpeg_mcu_block  *m_mcu_dec;
+    jpeg_dqt        *m_dqt;
+    bool             m_dequantize;
+    int32_t          m_samples[64];
+};
+
+#endif
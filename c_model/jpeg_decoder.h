@@ -0,0 +1,844 @@
+#ifndef JPEG_DECODER_H
+#define JPEG_DECODER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "jpeg_dqt.h"
+#include "jpeg_dht.h"
+#include "jpeg_idct.h"
+#include "jpeg_idct_ifast.h"
+#include "jpeg_idct_aan.h"  // Added aan IDCT header
+#include "jpeg_bit_buffer.h"
+#include "jpeg_mcu_block.h"
+#include "jpeg_image.h"
+#include "jpeg_arena.h"
+#include "jpeg_coeff.h"
+#include "jpeg_output.h"
+#include "jpeg_trace.h"
+
+#define dprintf
+#define dprintf_blk(_name, _arr, _max) for (int __i=0;__i<_max;__i++) { dprintf("%s: %d -> %d\n", _name, __i, _arr[__i]); }
+#define jpeg_log(...)   do { if (m_verbose) printf(__VA_ARGS__); } while (0)
+
+// Window of entropy coded data held at once (independent of image size).
+// Must be larger than the biggest possible MCU (6 blocks ~1.3KB).
+#ifndef JPEG_SCAN_BUFFER_SIZE
+#define JPEG_SCAN_BUFFER_SIZE    4096
+#endif
+
+// Largest SOF0 / DQT / DHT / SOS segment payload
+#ifndef JPEG_SEGMENT_BUFFER_SIZE
+#define JPEG_SEGMENT_BUFFER_SIZE 2048
+#endif
+
+#define JPEG_MAX_MCU_BLOCKS      6
+
+typedef enum eJpgDecStatus
+{
+    JPEG_DEC_NEED_DATA,
+    JPEG_DEC_DONE,
+    JPEG_DEC_ERROR
+} t_jpeg_dec_status;
+
+class jpeg_decoder;
+
+// Called once the frame header (SOF0) has been parsed - bind an output here
+typedef void (*t_jpeg_header_cb)(void *ctx, jpeg_decoder *dec);
+
+// Called as each MCU row has been written to the output
+typedef void (*t_jpeg_rows_cb)(void *ctx, jpeg_decoder *dec, int y_start, int rows);
+
+//-----------------------------------------------------------------------------
+// jpeg_decoder: Push style (incremental) baseline JPEG decoder.
+// Input can be supplied in arbitrarily sized chunks with feed(). If the
+// entropy coded data runs out part way through an MCU, the decoder rewinds
+// to the start of that MCU (bit position, DC predictors, MCU position) and
+// resumes from there when more data is fed.
+//-----------------------------------------------------------------------------
+class jpeg_decoder
+{
+public:
+    jpeg_decoder(): m_bit_buffer(m_scan_buf, JPEG_SCAN_BUFFER_SIZE),
+                    m_mcu_dec(&m_bit_buffer, &m_dht),
+                    m_coeff_dec(&m_mcu_dec, &m_dqt)
+    {
+        m_header_cb     = NULL;
+        m_rows_cb       = NULL;
+        m_cb_ctx        = NULL;
+        m_coeff_planes  = NULL;
+        m_coeff_dequant = false;
+        m_dc_only       = false;
+        m_fixed_colour  = false;
+        m_verbose       = true;
+        m_trace         = NULL;
+        reset();
+    }
+
+    //-------------------------------------------------------------------------
+    // reset: Prepare for a new image (callbacks / options are retained).
+    //        Releases the previous image's arena allocations.
+    //-------------------------------------------------------------------------
+    void reset(void)
+    {
+        m_dqt.reset();
+        m_dht.reset();
+        m_idct.reset();
+        m_output.reset();
+        m_bit_buffer.reset();
+        m_arena.reset();
+
+        m_status       = JPEG_DEC_NEED_DATA;
+        m_state        = STATE_MARKER;
+        m_last_b       = 0;
+        m_mode         = JPEG_UNSUPPORTED;
+        m_width        = 0;
+        m_height       = 0;
+        m_output_bound = false;
+        m_scan_done    = false;
+        m_mcu_count    = 0;
+        m_mcu_total    = 0;
+        m_mcu_end      = 0;
+        m_restart      = 0;
+        m_trace_block  = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    // Configuration
+    //-------------------------------------------------------------------------
+    void set_callbacks(t_jpeg_header_cb header_cb, t_jpeg_rows_cb rows_cb, void *ctx)
+    {
+        m_header_cb = header_cb;
+        m_rows_cb   = rows_cb;
+        m_cb_ctx    = ctx;
+    }
+
+    // Coefficient only decode into 'planes' (NULL to decode to pixels).
+    // The planes are allocated from the decoder arena and remain valid until
+    // the next reset().
+    void set_coeff_output(jpeg_coeff_planes *planes, bool dequantize)
+    {
+        m_coeff_planes  = planes;
+        m_coeff_dequant = dequantize;
+    }
+
+    // DC only decode: 1/8 scale output, one pixel per block from its DC
+    // coefficient (AC coefficients are entropy decoded but not used). The
+    // output is out_width() x out_height(), colour converted as the RTL.
+    void set_dc_only(bool dc_only) { m_dc_only = dc_only; }
+
+    // Colour convert with the fixed point (Q12) constants of the RTL
+    // (jpeg_output.v) instead of floating point, for exact co-simulation.
+    void set_fixed_colour(bool fixed) { m_fixed_colour = fixed; }
+
+    void set_verbose(bool verbose) { m_verbose = verbose; }
+
+    // Per-block trace of the dequantised coefficients, IDCT output and pixels
+    // (pixel decode only, NULL to disable). See jpeg_trace.h.
+    void set_trace(jpeg_trace *trace) { m_trace = trace; }
+
+    // Bind the destination frame buffer (once the header is known)
+    bool set_output(const t_jpeg_output_desc *desc)
+    {
+        m_output.set_fixed_colour(m_fixed_colour);
+        m_output_bound = m_output.init(desc, m_mode, out_width(), out_height());
+        return m_output_bound;
+    }
+
+    //-------------------------------------------------------------------------
+    // Image properties (valid from the header callback onwards)
+    //-------------------------------------------------------------------------
+    t_jpeg_mode       mode(void)   { return m_mode; }
+    int               width(void)  { return m_width; }
+    int               height(void) { return m_height; }
+    int               out_width(void)  { return m_dc_only ? (m_width  + 7) / 8 : m_width; }
+    int               out_height(void) { return m_dc_only ? (m_height + 7) / 8 : m_height; }
+    t_jpeg_dec_status status(void) { return m_status; }
+
+    // Per-image buffer arena (for allocation statistics)
+    jpeg_arena       *arena(void)  { return &m_arena; }
+
+    //-------------------------------------------------------------------------
+    // feed: Consume input bytes, decoding as much as possible.
+    //       Returns the number of bytes consumed (less than len only once
+    //       decoding has finished or failed).
+    //-------------------------------------------------------------------------
+    int feed(const uint8_t *data, int len)
+    {
+        int i = 0;
+
+        while (i < len && m_status == JPEG_DEC_NEED_DATA)
+        {
+            if (m_state != STATE_SCAN)
+            {
+                parse_byte(data[i++]);
+                continue;
+            }
+
+            // Entropy coded data
+            while (i < len && m_bit_buffer.space())
+            {
+                if (m_bit_buffer.push(data[i]))
+                    i++;
+                // Restart marker: next interval of the same scan
+                else if (m_restart && data[i] >= 0xd0 && data[i] <= 0xd7)
+                    restart_scan(data[i++]);
+                // Marker detected (leave it for the marker parser)
+                else
+                {
+                    end_scan();
+                    break;
+                }
+            }
+
+            if (m_state == STATE_SCAN)
+            {
+                int mcu_count = m_mcu_count;
+                decode_mcus();
+
+                // Window full without completing an MCU
+                if (!m_bit_buffer.space() && mcu_count == m_mcu_count)
+                {
+                    jpeg_log("ERROR: Scan buffer overflow\n");
+                    m_status = JPEG_DEC_ERROR;
+                }
+            }
+        }
+
+        return i;
+    }
+
+    //-------------------------------------------------------------------------
+    // finish: Signal end of input. Returns true if an image was decoded.
+    //-------------------------------------------------------------------------
+    bool finish(void)
+    {
+        if (m_status == JPEG_DEC_NEED_DATA && m_state == STATE_SCAN)
+            end_scan();
+
+        if (m_status == JPEG_DEC_NEED_DATA)
+            m_status = m_scan_done ? JPEG_DEC_DONE : JPEG_DEC_ERROR;
+
+        return m_status == JPEG_DEC_DONE;
+    }
+
+private:
+    //-------------------------------------------------------------------------
+    // parse_byte: Marker / segment parser
+    //-------------------------------------------------------------------------
+    void parse_byte(uint8_t b)
+    {
+        switch (m_state)
+        {
+            case STATE_MARKER:
+            {
+                uint8_t last_b = m_last_b;
+                m_last_b = b;
+                if (last_b == 0xFF)
+                    parse_marker(b);
+            }
+            break;
+            case STATE_SEG_LENH:
+                m_seg_len = b << 8;
+                m_state   = STATE_SEG_LENL;
+                break;
+            case STATE_SEG_LENL:
+                m_seg_len |= b;
+                m_seg_pos  = 0;
+                if (m_seg_len <= 2)
+                    end_segment();
+                else if (!m_seg_buffered)
+                    m_state = STATE_SEG_SKIP;
+                else if ((m_seg_len - 2) <= JPEG_SEGMENT_BUFFER_SIZE)
+                    m_state = STATE_SEG_DATA;
+                else
+                {
+                    jpeg_log("ERROR: Segment too large\n");
+                    m_status = JPEG_DEC_ERROR;
+                }
+                break;
+            case STATE_SEG_DATA:
+                m_seg_buf[m_seg_pos++] = b;
+                if (m_seg_pos == (m_seg_len - 2))
+                    process_segment();
+                break;
+            case STATE_SEG_SKIP:
+                if (++m_seg_pos == (m_seg_len - 2))
+                    end_segment();
+                break;
+            default:
+                break;
+        }
+    }
+
+    void begin_segment(uint8_t marker, bool buffered)
+    {
+        m_seg_marker   = marker;
+        m_seg_buffered = buffered;
+        m_state        = STATE_SEG_LENH;
+    }
+
+    void end_segment(void)
+    {
+        m_state  = STATE_MARKER;
+        m_last_b = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    // parse_marker: Marker following an 0xFF
+    //-------------------------------------------------------------------------
+    void parse_marker(uint8_t b)
+    {
+        //-----------------------------------------------------------------------------
+        // SOI: Start of image
+        //-----------------------------------------------------------------------------
+        if (b == 0xd8)
+            jpeg_log("Section: SOI\n");
+        //-----------------------------------------------------------------------------
+        // SOF0: Indicates that this is a baseline DCT-based JPEG
+        //-----------------------------------------------------------------------------
+        else if (b == 0xc0)
+        {
+            jpeg_log("Section: SOF0\n");
+            begin_segment(b, true);
+        }
+        //-----------------------------------------------------------------------------
+        // DQT: Quantisation table
+        //-----------------------------------------------------------------------------
+        else if (b == 0xdb)
+        {
+            jpeg_log("Section: DQT Table\n");
+            begin_segment(b, true);
+        }
+        //-----------------------------------------------------------------------------
+        // DHT: Huffman table
+        //-----------------------------------------------------------------------------
+        else if (b == 0xc4)
+        {
+            jpeg_log("Section: DHT Table\n");
+            begin_segment(b, true);
+        }
+        //-----------------------------------------------------------------------------
+        // EOI: End of image
+        //-----------------------------------------------------------------------------
+        else if (b == 0xd9)
+        {
+            jpeg_log("Section: EOI\n");
+            m_status = m_scan_done ? JPEG_DEC_DONE : JPEG_DEC_ERROR;
+        }
+        //-----------------------------------------------------------------------------
+        // SOS: Start of Scan Segment (SOS)
+        //-----------------------------------------------------------------------------
+        else if (b == 0xda)
+        {
+            jpeg_log("Section: SOS\n");
+
+            if (m_mode == JPEG_UNSUPPORTED)
+            {
+                jpeg_log("ERROR: Unsupported JPEG mode\n");
+                m_status = JPEG_DEC_ERROR;
+            }
+            else
+                begin_segment(b, true);
+        }
+        //-----------------------------------------------------------------------------
+        // Unsupported / Skipped
+        //-----------------------------------------------------------------------------
+        else if (b == 0xc2)
+        {
+            jpeg_log("Section: SOF2\n");
+            jpeg_log("ERROR: Progressive JPEG not supported\n");
+            m_status = JPEG_DEC_ERROR;
+        }
+        //-----------------------------------------------------------------------------
+        // DRI: Restart interval
+        //-----------------------------------------------------------------------------
+        else if (b == 0xdd)
+        {
+            jpeg_log("Section: DRI\n");
+            begin_segment(b, true);
+        }
+        else if (b >= 0xd0 && b <= 0xd7)
+            jpeg_log("Section: RST%d\n", b - 0xd0);
+        else if (b >= 0xe0 && b <= 0xef)
+        {
+            jpeg_log("Section: APP%d\n", b - 0xe0);
+            begin_segment(b, false);
+        }
+        else if (b == 0xfe)
+        {
+            jpeg_log("Section: COM\n");
+            begin_segment(b, false);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // process_segment: Fully buffered segment payload
+    //-------------------------------------------------------------------------
+    void process_segment(void)
+    {
+        uint8_t *buf = m_seg_buf;
+        int      i   = 0;
+
+        end_segment();
+
+        if (m_seg_marker == 0xc0)
+        {
+            // Precision of the frame data
+            uint8_t  precision = buf[i++];
+
+            // Image height in pixels
+            m_height = (buf[i] << 8) | buf[i+1]; i += 2;
+
+            // Image width in pixels
+            m_width  = (buf[i] << 8) | buf[i+1]; i += 2;
+
+            // # of components (n) in frame, 1 for monochrom, 3 for colour images
+            uint8_t num_comps = buf[i++];
+            if (num_comps > 3)
+            {
+                jpeg_log("ERROR: Too many components\n");
+                m_status = JPEG_DEC_ERROR;
+                return;
+            }
+
+            jpeg_log(" x=%d, y=%d, components=%d\n", m_width, m_height, num_comps);
+            uint8_t comp_id[3];
+            uint8_t comp_sample_factor[3];
+            uint8_t horiz_factor[3];
+            uint8_t vert_factor[3];
+
+            for (int x=0;x<num_comps;x++)
+            {
+                // First byte identifies the component
+                comp_id[x] = buf[i++];
+                // id: 1 = Y, 2 = Cb, 3 = Cr
+
+                // Second byte represents sampling factor (first four MSBs represent horizonal, last four LSBs represent vertical)
+                comp_sample_factor[x] = buf[i++];
+                horiz_factor[x]       = comp_sample_factor[x] >> 4;
+                vert_factor[x]        = comp_sample_factor[x] & 0xF;
+
+                // Third byte represents which quantization table to use for this component
+                m_dqt_table[x]        = buf[i++];
+                jpeg_log(" num: %d a: %02x b: %02x\n", comp_id[x], comp_sample_factor[x], m_dqt_table[x]);
+                jpeg_log(" horiz_factor: %d, vert_factor: %d\n", horiz_factor[x], vert_factor[x]);
+            }
+
+            m_mode = JPEG_UNSUPPORTED;
+
+            // Single component (Y)
+            if (num_comps == 1)
+            {
+                jpeg_log(" Mode: Monochrome\n");
+                m_mode = JPEG_MONOCHROME;
+            }
+            // Colour image (YCbCr)
+            else if (num_comps == 3)
+            {
+                // YCbCr ordering expected
+                if (comp_id[0] == 1 && comp_id[1] == 2 && comp_id[2] == 3)
+                {
+                    if (horiz_factor[0] == 1 && vert_factor[0] == 1 &&
+                        horiz_factor[1] == 1 && vert_factor[1] == 1 &&
+                        horiz_factor[2] == 1 && vert_factor[2] == 1)
+                    {
+                        m_mode = JPEG_YCBCR_444;
+                        jpeg_log(" Mode: YCbCr 4:4:4\n");
+                    }
+                    else if (horiz_factor[0] == 2 && vert_factor[0] == 2 &&
+                             horiz_factor[1] == 1 && vert_factor[1] == 1 &&
+                             horiz_factor[2] == 1 && vert_factor[2] == 1)
+                    {
+                        m_mode = JPEG_YCBCR_420;
+                        jpeg_log(" Mode: YCbCr 4:2:0\n");
+                    }
+                    else if (horiz_factor[0] == 2 && vert_factor[0] == 1 &&
+                             horiz_factor[1] == 1 && vert_factor[1] == 1 &&
+                             horiz_factor[2] == 1 && vert_factor[2] == 1)
+                    {
+                        m_mode = JPEG_YCBCR_422;
+                        jpeg_log(" Mode: YCbCr 4:2:2\n");
+                    }
+                }
+            }
+
+            (void)precision;
+
+            if (m_mode != JPEG_UNSUPPORTED && m_header_cb)
+                m_header_cb(m_cb_ctx, this);
+        }
+        else if (m_seg_marker == 0xdd && m_seg_len >= 4)
+        {
+            m_restart = (buf[0] << 8) | buf[1];
+            jpeg_log(" Restart interval: %d MCUs\n", m_restart);
+        }
+        else if (m_seg_marker == 0xdb)
+            m_dqt.process(buf, m_seg_len);
+        else if (m_seg_marker == 0xc4)
+            m_dht.process(buf, m_seg_len);
+        else if (m_seg_marker == 0xda)
+        {
+            // Component count (n)
+            uint8_t  comp_count = buf[i++];
+
+            // Component data
+            for (int x=0;x<comp_count;x++)
+            {
+                // First byte denotes component ID
+                uint8_t comp_id = buf[i++];
+
+                // Second byte denotes the Huffman table used (first four MSBs denote Huffman table for DC, and last four LSBs denote Huffman table for AC)
+                uint8_t comp_table = buf[i++];
+
+                jpeg_log(" %d: ID=%x Table=%x\n", x, comp_id, comp_table);
+            }
+
+            start_scan();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // start_scan: Setup for entropy coded data following SOS
+    //-------------------------------------------------------------------------
+    void start_scan(void)
+    {
+        if (m_coeff_planes)
+        {
+            if (!m_coeff_planes->init(m_mode, m_width, m_height, &m_arena))
+            {
+                jpeg_log("ERROR: Could not allocate coefficient planes\n");
+                m_status = JPEG_DEC_ERROR;
+                return;
+            }
+        }
+        else if (!m_output_bound)
+        {
+            jpeg_log("ERROR: No output buffer\n");
+            m_status = JPEG_DEC_ERROR;
+            return;
+        }
+
+        m_bit_buffer.reset();
+        m_bit_buffer.set_final(false);
+
+        m_dc_pred[0] = 0;
+        m_dc_pred[1] = 0;
+        m_dc_pred[2] = 0;
+
+        m_mcus_x    = (m_width  + jpeg_mcu_width(m_mode)  - 1) / jpeg_mcu_width(m_mode);
+        m_mcus_y    = (m_height + jpeg_mcu_height(m_mode) - 1) / jpeg_mcu_height(m_mode);
+        m_mcu_total = m_mcus_x * m_mcus_y;
+        m_mcu_count = 0;
+        m_mcu_end   = (m_restart && m_restart < m_mcu_total) ? m_restart : m_mcu_total;
+        m_mcu_x     = 0;
+        m_mcu_y     = 0;
+
+        m_state     = STATE_SCAN;
+    }
+
+    //-------------------------------------------------------------------------
+    // restart_scan: RSTn marker - finish the restart interval, then continue
+    //               from the next byte with the DC predictors reset
+    //-------------------------------------------------------------------------
+    void restart_scan(uint8_t marker)
+    {
+        m_bit_buffer.set_final(true);
+        decode_mcus();
+
+        if (m_mcu_count != m_mcu_end)
+            jpeg_log("WARNING: RST%d after %d MCUs (expected %d)\n", marker - 0xd0, m_mcu_count, m_mcu_end);
+
+        m_bit_buffer.reset();
+        m_bit_buffer.set_final(false);
+
+        m_dc_pred[0] = 0;
+        m_dc_pred[1] = 0;
+        m_dc_pred[2] = 0;
+
+        m_mcu_end = m_mcu_count + m_restart;
+        if (m_mcu_end > m_mcu_total)
+            m_mcu_end = m_mcu_total;
+    }
+
+    //-------------------------------------------------------------------------
+    // end_scan: Marker (or end of input) reached - decode remaining MCUs
+    //-------------------------------------------------------------------------
+    void end_scan(void)
+    {
+        m_bit_buffer.set_final(true);
+        decode_mcus();
+
+        m_scan_done = true;
+        m_state     = STATE_MARKER;
+        m_last_b    = 0xFF;
+    }
+
+    //-------------------------------------------------------------------------
+    // decode_mcus: Decode as many MCUs as the buffered data allows
+    //-------------------------------------------------------------------------
+    void decode_mcus(void)
+    {
+        while (m_mcu_count < m_mcu_end && !m_bit_buffer.eof())
+        {
+            int16_t dc_pred[3] = { m_dc_pred[0], m_dc_pred[1], m_dc_pred[2] };
+
+            m_bit_buffer.mark();
+            if (!decode_mcu())
+            {
+                // Suspend: restart this MCU once more data arrives
+                m_bit_buffer.rewind();
+                m_dc_pred[0] = dc_pred[0];
+                m_dc_pred[1] = dc_pred[1];
+                m_dc_pred[2] = dc_pred[2];
+                break;
+            }
+
+            m_mcu_count++;
+            if (++m_mcu_x == m_mcus_x)
+            {
+                int mcu_h   = m_dc_only ? (jpeg_mcu_height(m_mode) / 8) : jpeg_mcu_height(m_mode);
+                int y_start = m_mcu_y * mcu_h;
+                int rows    = out_height() - y_start;
+                if (rows > mcu_h)
+                    rows = mcu_h;
+
+                m_mcu_x = 0;
+                m_mcu_y++;
+
+                if (m_rows_cb)
+                    m_rows_cb(m_cb_ctx, this, y_start, rows);
+            }
+        }
+
+        // Any further scan data (in this restart interval) is padding
+        if (m_mcu_count == m_mcu_end)
+            m_bit_buffer.discard();
+        else
+        {
+            m_bit_buffer.mark();
+            m_bit_buffer.compact();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // decode_mcu: Decode one MCU. Returns false if the scan data ran out.
+    //-------------------------------------------------------------------------
+    bool decode_mcu(void)
+    {
+        if (m_coeff_planes)
+        {
+            m_coeff_dec.decode_mcu(m_mode, m_dqt_table, m_coeff_dequant, m_mcu_x, m_mcu_y, m_dc_pred, m_coeff_planes);
+            return !m_bit_buffer.underrun();
+        }
+
+        // [Y0 Y1 Y2 Y3 Cb Cr], [Y0 Y1 Cb Cr], [Y Cb Cr] or [Y]
+        static const int comp_420[] = { 0, 0, 0, 0, 1, 2 };
+        static const int comp_422[] = { 0, 0, 1, 2 };
+        static const int comp_444[] = { 0, 1, 2 };
+        static const int comp_mono[]= { 0 };
+
+        const int *comp;
+        int        blocks;
+        if (m_mode == JPEG_YCBCR_420)
+            comp = comp_420, blocks = 6;
+        else if (m_mode == JPEG_YCBCR_422)
+            comp = comp_422, blocks = 4;
+        else if (m_mode == JPEG_YCBCR_444)
+            comp = comp_444, blocks = 3;
+        else
+            comp = comp_mono, blocks = 1;
+
+        // Entropy decode the whole MCU before producing any output
+        for (int b=0;b<blocks;b++)
+        {
+            int table_idx = comp[b] ? DHT_TABLE_CX_DC_IDX : DHT_TABLE_Y_DC_IDX;
+            m_sample_count[b] = m_mcu_dec.decode(table_idx, m_dc_pred[comp[b]], m_sample_out[b]);
+        }
+
+        if (m_bit_buffer.underrun())
+            return false;
+
+        if (m_dc_only)
+        {
+            decode_dc_mcu(comp, blocks);
+            return true;
+        }
+
+        int y_blk = 0;
+        for (int b=0;b<blocks;b++)
+        {
+            int *dct_out = (comp[b] == 0) ? &m_y_dct_out[64 * y_blk++] :
+                           (comp[b] == 1) ? m_cb_dct_out : m_cr_dct_out;
+
+            m_dqt.process_samples(m_dqt_table[comp[b]], m_sample_out[b], m_block_out, m_sample_count[b]);
+            dprintf_blk("DCT-IN", m_block_out, 64);
+            if (m_trace)
+                m_trace->write_coeffs(JPEG_TRACE_DQT, comp[b], m_trace_block + b, m_mcu_x * jpeg_mcu_width(m_mode),
+                                      m_mcu_y * jpeg_mcu_height(m_mode), m_block_out);
+            m_idct.process(m_block_out, dct_out);
+            if (m_trace)
+                m_trace->write_coeffs(JPEG_TRACE_IDCT, comp[b], m_trace_block + b, m_mcu_x * jpeg_mcu_width(m_mode),
+                                      m_mcu_y * jpeg_mcu_height(m_mode), dct_out);
+        }
+
+        m_output.output_mcu(m_mcu_x * jpeg_mcu_width(m_mode), m_mcu_y * jpeg_mcu_height(m_mode),
+                            m_y_dct_out, m_cb_dct_out, m_cr_dct_out);
+
+        if (m_trace)
+        {
+            trace_pixels();
+            m_trace_block += blocks;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // decode_dc_mcu: DC only output of an entropy decoded MCU. A block with
+    //                only a DC coefficient has a flat IDCT output of DC / 8.
+    //-------------------------------------------------------------------------
+    void decode_dc_mcu(const int *comp, int blocks)
+    {
+        int y_val[4];
+        int cx_val[3] = { 0, 0, 0 };
+        int y_blk = 0;
+
+        for (int b=0;b<blocks;b++)
+        {
+            // First sample is always the DC (index 0), dequantised to 16-bits as the RTL
+            int16_t dc = (int16_t)(m_sample_out[b][0] & 0xFFFF);
+            int16_t dq = (int16_t)(dc * m_dqt.lookup(m_dqt_table[comp[b]], 0));
+            int     v  = (dq + 4) >> 3;
+
+            if (comp[b] == 0)
+                y_val[y_blk++] = v;
+            else
+                cx_val[comp[b]] = v;
+        }
+
+        m_output.output_dc_mcu(m_mcu_x * (jpeg_mcu_width(m_mode) / 8), m_mcu_y * (jpeg_mcu_height(m_mode) / 8),
+                               y_val, cx_val[1], cx_val[2]);
+    }
+
+    //-------------------------------------------------------------------------
+    // trace_pixels: Trace the RGB output of each luma block of the MCU
+    //               (whole 8x8 blocks, including any padding past the edge)
+    //-------------------------------------------------------------------------
+    void trace_pixels(void)
+    {
+        uint8_t rgb[64*3];
+        int     x_start = m_mcu_x * jpeg_mcu_width(m_mode);
+        int     y_start = m_mcu_y * jpeg_mcu_height(m_mode);
+
+        if (m_mode == JPEG_YCBCR_420)
+        {
+            for (int b=0;b<4;b++)
+            {
+                int cx = (b & 1) * 8;
+                int cy = (b >> 1) * 8;
+                m_output.block_rgb(&m_y_dct_out[64 * b], m_cb_dct_out, m_cr_dct_out, cx, cy, 1, 1, rgb);
+                m_trace->write_pixels(0, m_trace_block + b, x_start + cx, y_start + cy, rgb);
+            }
+        }
+        else if (m_mode == JPEG_YCBCR_422)
+        {
+            for (int b=0;b<2;b++)
+            {
+                int cx = b * 8;
+                m_output.block_rgb(&m_y_dct_out[64 * b], m_cb_dct_out, m_cr_dct_out, cx, 0, 1, 0, rgb);
+                m_trace->write_pixels(0, m_trace_block + b, x_start + cx, y_start, rgb);
+            }
+        }
+        else
+        {
+            m_output.block_rgb(m_y_dct_out, m_cb_dct_out, m_cr_dct_out, 0, 0, 0, 0, rgb);
+            m_trace->write_pixels(0, m_trace_block, x_start, y_start, rgb);
+        }
+    }
+
+private:
+    enum
+    {
+        STATE_MARKER,
+        STATE_SEG_LENH,
+        STATE_SEG_LENL,
+        STATE_SEG_DATA,
+        STATE_SEG_SKIP,
+        STATE_SCAN
+    };
+
+    jpeg_dqt           m_dqt;
+    jpeg_dht           m_dht;
+
+// Select IDCT implementation based on Makefile defines
+#if defined(IDCT_IFAST)
+    jpeg_idct_ifast    m_idct;
+#elif defined(IDCT_AAN)
+    idct_aan           m_idct;
+#else
+    jpeg_idct          m_idct;  // Default fallback (if neither is defined)
+#endif
+
+    // Fixed size scan window, per-image buffers come from the arena
+    uint8_t            m_scan_buf[JPEG_SCAN_BUFFER_SIZE + JPEG_BIT_BUFFER_SLACK];
+    jpeg_arena         m_arena;
+
+    jpeg_bit_buffer    m_bit_buffer;
+    jpeg_mcu_block     m_mcu_dec;
+    jpeg_coeff_decoder m_coeff_dec;
+    jpeg_output        m_output;
+
+    // Options
+    t_jpeg_header_cb   m_header_cb;
+    t_jpeg_rows_cb     m_rows_cb;
+    void              *m_cb_ctx;
+    jpeg_coeff_planes *m_coeff_planes;
+    bool               m_coeff_dequant;
+    bool               m_dc_only;
+    bool               m_fixed_colour;
+    bool               m_verbose;
+    jpeg_trace        *m_trace;
+
+    // Parser state
+    t_jpeg_dec_status  m_status;
+    int                m_state;
+    uint8_t            m_last_b;
+    uint8_t            m_seg_marker;
+    bool               m_seg_buffered;
+    int                m_seg_len;
+    int                m_seg_pos;
+    uint8_t            m_seg_buf[JPEG_SEGMENT_BUFFER_SIZE];
+
+    // Image
+    t_jpeg_mode        m_mode;
+    uint16_t           m_width;
+    uint16_t           m_height;
+    uint8_t            m_dqt_table[3];
+    bool               m_output_bound;
+    bool               m_scan_done;
+
+    // Scan position
+    int16_t            m_dc_pred[3];
+    int                m_mcus_x;
+    int                m_mcus_y;
+    int                m_mcu_x;
+    int                m_mcu_y;
+    int                m_mcu_count;
+    int                m_mcu_total;
+    int                m_mcu_end;       // End of the current restart interval (or m_mcu_total)
+    int                m_restart;       // Restart interval (MCUs, 0 = none)
+    uint32_t           m_trace_block;
+
+    // MCU working buffers
+    int32_t            m_sample_out[JPEG_MAX_MCU_BLOCKS][64];
+    int                m_sample_count[JPEG_MAX_MCU_BLOCKS];
+    int                m_block_out[64];
+    int                m_y_dct_out[4*64];
+    int                m_cb_dct_out[64];
+    int                m_cr_dct_out[64];
+};
+
+#endif
@@ -18,6 +18,14 @@
 
 #define dprintf
 
+#ifndef TEST_HOOKS_DHT
+#define TEST_HOOKS_DHT(x)
+#endif
+
+#ifndef TEST_HOOKS_DHT_DECL
+#define TEST_HOOKS_DHT_DECL
+#endif
+
 //-----------------------------------------------------------------------------
 // jpeg_dqt:
 //-----------------------------------------------------------------------------
@@ -116,6 +124,7 @@ public:
             //printf(" == %04x -> %02x\n", bitmap, value);
             if (shift_val == bitmap)
             {
+                TEST_HOOKS_DHT(width);
                 value   = m_dht_table[table_idx].value[i];
                 return width;
             }
@@ -123,6 +132,8 @@ public:
         return 0;
     }
 
+    TEST_HOOKS_DHT_DECL;
+
 private:
     typedef struct
     {
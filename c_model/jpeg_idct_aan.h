@@ -26,9 +26,11 @@ public:
 
 private:
 void rowIDCT_aan(int* blk) {
+#ifdef JPEG_IDCT_DEBUG
     printf("rowIDCT_aan input: ");
     for (int i = 0; i < 8; i++) printf("%d ", blk[i]);
     printf("\n");
+#endif
 
     const int FIX_0_707106781 = 5793;  // sqrt(2)/2 * 2^13
     const int FIX_0_382683433 = 3135;  // cos(6π/16) * 2^13
@@ -79,12 +79,14 @@ private:
         blk[6] = (t1 - t6) >> 8;
         blk[7] = (t0 - t7) >> 8;
 
+#ifdef JPEG_IDCT_DEBUG
             // Debug print
             printf("rowIDCT: ");
             for (int i = 0; i < DCTSIZE; i++) {
                 printf("%d ", blk[i]);
             }
             printf("\n");
+#endif
     }
 
     void colIDCT(const int* blk, int *out, int stride) {
@@ -145,12 +147,14 @@ private:
         *out = (t1 - t6) >> 14;  out += stride;
         *out = (t0 - t7) >> 14;
 
+#ifdef JPEG_IDCT_DEBUG
             // Debug print
             printf("colIDCT: ");
             for (int i = 0; i < DCTSIZE; i++) {
                 printf("%d ", out[i * stride]);
             }
             printf("\n");
+#endif
     }
 
 public:
@@ -0,0 +1,29 @@
+#ifndef JPEG_IMAGE_H
+#define JPEG_IMAGE_H
+
+//-----------------------------------------------------------------------------
+// Image (chroma subsampling) modes
+//-----------------------------------------------------------------------------
+typedef enum eJpgMode
+{
+    JPEG_MONOCHROME,
+    JPEG_YCBCR_444,
+    JPEG_YCBCR_420,
+    JPEG_YCBCR_422,
+    JPEG_UNSUPPORTED
+} t_jpeg_mode;
+
+//-----------------------------------------------------------------------------
+// jpeg_mcu_width: MCU width / height in pixels for a given mode
+//-----------------------------------------------------------------------------
+static inline int jpeg_mcu_width(t_jpeg_mode mode)
+{
+    return (mode == JPEG_YCBCR_420 || mode == JPEG_YCBCR_422) ? 16 : 8;
+}
+
+static inline int jpeg_mcu_height(t_jpeg_mode mode)
+{
+    return (mode == JPEG_YCBCR_420) ? 16 : 8;
+}
+
+#endif
@@ -0,0 +1,569 @@
+#ifndef JPEG_OUTPUT_H
+#define JPEG_OUTPUT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "jpeg_image.h"
+
+#define dprintf
+
+// Level shift and clamp to 0-255
+#define clamp_pixel(_v)  (((_v) & 0xffffff00) ? ((_v) >> 24) ^ 0xff : (_v))
+
+//-----------------------------------------------------------------------------
+// Output pixel formats
+//-----------------------------------------------------------------------------
+typedef enum eJpgPixFormat
+{
+    JPEG_PIX_RGB24,     // R, G, B bytes
+    JPEG_PIX_RGBA32,    // R, G, B, A(0xFF) bytes
+    JPEG_PIX_BGRA32,    // B, G, R, A(0xFF) bytes
+    JPEG_PIX_RGB565,    // 16-bit host endian, R[15:11] G[10:5] B[4:0]
+    JPEG_PIX_I420,      // Planar Y, Cb, Cr (chroma 1/2 x 1/2)
+    JPEG_PIX_NV12,      // Planar Y, interleaved CbCr (chroma 1/2 x 1/2)
+    JPEG_PIX_YUV444P    // Planar Y, Cb, Cr (full resolution)
+} t_jpeg_pix_format;
+
+//-----------------------------------------------------------------------------
+// t_jpeg_output_desc: Caller owned destination buffer.
+// plane[0] is the packed pixel buffer (RGB formats) or the Y plane.
+// plane[1], plane[2] are the Cb, Cr planes (I420, YUV444P), or for NV12
+// plane[1] is the interleaved CbCr plane. Strides are in bytes.
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    t_jpeg_pix_format format;
+    uint8_t          *plane[3];
+    int               stride[3];
+} t_jpeg_output_desc;
+
+//-----------------------------------------------------------------------------
+// jpeg_output: Colour conversion and store into caller provided buffers
+//-----------------------------------------------------------------------------
+class jpeg_output
+{
+public:
+    jpeg_output() { m_fixed_colour = false; reset(); }
+
+    // Fixed point (RTL) rather than floating point colour conversion
+    void set_fixed_colour(bool fixed) { m_fixed_colour = fixed; }
+
+    void reset(void)
+    {
+        memset(&m_desc, 0, sizeof(m_desc));
+        m_mode   = JPEG_UNSUPPORTED;
+        m_width  = 0;
+        m_height = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    // Format properties
+    //-------------------------------------------------------------------------
+    static bool is_yuv(t_jpeg_pix_format fmt)
+    {
+        return fmt == JPEG_PIX_I420 || fmt == JPEG_PIX_NV12 || fmt == JPEG_PIX_YUV444P;
+    }
+
+    // Bytes per pixel of plane 0
+    static int pixel_bytes(t_jpeg_pix_format fmt)
+    {
+        switch (fmt)
+        {
+            case JPEG_PIX_RGB24:  return 3;
+            case JPEG_PIX_RGBA32: return 4;
+            case JPEG_PIX_BGRA32: return 4;
+            case JPEG_PIX_RGB565: return 2;
+            default:              return 1;
+        }
+    }
+
+    static int chroma_width(t_jpeg_pix_format fmt, int width)
+    {
+        return (fmt == JPEG_PIX_YUV444P) ? width : ((width + 1) / 2);
+    }
+
+    static int chroma_height(t_jpeg_pix_format fmt, int height)
+    {
+        return (fmt == JPEG_PIX_YUV444P) ? height : ((height + 1) / 2);
+    }
+
+    //-------------------------------------------------------------------------
+    // frame_size: Bytes required for a contiguous frame (see desc_init)
+    //-------------------------------------------------------------------------
+    static int frame_size(t_jpeg_pix_format fmt, int width, int height, int stride)
+    {
+        if (stride <= 0)
+            stride = width * pixel_bytes(fmt);
+
+        int size = stride * height;
+        if (is_yuv(fmt))
+            size += chroma_width(fmt, width) * chroma_height(fmt, height) * 2;
+        return size;
+    }
+
+    //-------------------------------------------------------------------------
+    // desc_init: Describe a contiguous frame at 'buf' (plane 0 with 'stride',
+    //            or packed width if stride <= 0, then any chroma planes)
+    //-------------------------------------------------------------------------
+    static void desc_init(t_jpeg_output_desc *desc, t_jpeg_pix_format fmt, uint8_t *buf,
+                          int width, int height, int stride)
+    {
+        if (stride <= 0)
+            stride = width * pixel_bytes(fmt);
+
+        memset(desc, 0, sizeof(*desc));
+        desc->format    = fmt;
+        desc->plane[0]  = buf;
+        desc->stride[0] = stride;
+
+        if (is_yuv(fmt))
+        {
+            int cw = chroma_width(fmt, width);
+            int ch = chroma_height(fmt, height);
+
+            desc->plane[1] = buf + (stride * height);
+            if (fmt == JPEG_PIX_NV12)
+                desc->stride[1] = cw * 2;
+            else
+            {
+                desc->stride[1] = cw;
+                desc->plane[2]  = desc->plane[1] + (cw * ch);
+                desc->stride[2] = cw;
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // init: Bind a destination buffer to an image, checking it is usable
+    //-------------------------------------------------------------------------
+    bool init(const t_jpeg_output_desc *desc, t_jpeg_mode mode, int width, int height)
+    {
+        int bpp   = pixel_bytes(desc->format);
+        int align = (bpp == 3) ? 1 : bpp;
+
+        if (!desc->plane[0] || desc->stride[0] < (width * bpp))
+            return false;
+
+        // Packed 16/32-bit pixels must be naturally aligned
+        if (((uintptr_t)desc->plane[0] % align) || (desc->stride[0] % align))
+            return false;
+
+        if (desc->format == JPEG_PIX_NV12 && (!desc->plane[1] || desc->stride[1] < chroma_width(desc->format, width) * 2))
+            return false;
+        if ((desc->format == JPEG_PIX_I420 || desc->format == JPEG_PIX_YUV444P) &&
+            (!desc->plane[1] || !desc->plane[2] ||
+             desc->stride[1] < chroma_width(desc->format, width) ||
+             desc->stride[2] < chroma_width(desc->format, width)))
+            return false;
+
+        m_desc   = *desc;
+        m_mode   = mode;
+        m_width  = width;
+        m_height = height;
+
+        m_chroma_w    = chroma_width(desc->format, width);
+        m_chroma_h    = chroma_height(desc->format, height);
+        m_chroma_step = (desc->format == JPEG_PIX_NV12) ? 2 : 1;
+        m_cb_plane    = m_desc.plane[1];
+        m_cr_plane    = (desc->format == JPEG_PIX_NV12) ? (m_desc.plane[1] + 1) : m_desc.plane[2];
+        m_cb_stride   = m_desc.stride[1];
+        m_cr_stride   = (desc->format == JPEG_PIX_NV12) ? m_desc.stride[1] : m_desc.stride[2];
+
+        // Monochrome: chroma planes are never written by the decode, set mid-level
+        if (is_yuv(desc->format) && mode == JPEG_MONOCHROME)
+        {
+            for (int y=0;y<m_chroma_h;y++)
+            {
+                memset(m_cb_plane + (y * m_cb_stride), 128, m_chroma_w * m_chroma_step);
+                if (desc->format != JPEG_PIX_NV12)
+                    memset(m_cr_plane + (y * m_cr_stride), 128, m_chroma_w);
+            }
+        }
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // output_mcu: Store a decoded MCU (IDCT output, not level shifted).
+    //             x_start, y_start = MCU position in luma pixels.
+    //             4:2:0 - y holds 4 blocks (Y0-Y3), cb/cr one block each.
+    //             4:2:2 - y holds 2 blocks (Y0, Y1), cb/cr one block each.
+    //-------------------------------------------------------------------------
+    void output_mcu(int x_start, int y_start, int *y, int *cb, int *cr)
+    {
+        if (is_yuv(m_desc.format))
+        {
+            output_yuv(x_start, y_start, y, cb, cr);
+            return;
+        }
+
+        if (m_mode == JPEG_YCBCR_420)
+        {
+            // Chroma is indexed at half resolution relative to each Y block
+            convert_block(x_start + 0, y_start + 0, &y[0],   cb, cr, 0, 0, 1, 1);
+            convert_block(x_start + 8, y_start + 0, &y[64],  cb, cr, 8, 0, 1, 1);
+            convert_block(x_start + 0, y_start + 8, &y[128], cb, cr, 0, 8, 1, 1);
+            convert_block(x_start + 8, y_start + 8, &y[192], cb, cr, 8, 8, 1, 1);
+        }
+        else if (m_mode == JPEG_YCBCR_422)
+        {
+            // Chroma is indexed at half horizontal resolution
+            convert_block(x_start + 0, y_start, &y[0],  cb, cr, 0, 0, 1, 0);
+            convert_block(x_start + 8, y_start, &y[64], cb, cr, 8, 0, 1, 0);
+        }
+        else
+            convert_block(x_start, y_start, y, cb, cr, 0, 0, 0, 0);
+    }
+
+    //-------------------------------------------------------------------------
+    // output_dc_mcu: Store a DC only (1/8 scale) MCU, one pixel per block.
+    //                x_start, y_start = MCU position in output pixels.
+    //                y holds the Y block values (Y0-Y3 as output_mcu), cb / cr
+    //                one value each. Values are DC / 8 (not level shifted).
+    //-------------------------------------------------------------------------
+    void output_dc_mcu(int x_start, int y_start, int *y, int cb, int cr)
+    {
+        if (m_mode == JPEG_YCBCR_420)
+        {
+            store_dc(x_start + 0, y_start + 0, y[0], cb, cr);
+            store_dc(x_start + 1, y_start + 0, y[1], cb, cr);
+            store_dc(x_start + 0, y_start + 1, y[2], cb, cr);
+            store_dc(x_start + 1, y_start + 1, y[3], cb, cr);
+        }
+        else if (m_mode == JPEG_YCBCR_422)
+        {
+            store_dc(x_start + 0, y_start, y[0], cb, cr);
+            store_dc(x_start + 1, y_start, y[1], cb, cr);
+        }
+        else
+            store_dc(x_start, y_start, y[0], cb, cr);
+    }
+
+    //-------------------------------------------------------------------------
+    // block_rgb: Colour convert a whole 8x8 luma block to R,G,B bytes, with
+    //            no clipping to the image edge (used for block tracing).
+    //            Chroma sampling as output_mcu (cx, cy, hshift, vshift).
+    //-------------------------------------------------------------------------
+    void block_rgb(int *y, int *cb, int *cr, int cx, int cy, int hshift, int vshift, uint8_t *rgb)
+    {
+        for (int i=0;i<64;i++)
+        {
+            int r, g, b;
+
+            if (m_mode == JPEG_MONOCHROME)
+                convert_pixel<true>(y[i], 0, 0, r, g, b);
+            else
+            {
+                int c = (((cy + (i / 8)) >> vshift) * 8) + ((cx + (i % 8)) >> hshift);
+                if (m_fixed_colour)
+                    convert_pixel_fixed(false, y[i], cb[c], cr[c], r, g, b);
+                else
+                    convert_pixel<false>(y[i], cb[c], cr[c], r, g, b);
+            }
+
+            rgb[(i*3)+0] = r;
+            rgb[(i*3)+1] = g;
+            rgb[(i*3)+2] = b;
+        }
+    }
+
+private:
+    //-------------------------------------------------------------------------
+    // store_pixel: Format specific pixel store
+    //-------------------------------------------------------------------------
+    template <int FMT>
+    static inline void store_pixel(uint8_t *p, int r, int g, int b)
+    {
+        switch (FMT)
+        {
+            case JPEG_PIX_RGB24:
+                p[0] = r; p[1] = g; p[2] = b;
+                break;
+            case JPEG_PIX_RGBA32:
+                p[0] = r; p[1] = g; p[2] = b; p[3] = 0xFF;
+                break;
+            case JPEG_PIX_BGRA32:
+                p[0] = b; p[1] = g; p[2] = r; p[3] = 0xFF;
+                break;
+            case JPEG_PIX_RGB565:
+                *(uint16_t*)p = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+                break;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // convert_pixel: YCbCr (IDCT output, not level shifted) -> clamped RGB
+    //-------------------------------------------------------------------------
+    template <bool MONO>
+    static inline void convert_pixel(int y, int cb, int cr, int &r, int &g, int &b)
+    {
+        if (MONO)
+        {
+            r = g = b = 128 + y;
+        }
+        else
+        {
+            r = 128 + y + (cr * 1.402);
+            g = 128 + y - (cb * 0.34414) - (cr * 0.71414);
+            b = 128 + y + (cb * 1.772);
+        }
+
+        // Avoid overflows
+        r = clamp_pixel(r);
+        g = clamp_pixel(g);
+        b = clamp_pixel(b);
+    }
+
+    //-------------------------------------------------------------------------
+    // convert_pixel_fixed: As convert_pixel, with the fixed point (Q12)
+    //                      constants used by the RTL (jpeg_output.v)
+    //-------------------------------------------------------------------------
+    static inline void convert_pixel_fixed(bool mono, int y, int cb, int cr, int &r, int &g, int &b)
+    {
+        if (mono)
+        {
+            r = g = b = 128 + y;
+        }
+        else
+        {
+            r = 128 + y + ((cr * 5743) >> 12);
+            g = 128 + y - ((cb * 1410) >> 12) - ((cr * 2925) >> 12);
+            b = 128 + y + ((cb * 7258) >> 12);
+        }
+
+        r = clamp_pixel(r);
+        g = clamp_pixel(g);
+        b = clamp_pixel(b);
+    }
+
+    //-------------------------------------------------------------------------
+    // store_dc: One DC only output pixel (RGB formats), clipped to the image
+    //-------------------------------------------------------------------------
+    void store_dc(int x, int y, int y_val, int cb, int cr)
+    {
+        if (x >= m_width || y >= m_height)
+            return;
+
+        int r, g, b;
+        convert_pixel_fixed(m_mode == JPEG_MONOCHROME, y_val, cb, cr, r, g, b);
+
+        uint8_t *p = m_desc.plane[0] + (y * m_desc.stride[0]) + (x * pixel_bytes(m_desc.format));
+        switch (m_desc.format)
+        {
+            case JPEG_PIX_RGB24:  store_pixel<JPEG_PIX_RGB24>(p, r, g, b);  break;
+            case JPEG_PIX_RGBA32: store_pixel<JPEG_PIX_RGBA32>(p, r, g, b); break;
+            case JPEG_PIX_BGRA32: store_pixel<JPEG_PIX_BGRA32>(p, r, g, b); break;
+            case JPEG_PIX_RGB565: store_pixel<JPEG_PIX_RGB565>(p, r, g, b); break;
+            default:              break;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // convert_kernel: YCbCr -> RGB for one 8x8 luma block, stored in format FMT.
+    // Chroma sample for pixel (px,py) is at ((cy+py)>>vshift, (cx+px)>>hshift).
+    //-------------------------------------------------------------------------
+    template <int FMT, bool MONO>
+    void convert_kernel(int x_start, int y_start, int *y, int *cb, int *cr,
+                        int cx, int cy, int hshift, int vshift)
+    {
+        const int bpp = (FMT == JPEG_PIX_RGB24) ? 3 : (FMT == JPEG_PIX_RGB565) ? 2 : 4;
+
+        int w = m_width  - x_start; if (w > 8) w = 8;
+        int h = m_height - y_start; if (h > 8) h = 8;
+
+        for (int py=0;py<h;py++)
+        {
+            uint8_t *row  = m_desc.plane[0] + ((y_start + py) * m_desc.stride[0]) + (x_start * bpp);
+            int     *yrow = &y[py * 8];
+            int      crow = ((cy + py) >> vshift) * 8;
+
+            for (int px=0;px<w;px++)
+            {
+                int r, g, b;
+                int c = crow + ((cx + px) >> hshift);
+
+                if (MONO)
+                    convert_pixel<true>(yrow[px], 0, 0, r, g, b);
+                else if (m_fixed_colour)
+                    convert_pixel_fixed(false, yrow[px], cb[c], cr[c], r, g, b);
+                else
+                    convert_pixel<false>(yrow[px], cb[c], cr[c], r, g, b);
+
+                dprintf("RGB: r=%d g=%d b=%d [x=%d,y=%d]\n", r, g, b, x_start + px, y_start + py);
+                store_pixel<FMT>(row + (px * bpp), r, g, b);
+            }
+        }
+    }
+
+    template <bool MONO>
+    void convert_block_fmt(int x_start, int y_start, int *y, int *cb, int *cr, int cx, int cy, int hshift, int vshift)
+    {
+        switch (m_desc.format)
+        {
+            case JPEG_PIX_RGB24:
+                convert_kernel<JPEG_PIX_RGB24,  MONO>(x_start, y_start, y, cb, cr, cx, cy, hshift, vshift);
+                break;
+            case JPEG_PIX_RGBA32:
+                convert_kernel<JPEG_PIX_RGBA32, MONO>(x_start, y_start, y, cb, cr, cx, cy, hshift, vshift);
+                break;
+            case JPEG_PIX_BGRA32:
+                convert_kernel<JPEG_PIX_BGRA32, MONO>(x_start, y_start, y, cb, cr, cx, cy, hshift, vshift);
+                break;
+            case JPEG_PIX_RGB565:
+                convert_kernel<JPEG_PIX_RGB565, MONO>(x_start, y_start, y, cb, cr, cx, cy, hshift, vshift);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void convert_block(int x_start, int y_start, int *y, int *cb, int *cr, int cx, int cy, int hshift, int vshift)
+    {
+        if (x_start >= m_width || y_start >= m_height)
+            return;
+
+        if (m_mode == JPEG_MONOCHROME)
+            convert_block_fmt<true>(x_start, y_start, y, cb, cr, cx, cy, hshift, vshift);
+        else
+            convert_block_fmt<false>(x_start, y_start, y, cb, cr, cx, cy, hshift, vshift);
+    }
+
+    //-------------------------------------------------------------------------
+    // store_plane: Store 8x8 IDCT output into a 8-bit plane, with a scale of
+    //              1 (direct), 2 (upsample) or -2 (2x2 average downsample).
+    //              sx / sy give a separate horizontal / vertical scale (4:2:2).
+    //-------------------------------------------------------------------------
+    void store_plane(uint8_t *plane, int stride, int plane_w, int plane_h, int step,
+                     int x_start, int y_start, int *blk, int scale)
+    {
+        store_plane(plane, stride, plane_w, plane_h, step, x_start, y_start, blk, scale, scale);
+    }
+
+    void store_plane(uint8_t *plane, int stride, int plane_w, int plane_h, int step,
+                     int x_start, int y_start, int *blk, int sx, int sy)
+    {
+        // 2x2 average (4:4:4 chroma -> 4:2:0 chroma)
+        if (sx < 0 && sy < 0)
+        {
+            for (int i=0;i<16;i++)
+            {
+                int bx = (i % 4) * 2;
+                int by = (i / 4) * 2;
+                int v  = blk[(by*8)+bx] + blk[(by*8)+bx+1] + blk[((by+1)*8)+bx] + blk[((by+1)*8)+bx+1];
+                v = 128 + ((v + 2) >> 2);
+                v = clamp_pixel(v);
+
+                int _x = x_start + (i % 4);
+                int _y = y_start + (i / 4);
+                if (_x < plane_w && _y < plane_h)
+                    plane[(_y * stride) + (_x * step)] = v;
+            }
+            return;
+        }
+
+        // Vertical pair average (4:2:2 chroma -> 4:2:0 chroma)
+        if (sy < 0)
+        {
+            for (int i=0;i<32;i++)
+            {
+                int bx = i % 8;
+                int by = (i / 8) * 2;
+                int v  = blk[(by*8)+bx] + blk[((by+1)*8)+bx];
+                v = 128 + ((v + 1) >> 1);
+                v = clamp_pixel(v);
+
+                int _x = x_start + bx;
+                int _y = y_start + (i / 8);
+                if (_x < plane_w && _y < plane_h)
+                    plane[(_y * stride) + (_x * step)] = v;
+            }
+            return;
+        }
+
+        // Direct (scale=1) or pixel replication (scale=2)
+        for (int i=0;i<64*sx*sy;i++)
+        {
+            int px = i % (8*sx);
+            int py = i / (8*sx);
+            int v  = 128 + blk[((py/sy)*8) + (px/sx)];
+            v = clamp_pixel(v);
+
+            int _x = x_start + px;
+            int _y = y_start + py;
+            if (_x < plane_w && _y < plane_h)
+                plane[(_y * stride) + (_x * step)] = v;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // output_yuv: Store a decoded MCU directly into the YCbCr planes
+    //-------------------------------------------------------------------------
+    void output_yuv(int x_start, int y_start, int *y, int *cb, int *cr)
+    {
+        bool     sub_out = (m_desc.format != JPEG_PIX_YUV444P);
+        uint8_t *y_plane = m_desc.plane[0];
+        int      y_stride= m_desc.stride[0];
+
+        if (m_mode == JPEG_YCBCR_420)
+        {
+            store_plane(y_plane, y_stride, m_width, m_height, 1, x_start + 0, y_start + 0, &y[0],   1);
+            store_plane(y_plane, y_stride, m_width, m_height, 1, x_start + 8, y_start + 0, &y[64],  1);
+            store_plane(y_plane, y_stride, m_width, m_height, 1, x_start + 0, y_start + 8, &y[128], 1);
+            store_plane(y_plane, y_stride, m_width, m_height, 1, x_start + 8, y_start + 8, &y[192], 1);
+
+            // Chroma is already at output resolution (no upsampling) for I420 / NV12
+            int cx = sub_out ? (x_start / 2) : x_start;
+            int cy = sub_out ? (y_start / 2) : y_start;
+            store_plane(m_cb_plane, m_cb_stride, m_chroma_w, m_chroma_h, m_chroma_step, cx, cy, cb, sub_out ? 1 : 2);
+            store_plane(m_cr_plane, m_cr_stride, m_chroma_w, m_chroma_h, m_chroma_step, cx, cy, cr, sub_out ? 1 : 2);
+        }
+        else if (m_mode == JPEG_YCBCR_422)
+        {
+            store_plane(y_plane, y_stride, m_width, m_height, 1, x_start + 0, y_start, &y[0],  1);
+            store_plane(y_plane, y_stride, m_width, m_height, 1, x_start + 8, y_start, &y[64], 1);
+
+            // Chroma is at output resolution horizontally for I420 / NV12 (rows pair averaged),
+            // upsampled horizontally for YUV444P
+            int cx = sub_out ? (x_start / 2) : x_start;
+            int cy = sub_out ? (y_start / 2) : y_start;
+            store_plane(m_cb_plane, m_cb_stride, m_chroma_w, m_chroma_h, m_chroma_step, cx, cy, cb,
+                        sub_out ? 1 : 2, sub_out ? -2 : 1);
+            store_plane(m_cr_plane, m_cr_stride, m_chroma_w, m_chroma_h, m_chroma_step, cx, cy, cr,
+                        sub_out ? 1 : 2, sub_out ? -2 : 1);
+        }
+        else
+        {
+            store_plane(y_plane, y_stride, m_width, m_height, 1, x_start, y_start, y, 1);
+
+            if (m_mode == JPEG_YCBCR_444)
+            {
+                int cx = sub_out ? (x_start / 2) : x_start;
+                int cy = sub_out ? (y_start / 2) : y_start;
+                store_plane(m_cb_plane, m_cb_stride, m_chroma_w, m_chroma_h, m_chroma_step, cx, cy, cb, sub_out ? -2 : 1);
+                store_plane(m_cr_plane, m_cr_stride, m_chroma_w, m_chroma_h, m_chroma_step, cx, cy, cr, sub_out ? -2 : 1);
+            }
+        }
+    }
+
+private:
+    t_jpeg_output_desc m_desc;
+    t_jpeg_mode        m_mode;
+    int                m_width;
+    int                m_height;
+
+    int                m_chroma_w;
+    int                m_chroma_h;
+    int                m_chroma_step;
+    uint8_t           *m_cb_plane;
+    uint8_t           *m_cr_plane;
+    int                m_cb_stride;
+    int                m_cr_stride;
+
+    bool               m_fixed_colour;
+};
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef JPEG_TRACE_H
+#define JPEG_TRACE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+//-----------------------------------------------------------------------------
+// Block trace file format (shared by the C model, the RTL testbench and
+// trace_diff). Host endian, a file header then a sequence of records:
+//   header  : magic 'JTRC', version
+//   record  : stage, comp, block, x, y + payload
+//   payload : DQT / IDCT - int16[64] natural (raster) order
+//             PIXELS     - uint8[64*3] R,G,B for each pixel of an 8x8 block
+// 'block' is the decode order index of the coefficient block (EOF marker
+// blocks excluded). For PIXELS it is the index of the luma block the pixels
+// were generated from. x, y is the block origin in pixels (informational).
+//-----------------------------------------------------------------------------
+#define JPEG_TRACE_MAGIC        0x4352544A
+#define JPEG_TRACE_VERSION      1
+
+typedef enum eJpgTraceStage
+{
+    JPEG_TRACE_DQT,     // Dequantised, de-zigzagged coefficients
+    JPEG_TRACE_IDCT,    // IDCT output (not level shifted)
+    JPEG_TRACE_PIXELS,  // Colour converted RGB
+    JPEG_TRACE_STAGES
+} t_jpeg_trace_stage;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+} t_jpeg_trace_file_hdr;
+
+typedef struct
+{
+    uint8_t  stage;
+    uint8_t  comp;      // 0 = Y, 1 = Cb, 2 = Cr
+    uint16_t reserved;
+    uint32_t block;
+    uint16_t x;
+    uint16_t y;
+} t_jpeg_trace_hdr;
+
+typedef struct
+{
+    t_jpeg_trace_hdr hdr;
+    union
+    {
+        int16_t coeff[64];
+        uint8_t rgb[64*3];
+    };
+} t_jpeg_trace_rec;
+
+//-----------------------------------------------------------------------------
+// jpeg_trace: Block trace writer / reader
+//-----------------------------------------------------------------------------
+class jpeg_trace
+{
+public:
+    jpeg_trace(): m_file(NULL), m_write(false) { }
+    ~jpeg_trace() { close(); }
+
+    static const char *stage_name(int stage)
+    {
+        switch (stage)
+        {
+            case JPEG_TRACE_DQT:    return "DQT";
+            case JPEG_TRACE_IDCT:   return "IDCT";
+            case JPEG_TRACE_PIXELS: return "PIXELS";
+            default:                return "?";
+        }
+    }
+
+    static int payload_size(int stage)
+    {
+        return (stage == JPEG_TRACE_PIXELS) ? (64 * 3) : (64 * sizeof(int16_t));
+    }
+
+    //-------------------------------------------------------------------------
+    // open: Create a trace file (write), or open one for reading
+    //-------------------------------------------------------------------------
+    bool open(const char *filename, bool write)
+    {
+        close();
+
+        m_file  = fopen(filename, write ? "wb" : "rb");
+        m_write = write;
+        if (!m_file)
+            return false;
+
+        t_jpeg_trace_file_hdr hdr;
+        if (write)
+        {
+            hdr.magic   = JPEG_TRACE_MAGIC;
+            hdr.version = JPEG_TRACE_VERSION;
+            if (fwrite(&hdr, sizeof(hdr), 1, m_file) == 1)
+                return true;
+        }
+        else if (fread(&hdr, sizeof(hdr), 1, m_file) == 1 &&
+                 hdr.magic == JPEG_TRACE_MAGIC && hdr.version == JPEG_TRACE_VERSION)
+            return true;
+
+        close();
+        return false;
+    }
+
+    void close(void)
+    {
+        if (m_file)
+            fclose(m_file);
+        m_file = NULL;
+    }
+
+    bool is_open(void) { return m_file != NULL; }
+
+    //-------------------------------------------------------------------------
+    // write_coeffs: DQT / IDCT stage block (values saturated to int16)
+    //-------------------------------------------------------------------------
+    void write_coeffs(int stage, int comp, uint32_t block, int x, int y, const int *data)
+    {
+        assert(m_write && stage != JPEG_TRACE_PIXELS);
+
+        int16_t coeff[64];
+        for (int i=0;i<64;i++)
+            coeff[i] = (data[i] > 32767) ? 32767 : (data[i] < -32768) ? -32768 : data[i];
+
+        write_record(stage, comp, block, x, y, coeff);
+    }
+
+    //-------------------------------------------------------------------------
+    // write_pixels: RGB output for one 8x8 block
+    //-------------------------------------------------------------------------
+    void write_pixels(int comp, uint32_t block, int x, int y, const uint8_t *rgb)
+    {
+        assert(m_write);
+        write_record(JPEG_TRACE_PIXELS, comp, block, x, y, rgb);
+    }
+
+    //-------------------------------------------------------------------------
+    // read: Next record, false at end of file (or on a corrupt record)
+    //-------------------------------------------------------------------------
+    bool read(t_jpeg_trace_rec *rec)
+    {
+        assert(!m_write);
+        if (!m_file || fread(&rec->hdr, sizeof(rec->hdr), 1, m_file) != 1)
+            return false;
+        if (rec->hdr.stage >= JPEG_TRACE_STAGES)
+            return false;
+        return fread(rec->rgb, payload_size(rec->hdr.stage), 1, m_file) == 1;
+    }
+
+private:
+    void write_record(int stage, int comp, uint32_t block, int x, int y, const void *payload)
+    {
+        if (!m_file)
+            return;
+
+        t_jpeg_trace_hdr hdr;
+        hdr.stage    = stage;
+        hdr.comp     = comp;
+        hdr.reserved = 0;
+        hdr.block    = block;
+        hdr.x        = x;
+        hdr.y        = y;
+        fwrite(&hdr, sizeof(hdr), 1, m_file);
+        fwrite(payload, payload_size(stage), 1, m_file);
+    }
+
+private:
+    FILE *m_file;
+    bool  m_write;
+};
+
+#endif
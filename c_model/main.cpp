@@ -4,286 +4,401 @@
 #include <string.h>
 #include <unistd.h>
 #include <assert.h>
+#include <time.h>
+#include <new>
 
-#include "jpeg_dqt.h"
-#include "jpeg_dht.h"
-#include "jpeg_idct.h"
-#include "jpeg_idct_ifast.h"
-#include "jpeg_idct_aan.h"  // Added aan IDCT header
-#include "jpeg_bit_buffer.h"
-#include "jpeg_mcu_block.h"
-
-static jpeg_dqt        m_dqt;
-static jpeg_dht        m_dht;
-
-// Select IDCT implementation based on Makefile defines
-#if defined(IDCT_IFAST)
-static jpeg_idct_ifast m_idct;
-#elif defined(IDCT_ANN)
-static jpeg_idct_ann m_idct;
-#else
-static jpeg_idct       m_idct;  // Default fallback (if neither is defined)
-#endif
-
-static jpeg_bit_buffer m_bit_buffer;
-static jpeg_mcu_block  m_mcu_dec(&m_bit_buffer, &m_dht);
+#include "jpeg_image.h"
+#include "jpeg_coeff.h"
+#include "jpeg_output.h"
+#include "jpeg_decoder.h"
+#include "jpeg_trace.h"
+
+static jpeg_decoder       m_decoder;
 
 static uint16_t m_width;
 static uint16_t m_height;
 
-typedef enum eJpgMode
-{
-    JPEG_MONOCHROME,
-    JPEG_YCBCR_444,
-    JPEG_YCBCR_420,
-    JPEG_UNSUPPORTED
-} t_jpeg_mode;
-
 static t_jpeg_mode m_mode;
 
-static uint8_t m_dqt_table[3];
+// Destination frame buffer
+static t_jpeg_output_desc m_output_desc;
+static t_jpeg_pix_format  m_out_format;
+static int                m_out_stride;
+static uint8_t           *m_frame_buf;
+static int                m_frame_size;
+
+// Coefficient only decode (no IDCT / colour conversion)
+static jpeg_coeff_planes  m_coeff_planes;
+static bool               m_coeff_mode;
+static bool               m_coeff_dequant;
+
+// DC only (1/8 scale) decode
+static bool               m_dc_only;
+
+// RTL (fixed point) colour conversion
+static bool               m_fixed_colour;
 
-#define get_byte(_buf, _idx)  _buf[_idx++]
-#define get_word(_buf, _idx)  ((_buf[_idx++] << 8) | (_buf[_idx++]))
+// Input chunk size for incremental decode (0 = whole file)
+static int                m_chunk_size;
 
-static uint8_t *m_output_r;
-static uint8_t *m_output_g;
-static uint8_t *m_output_b;
+// Per-block trace (-t)
+static jpeg_trace         m_trace;
 
-#define dprintf
-#define dprintf_blk(_name, _arr, _max) for (int __i=0;__i<_max;__i++) { dprintf("%s: %d -> %d\n", _name, __i, _arr[__i]); }
+// Suppress section logging (benchmark mode)
+static bool               m_quiet;
+
+#define log_printf(...)   do { if (!m_quiet) printf(__VA_ARGS__); } while (0)
 
 //-----------------------------------------------------------------------------
-// ConvertYUV2RGB: Convert from YUV to RGB
+// Heap allocation counter: operator new plus the explicit posix_memalign
+// calls made by the frame buffer and the decoder arena
 //-----------------------------------------------------------------------------
-static void ConvertYUV2RGB(int block_num, int *y, int *cb, int *cr)
+static long m_heap_allocs;
+
+void *operator new(size_t size)
 {
-    int x_blocks = (m_width / 8);
+    m_heap_allocs++;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+void *operator new[](size_t size)            { return operator new(size); }
+void  operator delete(void *p) throw()       { free(p); }
+void  operator delete[](void *p) throw()     { free(p); }
+void  operator delete(void *p, size_t) throw()   { free(p); }
+void  operator delete[](void *p, size_t) throw() { free(p); }
 
-    // If width is not a multiple of 8, round up
-    if (m_width % 8)
-        x_blocks++;
+static long HeapAllocs(void)
+{
+    return m_heap_allocs + m_decoder.arena()->sys_allocs();
+}
 
-    int x_start = (block_num % x_blocks) * 8;
-    int y_start = (block_num / x_blocks) * 8;
+//-----------------------------------------------------------------------------
+// AllocOutput: Allocate (or reuse) the frame buffer and bind it to the image
+//-----------------------------------------------------------------------------
+static bool AllocOutput(void)
+{
+    int size = jpeg_output::frame_size(m_out_format, m_width, m_height, m_out_stride);
 
-    if (m_mode == JPEG_MONOCHROME)
+    // 64 byte aligned, reused for subsequent images of the same (or smaller) size
+    if (size > m_frame_size)
     {
-        for (int i=0;i<64;i++)
-        {
-            int r = 128 + y[i];
-            int g = 128 + y[i];
-            int b = 128 + y[i];
-
-            // Avoid overflows
-            r = (r & 0xffffff00) ? (r >> 24) ^ 0xff : r;
-            g = (g & 0xffffff00) ? (g >> 24) ^ 0xff : g;
-            b = (b & 0xffffff00) ? (b >> 24) ^ 0xff : b;
-
-            int _x = x_start + (i % 8);
-            int _y = y_start + (i / 8);
-            int offset = (_y * m_width) + _x;
-
-            dprintf("RGB: r=%d g=%d b=%d -> %d\n", r, g, b, offset);
-            m_output_r[offset] = r;
-            m_output_g[offset] = g;
-            m_output_b[offset] = b;
-        }
+        free(m_frame_buf);
+        m_frame_buf  = NULL;
+        m_frame_size = 0;
+        if (posix_memalign((void**)&m_frame_buf, 64, size) != 0)
+            return false;
+        m_frame_size = size;
+        m_heap_allocs++;
     }
-    else
+
+    jpeg_output::desc_init(&m_output_desc, m_out_format, m_frame_buf, m_width, m_height, m_out_stride);
+    return m_decoder.set_output(&m_output_desc);
+}
+//-----------------------------------------------------------------------------
+// OnHeader: Frame header parsed - bind the destination frame buffer
+//-----------------------------------------------------------------------------
+static void OnHeader(void *ctx, jpeg_decoder *dec)
+{
+    m_width  = dec->out_width();
+    m_height = dec->out_height();
+    m_mode   = dec->mode();
+
+    // Not required when only extracting coefficients
+    if (!m_coeff_mode && !AllocOutput())
+        log_printf("ERROR: Could not setup output buffer\n");
+}
+//-----------------------------------------------------------------------------
+// WriteOutput: Write frame buffer to file (PPM for RGB24, otherwise raw
+//              planes with the row stride removed)
+//-----------------------------------------------------------------------------
+static bool WriteOutput(const char *filename)
+{
+    FILE *f = fopen(filename, "wb");
+    if (!f)
+        return false;
+
+    int bpp = jpeg_output::pixel_bytes(m_out_format);
+
+    if (m_out_format == JPEG_PIX_RGB24)
     {
-        for (int i=0;i<64;i++)
-        {
-            int r = 128 + y[i] + (cr[i] * 1.402);
-            int g = 128 + y[i] - (cb[i] * 0.34414) - (cr[i] * 0.71414);
-            int b = 128 + y[i] + (cb[i] * 1.772);
+        fprintf(f, "P6\n");
+        fprintf(f, "%d %d\n", m_width, m_height);
+        fprintf(f, "255\n");
+    }
 
-            // Avoid overflows
-            r = (r & 0xffffff00) ? (r >> 24) ^ 0xff : r;
-            g = (g & 0xffffff00) ? (g >> 24) ^ 0xff : g;
-            b = (b & 0xffffff00) ? (b >> 24) ^ 0xff : b;
+    for (int y=0;y<m_height;y++)
+        fwrite(m_output_desc.plane[0] + (y * m_output_desc.stride[0]), bpp, m_width, f);
 
-            int _x = x_start + (i % 8);
-            int _y = y_start + (i / 8);
-            int offset = (_y * m_width) + _x;
+    if (jpeg_output::is_yuv(m_out_format))
+    {
+        int cw    = jpeg_output::chroma_width(m_out_format, m_width);
+        int ch    = jpeg_output::chroma_height(m_out_format, m_height);
+        int count = (m_out_format == JPEG_PIX_NV12) ? 1 : 2;
+        int step  = (m_out_format == JPEG_PIX_NV12) ? 2 : 1;
 
-            if (_x < m_width && _y < m_height)
-            {
-                dprintf("RGB: r=%d g=%d b=%d -> %d [x=%d,y=%d]\n", r, g, b, offset, _x, _y);
-                m_output_r[offset] = r;
-                m_output_g[offset] = g;
-                m_output_b[offset] = b;
-            }
-        }
+        for (int c=1;c<=count;c++)
+            for (int y=0;y<ch;y++)
+                fwrite(m_output_desc.plane[c] + (y * m_output_desc.stride[c]), step, cw, f);
+
+        printf("YUV: %dx%d, chroma %dx%d\n", m_width, m_height, cw, ch);
     }
+
+    fclose(f);
+    return true;
 }
 //-----------------------------------------------------------------------------
-// DecodeImage: Decode image data section (supports 4:4:4, 4:2:0, monochrom)
+// WriteCoeffs: Dump coefficient planes (raw int16, plane after plane)
 //-----------------------------------------------------------------------------
-
-static bool DecodeImage(void)
+static bool WriteCoeffs(const char *filename)
 {
-    int16_t dc_coeff_Y = 0;
-    int16_t dc_coeff_Cb= 0;
-    int16_t dc_coeff_Cr= 0;
-    int32_t sample_out[64];
-    int     block_out[64];
-    int     y_dct_out[4*64];
-    int     cb_dct_out[64];
-    int     cr_dct_out[64];
-    int     count = 0;
-    int     loop = 0;
-
-    int block_num = 0;
-    while (!m_bit_buffer.eof())
-    {
-        // [Y0 Y1 Y2 Y3 Cb Cr] x N
-        if (m_mode == JPEG_YCBCR_420)
-        {
-            // Y0
-            count = m_mcu_dec.decode(DHT_TABLE_Y_DC_IDX, dc_coeff_Y, sample_out);
-            m_dqt.process_samples(m_dqt_table[0], sample_out, block_out, count);
-            dprintf_blk("DCT-IN", block_out, 64);
-            m_idct.process(block_out, &y_dct_out[0]);
-
-            // Y1
-            count = m_mcu_dec.decode(DHT_TABLE_Y_DC_IDX, dc_coeff_Y, sample_out);
-            m_dqt.process_samples(m_dqt_table[0], sample_out, block_out, count);
-            dprintf_blk("DCT-IN", block_out, 64);
-            m_idct.process(block_out, &y_dct_out[64]);
-
-            // Y2
-            count = m_mcu_dec.decode(DHT_TABLE_Y_DC_IDX, dc_coeff_Y, sample_out);
-            m_dqt.process_samples(m_dqt_table[0], sample_out, block_out, count);
-            dprintf_blk("DCT-IN", block_out, 64);
-            m_idct.process(block_out, &y_dct_out[128]);
-            
-            // Y3
-            count = m_mcu_dec.decode(DHT_TABLE_Y_DC_IDX, dc_coeff_Y, sample_out);
-            m_dqt.process_samples(m_dqt_table[0], sample_out, block_out, count);
-            dprintf_blk("DCT-IN", block_out, 64);
-            m_idct.process(block_out, &y_dct_out[192]);
-
-            // Cb
-            count = m_mcu_dec.decode(DHT_TABLE_CX_DC_IDX, dc_coeff_Cb, sample_out);
-            m_dqt.process_samples(m_dqt_table[1], sample_out, block_out, count);
-            dprintf_blk("DCT-IN", block_out, 64);
-            m_idct.process(block_out, &cb_dct_out[0]);
-
-            // Cr
-            count = m_mcu_dec.decode(DHT_TABLE_CX_DC_IDX, dc_coeff_Cr, sample_out);
-            m_dqt.process_samples(m_dqt_table[2], sample_out, block_out, count);
-            dprintf_blk("DCT-IN", block_out, 64);
-            m_idct.process(block_out, &cr_dct_out[0]);
-
-            // Expand Cb/Cr samples to match Y0-3
-            int cb_dct_out_x2[256];
-            int cr_dct_out_x2[256];
-
-            for (int i=0;i<64;i++)
-            {
-                int x = i % 8;
-                int y = i / 16;
-                int sub_idx = (y * 8) + (x / 2);
-                cb_dct_out_x2[i] = cb_dct_out[sub_idx];
-                cr_dct_out_x2[i] = cr_dct_out[sub_idx];
-            }
-
-            for (int i=0;i<64;i++)
-            {
-                int x = i % 8;
-                int y = i / 16;
-                int sub_idx = (y * 8) + 4 + (x / 2);
-                cb_dct_out_x2[64 + i] = cb_dct_out[sub_idx];
-                cr_dct_out_x2[64 + i] = cr_dct_out[sub_idx];
-            }
+    FILE *f = fopen(filename, "wb");
+    if (!f)
+        return false;
 
-            for (int i=0;i<64;i++)
-            {
-                int x = i % 8;
-                int y = i / 16;
-                int sub_idx = 32 + (y * 8) + (x / 2);
-                cb_dct_out_x2[128+i] = cb_dct_out[sub_idx];
-                cr_dct_out_x2[128+i] = cr_dct_out[sub_idx];
-            }
+    for (int c=0;c<m_coeff_planes.num_comps();c++)
+    {
+        printf("Plane %d: %dx%d blocks\n", c, m_coeff_planes.blocks_w(c), m_coeff_planes.blocks_h(c));
+        for (int by=0;by<m_coeff_planes.blocks_h(c);by++)
+            fwrite(m_coeff_planes.block_row(c, by), sizeof(int16_t), m_coeff_planes.row_stride(c), f);
+    }
 
-            for (int i=0;i<64;i++)
-            {
-                int x = i % 8;
-                int y = i / 16;
-                int sub_idx = 32 + (y * 8) + 4 + (x / 2);
-                cb_dct_out_x2[192 + i] = cb_dct_out[sub_idx];
-                cr_dct_out_x2[192 + i] = cr_dct_out[sub_idx];
-            }
+    fclose(f);
+    return true;
+}
+//-----------------------------------------------------------------------------
+// DecodeJPEG: Decode JPEG file from memory (fed in m_chunk_size pieces)
+//-----------------------------------------------------------------------------
+static bool DecodeJPEG(uint8_t *buf, int len)
+{
+    m_decoder.reset();
+    m_decoder.set_verbose(!m_quiet);
+    m_decoder.set_callbacks(OnHeader, NULL, NULL);
+    m_decoder.set_coeff_output(m_coeff_mode ? &m_coeff_planes : NULL, m_coeff_dequant);
+    m_decoder.set_dc_only(m_dc_only);
+    m_decoder.set_fixed_colour(m_fixed_colour);
+
+    int chunk = (m_chunk_size > 0) ? m_chunk_size : len;
+    for (int i=0;i<len && m_decoder.status() == JPEG_DEC_NEED_DATA;)
+    {
+        int n = (len - i) < chunk ? (len - i) : chunk;
+        i += m_decoder.feed(&buf[i], n);
+    }
 
-            int mcu_width = m_width / 8;
-            if (m_width % 8)
-                mcu_width++;
+    return m_decoder.finish();
+}
+//-----------------------------------------------------------------------------
+// TimeNow: Monotonic time in seconds
+//-----------------------------------------------------------------------------
+static double TimeNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+//-----------------------------------------------------------------------------
+// CopyFrame: Repack an RGB24 frame into a packed RGB format (benchmark only,
+//            models the previous decode -> RGB planes -> frame buffer flow)
+//-----------------------------------------------------------------------------
+static void CopyFrame(const uint8_t *src, int src_stride, t_jpeg_output_desc *dst)
+{
+    int bpp = jpeg_output::pixel_bytes(dst->format);
 
-            // Output all 4 blocks of pixels
-            ConvertYUV2RGB((block_num/2) + 0, &y_dct_out[0],  &cb_dct_out_x2[0], &cr_dct_out_x2[0]);
-            ConvertYUV2RGB((block_num/2) + 1, &y_dct_out[64], &cb_dct_out_x2[64], &cr_dct_out_x2[64]);
-            ConvertYUV2RGB((block_num/2) + mcu_width + 0, &y_dct_out[128], &cb_dct_out_x2[128], &cr_dct_out_x2[128]);
-            ConvertYUV2RGB((block_num/2) + mcu_width + 1, &y_dct_out[192], &cb_dct_out_x2[192], &cr_dct_out_x2[192]);
-            block_num += 4;
+    for (int y=0;y<m_height;y++)
+    {
+        const uint8_t *s = src + (y * src_stride);
+        uint8_t       *d = dst->plane[0] + (y * dst->stride[0]);
 
-            if (++loop == (mcu_width / 2))
+        for (int x=0;x<m_width;x++, s += 3, d += bpp)
+        {
+            switch (dst->format)
             {
-                block_num += (mcu_width * 2);
-                loop = 0;
+                case JPEG_PIX_RGB24:
+                    d[0] = s[0]; d[1] = s[1]; d[2] = s[2];
+                    break;
+                case JPEG_PIX_RGBA32:
+                    d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = 0xFF;
+                    break;
+                case JPEG_PIX_BGRA32:
+                    d[0] = s[2]; d[1] = s[1]; d[2] = s[0]; d[3] = 0xFF;
+                    break;
+                case JPEG_PIX_RGB565:
+                    *(uint16_t*)d = ((s[0] & 0xF8) << 8) | ((s[1] & 0xFC) << 3) | (s[2] >> 3);
+                    break;
+                default:
+                    break;
             }
         }
-        // [Y Cb Cr] x N
-        else if (m_mode == JPEG_YCBCR_444)
-        {
-            // Y
-            count = m_mcu_dec.decode(DHT_TABLE_Y_DC_IDX, dc_coeff_Y, sample_out);
-            m_dqt.process_samples(m_dqt_table[0], sample_out, block_out, count);
-            dprintf_blk("DCT-IN", block_out, 64);
-            m_idct.process(block_out, &y_dct_out[0]);
-
-            // Cb
-            count = m_mcu_dec.decode(DHT_TABLE_CX_DC_IDX, dc_coeff_Cb, sample_out);
-            m_dqt.process_samples(m_dqt_table[1], sample_out, block_out, count);
-            dprintf_blk("DCT-IN", block_out, 64);
-            m_idct.process(block_out, &cb_dct_out[0]);
-
-            // Cr
-            count = m_mcu_dec.decode(DHT_TABLE_CX_DC_IDX, dc_coeff_Cr, sample_out);
-            m_dqt.process_samples(m_dqt_table[2], sample_out, block_out, count);
-            dprintf_blk("DCT-IN", block_out, 64);
-            m_idct.process(block_out, &cr_dct_out[0]);
-
-            ConvertYUV2RGB(block_num++, y_dct_out, cb_dct_out, cr_dct_out);
-        }
-        // [Y] x N
-        else if (m_mode == JPEG_MONOCHROME)
+    }
+}
+//-----------------------------------------------------------------------------
+// Benchmark: Time decode-to-frame-buffer, direct vs decode + copy pass,
+//            counting heap allocations per frame
+//-----------------------------------------------------------------------------
+static bool Benchmark(uint8_t *buf, int len, int iterations)
+{
+    t_jpeg_pix_format  fmt    = m_out_format;
+    int                stride = m_out_stride;
+    bool               ok     = true;
+
+    m_quiet = true;
+
+    // Warm up: the arena settles to a single block after its first reset
+    ok = DecodeJPEG(buf, len);
+
+    // Direct: IDCT output is colour converted straight into the frame buffer
+    long   allocs = HeapAllocs();
+    double t0     = TimeNow();
+    for (int i=0;i<iterations && ok;i++)
+        ok = DecodeJPEG(buf, len);
+    double t_direct      = (TimeNow() - t0) / iterations;
+    double allocs_direct = (double)(HeapAllocs() - allocs) / iterations;
+
+    t_jpeg_output_desc dst = m_output_desc;
+    uint8_t           *dst_buf = m_frame_buf;
+    double             t_copy  = 0;
+    double             allocs_copy = 0;
+
+    // Copy: decode into freshly allocated RGB planes, then repack (packed RGB only)
+    if (ok && !m_coeff_mode && !jpeg_output::is_yuv(fmt))
+    {
+        m_frame_buf    = NULL;
+        m_frame_size   = 0;
+        m_out_format   = JPEG_PIX_RGB24;
+        m_out_stride   = 0;
+
+        allocs = HeapAllocs();
+        t0     = TimeNow();
+        for (int i=0;i<iterations && ok;i++)
         {
-            // Y
-            count = m_mcu_dec.decode(DHT_TABLE_Y_DC_IDX, dc_coeff_Y, sample_out);
-            m_dqt.process_samples(m_dqt_table[0], sample_out, block_out, count);
-            dprintf_blk("DCT-IN", block_out, 64);
-            m_idct.process(block_out, &y_dct_out[0]);
+            ok = DecodeJPEG(buf, len);
+            CopyFrame(m_frame_buf, m_output_desc.stride[0], &dst);
 
-            ConvertYUV2RGB(block_num++, y_dct_out, cb_dct_out, cr_dct_out);
+            // Previous flow allocated the output planes for every image
+            free(m_frame_buf);
+            m_frame_buf  = NULL;
+            m_frame_size = 0;
         }
+        t_copy      = (TimeNow() - t0) / iterations;
+        allocs_copy = (double)(HeapAllocs() - allocs) / iterations;
+
+        m_out_format  = fmt;
+        m_out_stride  = stride;
+        m_frame_buf   = dst_buf;
+        m_frame_size  = jpeg_output::frame_size(fmt, m_width, m_height, stride);
+        m_output_desc = dst;
     }
 
-    return true;
+    m_quiet = false;
+
+    double mpix = (m_width * m_height) / 1e6;
+    printf("Benchmark: %dx%d, %d iterations\n", m_width, m_height, iterations);
+    printf("  direct:      %8.3f ms/frame  %8.2f MPix/s  %6.2f heap allocs/frame\n", t_direct * 1e3, mpix / t_direct, allocs_direct);
+    if (t_copy > 0)
+        printf("  decode+copy: %8.3f ms/frame  %8.2f MPix/s  %6.2f heap allocs/frame\n", t_copy * 1e3, mpix / t_copy, allocs_copy);
+
+    return ok;
+}
+//-----------------------------------------------------------------------------
+// usage:
+//-----------------------------------------------------------------------------
+static int usage(void)
+{
+    printf("./jpeg [-c|-d|-8] [-x] [-f format] [-s stride] [-b iterations] [-i chunk] [-t trace] src_image.jpg dst_image.ppm\n");
+    printf("  -c  Output quantised DCT coefficients (int16 planes) instead of pixels\n");
+    printf("  -d  Output dequantised DCT coefficients (int16 planes) instead of pixels\n");
+    printf("  -8  DC only decode: 1/8 scale image, one pixel per 8x8 block (RGB formats only)\n");
+    printf("  -x  Colour convert with the RTL's fixed point constants (bit exact with jpeg_output.v)\n");
+    printf("  -f  Output format: rgb (PPM, default), rgba, bgra, rgb565, i420, nv12, yuv444p (raw)\n");
+    printf("  -s  Frame buffer row stride in bytes (default: packed)\n");
+    printf("  -b  Benchmark decode to frame buffer over N iterations\n");
+    printf("  -i  Feed the decoder incrementally in chunks of N bytes\n");
+    printf("  -t  Write a per-block trace (coefficients, IDCT output, pixels) for trace_diff\n");
+    return -1;
 }
 //-----------------------------------------------------------------------------
 // main:
 //-----------------------------------------------------------------------------
 int main(int argc, char* argv[])
 {
-    if (argc < 3)
+    int c;
+    int iterations = 0;
+
+    m_coeff_mode    = false;
+    m_coeff_dequant = false;
+    m_dc_only       = false;
+    m_fixed_colour  = false;
+    m_out_format    = JPEG_PIX_RGB24;
+    m_out_stride    = 0;
+    m_frame_buf     = NULL;
+    m_frame_size    = 0;
+    m_quiet         = false;
+    m_chunk_size    = 0;
+
+    const char *trace_file = NULL;
+
+    while ((c = getopt(argc, argv, "cd8xf:s:b:i:t:")) != -1)
     {
-        printf("./jpeg src_image.jpg dst_image.ppm\n");
-        return -1;
+        switch (c)
+        {
+            case 'c':
+                m_coeff_mode = true;
+                break;
+            case 'd':
+                m_coeff_mode    = true;
+                m_coeff_dequant = true;
+                break;
+            case '8':
+                m_dc_only = true;
+                break;
+            case 'x':
+                m_fixed_colour = true;
+                break;
+            case 'f':
+                if (!strcmp(optarg, "rgb"))
+                    m_out_format = JPEG_PIX_RGB24;
+                else if (!strcmp(optarg, "rgba"))
+                    m_out_format = JPEG_PIX_RGBA32;
+                else if (!strcmp(optarg, "bgra"))
+                    m_out_format = JPEG_PIX_BGRA32;
+                else if (!strcmp(optarg, "rgb565"))
+                    m_out_format = JPEG_PIX_RGB565;
+                else if (!strcmp(optarg, "i420"))
+                    m_out_format = JPEG_PIX_I420;
+                else if (!strcmp(optarg, "nv12"))
+                    m_out_format = JPEG_PIX_NV12;
+                else if (!strcmp(optarg, "yuv444p"))
+                    m_out_format = JPEG_PIX_YUV444P;
+                else
+                    return usage();
+                break;
+            case 's':
+                m_out_stride = (int)strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                iterations = (int)strtoul(optarg, NULL, 0);
+                break;
+            case 'i':
+                m_chunk_size = (int)strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                trace_file = optarg;
+                break;
+            default:
+                return usage();
+        }
     }
 
-    const char *src_image = argv[1];
-    const char *dst_image = argv[2];
+    if (optind + 2 > argc)
+        return usage();
+
+    // DC only output is colour converted as the RTL (packed RGB), no per-block trace
+    if (m_dc_only && (m_coeff_mode || trace_file || jpeg_output::is_yuv(m_out_format)))
+        return usage();
+
+    const char *src_image = argv[optind + 0];
+    const char *dst_image = argv[optind + 1];
 
     // Load source file
     uint8_t *buf = NULL;
@@ -306,276 +421,46 @@ int main(int argc, char* argv[])
         fclose(f);
     }
     else
-    {
-        printf("./jpeg src_image.jpg dst_image.ppm\n");
-        return -1;
-    }
+        return usage();
 
-    m_dqt.reset();
-    m_dht.reset();
-    m_idct.reset();
-    m_mode = JPEG_UNSUPPORTED;
-    m_output_r = NULL;
-    m_output_g = NULL;
-    m_output_b = NULL;
-
-    uint8_t last_b = 0;
-    bool decode_done = false;
-    for (int i=0;i<len;)
+    if (trace_file)
     {
-        uint8_t b = buf[i++];
-
-        //-----------------------------------------------------------------------------
-        // SOI: Start of image
-        //-----------------------------------------------------------------------------
-        if (last_b == 0xFF && b == 0xd8)
-            printf("Section: SOI\n");
-        //-----------------------------------------------------------------------------
-        // SOF0: Indicates that this is a baseline DCT-based JPEG
-        //-----------------------------------------------------------------------------
-        else if (last_b == 0xFF && b == 0xc0)
+        if (m_coeff_mode || !m_trace.open(trace_file, true))
         {
-            printf("Section: SOF0\n");
-            int seg_start = i;
-
-            // Length of the segment
-            uint16_t seg_len   = get_word(buf, i);
-
-            // Precision of the frame data
-            uint8_t  precision = get_byte(buf,i);
-
-            // Image height in pixels
-            m_height = get_word(buf, i);
-
-            // Image width in pixels
-            m_width = get_word(buf, i);
-
-            // Allocate pixel buffer
-            m_output_r = new uint8_t[m_height * m_width];
-            m_output_g = new uint8_t[m_height * m_width];
-            m_output_b = new uint8_t[m_height * m_width];
-            memset(m_output_r, 0, m_height * m_width);
-            memset(m_output_g, 0, m_height * m_width);
-            memset(m_output_b, 0, m_height * m_width);
-
-            // # of components (n) in frame, 1 for monochrom, 3 for colour images
-            uint8_t num_comps = get_byte(buf,i);
-            assert(num_comps <= 3);
-
-            printf(" x=%d, y=%d, components=%d\n", m_width, m_height, num_comps);
-            uint8_t comp_id[3];
-            uint8_t comp_sample_factor[3];
-            uint8_t horiz_factor[3];
-            uint8_t vert_factor[3];
-
-            for (int x=0;x<num_comps;x++)
-            {
-                // First byte identifies the component
-                comp_id[x] = get_byte(buf,i);
-                // id: 1 = Y, 2 = Cb, 3 = Cr
-
-                // Second byte represents sampling factor (first four MSBs represent horizonal, last four LSBs represent vertical)
-                comp_sample_factor[x] = get_byte(buf,i);
-                horiz_factor[x]       = comp_sample_factor[x] >> 4;
-                vert_factor[x]        = comp_sample_factor[x] & 0xF;
-
-                // Third byte represents which quantization table to use for this component
-                m_dqt_table[x]        = get_byte(buf,i);
-                printf(" num: %d a: %02x b: %02x\n", comp_id[x], comp_sample_factor[x], m_dqt_table[x]);
-                printf(" horiz_factor: %d, vert_factor: %d\n", horiz_factor[x], vert_factor[x]);
-            }
-
-            m_mode = JPEG_UNSUPPORTED;
-
-            // Single component (Y)
-            if (num_comps == 1)
-            {
-                printf(" Mode: Monochrome\n");
-                m_mode = JPEG_MONOCHROME;
-            }
-            // Colour image (YCbCr)
-            else if (num_comps == 3)
-            {
-                // YCbCr ordering expected
-                if (comp_id[0] == 1 && comp_id[1] == 2 && comp_id[2] == 3)
-                {
-                    if (horiz_factor[0] == 1 && vert_factor[0] == 1 &&
-                        horiz_factor[1] == 1 && vert_factor[1] == 1 &&
-                        horiz_factor[2] == 1 && vert_factor[2] == 1)
-                    {
-                        m_mode = JPEG_YCBCR_444;
-                        printf(" Mode: YCbCr 4:4:4\n");
-                    }
-                    else if (horiz_factor[0] == 2 && vert_factor[0] == 2 &&
-                             horiz_factor[1] == 1 && vert_factor[1] == 1 &&
-                             horiz_factor[2] == 1 && vert_factor[2] == 1)
-                    {
-                        m_mode = JPEG_YCBCR_420;
-                        printf(" Mode: YCbCr 4:2:0\n");
-                    }
-                }
-            }
-
-            i = seg_start + seg_len;
+            fprintf(stderr, "ERROR: Could not create trace %s (pixel decode only)\n", trace_file);
+            free(buf);
+            return -1;
         }
-        //-----------------------------------------------------------------------------
-        // DQT: Quantisation table
-        //-----------------------------------------------------------------------------
-        else if (last_b == 0xFF && b == 0xdb)
-        {
-            printf("Section: DQT Table\n");
-            int seg_start = i;
-            uint16_t seg_len   = get_word(buf, i);
-            m_dqt.process(&buf[i], seg_len);
-            i = seg_start + seg_len;
-        }
-        //-----------------------------------------------------------------------------
-        // DHT: Huffman table
-        //-----------------------------------------------------------------------------
-        else if (last_b == 0xFF && b == 0xc4)
-        {
-            int seg_start = i;
-            uint16_t seg_len   = get_word(buf, i);
-            printf("Section: DHT Table\n");
-            m_dht.process(&buf[i], seg_len);
-            i = seg_start + seg_len;
-        }
-        //-----------------------------------------------------------------------------
-        // EOI: End of image
-        //-----------------------------------------------------------------------------
-        else if (last_b == 0xFF && b == 0xd9)
-        {
-            printf("Section: EOI\n");
-            break;
-        }
-        //-----------------------------------------------------------------------------
-        // SOS: Start of Scan Segment (SOS)
-        //-----------------------------------------------------------------------------
-        else if (last_b == 0xFF && b == 0xda)
-        {
-            printf("Section: SOS\n");
-            int seg_start = i;
-
-            if (m_mode == JPEG_UNSUPPORTED)
-            {
-                printf("ERROR: Unsupported JPEG mode\n");
-                break;
-            }
-
-            uint16_t seg_len   = get_word(buf, i);
-
-            // Component count (n)
-            uint8_t  comp_count = get_byte(buf,i);
-
-            // Component data
-            for (int x=0;x<comp_count;x++)
-            {
-                // First byte denotes component ID
-                uint8_t comp_id = get_byte(buf,i);
-
-                // Second byte denotes the Huffman table used (first four MSBs denote Huffman table for DC, and last four LSBs denote Huffman table for AC)
-                uint8_t comp_table = get_byte(buf,i);
-
-                printf(" %d: ID=%x Table=%x\n", x, comp_id, comp_table);
-            }
-
-            // Skip bytes
-            get_byte(buf,i);
-            get_byte(buf,i);
-            get_byte(buf,i);
+        m_decoder.set_trace(&m_trace);
+    }
 
-            i = seg_start + seg_len;
+    bool decode_done = DecodeJPEG(buf, len);
 
-            //-----------------------------------------------------------------------
-            // Process data segment
-            //-----------------------------------------------------------------------
-            m_bit_buffer.reset(len);
-            while (i < len)
-            {
-                b = buf[i];
-                if (m_bit_buffer.push(b))
-                    i++;
-                // Marker detected (reverse one byte)
-                else
-                {
-                    i--;
-                    break;
-                }
-            }
+    // Trace the first decode only
+    m_decoder.set_trace(NULL);
+    m_trace.close();
 
-            decode_done = DecodeImage();
-        }
-        //-----------------------------------------------------------------------------
-        // Unsupported / Skipped
-        //-----------------------------------------------------------------------------        
-        else if (last_b == 0xFF && b == 0xc2)
-        {
-            printf("Section: SOF2\n");
-            int seg_start = i;
-            uint16_t seg_len   = get_word(buf, i);
-            i = seg_start + seg_len;
+    if (decode_done && iterations > 0)
+        decode_done = Benchmark(buf, len, iterations);
 
-            printf("ERROR: Progressive JPEG not supported\n");
-            break; // ERROR: Not supported
-        }
-        else if (last_b == 0xFF && b == 0xdd)
-        {
-            printf("Section: DRI\n");
-            int seg_start = i;
-            uint16_t seg_len   = get_word(buf, i);
-            i = seg_start + seg_len;            
-        }
-        else if (last_b == 0xFF && b >= 0xd0 && b <= 0xd7)
-        {
-            printf("Section: RST%d\n", b - 0xd0);
-            int seg_start = i;
-            uint16_t seg_len   = get_word(buf, i);
-            i = seg_start + seg_len;
-        }
-        else if (last_b == 0xFF && b >= 0xe0 && b <= 0xef)
-        {
-            printf("Section: APP%d\n", b - 0xe0);
-            int seg_start = i;
-            uint16_t seg_len   = get_word(buf, i);
-            i = seg_start + seg_len;
-        }
-        else if (last_b == 0xFF && b == 0xfe)
+    if (decode_done && m_coeff_mode)
+    {
+        if (!WriteCoeffs(dst_image))
         {
-            printf("Section: COM\n");
-            int seg_start = i;
-            uint16_t seg_len   = get_word(buf, i);
-            i = seg_start + seg_len;
+            fprintf(stderr, "ERROR: Could not write file\n");
+            decode_done = false;
         }
-
-        last_b = b;
     }
-
-    if (decode_done)
+    else if (decode_done)
     {
-        FILE *f = fopen(dst_image, "w");
-        if (f)
-        {
-            fprintf(f, "P6\n");
-            fprintf(f, "%d %d\n", m_width, m_height);
-            fprintf(f, "255\n");
-            for (int y=0;y<m_height;y++)
-                for (int x=0;x<m_width;x++)
-                {
-                    putc(m_output_r[(y*m_width)+x], f);
-                    putc(m_output_g[(y*m_width)+x], f);
-                    putc(m_output_b[(y*m_width)+x], f);
-                }
-            fclose(f);
-        }
-        else
+        if (!WriteOutput(dst_image))
         {
             fprintf(stderr, "ERROR: Could not write file\n");
             decode_done = false;
         }
     }
 
-    if (m_output_r) delete [] m_output_r;
-    if (m_output_g) delete [] m_output_g;
-    if (m_output_b) delete [] m_output_b;
+    free(m_frame_buf);
+    free(buf);
     return decode_done ? 0 : -1;
-}
\ No newline at end of file
+}
@@ -0,0 +1,559 @@
+#ifndef JPEG_PERF_H
+#define JPEG_PERF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Bits consumed by each Huffman symbol, captured through the bit buffer test
+// hook (one advance() per symbol), and the code widths through the DHT
+// lookup hook. Must be included before the C model.
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    int     count;
+    uint8_t bits[64];
+
+    void clear(void)      { count = 0; }
+    void push(int width)  { if (count < 64) bits[count++] = width; }
+} t_jpeg_symbol_log;
+
+#if defined(JPEG_BIT_BUFFER_H) || defined(JPEG_DHT_H)
+#error "jpeg_perf.h must be included before the C model headers"
+#endif
+
+#define TEST_HOOKS_BITBUFFER(x)     m_symbols.push(x)
+#define TEST_HOOKS_BITBUFFER_DECL   t_jpeg_symbol_log m_symbols
+#define TEST_HOOKS_DHT(x)           m_codes.push(x)
+#define TEST_HOOKS_DHT_DECL         t_jpeg_symbol_log m_codes
+
+#include "jpeg_bit_buffer.h"
+#include "jpeg_dht.h"
+#include "jpeg_mcu_block.h"
+
+#define JPEG_PERF_MONO      0
+#define JPEG_PERF_444       1
+#define JPEG_PERF_420       2
+#define JPEG_PERF_422       3
+
+//-----------------------------------------------------------------------------
+// Hardware configuration: cycle costs and buffer sizes of the jpeg_core
+// stages (defaults from the RTL, see README.md for the derivation)
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    int input_latency;      // jpeg_input byte -> jpeg_bitbuffer
+    int input_bytes;        // Input bus bytes (8: INPUT_WIDTH=64, whole words of scan data per cycle)
+    int bitbuffer_bits;     // jpeg_bitbuffer capacity
+    int lookup_cycles;      // jpeg_dht lookup (1 = standard tables, 2 = SUPPORT_WRITABLE_DHT)
+    int fast_bits;          // Codes up to this width resolve in 1 cycle (writable DHT first level lookup, 0 = off)
+    int dual_symbol;        // Two AC symbols per lookup when they fit in 32 bits (SUPPORT_DUAL_SYMBOL)
+    int block_idle;         // jpeg_mcu_proc cycles between EOB and the next block
+    int idct_blocks;        // jpeg_idct_ram input buffer depth (blocks)
+    int idct_cycles;        // Cycles per block through each IDCT pass
+    int idct_latency;       // IDCT read start -> first sample into jpeg_output
+    int y_level;            // jpeg_output accepts while the Y level is <= this
+    int cx_level;           // ... and the Cr level is <= this
+    int output_cycles;      // Cycles per 8x8 pixel block output
+    int offset;             // Fixed cycles (reset / output registers)
+} t_jpeg_perf_cfg;
+
+typedef struct
+{
+    const char *name;
+    int         t_jpeg_perf_cfg::*field;
+    const char *desc;
+} t_jpeg_perf_param;
+
+static const t_jpeg_perf_param jpeg_perf_params[] =
+{
+    { "input_latency",  &t_jpeg_perf_cfg::input_latency,  "jpeg_input -> bitbuffer cycles" },
+    { "input_bytes",    &t_jpeg_perf_cfg::input_bytes,    "input bus width in bytes (4 or 8)" },
+    { "bitbuffer_bits", &t_jpeg_perf_cfg::bitbuffer_bits, "jpeg_bitbuffer capacity (bits)" },
+    { "lookup_cycles",  &t_jpeg_perf_cfg::lookup_cycles,  "Huffman lookup latency (2 = writable DHT)" },
+    { "fast_bits",      &t_jpeg_perf_cfg::fast_bits,      "1 cycle lookup for codes <= bits (writable DHT)" },
+    { "dual_symbol",    &t_jpeg_perf_cfg::dual_symbol,    "two AC symbols per lookup (1 = SUPPORT_DUAL_SYMBOL)" },
+    { "block_idle",     &t_jpeg_perf_cfg::block_idle,     "jpeg_mcu_proc idle cycles between blocks" },
+    { "idct_blocks",    &t_jpeg_perf_cfg::idct_blocks,    "IDCT input buffer depth (blocks)" },
+    { "idct_cycles",    &t_jpeg_perf_cfg::idct_cycles,    "cycles per block per IDCT pass" },
+    { "idct_latency",   &t_jpeg_perf_cfg::idct_latency,   "IDCT read start -> first output sample" },
+    { "y_level",        &t_jpeg_perf_cfg::y_level,        "output Y RAM accept level" },
+    { "cx_level",       &t_jpeg_perf_cfg::cx_level,       "output Cr RAM accept level" },
+    { "output_cycles",  &t_jpeg_perf_cfg::output_cycles,  "cycles per 8x8 output block" },
+    { "offset",         &t_jpeg_perf_cfg::offset,         "fixed cycles per image" },
+    { NULL, NULL, NULL }
+};
+
+static inline void jpeg_perf_default_cfg(t_jpeg_perf_cfg *cfg)
+{
+    cfg->input_latency  = 1;
+    cfg->input_bytes    = 4;
+    cfg->bitbuffer_bits = 64;
+    cfg->lookup_cycles  = 1;
+    cfg->fast_bits      = 8;
+    cfg->dual_symbol    = 0;
+    cfg->block_idle     = 3;
+    cfg->idct_blocks    = 4;
+    cfg->idct_cycles    = 66;
+    cfg->idct_latency   = 150;
+    cfg->y_level        = 384;
+    cfg->cx_level       = 128;
+    cfg->output_cycles  = 65;
+    cfg->offset         = 4;
+}
+
+static inline const t_jpeg_perf_param *jpeg_perf_find_param(const char *name)
+{
+    for (const t_jpeg_perf_param *p = jpeg_perf_params; p->name; p++)
+        if (!strcmp(p->name, name))
+            return p;
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Results for one image (cycles from the first input byte)
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    int      mode;
+    int      width;
+    int      height;
+    int      blocks;        // Coefficient blocks
+    int      pixel_blocks;  // 8x8 output blocks
+    uint64_t symbols;
+    uint64_t pairs;         // Symbol pairs decoded together (dual_symbol)
+    uint64_t header;        // First scan byte
+    uint64_t first_out;
+    uint64_t total;         // Up to and including the last pixel
+
+    // Where the time went (cycles, summed over blocks)
+    uint64_t entropy_busy;  // jpeg_mcu_proc decoding
+    uint64_t entropy_data;  // ... waiting for the bit buffer
+    uint64_t entropy_space; // ... waiting for space in the IDCT input buffer
+    uint64_t idct_busy;
+    uint64_t idct_output;   // IDCT waiting for jpeg_output to accept
+    uint64_t input_full;    // Input stalled on a full bit buffer
+} t_jpeg_perf_stats;
+
+//-----------------------------------------------------------------------------
+// jpeg_perf_model: Transaction level timing model of jpeg_core. The entropy
+// coded data is walked with the C model Huffman decoder and each block is
+// timed through the stages;
+//   jpeg_input     - 1 byte per cycle (header and scan), or with a 64-bit
+//                    bus a whole aligned scan word without 0xFF bytes;
+//                    stuffing and RSTn markers are dropped
+//   jpeg_bitbuffer - bounded bit FIFO, symbol fetch needs >= 32 bits
+//   jpeg_mcu_proc  - fetch / lookup / output per symbol (or per AC symbol
+//                    pair with dual_symbol), idle between blocks, byte
+//                    align and DC predictor reset per restart interval
+//   jpeg_idct      - buffer of idct_blocks, fixed cycles per block, gated
+//                    by jpeg_output's accept (RAM levels)
+//   jpeg_output    - reorder RAMs, one pixel per cycle once an MCU is ready
+// Output backpressure is not modelled (outport_accept_i always high).
+//-----------------------------------------------------------------------------
+class jpeg_perf_model
+{
+public:
+    jpeg_perf_model(const t_jpeg_perf_cfg &cfg): m_cfg(cfg), m_mcu_dec(&m_bit_buffer, &m_dht) { }
+
+    //-------------------------------------------------------------------------
+    // run: Time one JPEG image. Returns false if it is not a baseline image
+    //      the core supports.
+    //-------------------------------------------------------------------------
+    bool run(const uint8_t *buf, int len, t_jpeg_perf_stats *st)
+    {
+        memset(st, 0, sizeof(*st));
+        if (!parse(buf, len, st))
+            return false;
+
+        reset_timing(st);
+
+        static const int comp_420[]  = { 0, 0, 0, 0, 1, 2 };
+        static const int comp_422[]  = { 0, 0, 1, 2 };
+        static const int comp_444[]  = { 0, 1, 2 };
+        static const int comp_mono[] = { 0 };
+        const int *comp   = (st->mode == JPEG_PERF_420) ? comp_420 : (st->mode == JPEG_PERF_422) ? comp_422 :
+                            (st->mode == JPEG_PERF_444) ? comp_444 : comp_mono;
+        int        blocks = (st->mode == JPEG_PERF_420) ? 6 : (st->mode == JPEG_PERF_422) ? 4 :
+                            (st->mode == JPEG_PERF_444) ? 3 : 1;
+        int        mcu_w  = (st->mode == JPEG_PERF_420 || st->mode == JPEG_PERF_422) ? 16 : 8;
+        int        mcu_h  = (st->mode == JPEG_PERF_420) ? 16 : 8;
+        int        mcus   = ((st->width + mcu_w - 1) / mcu_w) * ((st->height + mcu_h - 1) / mcu_h);
+        int16_t    dc_pred[3] = { 0, 0, 0 };
+        int32_t    samples[64];
+
+        for (int m=0;m<mcus;m++)
+        {
+            for (int b=0;b<blocks;b++)
+            {
+                m_bit_buffer.m_symbols.clear();
+                m_dht.m_codes.clear();
+                m_mcu_dec.decode(comp[b] ? DHT_TABLE_CX_DC_IDX : DHT_TABLE_Y_DC_IDX, dc_pred[comp[b]], samples);
+                time_block(comp[b], m_bit_buffer.m_symbols, m_dht.m_codes, st);
+            }
+            if (st->mode == JPEG_PERF_420)
+                schedule_output(4, st);
+            else if (st->mode == JPEG_PERF_422)
+                schedule_output(2, st);
+            else if (st->mode == JPEG_PERF_444)
+                schedule_output(1, st);
+
+            // End of a restart interval: skip to the byte boundary (the next
+            // interval follows the RSTn marker) with the EOB, reset the DC
+            if (m_dri && ((m + 1) % m_dri) == 0)
+            {
+                int pad = (int)((8 - (m_consumed & 7)) & 7);
+                m_bit_buffer.advance(pad);
+                m_consumed += pad;
+                dc_pred[0] = dc_pred[1] = dc_pred[2] = 0;
+            }
+        }
+
+        st->blocks       = m_blk;
+        st->pixel_blocks = (int)m_out_start.size();
+        st->first_out    = m_out_start[0] + 1 + m_cfg.offset;
+
+        // Last pixel inside the image: luma block holding (w-1, h-1)
+        int bx   = (st->width - 1) / 8;
+        int by   = (st->height - 1) / 8;
+        int blk  = (st->mode == JPEG_PERF_420) ? (mcus - 1) * 4 + ((by & 1) * 2) + (bx & 1) :
+                   (st->mode == JPEG_PERF_422) ? (mcus - 1) * 2 + (bx & 1) : (mcus - 1);
+        int idx  = (((st->height - 1) % 8) * 8) + ((st->width - 1) % 8);
+        st->total = m_out_start[blk] + 1 + idx + m_cfg.offset + 1;
+        return true;
+    }
+
+private:
+    //-------------------------------------------------------------------------
+    // parse: Marker segments up to SOS, then load the scan into the bit
+    //        buffer and index its raw bytes (stuffing / EOI) for the input
+    //-------------------------------------------------------------------------
+    bool parse(const uint8_t *buf, int len, t_jpeg_perf_stats *st)
+    {
+        bool sof = false;
+        int  i   = 0;
+
+        m_dht.reset();
+        m_dri    = 0;
+        st->mode = -1;
+        while (i + 4 <= len)
+        {
+            if (buf[i] != 0xFF || buf[i+1] == 0xFF || buf[i+1] == 0x00 || buf[i+1] == 0xD8)
+            {
+                i += (buf[i] == 0xFF && buf[i+1] != 0xFF) ? 2 : 1;
+                continue;
+            }
+            uint8_t marker  = buf[i+1];
+            int     seg_len = (buf[i+2] << 8) | buf[i+3];
+            uint8_t *seg    = (uint8_t *)&buf[i+4];
+            if (marker == 0xD9 || i + 2 + seg_len > len)
+                return false;
+
+            if (marker == 0xC0 && seg_len >= 8)
+            {
+                int comps  = seg[5];
+                st->height = (seg[1] << 8) | seg[2];
+                st->width  = (seg[3] << 8) | seg[4];
+                if (comps == 1)
+                    st->mode = JPEG_PERF_MONO;
+                else if (comps == 3 && seg_len >= 17 && seg[10] == 0x11 && seg[13] == 0x11)
+                    st->mode = (seg[7] == 0x11) ? JPEG_PERF_444 : (seg[7] == 0x22) ? JPEG_PERF_420 :
+                               (seg[7] == 0x21) ? JPEG_PERF_422 : -1;
+                sof = true;
+            }
+            else if (marker == 0xC4)
+                m_dht.process(seg, seg_len);
+            else if (marker == 0xDD && seg_len >= 4)
+                m_dri = (seg[0] << 8) | seg[1];
+            else if (marker == 0xDA)
+            {
+                i += 2 + seg_len;
+                break;
+            }
+            else if (marker == 0xC2)
+                return false;
+            i += 2 + seg_len;
+        }
+
+        if (!sof || st->mode < 0 || st->width == 0 || st->height == 0 || i >= len)
+            return false;
+
+        // Scan: up to the next marker (EOI) other than RSTn
+        st->header = i;
+        m_stuffed.clear();
+        m_scan_ff.clear();
+        int clean = 0;
+        int k;
+        for (k=i;k<len;k++)
+        {
+            m_scan_ff.push_back(buf[k] == 0xFF);
+            if (k > i && buf[k-1] == 0xFF && !m_stuffed.back())
+            {
+                // RSTn: dropped by jpeg_input along with its 0xFF
+                if (m_dri && buf[k] >= 0xD0 && buf[k] <= 0xD7)
+                {
+                    m_stuffed.back() = true;
+                    m_stuffed.push_back(true);
+                    clean--;
+                    continue;
+                }
+                if (buf[k] != 0x00)
+                    break;
+                m_stuffed.push_back(true);
+                continue;
+            }
+            m_stuffed.push_back(false);
+            clean++;
+        }
+        // Drop the marker's 0xFF
+        if (k < len)
+        {
+            m_stuffed.pop_back();
+            clean--;
+        }
+        m_scan_raw  = (int)m_stuffed.size();
+        m_scan_eoi  = st->header + m_scan_raw + 2;
+
+        // The bit buffer drops stuffing itself, RSTn markers are skipped here
+        m_bit_buffer.reset(clean + 1);
+        for (k=i;k<i+m_scan_raw;k++)
+            if (!m_stuffed[k - i] || buf[k] == 0x00)
+                m_bit_buffer.push(buf[k]);
+        m_scan_bytes = clean;
+        m_scan_start = i;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // Input / bit buffer
+    //-------------------------------------------------------------------------
+    void reset_timing(t_jpeg_perf_stats *st)
+    {
+        m_in_raw      = 0;
+        m_in_t        = st->header;
+        m_pushed      = 0;
+        m_consumed    = 0;
+        m_push_time.assign(m_scan_bytes, 0);
+
+        m_blk         = 0;
+        m_cx_scale    = (st->mode == JPEG_PERF_420) ? 4 : (st->mode == JPEG_PERF_422) ? 2 : 1;
+        m_mcu_free    = st->header;
+        m_idct_free   = 0;
+        m_read_start.clear();
+        m_y_push.clear();
+        m_cb_push.clear();
+        m_cr_push.clear();
+        m_out_start.clear();
+        m_y_pushed_idx = m_cr_pushed_idx = m_popped_idx = 0;
+    }
+
+    // Raw scan bytes taken by jpeg_input in one cycle from m_in_raw
+    int input_burst(void)
+    {
+        int n = m_cfg.input_bytes;
+        if (n <= 4 || ((m_scan_start + m_in_raw) % n) != 0 || m_in_raw + n > m_scan_raw)
+            return 1;
+        if (m_in_raw > 0 && m_scan_ff[m_in_raw - 1])
+            return 1;
+        for (int i=0;i<n;i++)
+            if (m_scan_ff[m_in_raw + i])
+                return 1;
+        return n;
+    }
+
+    // Run the input up to cycle t (the bit buffer accepts while there is room
+    // for a whole input burst)
+    void advance_input(uint64_t t, t_jpeg_perf_stats *st)
+    {
+        int burst_bits = (m_cfg.input_bytes > 4) ? (m_cfg.input_bytes * 8) : 8;
+
+        while (m_in_raw < m_scan_raw && m_in_t <= t)
+        {
+            int n = input_burst();
+            if (n > 1 || !m_stuffed[m_in_raw])
+            {
+                if ((m_pushed * 8) - m_consumed > (uint64_t)(m_cfg.bitbuffer_bits - burst_bits))
+                {
+                    st->input_full += t + 1 - m_in_t;
+                    m_in_t = t + 1;
+                    return;
+                }
+            }
+            for (int i=0;i<n;i++)
+                if (!m_stuffed[m_in_raw + i])
+                    m_push_time[m_pushed++] = m_in_t + m_cfg.input_latency;
+            m_in_raw += n;
+            m_in_t++;
+        }
+    }
+
+    // Earliest cycle >= t with a full word (or the drained tail) in the bit buffer
+    uint64_t wait_data(uint64_t t, t_jpeg_perf_stats *st)
+    {
+        uint64_t need = (m_consumed + 32 + 7) / 8;
+        while (m_pushed < need && m_pushed < m_scan_bytes)
+            advance_input(m_in_t, st);
+
+        uint64_t ready = (need <= m_scan_bytes) ? m_push_time[need - 1] + 1 :
+                                                  m_scan_eoi + m_cfg.input_latency + 1;
+        return ready > t ? ready : t;
+    }
+
+    // Symbol popped from the bit buffer at cycle t
+    void pop_bits(uint64_t t, int bits, t_jpeg_perf_stats *st)
+    {
+        advance_input(t, st);
+        m_consumed += bits;
+    }
+
+    //-------------------------------------------------------------------------
+    // time_block: jpeg_mcu_proc -> jpeg_dqt -> jpeg_idct for one block
+    //-------------------------------------------------------------------------
+    void time_block(int comp, const t_jpeg_symbol_log &syms, const t_jpeg_symbol_log &codes, t_jpeg_perf_stats *st)
+    {
+        // Space in the IDCT input buffer
+        uint64_t t = m_mcu_free;
+        if (m_blk >= m_cfg.idct_blocks)
+        {
+            uint64_t space = m_read_start[m_blk - m_cfg.idct_blocks] + m_cfg.idct_cycles + 1;
+            if (space > t)
+            {
+                st->entropy_space += space - t;
+                t = space;
+            }
+        }
+
+        // FETCH -> LOOKUP -> OUTPUT per symbol, then FETCH (idx >= 63) -> EOB.
+        // With dual_symbol an AC symbol (never the last of the block) and the
+        // one after it are popped together when both fit in the lookup word,
+        // then OUTPUT2 writes the second coefficient.
+        uint64_t start = t;
+        for (int s=0;s<syms.count;s++)
+        {
+            uint64_t ready = wait_data(t, st);
+            st->entropy_data += ready - t;
+            bool fast = (s < codes.count && codes.bits[s] <= m_cfg.fast_bits);
+            t = ready + 1 + (fast ? 1 : m_cfg.lookup_cycles);
+            if (m_cfg.dual_symbol && s > 0 && (s + 1) < syms.count && (syms.bits[s] + syms.bits[s+1]) <= 32)
+            {
+                pop_bits(t, syms.bits[s] + syms.bits[s+1], st);
+                st->pairs++;
+                s++;
+                t++;
+            }
+            else
+                pop_bits(t, syms.bits[s], st);
+            t++;
+        }
+        uint64_t eob = t + 1;
+        st->entropy_busy += (eob + 1 - start);
+        st->symbols      += syms.count;
+        m_mcu_free        = eob + 1 + m_cfg.block_idle;
+
+        // Block complete in the IDCT input buffer once the EOB has passed jpeg_dqt
+        uint64_t rd = eob + 3;
+        if (rd < m_idct_free)
+            rd = m_idct_free;
+        uint64_t ready = rd;
+        while (!output_accept(rd))
+            rd++;
+        st->idct_output += rd - ready;
+        st->idct_busy   += m_cfg.idct_cycles;
+        m_idct_free      = rd + m_cfg.idct_cycles;
+        m_read_start.push_back(rd);
+
+        uint64_t push = rd + m_cfg.idct_latency;
+        if (comp == 0)
+            m_y_push.push_back(push);
+        else if (comp == 1)
+            m_cb_push.push_back(push);
+        else
+            m_cr_push.push_back(push);
+        m_blk++;
+
+        if (st->mode == JPEG_PERF_MONO)
+            schedule_output(1, st);
+    }
+
+    //-------------------------------------------------------------------------
+    // jpeg_output
+    //-------------------------------------------------------------------------
+    // Samples pushed / popped by cycle t for 64 sample blocks starting at times[]
+    static uint64_t samples_by(const std::vector<uint64_t> &times, size_t &done, uint64_t t)
+    {
+        while (done < times.size() && times[done] + 63 < t)
+            done++;
+        uint64_t n = done * 64;
+        for (size_t i=done;i<times.size() && times[i] < t;i++)
+            n += t - times[i];
+        return n;
+    }
+
+    bool output_accept(uint64_t t)
+    {
+        uint64_t popped = samples_by(m_out_start, m_popped_idx, t);
+        uint64_t y_lvl  = samples_by(m_y_push, m_y_pushed_idx, t) - popped;
+        uint64_t cr     = samples_by(m_cr_push, m_cr_pushed_idx, t) * m_cx_scale;
+        uint64_t cr_lvl = (cr > popped) ? cr - popped : 0;
+
+        return y_lvl <= (uint64_t)m_cfg.y_level && cr_lvl <= (uint64_t)m_cfg.cx_level;
+    }
+
+    // Output the luma blocks of the MCU just pushed (one pixel per cycle)
+    void schedule_output(int count, t_jpeg_perf_stats *st)
+    {
+        // Whole MCU in the output RAMs (level registered, then active_q)
+        uint64_t ready = (st->mode == JPEG_PERF_MONO) ? m_y_push.back() : m_cr_push.back();
+        ready += 64 + 2;
+
+        for (int i=0;i<count;i++)
+        {
+            uint64_t t = ready;
+            if (!m_out_start.empty() && m_out_start.back() + m_cfg.output_cycles > t)
+                t = m_out_start.back() + m_cfg.output_cycles;
+            m_out_start.push_back(t);
+        }
+    }
+
+private:
+    t_jpeg_perf_cfg    m_cfg;
+    jpeg_bit_buffer    m_bit_buffer;
+    jpeg_dht           m_dht;
+    jpeg_mcu_block     m_mcu_dec;
+
+    // Scan
+    int                m_dri;           // Restart interval (MCUs, 0 = none)
+    std::vector<bool>  m_stuffed;       // Raw scan byte is a stuffed 0x00 or part of an RSTn marker
+    std::vector<bool>  m_scan_ff;       // Raw scan byte is 0xFF
+    int                m_scan_start;    // File offset of the scan
+    int                m_scan_raw;
+    uint64_t           m_scan_bytes;
+    uint64_t           m_scan_eoi;
+
+    // Input / bit buffer
+    int                m_in_raw;
+    uint64_t           m_in_t;
+    uint64_t           m_pushed;
+    uint64_t           m_consumed;
+    std::vector<uint64_t> m_push_time;  // Bit buffer write of each scan byte
+
+    // Blocks
+    int                m_blk;
+    int                m_cx_scale;      // Luma samples per chroma sample
+    uint64_t           m_mcu_free;
+    uint64_t           m_idct_free;
+    std::vector<uint64_t> m_read_start; // IDCT read start per block
+    std::vector<uint64_t> m_y_push;     // First sample into jpeg_output per block
+    std::vector<uint64_t> m_cb_push;
+    std::vector<uint64_t> m_cr_push;
+    std::vector<uint64_t> m_out_start;  // First pop per output block
+    size_t             m_y_pushed_idx;
+    size_t             m_cr_pushed_idx;
+    size_t             m_popped_idx;
+};
+
+#endif
@@ -0,0 +1,393 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "jpeg_perf.h"
+
+//-----------------------------------------------------------------------------
+// perf_model: Estimate jpeg_core cycles per image from the JPEG files alone
+// (transaction level model, see jpeg_perf.h) and sweep the hardware
+// configuration over an image corpus.
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    std::string          name;
+    std::vector<uint8_t> data;
+} t_image;
+
+static const char *m_mode_name[] = { "mono", "444", "420", "422" };
+
+//-----------------------------------------------------------------------------
+// LoadFile: Whole file, or a list of files (one per line) for @list
+//-----------------------------------------------------------------------------
+static bool LoadFile(const char *filename, std::vector<t_image> &images)
+{
+    if (filename[0] == '@')
+    {
+        FILE *f = fopen(filename + 1, "r");
+        if (!f)
+        {
+            fprintf(stderr, "ERROR: Could not open list %s\n", filename + 1);
+            return false;
+        }
+
+        char line[1024];
+        bool ok = true;
+        while (ok && fgets(line, sizeof(line), f))
+        {
+            line[strcspn(line, "\r\n")] = 0;
+            if (line[0] && line[0] != '#')
+                ok = LoadFile(line, images);
+        }
+        fclose(f);
+        return ok;
+    }
+
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+    {
+        fprintf(stderr, "ERROR: Could not open %s\n", filename);
+        return false;
+    }
+
+    t_image img;
+    img.name = filename;
+    fseek(f, 0, SEEK_END);
+    img.data.resize(ftell(f));
+    rewind(f);
+    size_t len = fread(img.data.data(), 1, img.data.size(), f);
+    fclose(f);
+    if (len != img.data.size())
+        return false;
+
+    images.push_back(img);
+    return true;
+}
+//-----------------------------------------------------------------------------
+// LoadRtlCsv: total_cycles per image from a run_bench / +csv results file
+//-----------------------------------------------------------------------------
+static bool LoadRtlCsv(const char *filename, std::map<std::string, uint64_t> &cycles)
+{
+    FILE *f = fopen(filename, "r");
+    if (!f)
+    {
+        fprintf(stderr, "ERROR: Could not open %s\n", filename);
+        return false;
+    }
+
+    char line[4096];
+    int  col_name   = -1;
+    int  col_cycles = -1;
+    while (fgets(line, sizeof(line), f))
+    {
+        line[strcspn(line, "\r\n")] = 0;
+
+        std::vector<std::string> fields;
+        for (char *p = strtok(line, ","); p; p = strtok(NULL, ","))
+            fields.push_back(p);
+
+        // Header row names the columns
+        if (col_cycles < 0)
+        {
+            for (size_t i=0;i<fields.size();i++)
+            {
+                if (fields[i] == "image" || fields[i] == "file")
+                    col_name = i;
+                else if (fields[i] == "total_cycles" || fields[i] == "cycles")
+                    col_cycles = i;
+            }
+            if (col_name < 0 || col_cycles < 0)
+                break;
+            continue;
+        }
+
+        if ((int)fields.size() > col_name && (int)fields.size() > col_cycles)
+        {
+            // Match on the file name only
+            std::string name = fields[col_name];
+            size_t      pos  = name.find_last_of('/');
+            if (pos != std::string::npos)
+                name = name.substr(pos + 1);
+            cycles[name] = strtoull(fields[col_cycles].c_str(), NULL, 0);
+        }
+    }
+    fclose(f);
+
+    if (col_cycles < 0)
+    {
+        fprintf(stderr, "ERROR: %s has no image / total_cycles columns\n", filename);
+        return false;
+    }
+    return true;
+}
+//-----------------------------------------------------------------------------
+// SetParam: name=value
+//-----------------------------------------------------------------------------
+static bool SetParam(t_jpeg_perf_cfg *cfg, const char *arg)
+{
+    std::string             s   = arg;
+    size_t                  pos = s.find('=');
+    const t_jpeg_perf_param *p  = jpeg_perf_find_param(s.substr(0, pos).c_str());
+
+    if (pos == std::string::npos || !p)
+    {
+        fprintf(stderr, "ERROR: Unknown parameter '%s'\n", arg);
+        return false;
+    }
+
+    cfg->*(p->field) = atoi(s.c_str() + pos + 1);
+    return true;
+}
+//-----------------------------------------------------------------------------
+// BaseName:
+//-----------------------------------------------------------------------------
+static std::string BaseName(const std::string &name)
+{
+    size_t pos = name.find_last_of('/');
+    return (pos == std::string::npos) ? name : name.substr(pos + 1);
+}
+//-----------------------------------------------------------------------------
+// usage:
+//-----------------------------------------------------------------------------
+static int usage(void)
+{
+    printf("./perf_model [options] image.jpg|@list [...]\n");
+    printf("  -D name=value   Override a hardware parameter\n");
+    printf("  -s name=v1,v2.. Sweep a parameter over the corpus\n");
+    printf("  -r rtl.csv      Compare with RTL cycles (run_bench / +csv output)\n");
+    printf("  -o file.csv     Per image results\n");
+    printf("  -f MHz          Clock for fps figures (default 75)\n");
+    printf("  -q              Summary only\n");
+    printf("Parameters (default):\n");
+
+    t_jpeg_perf_cfg cfg;
+    jpeg_perf_default_cfg(&cfg);
+    for (const t_jpeg_perf_param *p = jpeg_perf_params; p->name; p++)
+        printf("  %-16s %-44s (%d)\n", p->name, p->desc, cfg.*(p->field));
+    return 2;
+}
+//-----------------------------------------------------------------------------
+// main:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    t_jpeg_perf_cfg cfg;
+    const char *    sweep     = NULL;
+    const char *    rtl_csv   = NULL;
+    const char *    out_csv   = NULL;
+    double          clock_mhz = 75.0;
+    bool            quiet     = false;
+    int c;
+
+    jpeg_perf_default_cfg(&cfg);
+
+    while ((c = getopt(argc, argv, "D:s:r:o:f:q")) != -1)
+    {
+        switch (c)
+        {
+            case 'D':
+                if (!SetParam(&cfg, optarg))
+                    return 2;
+                break;
+            case 's':
+                sweep = optarg;
+                break;
+            case 'r':
+                rtl_csv = optarg;
+                break;
+            case 'o':
+                out_csv = optarg;
+                break;
+            case 'f':
+                clock_mhz = atof(optarg);
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            default:
+                return usage();
+        }
+    }
+
+    if (optind >= argc)
+        return usage();
+
+    std::vector<t_image> images;
+    for (int i=optind;i<argc;i++)
+        if (!LoadFile(argv[i], images))
+            return 1;
+
+    std::map<std::string, uint64_t> rtl;
+    if (rtl_csv && !LoadRtlCsv(rtl_csv, rtl))
+        return 1;
+
+    // Sweep: name=v1,v2,...
+    std::string      sweep_name;
+    std::vector<int> sweep_values;
+    if (sweep)
+    {
+        const char *eq = strchr(sweep, '=');
+        if (!eq || !jpeg_perf_find_param(std::string(sweep, eq - sweep).c_str()))
+        {
+            fprintf(stderr, "ERROR: Bad sweep '%s'\n", sweep);
+            return 2;
+        }
+        sweep_name = std::string(sweep, eq - sweep);
+        for (const char *p = eq + 1; *p; )
+        {
+            sweep_values.push_back(atoi(p));
+            p += strcspn(p, ",");
+            if (*p == ',')
+                p++;
+        }
+        quiet = true;
+    }
+    else
+        sweep_values.push_back(0);
+
+    FILE *csv = NULL;
+    if (out_csv)
+    {
+        csv = fopen(out_csv, "w");
+        if (!csv)
+        {
+            fprintf(stderr, "ERROR: Could not create %s\n", out_csv);
+            return 1;
+        }
+        fprintf(csv, "image,mode,width,height,blocks,symbols,%stotal_cycles,cycles_per_block,"
+                     "entropy_busy,entropy_data,entropy_space,idct_busy,idct_output,input_full,rtl_cycles,error_pct\n",
+                     sweep ? (sweep_name + ",").c_str() : "");
+    }
+
+    if (sweep)
+        printf("%-16s %8s %14s %10s %10s %9s\n", sweep_name.c_str(), "images", "cycles", "cyc/blk", "fps", "err%");
+    else if (!quiet)
+        printf("%-32s %-4s %11s %8s %12s %8s %9s %8s\n", "image", "mode", "size", "blocks", "cycles", "cyc/blk", "rtl", "err%");
+
+    clock_t  start     = clock();
+    uint64_t simulated = 0;
+    int      skipped   = 0;
+
+    for (size_t v=0;v<sweep_values.size();v++)
+    {
+        t_jpeg_perf_cfg run_cfg = cfg;
+        if (sweep)
+            run_cfg.*(jpeg_perf_find_param(sweep_name.c_str())->field) = sweep_values[v];
+
+        jpeg_perf_model model(run_cfg);
+        uint64_t total_cycles = 0;
+        uint64_t total_blocks = 0;
+        int      count        = 0;
+        int      compared     = 0;
+        double   abs_err      = 0;
+        double   max_err      = 0;
+
+        for (size_t i=0;i<images.size();i++)
+        {
+            t_jpeg_perf_stats st;
+
+            if (!model.run(images[i].data.data(), (int)images[i].data.size(), &st))
+            {
+                if (v == 0)
+                {
+                    fprintf(stderr, "Skipping %s (not a supported baseline JPEG)\n", images[i].name.c_str());
+                    skipped++;
+                }
+                continue;
+            }
+
+            count++;
+            total_cycles += st.total;
+            total_blocks += st.pixel_blocks;
+            simulated    += st.total;
+
+            double err = 0;
+            std::map<std::string, uint64_t>::iterator r = rtl.find(BaseName(images[i].name));
+            if (r != rtl.end() && r->second)
+            {
+                err = 100.0 * ((double)st.total - (double)r->second) / (double)r->second;
+                abs_err += fabs(err);
+                if (fabs(err) > fabs(max_err))
+                    max_err = err;
+                compared++;
+            }
+
+            if (!quiet)
+            {
+                char size[32];
+                snprintf(size, sizeof(size), "%dx%d", st.width, st.height);
+                printf("%-32s %-4s %11s %8d %12llu %8.1f", BaseName(images[i].name).c_str(), m_mode_name[st.mode],
+                       size, st.pixel_blocks, (unsigned long long)st.total, (double)st.total / st.pixel_blocks);
+                if (r != rtl.end())
+                    printf(" %9llu %+7.2f%%", (unsigned long long)r->second, err);
+                printf("\n");
+            }
+
+            if (csv)
+            {
+                fprintf(csv, "%s,%s,%d,%d,%d,%llu,", images[i].name.c_str(), m_mode_name[st.mode],
+                        st.width, st.height, st.blocks, (unsigned long long)st.symbols);
+                if (sweep)
+                    fprintf(csv, "%d,", sweep_values[v]);
+                fprintf(csv, "%llu,%.2f,%llu,%llu,%llu,%llu,%llu,%llu,",
+                        (unsigned long long)st.total, (double)st.total / st.pixel_blocks,
+                        (unsigned long long)st.entropy_busy, (unsigned long long)st.entropy_data,
+                        (unsigned long long)st.entropy_space, (unsigned long long)st.idct_busy,
+                        (unsigned long long)st.idct_output, (unsigned long long)st.input_full);
+                if (r != rtl.end())
+                    fprintf(csv, "%llu,%.3f\n", (unsigned long long)r->second, err);
+                else
+                    fprintf(csv, ",\n");
+            }
+
+            // Where the time went (single image runs)
+            if (!quiet && images.size() == 1)
+            {
+                printf("  header           %12llu cycles\n", (unsigned long long)st.header);
+                printf("  first pixel      %12llu\n", (unsigned long long)st.first_out);
+                printf("  symbols          %12llu (%.1f per block)\n", (unsigned long long)st.symbols, (double)st.symbols / st.blocks);
+                if (cfg.dual_symbol)
+                    printf("  symbol pairs     %12llu\n", (unsigned long long)st.pairs);
+                printf("  entropy busy     %12llu\n", (unsigned long long)st.entropy_busy);
+                printf("  entropy no data  %12llu\n", (unsigned long long)st.entropy_data);
+                printf("  entropy no space %12llu\n", (unsigned long long)st.entropy_space);
+                printf("  idct busy        %12llu\n", (unsigned long long)st.idct_busy);
+                printf("  idct -> output   %12llu (stalled)\n", (unsigned long long)st.idct_output);
+                printf("  input full       %12llu\n", (unsigned long long)st.input_full);
+            }
+        }
+
+        if (sweep)
+        {
+            printf("%-16d %8d %14llu %10.1f %10.1f", sweep_values[v], count, (unsigned long long)total_cycles,
+                   total_blocks ? (double)total_cycles / total_blocks : 0.0,
+                   total_cycles ? (clock_mhz * 1e6 * count) / total_cycles : 0.0);
+            if (compared)
+                printf(" %8.2f%%", abs_err / compared);
+            printf("\n");
+        }
+        else
+        {
+            printf("Total: %d images, %llu cycles, %.1f cycles/block, %.1f fps @ %.0f MHz\n", count,
+                   (unsigned long long)total_cycles, total_blocks ? (double)total_cycles / total_blocks : 0.0,
+                   total_cycles ? (clock_mhz * 1e6 * count) / total_cycles : 0.0, clock_mhz);
+            if (compared)
+                printf("RTL: %d images compared, mean |error| %.2f%%, worst %+.2f%%\n", compared, abs_err / compared, max_err);
+        }
+    }
+
+    double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    fprintf(stderr, "Modelled %llu cycles in %.2fs (%.1f Mcycles/s)%s\n", (unsigned long long)simulated, secs,
+            secs > 0 ? simulated / secs / 1e6 : 0.0, skipped ? ", some images skipped" : "");
+
+    if (csv)
+        fclose(csv);
+    return 0;
+}
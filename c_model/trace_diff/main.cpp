@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <map>
+
+#include "jpeg_trace.h"
+
+//-----------------------------------------------------------------------------
+// trace_diff: Compare two block traces (e.g. C model vs RTL) and report the
+// first block / pipeline stage that diverges.
+//-----------------------------------------------------------------------------
+typedef std::map<uint32_t, t_jpeg_trace_rec> t_stage_recs;
+
+typedef struct
+{
+    int      mismatches;
+    int      missing;
+    int      max_err;
+    uint32_t first;     // First diverging block
+    bool     diverged;
+} t_stage_result;
+
+static int m_tolerance[JPEG_TRACE_STAGES];
+
+//-----------------------------------------------------------------------------
+// LoadTrace: Read a trace into per stage maps (indexed by block)
+//-----------------------------------------------------------------------------
+static bool LoadTrace(const char *filename, t_stage_recs *stages)
+{
+    jpeg_trace       trace;
+    t_jpeg_trace_rec rec;
+
+    if (!trace.open(filename, false))
+    {
+        fprintf(stderr, "ERROR: Could not read trace %s\n", filename);
+        return false;
+    }
+
+    while (trace.read(&rec))
+        stages[rec.hdr.stage][rec.hdr.block] = rec;
+
+    return true;
+}
+//-----------------------------------------------------------------------------
+// RecordError: Largest absolute difference between two records (-1 if the
+//              component differs)
+//-----------------------------------------------------------------------------
+static int RecordError(const t_jpeg_trace_rec &a, const t_jpeg_trace_rec &b)
+{
+    int max_err = 0;
+
+    if (a.hdr.comp != b.hdr.comp)
+        return -1;
+
+    if (a.hdr.stage == JPEG_TRACE_PIXELS)
+    {
+        for (int i=0;i<64*3;i++)
+            if (abs(a.rgb[i] - b.rgb[i]) > max_err)
+                max_err = abs(a.rgb[i] - b.rgb[i]);
+    }
+    else
+    {
+        for (int i=0;i<64;i++)
+            if (abs(a.coeff[i] - b.coeff[i]) > max_err)
+                max_err = abs(a.coeff[i] - b.coeff[i]);
+    }
+
+    return max_err;
+}
+//-----------------------------------------------------------------------------
+// CompareStage:
+//-----------------------------------------------------------------------------
+static t_stage_result CompareStage(int stage, t_stage_recs &ref, t_stage_recs &dut)
+{
+    t_stage_result res;
+    memset(&res, 0, sizeof(res));
+
+    for (t_stage_recs::iterator it = ref.begin(); it != ref.end(); ++it)
+    {
+        t_stage_recs::iterator other = dut.find(it->first);
+        bool diverged;
+
+        if (other == dut.end())
+        {
+            res.missing++;
+            diverged = true;
+        }
+        else
+        {
+            int err = RecordError(it->second, other->second);
+            diverged = (err < 0) || (err > m_tolerance[stage]);
+            if (diverged)
+                res.mismatches++;
+            if (err > res.max_err)
+                res.max_err = err;
+        }
+
+        if (diverged && !res.diverged)
+        {
+            res.diverged = true;
+            res.first    = it->first;
+        }
+    }
+
+    // Blocks only present in the DUT trace
+    for (t_stage_recs::iterator it = dut.begin(); it != dut.end(); ++it)
+    {
+        if (ref.find(it->first) != ref.end())
+            continue;
+
+        res.missing++;
+        if (!res.diverged || it->first < res.first)
+        {
+            res.diverged = true;
+            res.first    = it->first;
+        }
+    }
+
+    return res;
+}
+//-----------------------------------------------------------------------------
+// PrintBlock: Dump a block side by side ('*' marks differences)
+//-----------------------------------------------------------------------------
+static void PrintBlock(const char *name, const t_jpeg_trace_rec *rec, const t_jpeg_trace_rec *other)
+{
+    if (!rec)
+    {
+        printf("  %s: <missing>\n", name);
+        return;
+    }
+
+    printf("  %s: comp=%d x=%d y=%d\n", name, rec->hdr.comp, rec->hdr.x, rec->hdr.y);
+    for (int y=0;y<8;y++)
+    {
+        printf("   ");
+        for (int x=0;x<8;x++)
+        {
+            int i = (y * 8) + x;
+            if (rec->hdr.stage == JPEG_TRACE_PIXELS)
+            {
+                bool diff = other && memcmp(&rec->rgb[i*3], &other->rgb[i*3], 3);
+                printf(" %02x%02x%02x%c", rec->rgb[i*3], rec->rgb[(i*3)+1], rec->rgb[(i*3)+2], diff ? '*' : ' ');
+            }
+            else
+            {
+                bool diff = other && rec->coeff[i] != other->coeff[i];
+                printf(" %6d%c", rec->coeff[i], diff ? '*' : ' ');
+            }
+        }
+        printf("\n");
+    }
+}
+//-----------------------------------------------------------------------------
+// usage:
+//-----------------------------------------------------------------------------
+static int usage(void)
+{
+    printf("./trace_diff [-i tolerance] [-p tolerance] ref.trace dut.trace\n");
+    printf("  -i  Largest IDCT output difference allowed (default 0)\n");
+    printf("  -p  Largest pixel channel difference allowed (default 0)\n");
+    return 2;
+}
+//-----------------------------------------------------------------------------
+// main:
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    int c;
+
+    memset(m_tolerance, 0, sizeof(m_tolerance));
+
+    while ((c = getopt(argc, argv, "i:p:")) != -1)
+    {
+        switch (c)
+        {
+            case 'i':
+                m_tolerance[JPEG_TRACE_IDCT] = atoi(optarg);
+                break;
+            case 'p':
+                m_tolerance[JPEG_TRACE_PIXELS] = atoi(optarg);
+                break;
+            default:
+                return usage();
+        }
+    }
+
+    if (optind + 2 > argc)
+        return usage();
+
+    static t_stage_recs ref[JPEG_TRACE_STAGES];
+    static t_stage_recs dut[JPEG_TRACE_STAGES];
+
+    if (!LoadTrace(argv[optind + 0], ref) || !LoadTrace(argv[optind + 1], dut))
+        return 2;
+
+    // Earliest diverging block, and the earliest stage within that block
+    int      first_stage = -1;
+    uint32_t first_block = 0;
+
+    for (int s=0;s<JPEG_TRACE_STAGES;s++)
+    {
+        t_stage_result res = CompareStage(s, ref[s], dut[s]);
+
+        printf("%-6s: %7d / %7d blocks, %d mismatching, %d missing, max error %d\n",
+               jpeg_trace::stage_name(s), (int)ref[s].size(), (int)dut[s].size(),
+               res.mismatches, res.missing, res.max_err);
+
+        if (res.diverged && (first_stage < 0 || res.first < first_block))
+        {
+            first_stage = s;
+            first_block = res.first;
+        }
+    }
+
+    if (first_stage < 0)
+    {
+        printf("MATCH\n");
+        return 0;
+    }
+
+    t_stage_recs::iterator r = ref[first_stage].find(first_block);
+    t_stage_recs::iterator d = dut[first_stage].find(first_block);
+
+    printf("DIVERGED: block %u, stage %s\n", first_block, jpeg_trace::stage_name(first_stage));
+    PrintBlock("ref", r != ref[first_stage].end() ? &r->second : NULL, d != dut[first_stage].end() ? &d->second : NULL);
+    PrintBlock("dut", d != dut[first_stage].end() ? &d->second : NULL, r != ref[first_stage].end() ? &r->second : NULL);
+    return 1;
+}
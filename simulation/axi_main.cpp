@@ -0,0 +1,411 @@
+// DESCRIPTION: Memory to memory decode harness for the AXI4 wrapper (jpeg_axi.v)
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#include <memory>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cinttypes>
+#include <verilated.h>
+
+#include "jpeg_file.h"
+#include "jpeg_stream.h"
+#include "jpeg_output.h"
+#include "frame.h"
+#include "axi_mem.h"
+
+// Include model header, generated from Verilating "jpeg_axi.v"
+#include "Vjpeg_axi.h"
+
+// Frame buffer bytes outside the image (stride padding), checked for stray writes
+#define FB_GUARD 0xA5
+
+struct axi_frame_stats {
+    uint64_t start;     // Descriptor accepted
+    uint64_t done;      // done_o
+    size_t   width;     // Output image size (done_width_o / done_height_o)
+    size_t   height;
+    bool     error;     // done_error_o
+    uint64_t stray;     // Frame buffer bytes written outside the image
+};
+
+// Plusarg value (copied, as the returned buffer is reused between calls)
+static bool plusarg(VerilatedContext *context, const char *name, std::string &value) {
+    const std::string match = std::string(name) + "=";
+    const char *arg = context->commandArgsPlusMatch(match.c_str());
+    if (!arg || !arg[0])
+        return false;
+    value = arg + 1 + match.size();
+    return true;
+}
+
+static bool parse_format(const std::string &name, t_jpeg_pix_format &fmt) {
+    if (name == "rgb")         fmt = JPEG_PIX_RGB24;
+    else if (name == "rgba")   fmt = JPEG_PIX_RGBA32;
+    else if (name == "bgra")   fmt = JPEG_PIX_BGRA32;
+    else if (name == "rgb565") fmt = JPEG_PIX_RGB565;
+    else
+        return false;
+    return true;
+}
+
+// Output image size of a frame (1/8 scale in DC only mode)
+static void out_size(const jpeg_file_info &info, size_t &w, size_t &h) {
+    w = JPEG_DC_ONLY ? (info.width + 7) / 8 : info.width;
+    h = JPEG_DC_ONLY ? (info.height + 7) / 8 : info.height;
+}
+
+// Frame buffer contents back to RGB (RGB565 expanded by bit replication)
+static void fb_read(const uint8_t *fb, size_t stride, t_jpeg_pix_format fmt, frame &out) {
+    const int bpp = jpeg_output::pixel_bytes(fmt);
+    for (size_t y = 0; y < out.height; y++) {
+        for (size_t x = 0; x < out.width; x++) {
+            const uint8_t *p = fb + y * stride + x * bpp;
+            const size_t pos = y * out.width + x;
+            switch (fmt) {
+            case JPEG_PIX_BGRA32:
+                out.r[pos] = p[2]; out.g[pos] = p[1]; out.b[pos] = p[0];
+                break;
+            case JPEG_PIX_RGB565: {
+                const uint16_t v = p[0] | (p[1] << 8);
+                const uint8_t r = v >> 11, g = (v >> 5) & 0x3F, b = v & 0x1F;
+                out.r[pos] = (r << 3) | (r >> 2);
+                out.g[pos] = (g << 2) | (g >> 4);
+                out.b[pos] = (b << 3) | (b >> 2);
+                break;
+            }
+            default:
+                out.r[pos] = p[0]; out.g[pos] = p[1]; out.b[pos] = p[2];
+                break;
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// run_axi: One descriptor per frame (JPEG in memory -> frame buffer), the next
+//          issued as soon as the wrapper accepts it. Frames alternate between
+//          two frame buffers, each read back (and checked for writes outside
+//          the image) on done_o.
+//-----------------------------------------------------------------------------
+static bool run_axi(VerilatedContext *context, const std::vector<frame_input> &frames,
+                    const std::vector<uint32_t> &src, uint32_t fb_base, size_t fb_size, const std::vector<size_t> &stride,
+                    t_jpeg_pix_format fmt, axi_mem &mem, uint64_t timeout,
+                    std::vector<axi_frame_stats> &st, std::vector<frame> &outs) {
+    const std::unique_ptr<Vjpeg_axi> top(new Vjpeg_axi(context, "JPEG_AXI"));
+    const size_t n = frames.size();
+    const int bpp = jpeg_output::pixel_bytes(fmt);
+
+    st.assign(n, axi_frame_stats());
+    outs.resize(n);
+
+    // Reset
+    top->clk_i = 0;
+    top->rst_i = 1;
+    top->desc_valid_i = 0;
+    for (int i = 0; i < 10; i++) {
+        top->clk_i = !top->clk_i;
+        context->timeInc(1);
+        top->eval();
+    }
+    top->rst_i = 0;
+    mem.reset();
+
+    uint64_t cycle = 0;
+    uint64_t last_progress = 0;
+    size_t issued = 0;
+    size_t done = 0;
+    bool ok = true;
+
+    while (done < n && !context->gotFinish()) {
+        // Next frame: clear its frame buffer to the guard pattern
+        const size_t buf = issued % 2;
+        if (issued < n && issued == done && !top->desc_valid_i) {
+            memset(mem.data(fb_base + buf * fb_size), FB_GUARD, fb_size);
+            top->desc_valid_i = 1;
+            top->desc_src_addr_i = src[issued];
+            top->desc_src_len_i = frames[issued].len;
+            top->desc_dst_addr_i = fb_base + buf * fb_size;
+            top->desc_dst_stride_i = stride[issued];
+            top->desc_format_i = fmt;
+            top->desc_dc_only_i = JPEG_DC_ONLY;
+        }
+
+        // Slave outputs settle on the falling edge
+        const axi_mem_out mo = mem.outputs();
+        top->axi_arready_i = mo.arready;
+        top->axi_rvalid_i = mo.rvalid;
+        top->axi_rdata_i = (jpeg_input_word)mo.rdata;
+        top->axi_rresp_i = mo.rresp;
+        top->axi_rid_i = 0;
+        top->axi_rlast_i = mo.rlast;
+        top->axi_awready_i = mo.awready;
+        top->axi_wready_i = mo.wready;
+        top->axi_bvalid_i = mo.bvalid;
+        top->axi_bresp_i = mo.bresp;
+        top->axi_bid_i = 0;
+        top->eval();
+
+        axi_mem_in mi;
+        mi.arvalid = top->axi_arvalid_o;
+        mi.araddr = top->axi_araddr_o;
+        mi.arlen = top->axi_arlen_o;
+        mi.rready = top->axi_rready_o;
+        mi.awvalid = top->axi_awvalid_o;
+        mi.awaddr = top->axi_awaddr_o;
+        mi.awlen = top->axi_awlen_o;
+        mi.wvalid = top->axi_wvalid_o;
+        mi.wdata = top->axi_wdata_o;
+        mi.wstrb = top->axi_wstrb_o;
+        mi.wlast = top->axi_wlast_o;
+        mi.bready = top->axi_bready_o;
+
+        // Handshakes completing on the rising edge
+        const bool desc_fire = top->desc_valid_i && top->desc_accept_o;
+        bool progress = desc_fire || (mo.rvalid && mi.rready) || (mo.wready && mi.wvalid);
+        if (desc_fire)
+            st[issued].start = cycle;
+
+        if (top->done_o) {
+            progress = true;
+            axi_frame_stats &s = st[done];
+            const uint8_t *fb = mem.data(fb_base + (done % 2) * fb_size);
+            s.done = cycle;
+            s.width = top->done_width_o;
+            s.height = top->done_height_o;
+            s.error = top->done_error_o;
+            s.stray = 0;
+
+            size_t w, h;
+            out_size(frames[done].info, w, h);
+            if (s.width != w || s.height != h) {
+                VL_PRINTF("ERROR: frame %zu: output %zux%zu, expected %zux%zu\n", done, s.width, s.height, w, h);
+                ok = false;
+            }
+            for (size_t i = 0; i < fb_size; i++) {
+                const size_t y = i / stride[done], x = i % stride[done];
+                if ((y >= h || x >= w * bpp) && fb[i] != FB_GUARD)
+                    s.stray++;
+            }
+            if (s.stray || s.error) {
+                VL_PRINTF("ERROR: frame %zu: %" PRIu64 " bytes written outside the image%s\n", done, s.stray,
+                          s.error ? ", AXI error response" : "");
+                ok = false;
+            }
+            outs[done].resize(w, h);
+            fb_read(fb, stride[done], fmt, outs[done]);
+            done++;
+        }
+
+        top->clk_i = 1;
+        context->timeInc(1);
+        top->eval();
+        mem.clock(mi, mo);
+        top->clk_i = 0;
+        context->timeInc(1);
+        top->eval();
+        cycle++;
+
+        if (desc_fire) {
+            top->desc_valid_i = 0;
+            issued++;
+        }
+
+        // Watchdog
+        if (progress)
+            last_progress = cycle;
+        else if (timeout && cycle - last_progress > timeout) {
+            VL_PRINTF("ERROR: No progress for %" PRIu64 " cycles (%zu of %zu frames issued, %zu completed)\n",
+                      timeout, issued, n, done);
+            ok = false;
+            break;
+        }
+    }
+
+    top->final();
+    return ok && done == n && mem.stats().errors == 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <stream.jpg | @list> [out.ppm] [options]" << std::endl;
+        std::cerr << "  Decodes every frame memory to memory through jpeg_axi (AXI4 read DMA + frame buffer writer)" << std::endl;
+        std::cerr << "  against a DDR like memory model, and reports the end to end frame rate and bus usage" << std::endl;
+        std::cerr << "  +format=<f>          Frame buffer format (as the C model -f): rgb, rgba (default), bgra, rgb565" << std::endl;
+        std::cerr << "  +stride_align=<n>    Frame buffer line stride rounded up to n bytes (default 64)" << std::endl;
+        std::cerr << "  +repeat=<n>          Feed the stream n times (default 1)" << std::endl;
+        std::cerr << "  +src_offset=<n>      Place each JPEG n bytes into a 4KB page, bus width aligned (default 0)" << std::endl;
+        std::cerr << "  +ref=<ppm>           Compare the first frame against a reference image (exit code 2 on mismatch)" << std::endl;
+        std::cerr << "  +max_err=<n>         Compare: largest channel difference allowed (default 0)" << std::endl;
+        std::cerr << "  +mem_latency=<n>     Read request to first data beat, open row (default 40)" << std::endl;
+        std::cerr << "  +mem_wr_latency=<n>  Last write beat to write response (default 20)" << std::endl;
+        std::cerr << "  +mem_row_miss=<n>    Extra latency on a DRAM row miss (default 12)" << std::endl;
+        std::cerr << "  +mem_turnaround=<n>  Data bus cycles lost on a read / write switch (default 4)" << std::endl;
+        std::cerr << "  +mem_outstanding=<n> Max reads / writes in flight (default 8)" << std::endl;
+        std::cerr << "  +mem_refresh=<n>     Refresh interval in cycles, 30 cycles each (default 0, off)" << std::endl;
+        std::cerr << "  +clock_mhz=<f>       Clock used for the frame rate and bandwidth (default 75)" << std::endl;
+        std::cerr << "  +timeout=<cycles>    Give up after this many cycles without progress (default 1000000)" << std::endl;
+        std::cerr << "  +csv=<file>          Append a result row to <file>" << std::endl;
+        exit(1);
+    }
+
+    std::vector<uint8_t> inbuf;
+    std::vector<frame_input> stream;
+    if (!load_stream(argv[1], inbuf, stream))
+        exit(1);
+
+    const std::unique_ptr<VerilatedContext> context(new VerilatedContext);
+    context->debug(0);
+    context->randReset(2);
+    context->commandArgs(argc, argv);
+
+    std::string csv_file, ref_file, arg;
+    const bool csv = plusarg(context.get(), "csv", csv_file);
+    const double clock_mhz = plusarg(context.get(), "clock_mhz", arg) ? atof(arg.c_str()) : 75.0;
+    const uint64_t timeout = plusarg(context.get(), "timeout", arg) ? strtoull(arg.c_str(), NULL, 0) : 1000000;
+    const int repeat = plusarg(context.get(), "repeat", arg) && atoi(arg.c_str()) > 0 ? atoi(arg.c_str()) : 1;
+    const size_t align = plusarg(context.get(), "stride_align", arg) && atoi(arg.c_str()) > 0 ? atoi(arg.c_str()) : 64;
+    const int max_err = plusarg(context.get(), "max_err", arg) ? atoi(arg.c_str()) : 0;
+    const size_t src_offset = plusarg(context.get(), "src_offset", arg) ?
+                              (strtoul(arg.c_str(), NULL, 0) & 0xFFF & ~(size_t)(JPEG_INPUT_BYTES - 1)) : 0;
+
+    std::string fmt_name = "rgba";
+    t_jpeg_pix_format fmt;
+    plusarg(context.get(), "format", fmt_name);
+    if (!parse_format(fmt_name, fmt)) {
+        std::cerr << "Unknown format " << fmt_name << " (rgb, rgba, bgra or rgb565)" << std::endl;
+        exit(1);
+    }
+
+    axi_mem_config mem_cfg;
+    if (plusarg(context.get(), "mem_latency", arg))
+        mem_cfg.read_latency = atoi(arg.c_str());
+    if (plusarg(context.get(), "mem_wr_latency", arg))
+        mem_cfg.write_latency = atoi(arg.c_str());
+    if (plusarg(context.get(), "mem_row_miss", arg))
+        mem_cfg.row_miss = atoi(arg.c_str());
+    if (plusarg(context.get(), "mem_turnaround", arg))
+        mem_cfg.turnaround = atoi(arg.c_str());
+    if (plusarg(context.get(), "mem_outstanding", arg) && atoi(arg.c_str()) > 0)
+        mem_cfg.outstanding = atoi(arg.c_str());
+    if (plusarg(context.get(), "mem_refresh", arg))
+        mem_cfg.refresh_interval = atoi(arg.c_str());
+
+    std::vector<frame_input> frames;
+    for (int r = 0; r < repeat; r++)
+        frames.insert(frames.end(), stream.begin(), stream.end());
+
+    // Memory map: each JPEG of the stream (src_offset into a 4KB page), then two frame buffers
+    const size_t bpp = jpeg_output::pixel_bytes(fmt);
+    std::vector<uint32_t> src_addr(stream.size());
+    size_t addr = 0;
+    for (size_t i = 0; i < stream.size(); i++) {
+        src_addr[i] = addr + src_offset;
+        addr += (src_offset + stream[i].len + 0xFFF) & ~(size_t)0xFFF;
+    }
+    std::vector<uint32_t> src;
+    std::vector<size_t> stride;
+    size_t fb_size = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        size_t w, h;
+        out_size(frames[i].info, w, h);
+        src.push_back(src_addr[i % stream.size()]);
+        stride.push_back((w * bpp + align - 1) / align * align);
+        if (stride.back() * h > fb_size)
+            fb_size = stride.back() * h;
+    }
+    fb_size = (fb_size + 0xFFF) & ~(size_t)0xFFF;
+    const uint32_t fb_base = addr;
+
+    axi_mem mem(addr + 2 * fb_size, JPEG_INPUT_BYTES, mem_cfg);
+    for (size_t i = 0; i < stream.size(); i++)
+        mem.load(src_addr[i], stream[i].data, stream[i].len);
+
+    VL_PRINTF("Decoding %zu frames of %s to memory...\n", frames.size(), argv[1]);
+    std::vector<axi_frame_stats> st;
+    std::vector<frame> outs;
+    const bool ok = run_axi(context.get(), frames, src, fb_base, fb_size, stride, fmt, mem, timeout, st, outs);
+
+    if (ok) {
+        const size_t n = frames.size();
+        const axi_mem_stats &ms = mem.stats();
+        const uint64_t span = st[n - 1].done - st[0].start + 1;
+        uint64_t pixels = 0;
+        for (size_t i = 0; i < n; i++)
+            pixels += st[i].width * st[i].height;
+        const double secs = span / (clock_mhz * 1e6);
+        const double rd_mb = ms.read_beats * JPEG_INPUT_BYTES / secs / 1e6;
+        const double wr_mb = ms.write_beats * JPEG_INPUT_BYTES / secs / 1e6;
+
+        VL_PRINTF("  frames:              %zu\n", n);
+        VL_PRINTF("  cycles:              %" PRIu64 "\n", span);
+        VL_PRINTF("  cycles per frame:    %.1f\n", (double)span / n);
+        VL_PRINTF("  pixels per cycle:    %.3f\n", (double)pixels / span);
+        VL_PRINTF("  fps:                 %.2f @ %.1f MHz\n", n / secs, clock_mhz);
+        VL_PRINTF("  read:                %" PRIu64 " bursts, %.1f beats avg, %.1f cycles latency avg, %.1f MB/s\n",
+                  ms.read_bursts, ms.read_bursts ? (double)ms.read_beats / ms.read_bursts : 0.0,
+                  ms.read_bursts ? (double)ms.read_latency_sum / ms.read_bursts : 0.0, rd_mb);
+        VL_PRINTF("  write:               %" PRIu64 " bursts, %.1f beats avg, %.1f%% strobes set, %.1f MB/s\n",
+                  ms.write_bursts, ms.write_bursts ? (double)ms.write_beats / ms.write_bursts : 0.0,
+                  ms.write_beats ? 100.0 * ms.write_bytes / (ms.write_beats * JPEG_INPUT_BYTES) : 0.0, wr_mb);
+        VL_PRINTF("  bus utilisation:     %.1f%% (%" PRIu64 " row misses)\n", 100.0 * ms.busy_cycles / span,
+                  ms.row_misses);
+
+        if (csv) {
+            FILE *f = fopen(csv_file.c_str(), "a+");
+            if (f == NULL) {
+                std::cerr << "Can not open csv file " << csv_file << std::endl;
+                exit(1);
+            }
+            fseek(f, 0, SEEK_END);
+            if (ftell(f) == 0)
+                fprintf(f, "stream,format,mem_latency,frames,cycles,pixels_per_cycle,fps,read_mbs,write_mbs,"
+                           "write_beats_per_burst,bus_utilisation\n");
+            fprintf(f, "%s,%s,%u,%zu,%" PRIu64 ",%.3f,%.2f,%.1f,%.1f,%.1f,%.3f\n", argv[1],
+                    fmt_name.c_str(), mem_cfg.read_latency, n, span, (double)pixels / span, n / secs,
+                    rd_mb, wr_mb, ms.write_bursts ? (double)ms.write_beats / ms.write_bursts : 0.0,
+                    (double)ms.busy_cycles / span);
+            fclose(f);
+        }
+    }
+
+    // Decoded frames (out.ppm -> out_0000.ppm, ... for more than one frame)
+    if (argc > 2 && argv[2][0] != '+') {
+        for (size_t i = 0; i < outs.size(); i++) {
+            std::string name(argv[2]);
+            if (outs.size() > 1) {
+                char suffix[16];
+                snprintf(suffix, sizeof(suffix), "_%04zu", i);
+                const size_t dot = name.rfind('.');
+                name = dot == std::string::npos ? name + suffix : name.substr(0, dot) + suffix + name.substr(dot);
+            }
+            if (outs[i].width * outs[i].height != 0 && !frame_save_ppm(name.c_str(), outs[i])) {
+                std::cerr << "Can not open ppm file " << name << std::endl;
+                exit(1);
+            }
+        }
+    }
+
+    int status = ok ? 0 : 1;
+    if (ok && plusarg(context.get(), "ref", ref_file)) {
+        frame ref;
+        if (!frame_load_ppm(ref_file.c_str(), ref)) {
+            std::cerr << "Can not read reference ppm file " << ref_file << std::endl;
+            exit(1);
+        }
+        const frame_diff d = frame_compare(outs[0], ref);
+        const bool pass = d.size_match && d.max_err <= max_err;
+        VL_PRINTF("Compare: %s (max_err=%d mismatches=%" PRIu64 " psnr=%.2f)\n", pass ? "PASS" : "FAIL",
+                  d.max_err, d.mismatches, d.psnr);
+        if (!pass)
+            status = 2;
+    }
+    return status;
+}
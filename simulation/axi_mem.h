@@ -0,0 +1,301 @@
+// DESCRIPTION: AXI4 slave memory model with DDR like timing
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#ifndef AXI_MEM_H
+#define AXI_MEM_H
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+// Timing parameters (cycles of the AXI clock)
+struct axi_mem_config {
+    uint32_t read_latency;      // Request accepted to first read data beat (open row)
+    uint32_t write_latency;     // Last write data beat to the write response
+    uint32_t row_miss;          // Extra latency when the bank has another row open
+    uint32_t row_bytes;         // DRAM row (page) size per bank
+    uint32_t banks;
+    uint32_t turnaround;        // Data bus idle cycles on a read <-> write switch
+    uint32_t outstanding;       // Max requests in flight (reads and writes each)
+    uint32_t refresh_interval;  // 0 = no refresh
+    uint32_t refresh_cycles;    // Data bus blocked per refresh
+
+    axi_mem_config()
+        : read_latency(40), write_latency(20), row_miss(12), row_bytes(2048), banks(8), turnaround(4),
+          outstanding(8), refresh_interval(0), refresh_cycles(30) {}
+};
+
+// Slave inputs (master outputs), sampled after the master has been evaluated
+struct axi_mem_in {
+    bool     arvalid;
+    uint32_t araddr;
+    uint32_t arlen;
+    bool     rready;
+    bool     awvalid;
+    uint32_t awaddr;
+    uint32_t awlen;
+    bool     wvalid;
+    uint64_t wdata;
+    uint32_t wstrb;
+    bool     wlast;
+    bool     bready;
+};
+
+// Slave outputs, a function of the model state only (no combinational paths)
+struct axi_mem_out {
+    bool     arready;
+    bool     rvalid;
+    uint64_t rdata;
+    uint32_t rresp;
+    bool     rlast;
+    bool     awready;
+    bool     wready;
+    bool     bvalid;
+    uint32_t bresp;
+};
+
+struct axi_mem_stats {
+    uint64_t read_bursts;
+    uint64_t read_beats;
+    uint64_t write_bursts;
+    uint64_t write_beats;
+    uint64_t write_bytes;       // Bytes with the strobe set
+    uint64_t busy_cycles;       // Cycles with a data beat transferred
+    uint64_t row_misses;
+    uint64_t errors;            // Out of range / protocol errors
+    uint64_t read_latency_sum;  // Request to first beat, summed over read bursts
+};
+
+//-----------------------------------------------------------------------------
+// axi_mem: Flat memory behind an in order DDR controller. Read and write
+// requests queue in arrival order and share one data bus (one beat per
+// cycle); each request waits for its latency (plus a row miss penalty when
+// its bank has another row open) and the bus turnaround on a direction
+// change. Write data is taken once the write is at the head of the queue and
+// acknowledged write_latency cycles after its last beat. Full width beats
+// (AxSIZE = bus width), INCR bursts only.
+//-----------------------------------------------------------------------------
+class axi_mem {
+public:
+    axi_mem(size_t size, uint32_t data_bytes, const axi_mem_config &cfg = axi_mem_config())
+        : m_mem(size, 0), m_bytes(data_bytes), m_cfg(cfg) {
+        if (m_cfg.banks == 0)
+            m_cfg.banks = 1;
+        if (m_cfg.row_bytes == 0)
+            m_cfg.row_bytes = 2048;
+        m_open_row.assign(m_cfg.banks, UINT64_MAX);
+        reset();
+    }
+
+    void reset(void) {
+        m_cycle = 0;
+        m_reads = m_writes = 0;
+        m_last_write = false;
+        m_bus_free = 0;
+        m_queue.clear();
+        m_bresp.clear();
+        m_open_row.assign(m_cfg.banks, UINT64_MAX);
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    // Backdoor access
+    size_t size(void) const { return m_mem.size(); }
+    uint8_t *data(uint32_t addr) { return &m_mem[addr]; }
+    void load(uint32_t addr, const uint8_t *buf, size_t len) { memcpy(&m_mem[addr], buf, len); }
+
+    const axi_mem_stats &stats(void) const { return m_stats; }
+    uint64_t cycle(void) const { return m_cycle; }
+
+    // Outputs for this cycle (before the master is evaluated)
+    axi_mem_out outputs(void) const {
+        axi_mem_out o;
+        memset(&o, 0, sizeof(o));
+        o.arready = m_reads < m_cfg.outstanding;
+        o.awready = m_writes < m_cfg.outstanding;
+
+        const t_req *head = m_queue.empty() ? NULL : &m_queue.front();
+        if (head && bus_ready(*head)) {
+            if (head->write)
+                o.wready = true;
+            else {
+                const uint32_t addr = head->addr + head->beat * m_bytes;
+                o.rvalid = true;
+                o.rlast = head->beat == head->len;
+                o.rresp = in_range(addr) ? 0 : 2; // SLVERR
+                o.rdata = in_range(addr) ? read_word(addr) : 0;
+            }
+        }
+        if (!m_bresp.empty() && m_bresp.front().ready <= m_cycle) {
+            o.bvalid = true;
+            o.bresp = m_bresp.front().resp;
+        }
+        return o;
+    }
+
+    // Rising edge: complete the handshakes of this cycle
+    void clock(const axi_mem_in &in, const axi_mem_out &out) {
+        // Data beat
+        if (!m_queue.empty()) {
+            t_req &head = m_queue.front();
+            const uint32_t addr = head.addr + head.beat * m_bytes;
+            bool beat = false;
+
+            if (head.write && out.wready && in.wvalid) {
+                beat = true;
+                if (in_range(addr))
+                    write_word(addr, in.wdata, in.wstrb);
+                else
+                    head.error = true;
+                for (uint32_t i = 0; i < m_bytes; i++)
+                    m_stats.write_bytes += (in.wstrb >> i) & 1;
+                m_stats.write_beats++;
+                if (in.wlast != (head.beat == head.len)) {
+                    error("WLAST on beat %u of a %u beat burst at 0x%08x", head.beat, head.len + 1, head.addr);
+                    head.error = true;
+                }
+            } else if (!head.write && out.rvalid && in.rready) {
+                beat = true;
+                if (head.beat == 0)
+                    m_stats.read_latency_sum += m_cycle - head.issued;
+                m_stats.read_beats++;
+            }
+
+            if (beat) {
+                m_stats.busy_cycles++;
+                m_last_write = head.write;
+                m_bus_free = m_cycle + 1;
+                if (head.beat++ == head.len) {
+                    if (head.write)
+                        m_bresp.push_back(t_bresp(m_cycle + m_cfg.write_latency, head.error ? 2 : 0));
+                    else
+                        m_reads--;
+                    m_queue.pop_front();
+                }
+            }
+        } else if (in.wvalid)
+            error("write data with no write request");
+
+        // Write response
+        if (out.bvalid && in.bready) {
+            m_bresp.pop_front();
+            m_writes--;
+        }
+
+        // Requests (a write is queued ahead of a read in the same cycle)
+        if (in.awvalid && out.awready) {
+            request(true, in.awaddr, in.awlen);
+            m_writes++;
+            m_stats.write_bursts++;
+        }
+        if (in.arvalid && out.arready) {
+            request(false, in.araddr, in.arlen);
+            m_reads++;
+            m_stats.read_bursts++;
+        }
+
+        m_cycle++;
+    }
+
+private:
+    struct t_req {
+        bool     write;
+        uint32_t addr;
+        uint32_t len;       // Beats - 1
+        uint32_t beat;      // Next beat
+        uint64_t issued;
+        uint64_t ready;     // First beat no earlier than
+        bool     error;
+    };
+
+    struct t_bresp {
+        uint64_t ready;
+        uint32_t resp;
+        t_bresp(uint64_t r, uint32_t s) : ready(r), resp(s) {}
+    };
+
+    bool in_range(uint32_t addr) const { return (size_t)addr + m_bytes <= m_mem.size(); }
+
+    uint64_t read_word(uint32_t addr) const {
+        uint64_t v = 0;
+        for (uint32_t i = 0; i < m_bytes; i++)
+            v |= (uint64_t)m_mem[addr + i] << (8 * i);
+        return v;
+    }
+
+    void write_word(uint32_t addr, uint64_t v, uint32_t strb) {
+        for (uint32_t i = 0; i < m_bytes; i++)
+            if ((strb >> i) & 1)
+                m_mem[addr + i] = (uint8_t)(v >> (8 * i));
+    }
+
+    // Data bus available to the head request this cycle
+    bool bus_ready(const t_req &r) const {
+        if (m_cycle < r.ready)
+            return false;
+        if (r.beat == 0 && r.write != m_last_write && m_cycle < m_bus_free + m_cfg.turnaround)
+            return false;
+        if (m_cfg.refresh_interval && (m_cycle % m_cfg.refresh_interval) < m_cfg.refresh_cycles)
+            return false;
+        return true;
+    }
+
+    void request(bool write, uint32_t addr, uint32_t len) {
+        t_req r;
+        r.write  = write;
+        r.addr   = addr;
+        r.len    = len;
+        r.beat   = 0;
+        r.issued = m_cycle;
+        r.ready  = m_cycle + (write ? 1 : m_cfg.read_latency);
+        r.error  = false;
+
+        if (addr % m_bytes)
+            error("unaligned %s burst at 0x%08x", write ? "write" : "read", addr);
+        if ((addr & 0xFFF) + (len + 1) * m_bytes > 0x1000)
+            error("%s burst at 0x%08x (%u beats) crosses a 4KB boundary", write ? "write" : "read", addr, len + 1);
+
+        // Row hit / miss in the bank of the first beat
+        const uint64_t row  = addr / m_cfg.row_bytes;
+        const uint32_t bank = (uint32_t)(row % m_cfg.banks);
+        if (m_open_row[bank] != row) {
+            if (m_open_row[bank] != UINT64_MAX)
+                r.ready += m_cfg.row_miss;
+            m_open_row[bank] = row;
+            m_stats.row_misses++;
+        }
+        m_queue.push_back(r);
+    }
+
+    void error(const char *fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        fprintf(stderr, "axi_mem: cycle %llu: ", (unsigned long long)m_cycle);
+        vfprintf(stderr, fmt, args);
+        fprintf(stderr, "\n");
+        va_end(args);
+        m_stats.errors++;
+    }
+
+private:
+    std::vector<uint8_t>  m_mem;
+    uint32_t              m_bytes;
+    axi_mem_config        m_cfg;
+    uint64_t              m_cycle;
+    uint32_t              m_reads;
+    uint32_t              m_writes;
+    bool                  m_last_write;
+    uint64_t              m_bus_free;
+    std::deque<t_req>     m_queue;
+    std::deque<t_bresp>   m_bresp;
+    std::vector<uint64_t> m_open_row;
+    axi_mem_stats         m_stats;
+};
+
+#endif
@@ -0,0 +1,137 @@
+// DESCRIPTION: Per-block trace of the RTL pipeline stages (see c_model/jpeg_trace.h)
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#ifndef BLOCK_TRACE_H
+#define BLOCK_TRACE_H
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+
+#include "jpeg_trace.h"
+
+// Assembles whole 8x8 blocks from the sample streams at the jpeg_dqt,
+// jpeg_idct and jpeg_output ports (sampled once per clock) and writes them
+// in the same format / block numbering as the C model 'jpeg -t' trace.
+class block_trace {
+public:
+    block_trace() { reset(); }
+
+    bool open(const char *filename) {
+        reset();
+        return m_trace.open(filename, true);
+    }
+
+    void close() { m_trace.close(); }
+
+    void reset() {
+        m_dqt_active = false;
+        m_dqt_block = 0;
+        m_idct_count = 0;
+        m_idct_block = 0;
+        m_pixel_count = 0;
+        m_luma.clear();
+    }
+
+    // jpeg_dqt -> jpeg_idct: sparse coefficients (natural order) then EOB
+    void dqt(bool valid, bool eob, int16_t data, int idx, uint32_t id) {
+        if (valid) {
+            if (!m_dqt_active) {
+                memset(m_dqt, 0, sizeof(m_dqt));
+                m_dqt_id = id;
+                m_dqt_active = true;
+            }
+            m_dqt[idx & 63] = data;
+        }
+        if (eob) {
+            if (!m_dqt_active) {
+                memset(m_dqt, 0, sizeof(m_dqt));
+                m_dqt_id = id;
+            }
+            if (block_type(m_dqt_id) != BLOCK_EOF)
+                m_trace.write_coeffs(JPEG_TRACE_DQT, block_type(m_dqt_id), m_dqt_block++,
+                                     block_x(m_dqt_id), block_y(m_dqt_id), m_dqt);
+            m_dqt_active = false;
+        }
+    }
+
+    // jpeg_idct -> jpeg_output: 64 samples per block (any order)
+    void idct(bool fire, int32_t data, int idx, uint32_t id) {
+        if (!fire)
+            return;
+        if (m_idct_count == 0)
+            m_idct_id = id;
+        m_idct[idx & 63] = data;
+        if (++m_idct_count < 64)
+            return;
+
+        m_idct_count = 0;
+        if (block_type(m_idct_id) == BLOCK_EOF)
+            return;
+        // Pixels are output per luma block
+        if (block_type(m_idct_id) == BLOCK_Y)
+            m_luma.push_back(m_idct_block);
+        m_trace.write_coeffs(JPEG_TRACE_IDCT, block_type(m_idct_id), m_idct_block++,
+                             block_x(m_idct_id), block_y(m_idct_id), m_idct);
+    }
+
+    // Core output port: 64 pixels per luma block
+    void pixel(bool fire, int x, int y, uint8_t r, uint8_t g, uint8_t b) {
+        if (!fire)
+            return;
+        if (m_pixel_count == 0) {
+            m_pixel_x = x & ~7;
+            m_pixel_y = y & ~7;
+        }
+        uint8_t *p = &m_rgb[(((y & 7) * 8) + (x & 7)) * 3];
+        p[0] = r;
+        p[1] = g;
+        p[2] = b;
+        if (++m_pixel_count < 64)
+            return;
+
+        m_pixel_count = 0;
+        const uint32_t block = m_luma.empty() ? 0xFFFFFFFF : m_luma.front();
+        if (!m_luma.empty())
+            m_luma.pop_front();
+        m_trace.write_pixels(0, block, m_pixel_x, m_pixel_y, m_rgb);
+    }
+
+    // True while a pixel block is partially output (the last pixel inside
+    // the image can precede the padding pixels of its block)
+    bool pixels_pending() const { return m_pixel_count != 0; }
+
+private:
+    enum { BLOCK_Y = 0, BLOCK_CB = 1, BLOCK_CR = 2, BLOCK_EOF = 3 };
+
+    // Block id: {type[1:0], block_y[13:0], block_x[15:0]} (see jpeg_mcu_id.v). Bit 29 is
+    // the frame parity with SUPPORT_FRAME_OVERLAP, block_y < 8192 for 16-bit heights.
+    static int block_type(uint32_t id) { return id >> 30; }
+    static int block_x(uint32_t id)    { return (id & 0xFFFF) * 8; }
+    static int block_y(uint32_t id)    { return ((id >> 16) & 0x1FFF) * 8; }
+
+    jpeg_trace m_trace;
+
+    bool     m_dqt_active;
+    uint32_t m_dqt_id;
+    uint32_t m_dqt_block;
+    int      m_dqt[64];
+
+    int      m_idct_count;
+    uint32_t m_idct_id;
+    uint32_t m_idct_block;
+    int      m_idct[64];
+
+    int      m_pixel_count;
+    int      m_pixel_x;
+    int      m_pixel_y;
+    uint8_t  m_rgb[64 * 3];
+
+    std::deque<uint32_t> m_luma;    // IDCT block index of each pending luma block
+};
+
+#endif
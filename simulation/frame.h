@@ -0,0 +1,105 @@
+// DESCRIPTION: RGB frame capture, PPM load / save and comparison
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+// Decoded frame (separate R, G, B planes)
+struct frame {
+    size_t width;
+    size_t height;
+    std::vector<uint8_t> r, g, b;
+
+    void resize(size_t w, size_t h) {
+        width = w;
+        height = h;
+        r.assign(w * h, 0);
+        g.assign(w * h, 0);
+        b.assign(w * h, 0);
+    }
+};
+
+// Result of comparing two frames
+struct frame_diff {
+    bool     size_match;
+    int      max_err;       // Largest absolute difference of any channel
+    uint64_t mismatches;    // Pixels with any channel different
+    double   psnr;          // dB (INFINITY if identical)
+};
+
+static inline bool frame_save_ppm(const char *filename, const frame &f) {
+    FILE *out = fopen(filename, "wb");
+    if (out == NULL)
+        return false;
+    fprintf(out, "P6\n%d %d\n255\n", (int)f.width, (int)f.height);
+    for (size_t pos = 0; pos < f.width * f.height; ++pos) {
+        putc(f.r[pos], out);
+        putc(f.g[pos], out);
+        putc(f.b[pos], out);
+    }
+    fclose(out);
+    return true;
+}
+
+// Binary (P6) 8-bit PPM only
+static inline bool frame_load_ppm(const char *filename, frame &f) {
+    FILE *in = fopen(filename, "rb");
+    if (in == NULL)
+        return false;
+
+    int w = 0, h = 0, maxval = 0;
+    if (fscanf(in, "P6 %d %d %d", &w, &h, &maxval) != 3 || maxval != 255 || w <= 0 || h <= 0) {
+        fclose(in);
+        return false;
+    }
+    fgetc(in); // Single whitespace before the raster
+
+    f.resize(w, h);
+    for (size_t pos = 0; pos < f.width * f.height; ++pos) {
+        f.r[pos] = fgetc(in);
+        f.g[pos] = fgetc(in);
+        f.b[pos] = fgetc(in);
+    }
+    const bool ok = !feof(in);
+    fclose(in);
+    return ok;
+}
+
+static inline frame_diff frame_compare(const frame &a, const frame &b) {
+    frame_diff d;
+    d.size_match = (a.width == b.width) && (a.height == b.height);
+    d.max_err = 0;
+    d.mismatches = 0;
+    d.psnr = 0;
+    if (!d.size_match)
+        return d;
+
+    double sq = 0;
+    for (size_t pos = 0; pos < a.width * a.height; ++pos) {
+        const int e[3] = { abs(a.r[pos] - b.r[pos]), abs(a.g[pos] - b.g[pos]), abs(a.b[pos] - b.b[pos]) };
+        bool diff = false;
+        for (int c = 0; c < 3; c++) {
+            if (e[c] > d.max_err)
+                d.max_err = e[c];
+            sq += (double)e[c] * e[c];
+            diff |= e[c] != 0;
+        }
+        d.mismatches += diff;
+    }
+
+    const double mse = sq / (3.0 * a.width * a.height);
+    d.psnr = (mse == 0) ? INFINITY : 10.0 * log10(255.0 * 255.0 / mse);
+    return d;
+}
+
+#endif
@@ -0,0 +1,521 @@
+// DESCRIPTION: Unit level testbench for jpeg_idct (random / edge case blocks vs the C model IDCT)
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#include <memory>
+#include <iostream>
+#include <deque>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <verilated.h>
+
+#include "jpeg_idct.h"
+#include "jpeg_idct_ifast.h"
+#include "wave_trace.h"
+
+// Include model header, generated from Verilating "jpeg_idct.v"
+#include "Vjpeg_idct.h"
+
+vluint64_t main_time = 0;	// Current simulation time (64-bit unsigned)
+
+double sc_time_stamp () {	// Called by $time in Verilog
+    return main_time;		// Note does conversion to real, to match SystemC
+}
+
+// C model IDCT matching each RTL variant (jpeg_idct_x/y.v, jpeg_idct_ifast_x/y.v)
+enum idct_ref { REF_AUTO, REF_CHEN, REF_IFAST, REF_COUNT };
+
+// Variant Verilated into this binary (idct_tb_<variant> targets), REF_AUTO if unknown
+#ifndef IDCT_VARIANT
+# define IDCT_VARIANT REF_AUTO
+#endif
+
+static const char *ref_name(int ref) {
+    static const char *names[] = { "auto", "chen", "ifast" };
+    return names[ref];
+}
+
+static void ref_idct(int ref, const int *in, int *out) {
+    static jpeg_idct       chen;
+    static jpeg_idct_ifast ifast;
+    int tmp[64];
+
+    // The row pass works in place on the input
+    memcpy(tmp, in, sizeof(tmp));
+    if (ref == REF_IFAST)
+        ifast.process(tmp, out);
+    else
+        chen.process(tmp, out);
+}
+
+// One coefficient block as presented by jpeg_dqt: non-zero (or explicitly
+// written) coefficients in zigzag order with their natural index, then EOB
+struct idct_block {
+    uint32_t id;
+    int      kind;
+    int      coeff[64];     // Natural order
+    std::vector<uint8_t> writes;
+    uint64_t first_in;      // Cycle the first coefficient / EOB was presented
+    uint64_t eob;           // Cycle the EOB was accepted
+};
+
+static const uint8_t zigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+// Block generators: random and edge cases
+enum { GEN_ZERO, GEN_DC, GEN_SINGLE, GEN_SPARSE, GEN_DENSE, GEN_EXTREME, GEN_ZERO_WRITES, GEN_COUNT };
+
+static const char *gen_name(int kind) {
+    static const char *names[] = { "zero", "dc", "single", "sparse", "dense", "extreme", "zero_writes" };
+    return names[kind];
+}
+
+class block_gen {
+public:
+    block_gen(uint32_t seed, int max_coeff) : m_rng(seed), m_max(max_coeff) {}
+
+    void next(idct_block &blk, uint32_t id) {
+        blk.id = id;
+        blk.kind = pick();
+        memset(blk.coeff, 0, sizeof(blk.coeff));
+        blk.writes.clear();
+
+        bool zero_writes = false;
+        switch (blk.kind) {
+        case GEN_ZERO:
+            break;
+        case GEN_DC:
+            blk.coeff[0] = edge_or_random();
+            break;
+        case GEN_SINGLE:
+            blk.coeff[zigzag[uniform(0, 63)]] = edge_or_random();
+            if (uniform(0, 1))
+                blk.coeff[0] = value(m_max);
+            break;
+        case GEN_SPARSE: {
+            // Typical image content: a few low frequency terms, magnitude falling with frequency
+            const int n = uniform(1, 12);
+            for (int i = 0; i < n; i++) {
+                const int zz = std::min(63, (int)(std::exponential_distribution<double>(0.15)(m_rng)));
+                blk.coeff[zigzag[zz]] = value(std::max(1, m_max >> (zz / 8)));
+            }
+            break;
+        }
+        case GEN_DENSE:
+            for (int i = 0; i < 64; i++)
+                blk.coeff[i] = value(m_max);
+            break;
+        case GEN_EXTREME: {
+            // Full scale patterns: all +max / -max, alternating signs, checkerboard
+            const int pattern = uniform(0, 3);
+            for (int i = 0; i < 64; i++) {
+                const int sign = pattern == 0 ? 1 : pattern == 1 ? -1 :
+                                 pattern == 2 ? ((i & 1) ? -1 : 1) : ((((i >> 3) ^ i) & 1) ? -1 : 1);
+                blk.coeff[i] = sign > 0 ? m_max : -m_max;
+            }
+            break;
+        }
+        case GEN_ZERO_WRITES:
+            // Zero valued coefficients written explicitly (must read back as zero)
+            for (int i = 0; i < 64; i++)
+                blk.coeff[i] = uniform(0, 3) ? 0 : value(m_max);
+            zero_writes = true;
+            break;
+        }
+
+        for (int zz = 0; zz < 64; zz++)
+            if (blk.coeff[zigzag[zz]] || (zero_writes && uniform(0, 1)))
+                blk.writes.push_back(zigzag[zz]);
+    }
+
+private:
+    int uniform(int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(m_rng); }
+    int value(int max) {
+        int v;
+        do { v = uniform(-max, max); } while (!v);
+        return v;
+    }
+    int edge_or_random() {
+        static const int edges[] = { 1, -1, 2, -2 };
+        const int r = uniform(0, 7);
+        if (r < 4)
+            return edges[r];
+        if (r == 4)
+            return m_max;
+        if (r == 5)
+            return -m_max;
+        return value(m_max);
+    }
+    // Mostly realistic blocks, with a steady share of edge cases
+    int pick() {
+        static const int weights[GEN_COUNT] = { 4, 8, 8, 60, 8, 4, 8 };
+        int r = uniform(0, 99);
+        for (int k = 0; k < GEN_COUNT; k++) {
+            if (r < weights[k])
+                return k;
+            r -= weights[k];
+        }
+        return GEN_SPARSE;
+    }
+
+    std::mt19937 m_rng;
+    int          m_max;
+};
+
+struct tb_config {
+    uint64_t blocks;
+    uint32_t seed;
+    int      max_coeff;
+    int      ref;
+    int      max_err;
+    int      max_report;    // Mismatching blocks printed in full
+    uint64_t timeout;
+    wave_trace *wave;
+};
+
+struct tb_stats {
+    uint64_t cycles;
+    uint64_t blocks;
+    uint64_t first_in;
+    uint64_t first_out;
+    uint64_t last_out;
+    uint64_t latency_first; // EOB accepted -> last sample, first block (empty pipeline)
+    uint64_t latency_min;   // EOB accepted -> last sample of the block (including buffering)
+    uint64_t latency_max;
+    uint64_t latency_sum;
+    uint64_t first_latency; // First coefficient -> first sample of the block (sum)
+    uint64_t in_stall;      // Block waiting for a free input buffer slot
+    uint64_t out_gap;       // Cycles between blocks without output (after the first)
+    uint64_t mismatches;
+    int      max_err;
+    uint64_t kind_blocks[GEN_COUNT];
+    uint64_t kind_fails[GEN_COUNT];
+};
+
+static void print_block(const char *name, const int *v) {
+    VL_PRINTF("  %s:\n", name);
+    for (int y = 0; y < 8; y++) {
+        VL_PRINTF("   ");
+        for (int x = 0; x < 8; x++)
+            VL_PRINTF(" %6d", v[y * 8 + x]);
+        VL_PRINTF("\n");
+    }
+}
+
+// Check a completed output block against the reference model
+static void check_block(const tb_config &cfg, tb_stats &st, const idct_block &blk, const int *out) {
+    int expected[64];
+    ref_idct(cfg.ref, blk.coeff, expected);
+
+    int err = 0;
+    for (int i = 0; i < 64; i++)
+        err = std::max(err, abs(out[i] - expected[i]));
+    st.max_err = std::max(st.max_err, err);
+    st.kind_blocks[blk.kind]++;
+    if (err <= cfg.max_err)
+        return;
+
+    st.kind_fails[blk.kind]++;
+    if (st.mismatches++ < (uint64_t)cfg.max_report) {
+        VL_PRINTF("MISMATCH: block %u (%s), max error %d\n", blk.id, gen_name(blk.kind), err);
+        print_block("input", blk.coeff);
+        print_block("expected", expected);
+        print_block("actual", out);
+    }
+}
+
+// Pick the C model matching the RTL variant from the first non-trivial block
+static int detect_ref(const idct_block &blk, const int *out) {
+    int best = REF_CHEN;
+    int best_err = -1;
+    for (int ref = REF_CHEN; ref < REF_COUNT; ref++) {
+        int expected[64];
+        int err = 0;
+        ref_idct(ref, blk.coeff, expected);
+        for (int i = 0; i < 64; i++)
+            err = std::max(err, abs(out[i] - expected[i]));
+        if (best_err < 0 || err < best_err) {
+            best = ref;
+            best_err = err;
+        }
+    }
+    return best;
+}
+
+//-----------------------------------------------------------------------------
+// run_idct: Stream cfg.blocks blocks back to back (no input bubbles, output
+//           always accepted) and check every output block
+//-----------------------------------------------------------------------------
+static bool run_idct(VerilatedContext *context, tb_config &cfg, tb_stats &st) {
+    const std::unique_ptr<Vjpeg_idct> idct(new Vjpeg_idct(context, "IDCT"));
+
+    memset(&st, 0, sizeof(st));
+    st.latency_min = ~0ULL;
+
+    idct->rst_i = !0;
+    idct->clk_i = 0;
+    idct->img_start_i = !1;
+    idct->img_end_i = !1;
+    idct->inport_valid_i = !1;
+    idct->inport_eob_i = !1;
+    idct->outport_accept_i = !0;
+
+    block_gen gen(cfg.seed, cfg.max_coeff);
+    std::deque<idct_block> pending;     // Sent (or being sent), awaiting output
+    size_t   wr = 0;                    // Next write of the block being sent (writes.size() = EOB)
+    uint64_t sent = 0;
+    int      out[64];
+    int      out_count = 0;
+    uint32_t out_id = 0;
+    bool     started = false;
+
+    const vluint64_t reset_end = context->time() + 10;
+    uint64_t cycle = 0;
+    uint64_t last_progress = 0;
+
+    while (!context->gotFinish() && st.blocks < cfg.blocks) {
+        context->timeInc(1);
+        idct->clk_i = !idct->clk_i;
+        main_time++;
+
+        if (idct->clk_i && !idct->rst_i && started) {
+            cycle++;
+            bool progress = false;
+
+            // Input handshake completing on this edge (only presented while accepted)
+            if (idct->inport_valid_i || idct->inport_eob_i) {
+                idct_block &blk = pending.back();
+                if (idct->inport_eob_i) {
+                    blk.eob = cycle;
+                    sent++;
+                    wr = 0;
+                } else
+                    wr++;
+                progress = true;
+            }
+
+            // Output samples (outport_accept_i is always high)
+            if (idct->outport_valid_o) {
+                if (pending.empty()) {
+                    VL_PRINTF("ERROR: Output with no block outstanding (cycle %" PRIu64 ")\n", cycle);
+                    return false;
+                }
+                const idct_block &blk = pending.front();
+                if (out_count == 0) {
+                    out_id = idct->outport_id_o;
+                    if (st.blocks == 0)
+                        st.first_out = cycle;
+                    else
+                        st.out_gap += cycle - st.last_out - 1;
+                    st.first_latency += cycle - blk.first_in;
+                }
+                out[idct->outport_idx_o & 63] = (int32_t)idct->outport_data_o;
+                st.last_out = cycle;
+                progress = true;
+
+                if (++out_count == 64) {
+                    out_count = 0;
+                    if (out_id != blk.id) {
+                        VL_PRINTF("ERROR: Block %u output with id %u\n", blk.id, out_id);
+                        st.mismatches++;
+                    }
+                    if (cfg.ref == REF_AUTO && blk.kind != GEN_ZERO) {
+                        cfg.ref = detect_ref(blk, out);
+                        VL_PRINTF("Reference IDCT: %s (detected)\n", ref_name(cfg.ref));
+                    }
+                    check_block(cfg, st, blk, out);
+
+                    const uint64_t latency = cycle - blk.eob;
+                    if (st.blocks == 0)
+                        st.latency_first = latency;
+                    st.latency_min = std::min(st.latency_min, latency);
+                    st.latency_max = std::max(st.latency_max, latency);
+                    st.latency_sum += latency;
+                    st.blocks++;
+                    pending.pop_front();
+                }
+            }
+
+            // Watchdog
+            if (progress)
+                last_progress = cycle;
+            else if (cycle - last_progress > cfg.timeout) {
+                VL_PRINTF("ERROR: No progress for %" PRIu64 " cycles (%" PRIu64 " blocks out)\n", cfg.timeout, st.blocks);
+                return false;
+            }
+        }
+
+        if (cfg.wave && idct->clk_i)
+            cfg.wave->cycle(idct.get(), cycle);
+
+        if (idct->clk_i)
+            idct->rst_i = context->time() < reset_end; // Reset for the first few cycles
+
+        // Evaluate model
+        idct->eval();
+
+        if (cfg.wave)
+            cfg.wave->dump(main_time);
+
+        if (!idct->rst_i && idct->clk_i) { // Setup input data
+            // Clear any state left from reset, then stream
+            idct->img_start_i = !started;
+            if (!started) {
+                started = true;
+                continue;
+            }
+
+            // Next block (the driver never withholds valid)
+            if (wr == 0 && (pending.empty() || pending.back().eob) && sent < cfg.blocks) {
+                pending.push_back(idct_block());
+                idct_block &blk = pending.back();
+                gen.next(blk, (uint32_t)sent);
+                blk.first_in = cycle + 1;
+                blk.eob = 0;
+                if (st.first_in == 0)
+                    st.first_in = blk.first_in;
+            }
+
+            // As from jpeg_dqt, a block is only presented once its buffer slot is free (the
+            // EOB also pushes the block id, so it must not be held against a full buffer)
+            bool sending = !pending.empty() && !pending.back().eob;
+            if (sending && !idct->inport_accept_o) {
+                st.in_stall++;
+                sending = false;
+            }
+            const idct_block *blk = sending ? &pending.back() : NULL;
+            idct->inport_valid_i = sending && wr < blk->writes.size();
+            idct->inport_eob_i = sending && wr == blk->writes.size();
+            idct->inport_idx_i = idct->inport_valid_i ? blk->writes[wr] : 0;
+            idct->inport_data_i = idct->inport_valid_i ? (uint16_t)blk->coeff[blk->writes[wr]] : 0;
+            idct->inport_id_i = sending ? blk->id : 0;
+        }
+    }
+
+    st.cycles = cycle;
+    idct->final();
+    return st.blocks == cfg.blocks;
+}
+
+// Plusarg value (copied, as the returned buffer is reused between calls)
+static bool plusarg(VerilatedContext *context, const char *name, std::string &value) {
+    const std::string match = std::string(name) + "=";
+    const char *arg = context->commandArgsPlusMatch(match.c_str());
+    if (!arg || !arg[0])
+        return false;
+    value = arg + 1 + match.size();
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const std::unique_ptr<VerilatedContext> context(new VerilatedContext);
+    context->debug(0);
+    context->randReset(2);
+    context->commandArgs(argc, argv);
+
+    if (context->commandArgsPlusMatch("help")[0]) {
+        std::cerr << argv[0] << " [options] [verilator_options]" << std::endl;
+        std::cerr << "  +blocks=<n>          Blocks to stream (default 1000000)" << std::endl;
+        std::cerr << "  +seed=<n>            Random seed (default 1)" << std::endl;
+        std::cerr << "  +max_coeff=<n>       Largest coefficient magnitude (default 2047)" << std::endl;
+        std::cerr << "  +ref=<idct>          C model to compare with: auto, chen or ifast" << std::endl;
+        std::cerr << "  +max_err=<n>         Largest sample difference allowed (default 0)" << std::endl;
+        std::cerr << "  +max_report=<n>      Mismatching blocks to print in full (default 4)" << std::endl;
+        std::cerr << "  +timeout=<cycles>    Give up after this many cycles without progress (default 10000)" << std::endl;
+        std::cerr << "  +trace               Write a waveform (idct.vcd / .fst, needs cmake -DTRACE=VCD|FST)" << std::endl;
+        std::cerr << "  +trace_start=<cycle> Start tracing at this cycle" << std::endl;
+        std::cerr << "  +trace_end=<cycle>   Stop tracing at this cycle" << std::endl;
+        exit(1);
+    }
+
+    tb_config cfg;
+    std::string arg;
+    cfg.blocks = plusarg(context.get(), "blocks", arg) ? strtoull(arg.c_str(), NULL, 0) : 1000000;
+    cfg.seed = plusarg(context.get(), "seed", arg) ? strtoul(arg.c_str(), NULL, 0) : 1;
+    cfg.max_coeff = plusarg(context.get(), "max_coeff", arg) ? atoi(arg.c_str()) : 2047;
+    cfg.max_err = plusarg(context.get(), "max_err", arg) ? atoi(arg.c_str()) : 0;
+    cfg.max_report = plusarg(context.get(), "max_report", arg) ? atoi(arg.c_str()) : 4;
+    cfg.timeout = plusarg(context.get(), "timeout", arg) ? strtoull(arg.c_str(), NULL, 0) : 10000;
+    cfg.ref = IDCT_VARIANT;
+    if (plusarg(context.get(), "ref", arg)) {
+        cfg.ref = -1;
+        for (int ref = 0; ref < REF_COUNT; ref++)
+            if (arg == ref_name(ref))
+                cfg.ref = ref;
+        if (cfg.ref < 0) {
+            std::cerr << "Unknown +ref=" << arg << " (auto, chen or ifast)" << std::endl;
+            exit(1);
+        }
+    }
+    if (cfg.blocks == 0 || cfg.max_coeff < 1 || cfg.max_coeff > 32767) {
+        std::cerr << "Bad +blocks / +max_coeff" << std::endl;
+        exit(1);
+    }
+
+    wave_config wave_cfg;
+    wave_cfg.enable = context->commandArgsPlusMatch("trace")[0] != 0;
+    const char *ext = strrchr(wave_config::default_file(), '.');
+    wave_cfg.file = std::string("idct") + (ext ? ext : "");
+    if (plusarg(context.get(), "trace_start", arg)) {
+        wave_cfg.enable = true;
+        wave_cfg.start = strtoull(arg.c_str(), NULL, 0);
+    }
+    if (plusarg(context.get(), "trace_end", arg)) {
+        wave_cfg.enable = true;
+        wave_cfg.end = strtoull(arg.c_str(), NULL, 0);
+    }
+    if (wave_cfg.enable && !wave_config::supported()) {
+        std::cerr << "Waveform tracing not built in: rebuild with cmake -DTRACE=VCD (or FST)" << std::endl;
+        exit(1);
+    }
+    wave_trace wave(wave_cfg);
+    if (wave_cfg.enable) {
+        context->traceEverOn(true);
+        cfg.wave = &wave;
+    } else
+        cfg.wave = NULL;
+
+    VL_PRINTF("jpeg_idct (%s): %" PRIu64 " blocks, seed %u, |coeff| <= %d, reference %s\n",
+              IDCT_VARIANT != REF_AUTO ? ref_name(IDCT_VARIANT) : "unknown variant", cfg.blocks, cfg.seed, cfg.max_coeff, ref_name(cfg.ref));
+
+    const auto start = std::chrono::steady_clock::now();
+    tb_stats st;
+    const bool complete = run_idct(context.get(), cfg, st);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Throughput from the first coefficient in to the last sample out
+    const uint64_t span = st.blocks ? st.last_out - st.first_in + 1 : 0;
+    VL_PRINTF("Blocks: %" PRIu64 " in %" PRIu64 " cycles\n", st.blocks, st.cycles);
+    if (st.blocks) {
+        VL_PRINTF("  throughput: %.5f blocks/cycle (%.2f cycles/block", (double)st.blocks / span, (double)span / st.blocks);
+        if (st.blocks > 1)
+            VL_PRINTF(", %.2f steady state", (double)(st.last_out - st.first_out) / (st.blocks - 1));
+        VL_PRINTF(")\n");
+        VL_PRINTF("  latency (EOB -> last sample): %" PRIu64 " cycles unloaded, min %" PRIu64 " mean %.1f max %" PRIu64 " streaming\n",
+                  st.latency_first, st.latency_min, (double)st.latency_sum / st.blocks, st.latency_max);
+        VL_PRINTF("  latency (first coefficient -> first sample): mean %.1f cycles\n", (double)st.first_latency / st.blocks);
+        VL_PRINTF("  input wait cycles: %" PRIu64 ", output gap cycles: %" PRIu64 "\n", st.in_stall, st.out_gap);
+    }
+    for (int k = 0; k < GEN_COUNT; k++)
+        if (st.kind_blocks[k])
+            VL_PRINTF("  %-12s %10" PRIu64 " blocks %8" PRIu64 " failing\n", gen_name(k), st.kind_blocks[k], st.kind_fails[k]);
+    VL_PRINTF("Simulated %.0f blocks/s (%.2fs)\n", secs > 0 ? st.blocks / secs : 0.0, secs);
+
+    const bool pass = complete && st.mismatches == 0;
+    VL_PRINTF("%s: %" PRIu64 " mismatching blocks, max error %d (allowed %d), reference %s\n",
+              pass ? "PASS" : "FAIL", st.mismatches, st.max_err, cfg.max_err, ref_name(cfg.ref));
+    return pass ? 0 : 1;
+}
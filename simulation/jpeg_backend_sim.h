@@ -0,0 +1,206 @@
+// DESCRIPTION: Decode backend running the Verilated jpeg_core
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#ifndef JPEG_BACKEND_SIM_H
+#define JPEG_BACKEND_SIM_H
+
+#include <memory>
+#include <thread>
+#include <cinttypes>
+#include <verilated.h>
+
+#include "jpeg_backend.h"
+#include "jpeg_file.h"
+
+// Include model header, generated from Verilating "jpeg_core.v"
+#include "Vjpeg_core.h"
+
+//-----------------------------------------------------------------------------
+// jpeg_backend_sim: One Verilated jpeg_core clocked by a dedicated thread.
+// The core is reset once and jobs are fed back to back (each frame starts
+// once the previous one is out and idle_o is set), so results carry the
+// core's cycle count per frame. Pixels are written straight into the job's
+// frame buffer; the core outputs RGB so YUV formats are rejected.
+//-----------------------------------------------------------------------------
+class jpeg_backend_sim: public jpeg_backend {
+public:
+    // timeout: cycles without input / output progress before a job is failed
+    jpeg_backend_sim(int queue_depth, uint64_t timeout = 1000000)
+        : jpeg_backend(queue_depth), m_timeout(timeout), m_cycles(0), m_busy_cycles(0) {
+        m_thread = std::thread(&jpeg_backend_sim::worker, this);
+    }
+
+    virtual ~jpeg_backend_sim() {
+        stop();
+        m_thread.join();
+    }
+
+    virtual const char *name(void) { return "sim"; }
+
+    // Total clocks simulated, and those spent with a frame in flight (sim thread only
+    // while running - read once drained)
+    uint64_t cycles(void) const { return m_cycles; }
+    uint64_t busy_cycles(void) const { return m_busy_cycles; }
+
+private:
+    static bool is_rgb(t_jpeg_pix_format fmt) {
+        return fmt == JPEG_PIX_RGB24 || fmt == JPEG_PIX_RGBA32 || fmt == JPEG_PIX_BGRA32 || fmt == JPEG_PIX_RGB565;
+    }
+
+    static void store_pixel(t_jpeg_pix_format fmt, uint8_t *p, uint8_t r, uint8_t g, uint8_t b) {
+        switch (fmt) {
+        case JPEG_PIX_RGBA32:
+            p[0] = r; p[1] = g; p[2] = b; p[3] = 0xFF;
+            break;
+        case JPEG_PIX_BGRA32:
+            p[0] = b; p[1] = g; p[2] = r; p[3] = 0xFF;
+            break;
+        case JPEG_PIX_RGB565: {
+            const uint16_t v = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+            memcpy(p, &v, sizeof(v));
+            break;
+        }
+        default:
+            p[0] = r; p[1] = g; p[2] = b;
+            break;
+        }
+    }
+
+    // One clock cycle: rising edge, then the falling edge where inputs are set up
+    void clock(void) {
+        m_core->clk_i = 1;
+        m_context->timeInc(1);
+        m_core->eval();
+        m_core->clk_i = 0;
+        m_context->timeInc(1);
+        m_core->eval();
+        m_cycles++;
+    }
+
+    void reset(void) {
+        m_core->rst_i = 1;
+        m_core->inport_valid_i = 0;
+        m_core->inport_last_i = 0;
+        m_core->outport_accept_i = 0;
+        m_core->dc_only_i = 0;
+        for (int i = 0; i < 5; i++)
+            clock();
+        m_core->rst_i = 0;
+        m_core->eval();
+    }
+
+    //-------------------------------------------------------------------------
+    // decode: Stream one JPEG through the core and collect its pixels
+    //-------------------------------------------------------------------------
+    t_jpeg_job_status decode(t_entry *e) {
+        const t_jpeg_job &job = e->job;
+        jpeg_file_info info;
+
+        const bool parsed = jpeg_file_parse(job.data, job.len, info);
+        e->res.width  = info.width;
+        e->res.height = info.height;
+        e->res.mode   = (t_jpeg_mode)info.mode;   // Same encoding as img_mode / t_jpeg_mode
+        if (!parsed || info.mode == JPEG_FILE_MODE_UNSUPPORTED || !is_rgb(job.format))
+            return JPEG_JOB_UNSUPPORTED;
+
+        t_jpeg_output_desc desc;
+        const t_jpeg_job_status st = bind_output(&job, info.width, info.height, &desc);
+        if (st != JPEG_JOB_OK)
+            return st;
+
+        const int      bpp    = jpeg_output::pixel_bytes(job.format);
+        const uint64_t pixels = jpeg_file_out_pixels(info);
+        const uint64_t start  = m_cycles;
+        uint64_t last_progress = m_cycles;
+        uint64_t out = 0;
+        size_t read = 0;
+
+        m_core->outport_accept_i = 1;
+        while (out < pixels || !m_core->idle_o) {
+            // Present the next word (valid held high after the end so the core can drain)
+            if (read < (size_t)job.len) {
+                m_core->inport_data_i = jpeg_input_pack(job.data, job.len, read);
+                m_core->inport_strb_i = JPEG_INPUT_STRB;
+                m_core->inport_last_i = 0;
+            } else
+                m_core->inport_last_i = 1;
+            m_core->inport_valid_i = 1;
+            m_core->eval();
+
+            const bool in_fire  = m_core->inport_accept_o && read < (size_t)job.len;
+            const bool out_fire = m_core->outport_valid_o && out < pixels;
+            if (out_fire) {
+                const size_t x = m_core->outport_pixel_x_o;
+                const size_t y = m_core->outport_pixel_y_o;
+                // Padding pixels of the right / bottom edge blocks are not stored
+                if (x < (size_t)info.width && y < (size_t)info.height) {
+                    uint8_t *p = desc.plane[0] + y * desc.stride[0] + x * bpp;
+                    store_pixel(job.format, p, m_core->outport_pixel_r_o, m_core->outport_pixel_g_o,
+                                m_core->outport_pixel_b_o);
+                    // Second pixel (x + 1) of a raster order beat
+                    if (JPEG_RASTER_OUTPUT && m_core->outport_pixel2_valid_o) {
+                        store_pixel(job.format, p + bpp, m_core->outport_pixel2_r_o, m_core->outport_pixel2_g_o,
+                                    m_core->outport_pixel2_b_o);
+                        out++;
+                    }
+                }
+                out++;
+            }
+
+            clock();
+
+            if (in_fire)
+                read += JPEG_INPUT_BYTES;
+            if (in_fire || out_fire)
+                last_progress = m_cycles;
+            else if (m_cycles - last_progress > m_timeout) {
+                VL_PRINTF("ERROR: jpeg_backend_sim: no progress for %" PRIu64 " cycles (job %" PRIu64 ", %" PRIu64
+                          " pixels output)\n", m_timeout, e->res.id, out);
+                e->res.cycles = m_cycles - start;
+                m_busy_cycles += m_cycles - start;
+                reset();
+                return JPEG_JOB_ERROR;
+            }
+        }
+
+        m_core->inport_valid_i = 0;
+        m_core->outport_accept_i = 0;
+        m_core->eval();
+
+        e->res.cycles = m_cycles - start;
+        m_busy_cycles += m_cycles - start;
+        return JPEG_JOB_OK;
+    }
+
+    //-------------------------------------------------------------------------
+    // worker: Sim thread - creates and owns the model for its whole lifetime
+    //-------------------------------------------------------------------------
+    void worker(void) {
+        t_entry e;
+
+        m_context.reset(new VerilatedContext);
+        m_core.reset(new Vjpeg_core(m_context.get(), "JPEG_DECODER"));
+
+        reset();
+        while (next_job(&e))
+            complete(&e, decode(&e));
+
+        m_core->final();
+        m_core.reset();
+        m_context.reset();
+    }
+
+private:
+    std::unique_ptr<VerilatedContext> m_context;
+    std::unique_ptr<Vjpeg_core>       m_core;
+    std::thread                       m_thread;
+    uint64_t                          m_timeout;
+    uint64_t                          m_cycles;
+    uint64_t                          m_busy_cycles;
+};
+
+#endif
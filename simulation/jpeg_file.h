@@ -0,0 +1,182 @@
+// DESCRIPTION: Minimal JPEG header scan used by the simulation harnesses
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#ifndef JPEG_FILE_H
+#define JPEG_FILE_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Input bus width (jpeg_core INPUT_WIDTH). Build with -DJPEG_INPUT_WIDTH=64 against
+// a core Verilated with -GINPUT_WIDTH=64.
+#ifndef JPEG_INPUT_WIDTH
+#define JPEG_INPUT_WIDTH 32
+#endif
+
+#if JPEG_INPUT_WIDTH == 64
+typedef uint64_t jpeg_input_word;
+#else
+typedef uint32_t jpeg_input_word;
+#endif
+
+// Output order (jpeg_core SUPPORT_RASTER_OUTPUT). Build with -DJPEG_RASTER_OUTPUT=1 against
+// a core Verilated with -GSUPPORT_RASTER_OUTPUT=1: pixels arrive in raster order, up to two
+// per beat (outport_pixel2_*), and padding pixels are not output.
+#ifndef JPEG_RASTER_OUTPUT
+#define JPEG_RASTER_OUTPUT 0
+#endif
+
+// Frame overlap (jpeg_core SUPPORT_FRAME_OVERLAP). Build with -DJPEG_FRAME_OVERLAP=1 against
+// a core Verilated with -GSUPPORT_FRAME_OVERLAP=1: the core takes the next frame while the
+// last one is still being output, so frames are streamed back to back by default.
+#ifndef JPEG_FRAME_OVERLAP
+#define JPEG_FRAME_OVERLAP 0
+#endif
+
+// DC only decode (jpeg_core SUPPORT_DC_ONLY). Build with -DJPEG_DC_ONLY=1 against a core
+// Verilated with -GSUPPORT_DC_ONLY=1: dc_only_i is driven high, so frames are output at 1/8
+// scale, one pixel per 8x8 block (padding blocks included) in block order.
+#ifndef JPEG_DC_ONLY
+#define JPEG_DC_ONLY 0
+#endif
+
+#define JPEG_INPUT_BYTES    sizeof(jpeg_input_word)
+#define JPEG_INPUT_STRB     ((1u << JPEG_INPUT_BYTES) - 1)
+
+// Input word at byte offset pos (little endian, zero padded past the end)
+static inline jpeg_input_word jpeg_input_pack(const uint8_t *data, size_t len, size_t pos) {
+    jpeg_input_word word = 0;
+    for (size_t i = 0; i < JPEG_INPUT_BYTES && pos + i < len; i++)
+        word |= (jpeg_input_word)data[pos + i] << (8 * i);
+    return word;
+}
+
+// Image modes (matches img_mode in jpeg_input.v)
+#define JPEG_FILE_MODE_MONO         0
+#define JPEG_FILE_MODE_YCBCR_444    1
+#define JPEG_FILE_MODE_YCBCR_420    2
+#define JPEG_FILE_MODE_YCBCR_422    3
+#define JPEG_FILE_MODE_UNSUPPORTED  4
+
+struct jpeg_file_info {
+    int    width;
+    int    height;
+    int    mode;
+    size_t scan_offset;     // First byte of entropy coded data (after SOS)
+};
+
+static inline const char *jpeg_file_mode_name(int mode) {
+    switch (mode) {
+    case JPEG_FILE_MODE_MONO:      return "mono";
+    case JPEG_FILE_MODE_YCBCR_444: return "444";
+    case JPEG_FILE_MODE_YCBCR_420: return "420";
+    case JPEG_FILE_MODE_YCBCR_422: return "422";
+    default:                       return "unsupported";
+    }
+}
+
+// Number of 8x8 pixel blocks output for the image (padded to whole MCUs)
+static inline size_t jpeg_file_blocks(const jpeg_file_info &info) {
+    const int mcu_w = (info.mode == JPEG_FILE_MODE_YCBCR_420 || info.mode == JPEG_FILE_MODE_YCBCR_422) ? 16 : 8;
+    const int mcu_h = (info.mode == JPEG_FILE_MODE_YCBCR_420) ? 16 : 8;
+    const size_t mcus_x = (info.width  + mcu_w - 1) / mcu_w;
+    const size_t mcus_y = (info.height + mcu_h - 1) / mcu_h;
+    return mcus_x * mcus_y * (mcu_w / 8) * (mcu_h / 8);
+}
+
+// Number of pixels output for the image (including padding in block order)
+static inline size_t jpeg_file_out_pixels(const jpeg_file_info &info) {
+    if (JPEG_DC_ONLY)
+        return jpeg_file_blocks(info);
+    if (JPEG_RASTER_OUTPUT)
+        return (size_t)info.width * info.height;
+    return jpeg_file_blocks(info) * 64;
+}
+
+// Walk the marker segments up to the first SOS. Returns false if no
+// baseline frame header / scan was found.
+static inline bool jpeg_file_parse(const uint8_t *buf, size_t len, jpeg_file_info &info) {
+    info.width = 0;
+    info.height = 0;
+    info.mode = JPEG_FILE_MODE_UNSUPPORTED;
+    info.scan_offset = 0;
+
+    bool sof = false;
+    size_t i = 0;
+    while (i + 4 <= len) {
+        if (buf[i] != 0xFF) {
+            i++;
+            continue;
+        }
+        const uint8_t marker = buf[i + 1];
+        // Standalone markers / fill bytes
+        if (marker == 0xFF || marker == 0x00 || marker == 0xD8 || marker == 0x01 ||
+            (marker >= 0xD0 && marker <= 0xD7)) {
+            i += (marker == 0xFF) ? 1 : 2;
+            continue;
+        }
+        if (marker == 0xD9)
+            break;
+
+        const size_t seg_len = (buf[i + 2] << 8) | buf[i + 3];
+        const uint8_t *seg = &buf[i + 4];
+        if (i + 2 + seg_len > len)
+            break;
+
+        if (marker == 0xC0 && seg_len >= 8) {
+            const int comps = seg[5];
+            info.height = (seg[1] << 8) | seg[2];
+            info.width  = (seg[3] << 8) | seg[4];
+            if (comps == 1)
+                info.mode = JPEG_FILE_MODE_MONO;
+            else if (comps == 3 && seg_len >= 17) {
+                const uint8_t y_factor = seg[7];
+                if (seg[10] == 0x11 && seg[13] == 0x11)
+                    info.mode = (y_factor == 0x11) ? JPEG_FILE_MODE_YCBCR_444 :
+                                (y_factor == 0x22) ? JPEG_FILE_MODE_YCBCR_420 :
+                                (y_factor == 0x21) ? JPEG_FILE_MODE_YCBCR_422 :
+                                                     JPEG_FILE_MODE_UNSUPPORTED;
+            }
+            sof = true;
+        } else if (marker == 0xDA) {
+            info.scan_offset = i + 2 + seg_len;
+            return sof;
+        }
+
+        i += 2 + seg_len;
+    }
+
+    return false;
+}
+
+// Length of the JPEG image starting at buf (up to and including EOI), used
+// to split an MJPEG stream / concatenated JPEGs into frames. Returns len if
+// the EOI marker is missing.
+static inline size_t jpeg_file_frame_len(const uint8_t *buf, size_t len) {
+    size_t i = 0;
+    while (i + 2 <= len) {
+        if (buf[i] != 0xFF) {
+            i++;
+            continue;
+        }
+        const uint8_t marker = buf[i + 1];
+        // Standalone markers / fill bytes / stuffed 0xFF in entropy coded data
+        if (marker == 0xFF || marker == 0x00 || marker == 0xD8 || marker == 0x01 ||
+            (marker >= 0xD0 && marker <= 0xD7)) {
+            i += (marker == 0xFF) ? 1 : 2;
+            continue;
+        }
+        if (marker == 0xD9)
+            return i + 2;
+        if (i + 4 > len)
+            break;
+        i += 2 + ((buf[i + 2] << 8) | buf[i + 3]);
+    }
+    return len;
+}
+
+#endif
@@ -0,0 +1,87 @@
+// DESCRIPTION: JPEG / MJPEG input stream loading, split into frames
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#ifndef JPEG_STREAM_H
+#define JPEG_STREAM_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "jpeg_file.h"
+
+// One JPEG frame of the input stream
+struct frame_input {
+    const uint8_t *data;
+    size_t         len;
+    jpeg_file_info info;
+};
+
+//-----------------------------------------------------------------------------
+// load_stream: Read a JPEG / MJPEG file, or '@list' (one JPEG per line,
+//              concatenated), and split it into frames at SOI / EOI
+//-----------------------------------------------------------------------------
+static inline bool load_file(const char *filename, std::vector<uint8_t> &buf) {
+    FILE *input = fopen(filename, "rb");
+    if (input == NULL) {
+        std::cerr << "Can not open jpeg file " << filename << std::endl;
+        return false;
+    }
+    fseek(input, 0, SEEK_END);
+    const size_t len = ftell(input);
+    fseek(input, 0, SEEK_SET);
+    const size_t base = buf.size();
+    buf.resize(base + len);
+    const bool ok = len == 0 || fread(&buf[base], len, 1, input) == 1;
+    fclose(input);
+    return ok;
+}
+
+static inline bool load_stream(const char *name, std::vector<uint8_t> &buf, std::vector<frame_input> &frames) {
+    if (name[0] == '@') {
+        FILE *list = fopen(name + 1, "r");
+        if (list == NULL) {
+            std::cerr << "Can not open file list " << name + 1 << std::endl;
+            return false;
+        }
+        char line[1024];
+        while (fgets(line, sizeof(line), list)) {
+            line[strcspn(line, "\r\n")] = 0;
+            if (line[0] && line[0] != '#' && !load_file(line, buf)) {
+                fclose(list);
+                return false;
+            }
+        }
+        fclose(list);
+    } else if (!load_file(name, buf))
+        return false;
+
+    size_t pos = 0;
+    while (pos + 2 <= buf.size()) {
+        if (buf[pos] != 0xFF || buf[pos + 1] != 0xD8) {
+            pos++;
+            continue;
+        }
+        frame_input f;
+        f.data = &buf[pos];
+        f.len = jpeg_file_frame_len(f.data, buf.size() - pos);
+        if (!jpeg_file_parse(f.data, f.len, f.info)) {
+            std::cerr << "Can not find frame header / scan in frame " << frames.size()
+                      << " of " << name << std::endl;
+            return false;
+        }
+        frames.push_back(f);
+        pos += f.len;
+    }
+    if (frames.empty())
+        std::cerr << "Can not find frame header / scan in " << name << std::endl;
+    return !frames.empty();
+}
+
+#endif
@@ -0,0 +1,355 @@
+// DESCRIPTION: Throughput harness for the multi-core wrapper (jpeg_multi.v)
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#include <memory>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cinttypes>
+#include <verilated.h>
+
+#include "jpeg_file.h"
+#include "jpeg_stream.h"
+#include "frame.h"
+#include "stall_gen.h"
+#include "jpeg_decoder.h"
+
+// Include model header, generated from Verilating "jpeg_multi.v"
+#include "Vjpeg_multi.h"
+
+#ifndef JPEG_MULTI_CORES
+#define JPEG_MULTI_CORES 2
+#endif
+
+// jpeg_multi MERGE_OUTPUT=1: all pixels on port 0, in frame order
+#ifndef JPEG_MULTI_MERGE
+#define JPEG_MULTI_MERGE 0
+#endif
+
+// Field of a per core (flattened) output port. Fields never straddle a 32-bit word.
+static inline uint32_t port_field(uint64_t port, int lsb, int width) {
+    return (uint32_t)(port >> lsb) & ((1u << width) - 1);
+}
+static inline uint32_t port_field(const uint32_t *port, int lsb, int width) {
+    return (port[lsb / 32] >> (lsb % 32)) & ((1u << width) - 1);
+}
+
+struct multi_stats {
+    uint64_t first_in;                  // First input cycle
+    uint64_t cycles;                    // Last frame completion
+    std::vector<uint64_t> done;         // Completion cycle per frame
+    std::vector<uint64_t> pixels;       // Per core pixels output
+};
+
+// Plusarg value (copied, as the returned buffer is reused between calls)
+static bool plusarg(VerilatedContext *context, const char *name, std::string &value) {
+    const std::string match = std::string(name) + "=";
+    const char *arg = context->commandArgsPlusMatch(match.c_str());
+    if (!arg || !arg[0])
+        return false;
+    value = arg + 1 + match.size();
+    return true;
+}
+
+// Reference decode: the C model with the RTL's fixed point colour conversion
+static void ref_header(void *ctx, jpeg_decoder *dec) {
+    static t_jpeg_output_desc desc;
+    std::vector<uint8_t> &rgb = *(std::vector<uint8_t> *)ctx;
+    rgb.resize(jpeg_output::frame_size(JPEG_PIX_RGB24, dec->width(), dec->height(), 0));
+    jpeg_output::desc_init(&desc, JPEG_PIX_RGB24, rgb.data(), dec->width(), dec->height(), 0);
+    dec->set_output(&desc);
+}
+
+static bool ref_decode(jpeg_decoder &dec, const frame_input &fi, frame &ref) {
+    std::vector<uint8_t> rgb;
+    dec.reset();
+    dec.set_callbacks(ref_header, NULL, &rgb);
+    dec.feed(fi.data, (int)fi.len);
+    if (!dec.finish())
+        return false;
+    ref.resize(dec.width(), dec.height());
+    for (size_t pos = 0; pos < ref.width * ref.height; pos++) {
+        ref.r[pos] = rgb[pos * 3 + 0];
+        ref.g[pos] = rgb[pos * 3 + 1];
+        ref.b[pos] = rgb[pos * 3 + 2];
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// run_multi: Feed the frames back to back (inport_last_i on the last word of
+//            each), collect every core's pixels by frame sequence number and
+//            check that completions arrive in frame order (and, with
+//            JPEG_MULTI_MERGE, that the pixels do too, all on port 0)
+//-----------------------------------------------------------------------------
+static bool run_multi(VerilatedContext *context, const std::vector<frame_input> &frames, stall_gen &out_stall,
+                      uint64_t timeout, multi_stats &st, std::vector<frame> &outs) {
+    const std::unique_ptr<Vjpeg_multi> top(new Vjpeg_multi(context, "JPEG_MULTI"));
+    const size_t n = frames.size();
+
+    st.first_in = 0;
+    st.cycles = 0;
+    st.done.assign(n, 0);
+    st.pixels.assign(JPEG_MULTI_CORES, 0);
+    outs.resize(n);
+    for (size_t i = 0; i < n; i++)
+        outs[i].width = outs[i].height = 0;
+
+    // Reset
+    top->clk_i = 0;
+    top->rst_i = 1;
+    top->inport_valid_i = 0;
+    top->inport_last_i = 0;
+    top->outport_accept_i = 0;
+    for (int i = 0; i < 10; i++) {
+        top->clk_i = !top->clk_i;
+        context->timeInc(1);
+        top->eval();
+    }
+    top->rst_i = 0;
+
+    uint64_t cycle = 0;
+    uint64_t last_progress = 0;
+    size_t in_frame = 0;
+    size_t read = 0;
+    size_t done = 0;
+    size_t merge_seq = 0;
+    bool ok = true;
+
+    while (done < n && !context->gotFinish()) {
+        // Inputs settle on the falling edge
+        const bool in_pending = in_frame < n;
+        if (in_pending) {
+            const frame_input &fi = frames[in_frame];
+            top->inport_data_i = jpeg_input_pack(fi.data, fi.len, read);
+            top->inport_strb_i = JPEG_INPUT_STRB;
+            top->inport_last_i = read + JPEG_INPUT_BYTES >= fi.len;
+        }
+        top->inport_valid_i = in_pending;
+        top->outport_accept_i = 0;
+        for (int c = 0; c < JPEG_MULTI_CORES; c++)
+            if (!out_stall.stall())
+                top->outport_accept_i |= 1u << c;
+        top->eval();
+
+        // Handshakes completing on the rising edge
+        const bool in_fire = in_pending && top->inport_accept_o;
+        bool progress = in_fire;
+        if (in_fire && in_frame == 0 && read == 0)
+            st.first_in = cycle;
+
+        for (int c = 0; c < JPEG_MULTI_CORES; c++) {
+            if (!((top->outport_valid_o >> c) & 1) || !((top->outport_accept_i >> c) & 1))
+                continue;
+            progress = true;
+            st.pixels[c]++;
+
+            const size_t seq = port_field(top->outport_frame_o, c * 16, 16);
+            if (JPEG_MULTI_MERGE && (c != 0 || seq < merge_seq)) {
+                VL_PRINTF("ERROR: merged output: pixel of frame %zu on port %d after frame %zu\n", seq, c, merge_seq);
+                ok = false;
+                break;
+            }
+            merge_seq = seq;
+            if (seq >= n)
+                continue;
+            frame &out = outs[seq];
+            if (out.width == 0)
+                out.resize(port_field(top->outport_width_o, c * 16, 16), port_field(top->outport_height_o, c * 16, 16));
+            // Padding pixels of the right / bottom edge blocks are not stored
+            const size_t x = port_field(top->outport_pixel_x_o, c * 16, 16);
+            const size_t y = port_field(top->outport_pixel_y_o, c * 16, 16);
+            if (x < out.width && y < out.height) {
+                const size_t pos = y * out.width + x;
+                out.r[pos] = port_field(top->outport_pixel_r_o, c * 8, 8);
+                out.g[pos] = port_field(top->outport_pixel_g_o, c * 8, 8);
+                out.b[pos] = port_field(top->outport_pixel_b_o, c * 8, 8);
+            }
+            // Raster output: second pixel of the beat at x + 1
+            if (((top->outport_pixel2_valid_o >> c) & 1) && x + 1 < out.width && y < out.height) {
+                const size_t pos = y * out.width + x + 1;
+                out.r[pos] = port_field(top->outport_pixel2_r_o, c * 8, 8);
+                out.g[pos] = port_field(top->outport_pixel2_g_o, c * 8, 8);
+                out.b[pos] = port_field(top->outport_pixel2_b_o, c * 8, 8);
+            }
+        }
+        if (!ok)
+            break;
+
+        if (top->frame_done_o) {
+            progress = true;
+            if (top->frame_done_seq_o != (done & 0xFFFF)) {
+                VL_PRINTF("ERROR: frame %u completed, expected frame %zu\n", top->frame_done_seq_o, done);
+                ok = false;
+                break;
+            }
+            st.done[done++] = cycle;
+        }
+
+        top->clk_i = 1;
+        context->timeInc(1);
+        top->eval();
+        top->clk_i = 0;
+        context->timeInc(1);
+        top->eval();
+        cycle++;
+
+        if (in_fire) {
+            read += JPEG_INPUT_BYTES;
+            if (read >= frames[in_frame].len) {
+                in_frame++;
+                read = 0;
+            }
+        }
+
+        // Watchdog
+        if (progress)
+            last_progress = cycle;
+        else if (timeout && cycle - last_progress > timeout) {
+            VL_PRINTF("ERROR: No progress for %" PRIu64 " cycles (%zu of %zu frames input, %zu completed)\n",
+                      timeout, in_frame, n, done);
+            ok = false;
+            break;
+        }
+    }
+
+    top->final();
+    st.cycles = cycle;
+    return ok && done == n;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <stream.jpg | @list> [out.ppm] [options]" << std::endl;
+        std::cerr << "  Decodes every frame through jpeg_multi (" << JPEG_MULTI_CORES << " cores) and reports aggregate fps" << std::endl;
+        std::cerr << "  +repeat=<n>          Feed the stream n times (default 1)" << std::endl;
+        std::cerr << "  +out_stall=<pct>     Hold each core's outport_accept_i low on a random pct% of cycles" << std::endl;
+        std::cerr << "  +seed=<n>            Random stall seed (default 1)" << std::endl;
+        std::cerr << "  +clock_mhz=<f>       Clock used for the frame rate (default 75)" << std::endl;
+        std::cerr << "  +timeout=<cycles>    Give up after this many cycles without progress (default 1000000)" << std::endl;
+        std::cerr << "  +csv=<file>          Append a result row to <file>" << std::endl;
+        std::cerr << "  +max_err=<n>         Largest channel difference from the C model allowed (default 0)" << std::endl;
+        exit(1);
+    }
+
+    std::vector<uint8_t> inbuf;
+    std::vector<frame_input> stream;
+    if (!load_stream(argv[1], inbuf, stream))
+        exit(1);
+
+    const std::unique_ptr<VerilatedContext> context(new VerilatedContext);
+    context->debug(0);
+    context->randReset(2);
+    context->commandArgs(argc, argv);
+
+    std::string csv_file, arg;
+    const bool csv = plusarg(context.get(), "csv", csv_file);
+    const double clock_mhz = plusarg(context.get(), "clock_mhz", arg) ? atof(arg.c_str()) : 75.0;
+    const uint32_t seed = plusarg(context.get(), "seed", arg) ? strtoul(arg.c_str(), NULL, 0) : 1;
+    const uint64_t timeout = plusarg(context.get(), "timeout", arg) ? strtoull(arg.c_str(), NULL, 0) : 1000000;
+    const int repeat = plusarg(context.get(), "repeat", arg) && atoi(arg.c_str()) > 0 ? atoi(arg.c_str()) : 1;
+    const int max_err = plusarg(context.get(), "max_err", arg) ? atoi(arg.c_str()) : 0;
+    stall_gen out_stall;
+    if (plusarg(context.get(), "out_stall", arg))
+        out_stall.set_random(atoi(arg.c_str()), seed);
+
+    std::vector<frame_input> frames;
+    for (int r = 0; r < repeat; r++)
+        frames.insert(frames.end(), stream.begin(), stream.end());
+
+    VL_PRINTF("Decoding %zu frames of %s on %d cores%s...\n", frames.size(), argv[1], JPEG_MULTI_CORES,
+              JPEG_MULTI_MERGE ? " (merged output)" : "");
+    multi_stats st;
+    std::vector<frame> outs;
+    const bool ok = run_multi(context.get(), frames, out_stall, timeout, st, outs);
+    int status = ok ? 0 : 1;
+
+    if (ok) {
+        // Overall: first input to last completion. Sustained: from the completion of the
+        // first frame on every core (pipeline full) to the last completion.
+        const size_t n = frames.size();
+        const size_t cores = JPEG_MULTI_CORES;
+        const uint64_t span = st.done[n - 1] - st.first_in + 1;
+        const double fps = clock_mhz * 1e6 * n / span;
+        const double sustained = n > cores ? clock_mhz * 1e6 * (n - cores) / (st.done[n - 1] - st.done[cores - 1]) : fps;
+        uint64_t pixels = 0;
+        for (int c = 0; c < JPEG_MULTI_CORES; c++)
+            pixels += st.pixels[c];
+
+        VL_PRINTF("  cores:               %d\n", JPEG_MULTI_CORES);
+        VL_PRINTF("  frames:              %zu\n", n);
+        VL_PRINTF("  cycles:              %" PRIu64 "\n", span);
+        VL_PRINTF("  pixels per cycle:    %.3f\n", (double)pixels / span);
+        for (int c = 0; c < JPEG_MULTI_CORES; c++)
+            VL_PRINTF("  core %d pixels:       %" PRIu64 "\n", c, st.pixels[c]);
+        VL_PRINTF("  overall fps:         %.2f @ %.1f MHz\n", fps, clock_mhz);
+        VL_PRINTF("  sustained fps:       %.2f\n", sustained);
+
+        if (csv) {
+            FILE *f = fopen(csv_file.c_str(), "a+");
+            if (f == NULL) {
+                std::cerr << "Can not open csv file " << csv_file << std::endl;
+                exit(1);
+            }
+            fseek(f, 0, SEEK_END);
+            if (ftell(f) == 0)
+                fprintf(f, "stream,cores,frames,cycles,pixels_per_cycle,fps,sustained_fps\n");
+            fprintf(f, "%s,%d,%zu,%" PRIu64 ",%.3f,%.2f,%.2f\n", argv[1], JPEG_MULTI_CORES, n, span,
+                    (double)pixels / span, fps, sustained);
+            fclose(f);
+        }
+
+        // Every frame against the C model (each distinct frame of the stream decoded once)
+        jpeg_decoder dec;
+        dec.set_verbose(false);
+        dec.set_fixed_colour(true);
+        size_t matched = 0, skipped = 0, reported = 0;
+        int worst = 0;
+        for (size_t s = 0; s < stream.size(); s++) {
+            frame ref;
+            if (!ref_decode(dec, stream[s], ref)) {
+                skipped += repeat;
+                continue;
+            }
+            for (size_t i = s; i < n; i += stream.size()) {
+                const frame_diff d = frame_compare(outs[i], ref);
+                if (d.size_match && d.max_err > worst)
+                    worst = d.max_err;
+                if (d.size_match && d.max_err <= max_err)
+                    matched++;
+                else if (reported++ < 10)
+                    VL_PRINTF("COMPARE: frame %zu %s\n", i, d.size_match ? "mismatch" : "size mismatch");
+            }
+        }
+        const bool pass = matched + skipped == n;
+        VL_PRINTF("COMPARE: %s %zu of %zu frames match the C model (%zu skipped), max_err=%d\n",
+                  pass ? "PASS" : "FAIL", matched, n - skipped, skipped, worst);
+        if (!pass)
+            status = 2;
+    }
+
+    // Decoded frames (out.ppm -> out_0000.ppm, out_0001.ppm, ...)
+    if (argc > 2 && argv[2][0] != '+') {
+        for (size_t i = 0; i < outs.size(); i++) {
+            char suffix[16];
+            snprintf(suffix, sizeof(suffix), "_%04zu", i);
+            std::string name(argv[2]);
+            const size_t dot = name.rfind('.');
+            name = dot == std::string::npos ? name + suffix : name.substr(0, dot) + suffix + name.substr(dot);
+            if (outs[i].width * outs[i].height != 0 && !frame_save_ppm(name.c_str(), outs[i])) {
+                std::cerr << "Can not open ppm file " << name << std::endl;
+                exit(1);
+            }
+        }
+    }
+
+    // 0: decoded and matched the C model, 1: error / timeout, 2: mismatch
+    return status;
+}
@@ -0,0 +1,31 @@
+#!/bin/sh
+# Cycle benchmark: run each image through the Verilated core, collecting
+# per image statistics in <csv> and a per mode summary in <csv>.modes.csv
+# Usage: ./run_bench.sh results.csv image.jpg [image.jpg ...]
+#        SIM=build/jpeg_decode_in64 ./run_bench.sh results_in64.csv image.jpg ...
+#        SIM=build/jpeg_decode_dual ./run_bench.sh results_dual.csv image.jpg ...
+#        SIM=build/jpeg_decode_in64_dual ./run_bench.sh results_in64_dual.csv image.jpg ...
+SIM=${SIM:-./build/jpeg_decode}
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 results.csv image.jpg [image.jpg ...]"
+    exit 1
+fi
+
+CSV=$1
+shift
+rm -f $CSV
+
+for img in "$@"; do
+    $SIM $img /dev/null +csv=$CSV > /dev/null || exit 1
+done
+
+# Mean cycles per pixel / per 8x8 block by mode, against the README figures
+awk -F, 'NR > 1 { n[$2]++; cpp[$2] += $11; cpb[$2] += $12 }
+END {
+    ref["mono"] = 66; ref["420"] = 137; ref["422"] = 134; ref["444"] = 198
+    print "mode,images,cycles_per_pixel,cycles_per_block,readme_cycles_per_block"
+    for (m in n)
+        printf "%s,%d,%.3f,%.2f,%s\n", m, n[m], cpp[m] / n[m], cpb[m] / n[m], ref[m]
+}' $CSV > $CSV.modes.csv
+
+cat $CSV.modes.csv
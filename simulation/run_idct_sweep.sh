@@ -0,0 +1,106 @@
+#!/bin/sh
+# IDCT variant sweep: run the same corpus through a jpeg_core build per IDCT
+# variant (build/jpeg_decode_<variant>) and tabulate cycles/pixel, accuracy
+# against the C model built with the same IDCT (../c_model/jpeg_<variant>) and
+# an estimate of the IDCT resources side by side.
+# Usage: ./run_idct_sweep.sh [-j jobs] [-o out_dir] [-v "chen ifast"] image.jpg|dir ...
+BUILD=${BUILD:-build}
+JOBS=$(nproc 2>/dev/null || echo 4)
+OUT=idct_sweep_out
+VARIANTS="chen ifast"
+
+while getopts "j:o:v:" opt; do
+    case $opt in
+        j) JOBS=$OPTARG ;;
+        o) OUT=$OPTARG ;;
+        v) VARIANTS=$OPTARG ;;
+        *) echo "Usage: $0 [-j jobs] [-o out_dir] [-v \"chen ifast\"] image.jpg|dir ..."; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 [-j jobs] [-o out_dir] [-v \"chen ifast\"] image.jpg|dir ..."
+    exit 1
+fi
+
+# Row / column modules of each variant (jpeg_idct.v USE_IDCT_IFAST)
+variant_files() {
+    case $1 in
+        chen)  echo "../src_v/jpeg_idct_x.v ../src_v/jpeg_idct_y.v" ;;
+        ifast) echo "../src_v/jpeg_idct_ifast_x.v ../src_v/jpeg_idct_ifast_y.v" ;;
+    esac
+}
+# C model build options of each variant (c_model/makefile IDCT=)
+variant_cmodel() {
+    case $1 in
+        chen)  echo "" ;;
+        ifast) echo "IDCT=IFAST" ;;
+    esac
+}
+variant_params() {
+    case $1 in
+        chen)  echo "-chparam USE_IDCT_IFAST 0" ;;
+        ifast) echo "-chparam USE_IDCT_IFAST 1" ;;
+    esac
+}
+
+rm -rf $OUT
+mkdir -p $OUT
+echo "variant,images,errors,cycles_per_pixel,exact_images,max_err,mean_psnr,min_psnr,mult_ops,cells" > $OUT/summary.csv
+
+for v in $VARIANTS; do
+    if [ -z "$(variant_files $v)" ]; then
+        echo "Unknown IDCT variant $v (chen or ifast)"
+        exit 1
+    fi
+
+    # Decoder for this variant (not part of the default build)
+    if ! cmake --build $BUILD --target jpeg_decode_$v > $OUT/build_$v.log 2>&1; then
+        echo "Failed to build $BUILD/jpeg_decode_$v (see $OUT/build_$v.log)"
+        exit 1
+    fi
+
+    # C model with the matching IDCT (own object directory, as the IDCT is a compile time option)
+    if ! make -C ../c_model $(variant_cmodel $v) TARGET=jpeg_$v OBJ_DIR=obj_$v/ > $OUT/cmodel_$v.log 2>&1; then
+        echo "Failed to build ../c_model/jpeg_$v (see $OUT/cmodel_$v.log)"
+        exit 1
+    fi
+
+    # Every image is compared, none fail on accuracy alone (PSNR >= 0)
+    echo "== $v"
+    SIM=$BUILD/jpeg_decode_$v CMODEL=../c_model/jpeg_$v ./run_regression.sh -j $JOBS -p 0 -o $OUT/$v "$@" | sed 's/^/   /'
+
+    # Resource estimate: multiply operators in the row / column modules, and generic
+    # cell count of jpeg_idct if yosys is installed
+    mults=$(cat $(variant_files $v) | sed 's#//.*##' | grep -c '[^*/]\*[^*/]')
+    cells=""
+    if command -v yosys > /dev/null 2>&1; then
+        cells=$(yosys -q -p "read_verilog ../src_v/jpeg_idct*.v; hierarchy -top jpeg_idct $(variant_params $v); synth -flatten -top jpeg_idct; stat" 2>/dev/null |
+                sed -n 's/^ *Number of cells: *\([0-9]*\).*$/\1/p' | tail -1)
+    fi
+
+    awk -F, -v variant=$v -v mults=$mults -v cells="$cells" 'NR > 1 && $2 != "SKIP" {
+        if ($2 == "ERROR") { errors++; next }
+        n++; pixels += $4; cycles += $7
+        if ($5 == 0) exact++
+        if ($5 > max_err) max_err = $5
+        if ($6 != "inf") {
+            finite++; psnr += $6
+            if (min_psnr == "" || $6 < min_psnr) min_psnr = $6
+        }
+    }
+    END {
+        printf "%s,%d,%d,%.4f,%d,%d,%s,%s,%d,%s\n", variant, n, errors, pixels ? cycles / pixels : 0, exact, max_err,
+               finite ? sprintf("%.2f", psnr / finite) : "inf", min_psnr == "" ? "inf" : min_psnr, mults, cells
+    }' $OUT/$v/results.csv >> $OUT/summary.csv
+done
+
+echo
+awk -F, 'NR == 1 {
+    printf "%-8s %7s %7s %10s %8s %8s %10s %10s %6s %8s\n", "variant", "images", "errors", "cyc/pixel", "exact",
+           "max_err", "mean_psnr", "min_psnr", "mults", "cells"
+    next
+}
+{ printf "%-8s %7d %7d %10.4f %8d %8d %10s %10s %6d %8s\n", $1, $2, $3, $4, $5, $6, $7, $8, $9, $10 == "" ? "n/a" : $10 }' $OUT/summary.csv
+echo "Per variant results in $OUT/<variant>/results.csv, summary in $OUT/summary.csv"
@@ -0,0 +1,47 @@
+#!/bin/sh
+# Multi-core sweep: decode the same MJPEG stream on jpeg_multi with 1, 2, 3, 4
+# and 8 cores (build/jpeg_multi_<n>) and tabulate aggregate fps against the
+# core count, to size NUM_CORES against FPGA resources.
+# Usage: ./run_multi_sweep.sh [-c "1 2 4"] [-r repeat] [-m clock_mhz] stream.mjpeg|@list
+BUILD=${BUILD:-build}
+CORES="1 2 3 4 8"
+REPEAT=1
+MHZ=75
+OUT=multi_sweep_out
+
+while getopts "c:r:m:" opt; do
+    case $opt in
+        c) CORES=$OPTARG ;;
+        r) REPEAT=$OPTARG ;;
+        m) MHZ=$OPTARG ;;
+        *) echo "Usage: $0 [-c \"1 2 4\"] [-r repeat] [-m clock_mhz] stream.mjpeg|@list"; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -ne 1 ]; then
+    echo "Usage: $0 [-c \"1 2 4\"] [-r repeat] [-m clock_mhz] stream.mjpeg|@list"
+    exit 1
+fi
+
+rm -rf $OUT
+mkdir -p $OUT
+
+for n in $CORES; do
+    # Harness for this core count (not part of the default build)
+    if ! cmake --build $BUILD --target jpeg_multi_$n > $OUT/build_$n.log 2>&1; then
+        echo "Failed to build $BUILD/jpeg_multi_$n (see $OUT/build_$n.log)"
+        exit 1
+    fi
+    if ! $BUILD/jpeg_multi_$n "$1" +repeat=$REPEAT +clock_mhz=$MHZ +csv=$OUT/results.csv > $OUT/run_$n.log; then
+        echo "jpeg_multi_$n failed (see $OUT/run_$n.log)"
+        exit 1
+    fi
+done
+
+# Speed up (of the sustained fps) against the smallest core count run
+awk -F, 'BEGIN { print "cores,frames,cycles,fps,sustained_fps,speedup,efficiency" }
+NR > 1 {
+    if (base == "") { base = $7; base_cores = $2 }
+    printf "%s,%s,%s,%s,%s,%.2f,%.2f\n", $2, $3, $4, $6, $7, $7 / base, $7 / base / ($2 / base_cores)
+}' $OUT/results.csv | tee $OUT/summary.csv
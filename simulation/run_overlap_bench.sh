@@ -0,0 +1,49 @@
+#!/bin/sh
+# Frame overlap benchmark: decode the same MJPEG stream back to back on the
+# default core (each frame waits for idle_o) and on the frame overlap core
+# (build/jpeg_decode_overlap, streamed), and compare the per frame dead
+# cycles (output idle between frames), period and fps.
+# Usage: ./run_overlap_bench.sh [-m clock_mhz] stream.mjpeg|@list
+BUILD=${BUILD:-build}
+MHZ=75
+OUT=overlap_bench_out
+
+while getopts "m:" opt; do
+    case $opt in
+        m) MHZ=$OPTARG ;;
+        *) echo "Usage: $0 [-m clock_mhz] stream.mjpeg|@list"; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -ne 1 ]; then
+    echo "Usage: $0 [-m clock_mhz] stream.mjpeg|@list"
+    exit 1
+fi
+
+rm -rf $OUT
+mkdir -p $OUT
+
+for sim in jpeg_decode jpeg_decode_overlap; do
+    if ! cmake --build $BUILD --target $sim > $OUT/build_$sim.log 2>&1; then
+        echo "Failed to build $BUILD/$sim (see $OUT/build_$sim.log)"
+        exit 1
+    fi
+done
+
+# name,sim,options
+for run in "serial,jpeg_decode," "overlap_wait,jpeg_decode_overlap,+wait_idle" "overlap,jpeg_decode_overlap,"; do
+    name=${run%%,*}
+    sim=${run#*,}; opts=${sim#*,}; sim=${sim%%,*}
+    if ! $BUILD/$sim "$1" $OUT/$name.ppm $opts +clock_mhz=$MHZ +csv=$OUT/$name.csv > $OUT/$name.log; then
+        echo "$sim $opts failed (see $OUT/$name.log)"
+        exit 1
+    fi
+done
+
+# Means over frames 1..n-1 (frame 0 has no predecessor)
+for name in serial overlap_wait overlap; do
+    awk -F, -v name=$name -v mhz=$MHZ 'NR > 2 { n++; dead += $10; period += $9 }
+    END { printf "%s,%d,%.1f,%.1f,%.2f\n", name, n, dead / n, period / n, mhz * 1e6 * n / period }' $OUT/$name.csv
+done | awk -F, 'BEGIN { print "run,frames,mean_dead_cycles,mean_period_cycles,sustained_fps,speedup" }
+{ if (NR == 1) base = $5; printf "%s,%.2f\n", $0, $5 / base }' | tee $OUT/summary.csv
@@ -0,0 +1,113 @@
+#!/bin/sh
+# Co-simulation regression: decode each JPEG with the Verilated core and the
+# C model (in parallel across cores) and compare the outputs.
+# Usage: ./run_regression.sh [-j jobs] [-e max_err | -p min_psnr] [-o out_dir] image.jpg|dir ...
+SIM=${SIM:-./build/jpeg_decode}
+
+# C model with the same IDCT as the core: jpeg_decode_ifast needs a C model
+# built with IDCT=IFAST, everything else uses the default (Chen) IDCT
+if [ -z "$CMODEL" ]; then
+    case $(basename $SIM) in
+        *_ifast) CMODEL=../c_model/jpeg_ifast ;;
+        *)       CMODEL=../c_model/jpeg ;;
+    esac
+fi
+export SIM CMODEL
+
+#-----------------------------------------------------------------------------
+# Single image (invoked through xargs): result line in <out_dir>/<name>.result
+#-----------------------------------------------------------------------------
+if [ "$1" = "--one" ]; then
+    img=$2
+    out=$3
+    shift 3
+    name=$(echo "$img" | sed 's#[^A-Za-z0-9]#_#g')
+
+    if ! $CMODEL -x "$img" "$out/$name.ref.ppm" > "$out/$name.cmodel.log" 2>&1; then
+        echo "$img,SKIP,,,,,," > "$out/$name.result"
+        exit 0
+    fi
+
+    $SIM "$img" "$out/$name.rtl.ppm" +ref="$out/$name.ref.ppm" "$@" > "$out/$name.rtl.log" 2>&1
+    case $? in
+        0) result=PASS ;;
+        2) result=FAIL ;;
+        *) result=ERROR ;;
+    esac
+
+    log="$out/$name.rtl.log"
+    size=$(sed -n 's/^.*: \([0-9]*\)x\([0-9]*\) (\(.*\)), [0-9]* blocks.*$/\1 \2 \3/p' "$log")
+    cmp=$(sed -n 's/^COMPARE: [A-Z]* max_err=\([0-9]*\) mismatches=[0-9]* psnr=\(.*\)$/\1,\2/p' "$log")
+    sim=$(sed -n 's/^SIM: cycles=\([0-9]*\) seconds=\([0-9.]*\).*$/\1,\2/p' "$log")
+    set -- $size
+    echo "$img,$result,${3:-},$(( ${1:-0} * ${2:-0} )),${cmp:-,},${sim:-,}" > "$out/$name.result"
+    [ $result = PASS ] && rm -f "$out/$name.ref.ppm" "$out/$name.rtl.ppm"
+    exit 0
+fi
+
+#-----------------------------------------------------------------------------
+# Driver
+#-----------------------------------------------------------------------------
+JOBS=$(nproc 2>/dev/null || echo 4)
+OPTS=""
+OUT=regression_out
+
+while getopts "j:e:p:o:" opt; do
+    case $opt in
+        j) JOBS=$OPTARG ;;
+        e) OPTS="$OPTS +max_err=$OPTARG" ;;
+        p) OPTS="$OPTS +min_psnr=$OPTARG" ;;
+        o) OUT=$OPTARG ;;
+        *) echo "Usage: $0 [-j jobs] [-e max_err | -p min_psnr] [-o out_dir] image.jpg|dir ..."; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 [-j jobs] [-e max_err | -p min_psnr] [-o out_dir] image.jpg|dir ..."
+    exit 1
+fi
+if [ ! -x $SIM ]; then
+    echo "Missing $SIM (build simulation/build first)"
+    exit 1
+fi
+if [ ! -x $CMODEL ]; then
+    case $CMODEL in
+        *_ifast) echo "Missing $CMODEL (make -C ../c_model IDCT=IFAST TARGET=jpeg_ifast OBJ_DIR=obj_ifast/)" ;;
+        *)       echo "Missing $CMODEL (build c_model first)" ;;
+    esac
+    exit 1
+fi
+
+rm -rf $OUT
+mkdir -p $OUT
+START=$(date +%s.%N)
+
+for p in "$@"; do
+    if [ -d "$p" ]; then
+        find "$p" -type f \( -iname '*.jpg' -o -iname '*.jpeg' \)
+    else
+        echo "$p"
+    fi
+done | sort -u | xargs -P $JOBS -I{} sh "$0" --one {} $OUT $OPTS
+
+END=$(date +%s.%N)
+
+echo "image,result,mode,pixels,max_err,psnr,cycles,sim_seconds" > $OUT/results.csv
+cat $OUT/*.result >> $OUT/results.csv 2>/dev/null
+rm -f $OUT/*.result
+
+awk -F, -v start=$START -v end=$END 'NR > 1 {
+    n[$2]++
+    if ($2 == "FAIL" || $2 == "ERROR") failed = failed "  " $2 " " $1 " (max_err=" $5 ", psnr=" $6 ")\n"
+    pixels += $4; cycles += $7; sim += $8
+}
+END {
+    wall = end - start
+    total = n["PASS"] + n["FAIL"] + n["ERROR"]
+    printf "Images: %d passed, %d failed, %d errors, %d skipped (not decodable by the C model)\n", n["PASS"], n["FAIL"], n["ERROR"], n["SKIP"]
+    if (failed != "") printf "%s", failed
+    printf "Wall time: %.1f s, %.2f images/s, %.3f MPix/s\n", wall, total / wall, pixels / wall / 1e6
+    if (sim > 0) printf "Simulation: %d cycles in %.1f CPU s (%.1f kHz per job)\n", cycles, sim, cycles / sim / 1e3
+    exit (n["FAIL"] + n["ERROR"]) ? 1 : 0
+}' $OUT/results.csv
@@ -7,19 +7,24 @@
 
 #include <memory>
 #include <iostream>
+#include <vector>
+#include <string>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
+#include <chrono>
 #include <verilated.h>
 
-#define VM_TRACE 1
+#include "jpeg_file.h"
+#include "jpeg_stream.h"
+#include "frame.h"
+#include "stall_gen.h"
+#include "block_trace.h"
+#include "wave_trace.h"
 
 // Include model header, generated from Verilating "jpeg_core.v"
 #include "Vjpeg_core.h"
-
-#if VM_TRACE
-# include <verilated_vcd_c.h>	// Trace file format header
-#endif
+#include "Vjpeg_core___024root.h"   // Internal stage signals (public_flat_rd) for the block trace
 
 vluint64_t main_time = 0;	// Current simulation time (64-bit unsigned)
 
@@ -27,157 +32,622 @@ double sc_time_stamp () {	// Called by $time in Verilog
     return main_time;		// Note does conversion to real, to match SystemC
 }
 
-int main(int argc, char** argv) {
+// Cycle accounting (clk_i cycles after reset)
+struct perf_stats {
+    uint64_t cycle;         // Current cycle
+    uint64_t first_in;      // First cycle with inport_valid_i
+    uint64_t last_in;       // Last input word accepted
+    uint64_t header_end;    // Cycle the first word of scan data was accepted
+    uint64_t first_out;     // First pixel accepted
+    uint64_t last_out;      // Last pixel (inside the image) accepted
+    uint64_t in_stall;      // inport_valid_i && !inport_accept_o
+    uint64_t in_bubble;     // Input data pending but inport_valid_i withheld
+    uint64_t out_stall;     // outport_valid_o && !outport_accept_i
+    uint64_t pixels;        // Including padding pixels past the image edge
+    bool     started;
+    bool     header_done;
+};
 
-    if (argc < 3) {
-        std::cerr << "Should specify jpeg file and output bmp file path" << std::endl;
-        std::cerr << argv[0] << " <jpeg_file> <ppm_file> [verilator_options]" << std::endl;
-        exit(1);
-    }
+// Stall patterns applied to inport_valid_i / outport_accept_i
+struct sim_config {
+    stall_gen in;
+    stall_gen out;
+    uint64_t  timeout;      // Cycles without any handshake before giving up
+    bool      wait_idle;    // Hold each frame back until the previous one is out and idle_o is set
+    wave_trace  *wave;      // Waveform capture (NULL if disabled)
+    block_trace *blocks;    // Per-block stage trace (NULL if disabled)
+};
 
-    FILE *input = fopen(argv[1], "rb");
-    uint8_t *inbuf = NULL;
-    size_t len;
-    if (input != NULL) {
-        fseek(input, 0, SEEK_END);
-        len = ftell(input);
-        fseek(input, 0, SEEK_SET);
-        if (len > 0) {
-            inbuf = new uint8_t[len];
-            if (inbuf != NULL) {
-                fread(inbuf, len, 1, input);
-            }
-        }
-        fclose(input);
-    } else {
-        std::cerr << "Can not open jpeg file " << argv[1] << std::endl;
-        exit(1);
-    }
-
-    FILE *output = fopen(argv[2], "w");
-    if (output != NULL) {
-        fprintf(output, "P6\n");
-    } else {
-        std::cerr << "Can not open ppm file " << argv[2] << std::endl;
-        exit(1);
-    }
-
-    const std::unique_ptr<VerilatedContext> context(new VerilatedContext);
-    context->debug(0);
-    context->randReset(2);
-    context->commandArgs(argc, argv);
+//-----------------------------------------------------------------------------
+// run_frames: Reset a fresh model instance and decode the frames through it
+//             back to back, without a reset in between. Each frame starts on
+//             a word boundary. Output pixels are assigned to frames by count
+//             (whole 8x8 blocks, or width x height in raster order, see
+//             jpeg_file_out_pixels).
+//-----------------------------------------------------------------------------
+static bool run_frames(VerilatedContext *context, const std::vector<frame_input> &frames, sim_config &cfg,
+                       std::vector<perf_stats> &stats, std::vector<frame> &outs) {
     // Construct the Verilated model, from Vjpeg_core.h generated from Verilating "jpeg_core.v"
-    const std::unique_ptr<Vjpeg_core> decoder(new Vjpeg_core(context.get(), "JPEG_DECODER"));
-
+    const std::unique_ptr<Vjpeg_core> decoder(new Vjpeg_core(context, "JPEG_DECODER"));
 
-#if VM_TRACE			// If verilator was invoked with --trace
-     context->traceEverOn(true);
-    VerilatedVcdC* tfp = new VerilatedVcdC;
-    decoder->trace (tfp, 99);	// Trace 99 levels of hierarchy, should be enough
-    tfp->open ("decoder.vcd");	// Open the dump file
-#endif
+    if (cfg.wave)
+        cfg.wave->reset();
 
     decoder->rst_i = !0;
     decoder->clk_i = 0;
     decoder->inport_valid_i = !1;
     decoder->outport_accept_i = !1;
     decoder->inport_last_i = !1;
+    decoder->dc_only_i = JPEG_DC_ONLY;
 
-    size_t read = 0;
-    size_t out_width, out_height, out_size = 0;
-    uint8_t *out_r, *out_g, *out_b;
+    stats.resize(frames.size());
+    outs.resize(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        memset(&stats[i], 0, sizeof(stats[i]));
+        outs[i].width = outs[i].height = 0;
+    }
+    cfg.in.reset();
+    cfg.out.reset();
 
-    VL_PRINTF("Decoding %s...\n", argv[1]);
-    // Simulate until $finish
-    while (!context->gotFinish()) {
+    const vluint64_t reset_end = context->time() + 10;
+    uint64_t cycle = 0;
+    uint64_t last_progress = 0;
+    size_t in_frame = 0;        // Frame being input
+    size_t read = 0;            // Offset into that frame
+    bool in_pending = false;    // Frame data is being presented
+    size_t out_frame = 0;       // Frame being output
+    int64_t idct_blocks = 0;
+    bool done = false;
+
+    // Simulate until $finish or the last pixel (and the rest of its block if tracing)
+    while (!context->gotFinish() && !(done && !(cfg.blocks && cfg.blocks->pixels_pending()))) {
         context->timeInc(1);
         decoder->clk_i = !decoder->clk_i;
         main_time++;
 
-        if (decoder->clk_i) {
-            if (context->time() < 10) {
-                decoder->rst_i = !0; // Assert reset
-            } else {
-                decoder->rst_i = !1; // Deassert reset
-                decoder->outport_accept_i = !0;
+        bool in_fire = false;
+        bool out_fire = false;
+        if (decoder->clk_i && !decoder->rst_i) {
+            cycle++;
+
+            // Handshakes completing on this edge (inputs settled by the previous eval)
+            in_fire = decoder->inport_valid_i && decoder->inport_accept_o && in_pending;
+            if (in_pending) {
+                perf_stats &fs = stats[in_frame];
+                if (decoder->inport_valid_i && !fs.started) {
+                    fs.started = true;
+                    fs.first_in = cycle;
+                }
+                if (decoder->inport_valid_i && !decoder->inport_accept_o)
+                    fs.in_stall++;
+                if (!decoder->inport_valid_i && fs.started)
+                    fs.in_bubble++;
+            }
+
+            // Stage outputs for the block trace
+            if (cfg.blocks) {
+                const Vjpeg_core___024root *root = decoder->rootp;
+                cfg.blocks->dqt(root->jpeg_core__DOT__idct_inport_valid_w, root->jpeg_core__DOT__idct_inport_eob_w,
+                                (int16_t)root->jpeg_core__DOT__idct_outport_data_w,
+                                root->jpeg_core__DOT__idct_inport_idx_w, root->jpeg_core__DOT__idct_inport_id_w);
+                cfg.blocks->idct(root->jpeg_core__DOT__output_inport_valid_w && root->jpeg_core__DOT__output_inport_accept_w,
+                                 (int32_t)root->jpeg_core__DOT__output_outport_data_w,
+                                 root->jpeg_core__DOT__output_inport_idx_w, root->jpeg_core__DOT__output_inport_id_w);
+                // Pixel blocks are only traced in block order, at full scale
+                if (!JPEG_RASTER_OUTPUT && !JPEG_DC_ONLY)
+                    cfg.blocks->pixel(decoder->outport_valid_o && decoder->outport_accept_i,
+                                      decoder->outport_pixel_x_o, decoder->outport_pixel_y_o, decoder->outport_pixel_r_o,
+                                      decoder->outport_pixel_g_o, decoder->outport_pixel_b_o);
+            }
+
+            // Waveform triggers (a pixel output, or a block entering the IDCT)
+            if (cfg.wave) {
+                const Vjpeg_core___024root *root = decoder->rootp;
+                if (root->jpeg_core__DOT__idct_inport_eob_w && (root->jpeg_core__DOT__idct_inport_id_w >> 30) != 3 &&
+                    idct_blocks++ == cfg.wave->config().block)
+                    cfg.wave->trigger();
+                if (decoder->outport_valid_o && decoder->outport_accept_i &&
+                    decoder->outport_pixel_x_o == cfg.wave->config().pixel_x &&
+                    decoder->outport_pixel_y_o == cfg.wave->config().pixel_y)
+                    cfg.wave->trigger();
+            }
+
+            // Once done, only the remainder of a traced pixel block is collected
+            out_fire = !done && decoder->outport_valid_o && decoder->outport_accept_i;
+            if (!done && decoder->outport_valid_o && !decoder->outport_accept_i)
+                stats[out_frame].out_stall++;
+            if (out_fire) { // Caputure output data
+                perf_stats &fs = stats[out_frame];
+                frame &out = outs[out_frame];
+                // Second pixel (x + 1) of a raster order beat
+                const size_t n = 1 + (JPEG_RASTER_OUTPUT && decoder->outport_pixel2_valid_o);
+                if (fs.pixels == 0) {
+                    fs.first_out = cycle;
+                    out.resize(decoder->outport_width_o, decoder->outport_height_o);
+                }
+                fs.pixels += n;
+                // Padding pixels of the right / bottom edge blocks are not stored
+                const size_t x = decoder->outport_pixel_x_o;
+                const size_t y = decoder->outport_pixel_y_o;
+                if (x < out.width && y < out.height) {
+                    const size_t pos = y * out.width + x;
+                    out.r[pos] = decoder->outport_pixel_r_o;
+                    out.g[pos] = decoder->outport_pixel_g_o;
+                    out.b[pos] = decoder->outport_pixel_b_o;
+                    if (n == 2) {
+                        out.r[pos + 1] = decoder->outport_pixel2_r_o;
+                        out.g[pos + 1] = decoder->outport_pixel2_g_o;
+                        out.b[pos + 1] = decoder->outport_pixel2_b_o;
+                    }
+                    fs.last_out = cycle;
+                }
+                if (out_frame + 1 == frames.size()) {
+                    if (x + n == out.width && y + 1 == out.height) {
+                        if (cfg.wave)
+                            VL_PRINTF("[%" PRId64 "] postion=%dX%d, exiting...\n",
+                                context->time(), decoder->outport_pixel_x_o + 1, decoder->outport_pixel_y_o + 1);
+                        done = true;
+                    }
+                } else if (fs.pixels == jpeg_file_out_pixels(frames[out_frame].info))
+                    out_frame++;
+            }
+
+            // Watchdog
+            if (in_fire || out_fire)
+                last_progress = cycle;
+            else if (cfg.timeout && cycle - last_progress > cfg.timeout) {
+                VL_PRINTF("ERROR: No progress for %" PRIu64 " cycles (frame %zu, %" PRIu64 " pixels output)\n",
+                          cfg.timeout, out_frame, stats[out_frame].pixels);
+                break;
             }
         }
 
+        // Open / close the waveform window (reset is cycle 0)
+        if (cfg.wave && decoder->clk_i)
+            cfg.wave->cycle(decoder.get(), cycle);
+
+        if (decoder->clk_i)
+            decoder->rst_i = context->time() < reset_end; // Reset for the first few cycles
+
         // Evaluate model
         decoder->eval();
 
-#if VM_TRACE
-	    if (tfp) {
-            tfp->dump(main_time);	// Create waveform trace for this timestamp
-        }
-#endif
+        if (cfg.wave)
+            cfg.wave->dump(main_time);	// Create waveform trace for this timestamp (inside the window)
 
         if (!decoder->rst_i && decoder->clk_i) { // Setup input data
-            if (read < len) {
-                uint32_t in_data = (inbuf[read + 3] << 24) | (inbuf[read + 2] << 16) | (inbuf[read + 1] << 8) | inbuf[read];
-                decoder->inport_data_i = in_data;
-                decoder->inport_strb_i = 0xf;
-                decoder->inport_valid_i = !0;
+            if (in_fire) {
+                perf_stats &fs = stats[in_frame];
+                read += JPEG_INPUT_BYTES;
+                fs.last_in = cycle;
+                if (!fs.header_done && read > frames[in_frame].info.scan_offset) {
+                    fs.header_done = true;
+                    fs.header_end = cycle;
+                }
+            }
+
+            // Move on to the next frame (once the core has finished the last one, if waiting)
+            if (in_frame + 1 < frames.size() && read >= frames[in_frame].len &&
+                (!cfg.wait_idle || (out_frame > in_frame && decoder->idle_o))) {
+                in_frame++;
+                read = 0;
+            }
+
+            const frame_input &fi = frames[in_frame];
+            in_pending = read < fi.len;
+            if (in_pending) {
+                decoder->inport_data_i = jpeg_input_pack(fi.data, fi.len, read);
+                decoder->inport_strb_i = JPEG_INPUT_STRB;
+                decoder->inport_valid_i = !cfg.in.stall();
                 decoder->inport_last_i = !1;
             } else {
+                // Keep valid high so the core can drain the last word
+                decoder->inport_valid_i = !0;
                 decoder->inport_last_i = !0;
             }
-            if (decoder->inport_accept_o && read < len) {
-                read += sizeof(uint32_t);
-            }
-        }
 
-        if (!decoder->rst_i && !decoder->clk_i) {
-            if (decoder->outport_valid_o) { // Caputure output data
-                if (out_size == 0) {
-                    out_width = decoder->outport_width_o;
-                    out_height = decoder->outport_height_o;
-                    out_size = out_width * out_height;
-                    out_r = new uint8_t[out_size];
-                    out_g = new uint8_t[out_size];
-                    out_b = new uint8_t[out_size];
-                }
-                const size_t pos = decoder->outport_pixel_y_o * out_width + decoder->outport_pixel_x_o;
-                out_r[pos] = decoder->outport_pixel_r_o;
-                out_g[pos] = decoder->outport_pixel_g_o;
-                out_b[pos] = decoder->outport_pixel_b_o;
-                if (pos == (out_size - 1)) {
-                    VL_PRINTF("[%" PRId64 "] postion=%dX%d, exiting...\n",
-                        context->time(), decoder->outport_pixel_x_o + 1, decoder->outport_pixel_y_o + 1);
-                    break;
-                }
-            }
+            decoder->outport_accept_i = !cfg.out.stall();
         }
     }
 
     // Final model cleanup
     decoder->final();
 
-    // Save decoded raster data to ppm file
-    if (output != NULL && out_size != 0) {
-        fprintf(output, "%d %d\n", (int)out_width, (int)out_height);
-        fprintf(output, "255\n");
-        for (size_t y = 0; y < out_height; ++y) {
-            size_t pos = y * out_width;
-            for (size_t x = 0; x < out_width; ++x) {
-                putc(out_r[pos], output);
-                putc(out_g[pos], output);
-                putc(out_b[pos], output);
-                pos++;
+    if (cfg.wave)
+        cfg.wave->close();
+
+    for (size_t i = 0; i < stats.size(); i++)
+        stats[i].cycle = cycle;
+    return done;
+}
+
+// Single image
+static bool run_image(VerilatedContext *context, const frame_input &image, sim_config &cfg,
+                      perf_stats &st, frame &out) {
+    std::vector<frame_input> frames(1, image);
+    std::vector<perf_stats> stats;
+    std::vector<frame> outs;
+    const bool done = run_frames(context, frames, cfg, stats, outs);
+    st = stats[0];
+    std::swap(out, outs[0]);
+    return done;
+}
+
+//-----------------------------------------------------------------------------
+// print_stats / write_csv: Cycle statistics
+//-----------------------------------------------------------------------------
+static void print_stats(const char *image, const jpeg_file_info &info, const perf_stats &st) {
+    const uint64_t total  = st.last_out - st.first_in + 1;
+    const uint64_t header = st.header_end - st.first_in;
+    const size_t   blocks = jpeg_file_blocks(info);
+    VL_PRINTF("%s: %dx%d (%s), %zu blocks, %d-bit input\n", image, info.width, info.height,
+              jpeg_file_mode_name(info.mode), blocks, JPEG_INPUT_WIDTH);
+    VL_PRINTF("  total cycles:        %" PRIu64 "\n", total);
+    VL_PRINTF("  header cycles:       %" PRIu64 "\n", header);
+    VL_PRINTF("  input stall cycles:  %" PRIu64 "\n", st.in_stall);
+    VL_PRINTF("  input bubble cycles: %" PRIu64 "\n", st.in_bubble);
+    VL_PRINTF("  output stall cycles: %" PRIu64 "\n", st.out_stall);
+    VL_PRINTF("  first pixel latency: %" PRIu64 "\n", st.first_out - st.first_in);
+    VL_PRINTF("  cycles/pixel:        %.3f\n", (double)total / ((double)info.width * info.height));
+    VL_PRINTF("  cycles/8x8 block:    %.2f (excluding header)\n", (double)(total - header) / blocks);
+}
+
+// Append one result row to a CSV file (header written if the file is new)
+static void write_csv(const char *filename, const char *image, const jpeg_file_info &info,
+                      const perf_stats &st) {
+    FILE *f = fopen(filename, "a+");
+    if (f == NULL) {
+        std::cerr << "Can not open csv file " << filename << std::endl;
+        return;
+    }
+    fseek(f, 0, SEEK_END);
+    if (ftell(f) == 0)
+        fprintf(f, "image,mode,width,height,blocks,total_cycles,header_cycles,input_stall_cycles,"
+                   "output_stall_cycles,latency_cycles,cycles_per_pixel,cycles_per_block\n");
+
+    const uint64_t total  = st.last_out - st.first_in + 1;
+    const uint64_t header = st.header_end - st.first_in;
+    const size_t   blocks = jpeg_file_blocks(info);
+    fprintf(f, "%s,%s,%d,%d,%zu,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.3f,%.2f\n",
+            image, jpeg_file_mode_name(info.mode), info.width, info.height, blocks,
+            total, header, st.in_stall, st.out_stall, st.first_out - st.first_in,
+            (double)total / ((double)info.width * info.height),
+            (double)(total - header) / blocks);
+    fclose(f);
+}
+
+//-----------------------------------------------------------------------------
+// run_sweep: Throughput against random stall rate on the input, the output
+//            and both (printed as CSV)
+//-----------------------------------------------------------------------------
+static bool run_sweep(VerilatedContext *context, const frame_input &image, int step, int max_rate,
+                      uint32_t seed, uint64_t timeout) {
+    static const char *targets[] = { "input", "output", "both" };
+    perf_stats st;
+    frame out;
+    uint64_t base_cycles = 0;
+
+    VL_PRINTF("target,stall_pct,total_cycles,pixels_per_cycle,relative_throughput,input_stall_cycles,input_bubble_cycles,output_stall_cycles\n");
+    for (int t = 0; t < 3; t++) {
+        for (int rate = 0; rate <= max_rate; rate += step) {
+            // Unstalled baseline is the same for every target
+            if (rate == 0 && t != 0)
+                continue;
+
+            sim_config cfg;
+            cfg.wave = NULL;
+            cfg.blocks = NULL;
+            cfg.timeout = timeout;
+            cfg.wait_idle = true;
+            if (t != 1)
+                cfg.in.set_random(rate, seed);
+            if (t != 0)
+                cfg.out.set_random(rate, seed + 1);
+
+            if (!run_image(context, image, cfg, st, out))
+                return false;
+
+            const uint64_t total = st.last_out - st.first_in + 1;
+            if (rate == 0)
+                base_cycles = total;
+            VL_PRINTF("%s,%d,%" PRIu64 ",%.4f,%.3f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+                      rate == 0 ? "none" : targets[t], rate, total,
+                      (double)st.pixels / total, (double)base_cycles / total,
+                      st.in_stall, st.in_bubble, st.out_stall);
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// print_frames / write_frames_csv: Back-to-back statistics. A frame's period
+// is the time between its last pixel and the previous frame's last pixel;
+// dead cycles are the output idle cycles between two frames.
+//-----------------------------------------------------------------------------
+struct frame_timing {
+    uint64_t latency;       // First input to last pixel
+    uint64_t first_pixel;   // First input to first pixel
+    uint64_t period;        // Last pixel to last pixel (latency for frame 0)
+    uint64_t dead;          // Output idle cycles since the previous frame
+    uint64_t in_gap;        // Input idle cycles since the previous frame
+};
+
+static frame_timing get_timing(const std::vector<perf_stats> &stats, size_t i) {
+    const perf_stats &st = stats[i];
+    frame_timing t;
+    t.latency     = st.last_out - st.first_in + 1;
+    t.first_pixel = st.first_out - st.first_in;
+    t.period      = i ? st.last_out - stats[i - 1].last_out : t.latency;
+    t.dead        = i ? st.first_out - stats[i - 1].last_out - 1 : 0;
+    t.in_gap      = i ? st.first_in - stats[i - 1].last_in - 1 : 0;
+    return t;
+}
+
+static void print_frames(const std::vector<frame_input> &frames, const std::vector<perf_stats> &stats,
+                         double clock_mhz) {
+    uint64_t period = 0, dead = 0, latency = 0;
+    VL_PRINTF("frame  size        mode  latency  first_pixel  dead  input_gap\n");
+    for (size_t i = 0; i < frames.size(); i++) {
+        const jpeg_file_info &info = frames[i].info;
+        const frame_timing t = get_timing(stats, i);
+        VL_PRINTF("%5zu  %4dx%-6d %-5s %8" PRIu64 " %12" PRIu64 " %5" PRIu64 " %10" PRIu64 "\n",
+                  i, info.width, info.height, jpeg_file_mode_name(info.mode),
+                  t.latency, t.first_pixel, t.dead, t.in_gap);
+        latency += t.latency;
+        if (i) {
+            period += t.period;
+            dead += t.dead;
+        }
+    }
+
+    const size_t n = frames.size();
+    const uint64_t span = stats[n - 1].last_out - stats[0].first_in + 1;
+    VL_PRINTF("  frames:              %zu\n", n);
+    VL_PRINTF("  mean latency:        %.1f cycles\n", (double)latency / n);
+    VL_PRINTF("  mean period:         %.1f cycles\n", (double)period / (n - 1));
+    VL_PRINTF("  mean dead cycles:    %.1f\n", (double)dead / (n - 1));
+    VL_PRINTF("  sustained fps:       %.2f @ %.1f MHz\n", clock_mhz * 1e6 * (n - 1) / period, clock_mhz);
+    VL_PRINTF("  overall fps:         %.2f (%" PRIu64 " cycles for all frames)\n",
+              clock_mhz * 1e6 * n / span, span);
+}
+
+static void write_frames_csv(const char *filename, const char *stream, const std::vector<frame_input> &frames,
+                             const std::vector<perf_stats> &stats, double clock_mhz) {
+    FILE *f = fopen(filename, "a+");
+    if (f == NULL) {
+        std::cerr << "Can not open csv file " << filename << std::endl;
+        return;
+    }
+    fseek(f, 0, SEEK_END);
+    if (ftell(f) == 0)
+        fprintf(f, "stream,frame,mode,width,height,blocks,latency_cycles,first_pixel_cycles,period_cycles,"
+                   "dead_cycles,input_gap_cycles,input_stall_cycles,output_stall_cycles,fps\n");
+
+    for (size_t i = 0; i < frames.size(); i++) {
+        const jpeg_file_info &info = frames[i].info;
+        const frame_timing t = get_timing(stats, i);
+        fprintf(f, "%s,%zu,%s,%d,%d,%zu,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+                   ",%" PRIu64 ",%.2f\n",
+                stream, i, jpeg_file_mode_name(info.mode), info.width, info.height, jpeg_file_blocks(info),
+                t.latency, t.first_pixel, t.period, t.dead, t.in_gap, stats[i].in_stall, stats[i].out_stall,
+                clock_mhz * 1e6 / t.period);
+    }
+    fclose(f);
+}
+
+// Output file for frame n of a multi-frame run: out.ppm -> out_0003.ppm
+static std::string frame_file(const char *filename, size_t n) {
+    std::string name(filename);
+    const size_t dot = name.rfind('.');
+    const size_t slash = name.rfind('/');
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), "_%04zu", n);
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return name + suffix;
+    return name.substr(0, dot) + suffix + name.substr(dot);
+}
+
+// Plusarg value (copied, as the returned buffer is reused between calls)
+static bool plusarg(VerilatedContext *context, const char *name, std::string &value) {
+    const std::string match = std::string(name) + "=";
+    const char *arg = context->commandArgsPlusMatch(match.c_str());
+    if (!arg || !arg[0])
+        return false;
+    value = arg + 1 + match.size();
+    return true;
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 3) {
+        std::cerr << "Should specify jpeg file and output bmp file path" << std::endl;
+        std::cerr << argv[0] << " <jpeg_file> <ppm_file> [options] [verilator_options]" << std::endl;
+        std::cerr << "  <jpeg_file> may be an MJPEG stream / concatenated JPEGs, or @list (one JPEG per line)," << std::endl;
+        std::cerr << "  decoded back to back without a reset (frame n is written to <ppm_file>_<nnnn>.ppm)" << std::endl;
+        std::cerr << "  +csv=<file>          Append cycle statistics to a CSV file" << std::endl;
+        std::cerr << "  +ref=<ppm>           Compare output against a reference image (e.g. from the C model)" << std::endl;
+        std::cerr << "  +max_err=<n>         Compare: largest channel difference allowed (default 0)" << std::endl;
+        std::cerr << "  +min_psnr=<db>       Compare: pass if PSNR >= db instead of using +max_err" << std::endl;
+        std::cerr << "  +timeout=<cycles>    Give up after this many cycles without progress (default 1000000)" << std::endl;
+        std::cerr << "  +trace               Write a waveform (decoder.vcd / .fst, needs cmake -DTRACE=VCD|FST)" << std::endl;
+        std::cerr << "  +trace_file=<file>   Waveform file name (implies +trace, as do the options below)" << std::endl;
+        std::cerr << "  +trace_depth=<n>     Hierarchy levels to trace (default 99)" << std::endl;
+        std::cerr << "  +trace_start=<cycle> Start tracing at this cycle" << std::endl;
+        std::cerr << "  +trace_end=<cycle>   Stop tracing at this cycle" << std::endl;
+        std::cerr << "  +trace_pixel=<x>,<y> Start tracing when this pixel is output" << std::endl;
+        std::cerr << "  +trace_block=<n>     Start tracing when block n (decode order) enters the IDCT" << std::endl;
+        std::cerr << "  +trace_cycles=<n>    Trace for n cycles from the start / trigger" << std::endl;
+        std::cerr << "  +block_trace=<file>  Write a per-block DQT / IDCT / pixel trace (compare with trace_diff)" << std::endl;
+        std::cerr << "  +seed=<n>            Seed for random stalls (default 1)" << std::endl;
+        std::cerr << "  +in_stall=<pct>      Randomly withhold inport_valid_i <pct>% of cycles" << std::endl;
+        std::cerr << "  +out_stall=<pct>     Randomly drop outport_accept_i <pct>% of cycles" << std::endl;
+        std::cerr << "  +in_profile=<p>      Repeating valid pattern, e.g. 1110 (1=valid, 0=bubble), or @file" << std::endl;
+        std::cerr << "  +out_profile=<p>     Repeating accept pattern (1=accept, 0=stall), or @file" << std::endl;
+        std::cerr << "  +stream_frames       Send each frame straight after the previous one instead of waiting for idle_o" << std::endl;
+        std::cerr << "  +wait_idle           Frame overlap core: wait for idle_o between frames (default is to stream)" << std::endl;
+        std::cerr << "  +clock_mhz=<f>       Clock used for the frame rate (default 75)" << std::endl;
+        std::cerr << "  +sweep=<step>        Sweep random stall rate 0..+sweep_max (default 90) in <step>% steps" << std::endl;
+        exit(1);
+    }
+
+    std::vector<uint8_t> inbuf;
+    std::vector<frame_input> frames;
+    if (!load_stream(argv[1], inbuf, frames))
+        exit(1);
+
+    const std::unique_ptr<VerilatedContext> context(new VerilatedContext);
+    context->debug(0);
+    context->randReset(2);
+    context->commandArgs(argc, argv);
+
+    // Options
+    std::string csv_file, arg;
+    const bool csv = plusarg(context.get(), "csv", csv_file);
+    const double clock_mhz = plusarg(context.get(), "clock_mhz", arg) ? atof(arg.c_str()) : 75.0;
+    const uint32_t seed = plusarg(context.get(), "seed", arg) ? strtoul(arg.c_str(), NULL, 0) : 1;
+
+    sim_config cfg;
+    cfg.wave = NULL;
+    cfg.blocks = NULL;
+    cfg.timeout = plusarg(context.get(), "timeout", arg) ? strtoull(arg.c_str(), NULL, 0) : 1000000;
+    if (JPEG_FRAME_OVERLAP)
+        cfg.wait_idle = context->commandArgsPlusMatch("wait_idle")[0] != 0;
+    else
+        cfg.wait_idle = context->commandArgsPlusMatch("stream_frames")[0] == 0;
+    if (plusarg(context.get(), "in_stall", arg))
+        cfg.in.set_random(atoi(arg.c_str()), seed);
+    if (plusarg(context.get(), "out_stall", arg))
+        cfg.out.set_random(atoi(arg.c_str()), seed + 1);
+    if (plusarg(context.get(), "in_profile", arg) && !cfg.in.set_profile(arg.c_str())) {
+        std::cerr << "Bad input stall profile " << arg << std::endl;
+        exit(1);
+    }
+    if (plusarg(context.get(), "out_profile", arg) && !cfg.out.set_profile(arg.c_str())) {
+        std::cerr << "Bad output stall profile " << arg << std::endl;
+        exit(1);
+    }
+
+    // Waveform capture: off unless a +trace option is given
+    wave_config wave_cfg;
+    wave_cfg.enable = context->commandArgsPlusMatch("trace")[0] != 0;
+    wave_cfg.file = plusarg(context.get(), "trace_file", arg) ? arg : wave_config::default_file();
+    if (plusarg(context.get(), "trace_depth", arg))
+        wave_cfg.depth = atoi(arg.c_str());
+    if (plusarg(context.get(), "trace_start", arg))
+        wave_cfg.start = strtoull(arg.c_str(), NULL, 0);
+    if (plusarg(context.get(), "trace_end", arg))
+        wave_cfg.end = strtoull(arg.c_str(), NULL, 0);
+    if (plusarg(context.get(), "trace_cycles", arg))
+        wave_cfg.cycles = strtoull(arg.c_str(), NULL, 0);
+    if (plusarg(context.get(), "trace_block", arg))
+        wave_cfg.block = strtoll(arg.c_str(), NULL, 0);
+    if (plusarg(context.get(), "trace_pixel", arg) &&
+        sscanf(arg.c_str(), "%d,%d", &wave_cfg.pixel_x, &wave_cfg.pixel_y) != 2) {
+        std::cerr << "Bad trace pixel " << arg << ", expected <x>,<y>" << std::endl;
+        exit(1);
+    }
+    if (wave_cfg.enable && !wave_config::supported()) {
+        std::cerr << "Built without waveform support, reconfigure with cmake -DTRACE=VCD (or FST)" << std::endl;
+        exit(1);
+    }
+    wave_trace wave(wave_cfg);
+    if (wave_cfg.enable) {
+        context->traceEverOn(true);
+        cfg.wave = &wave;
+    }
+
+    if (plusarg(context.get(), "sweep", arg)) {
+        const int step = atoi(arg.c_str()) > 0 ? atoi(arg.c_str()) : 10;
+        const int max_rate = plusarg(context.get(), "sweep_max", arg) ? atoi(arg.c_str()) : 90;
+        VL_PRINTF("Sweeping %s...\n", argv[1]);
+        return run_sweep(context.get(), frames[0], step, max_rate, seed, cfg.timeout) ? 0 : 1;
+    }
+
+    // Per-block stage trace
+    std::string block_file;
+    block_trace blocks;
+    if (plusarg(context.get(), "block_trace", block_file)) {
+        if (!blocks.open(block_file.c_str())) {
+            std::cerr << "Can not create block trace " << block_file << std::endl;
+            exit(1);
+        }
+        cfg.blocks = &blocks;
+    }
+
+    if (frames.size() > 1) {
+        VL_PRINTF("Decoding %zu frames of %s back to back...\n", frames.size(), argv[1]);
+        std::vector<perf_stats> stats;
+        std::vector<frame> outs;
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool done = run_frames(context.get(), frames, cfg, stats, outs);
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        blocks.close();
+        VL_PRINTF("SIM: cycles=%" PRIu64 " seconds=%.3f khz=%.1f\n", stats[0].cycle, secs, stats[0].cycle / secs / 1e3);
+
+        if (done) {
+            print_frames(frames, stats, clock_mhz);
+            if (csv)
+                write_frames_csv(csv_file.c_str(), argv[1], frames, stats, clock_mhz);
+        }
+        for (size_t i = 0; i < outs.size(); i++) {
+            const std::string name = frame_file(argv[2], i);
+            if (outs[i].width * outs[i].height != 0 && !frame_save_ppm(name.c_str(), outs[i])) {
+                std::cerr << "Can not open ppm file " << name << std::endl;
+                exit(1);
             }
         }
-        fclose(output);
+        return done ? 0 : 1;
+    }
+
+    // Reference image for comparison
+    std::string ref_file;
+    frame ref;
+    const bool compare = plusarg(context.get(), "ref", ref_file);
+    if (compare && !frame_load_ppm(ref_file.c_str(), ref)) {
+        std::cerr << "Can not read reference ppm file " << ref_file << std::endl;
+        exit(1);
+    }
+    const int max_err = plusarg(context.get(), "max_err", arg) ? atoi(arg.c_str()) : 0;
+    const double min_psnr = plusarg(context.get(), "min_psnr", arg) ? atof(arg.c_str()) : -1;
+
+    VL_PRINTF("Decoding %s...\n", argv[1]);
+    perf_stats st;
+    frame out;
+    const auto t0 = std::chrono::steady_clock::now();
+    const jpeg_file_info &info = frames[0].info;
+    const bool done = run_image(context.get(), frames[0], cfg, st, out);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    blocks.close();
+    VL_PRINTF("SIM: cycles=%" PRIu64 " seconds=%.3f khz=%.1f\n", st.cycle, secs, st.cycle / secs / 1e3);
+
+    // Cycle statistics
+    if (st.pixels != 0) {
+        print_stats(argv[1], info, st);
+        if (csv)
+            write_csv(csv_file.c_str(), argv[1], info, st);
+    }
+
+    // Save decoded raster data to ppm file
+    if (out.width * out.height != 0 && !frame_save_ppm(argv[2], out)) {
+        std::cerr << "Can not open ppm file " << argv[2] << std::endl;
+        exit(1);
     }
 
-    // Release memory
-    if (inbuf) delete [] inbuf;
-    if (out_r) delete [] out_r;
-    if (out_g) delete [] out_g;
-    if (out_b) delete [] out_b;
+    int status = done ? 0 : 1;
+    if (compare) {
+        const frame_diff d = frame_compare(out, ref);
+        const bool pass = done && d.size_match &&
+                          (min_psnr >= 0 ? d.psnr >= min_psnr : d.max_err <= max_err);
+        if (!d.size_match)
+            VL_PRINTF("COMPARE: FAIL size %dx%d, reference %dx%d\n",
+                      (int)out.width, (int)out.height, (int)ref.width, (int)ref.height);
+        else
+            VL_PRINTF("COMPARE: %s max_err=%d mismatches=%" PRIu64 " psnr=%.2f\n",
+                      pass ? "PASS" : "FAIL", d.max_err, d.mismatches, d.psnr);
+        if (!pass)
+            status = 2;
+    }
 
-#if VM_TRACE
-     if (tfp) tfp->close();
-#endif
-    // Return good completion status
-    return 0;
+    // 0: decoded (and matched the reference), 1: error / timeout, 2: mismatch
+    return status;
 }
@@ -0,0 +1,86 @@
+// DESCRIPTION: Stall / bubble pattern generator for the AXI-stream ports
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#ifndef STALL_GEN_H
+#define STALL_GEN_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Decides, cycle by cycle, whether a handshake signal is held low.
+// Either seeded random (a percentage of cycles) or a repeating profile
+// string of '1' (active) / '0' (stall) characters.
+class stall_gen {
+public:
+    stall_gen() : m_rate(0), m_seed(1), m_state(1), m_pos(0) {}
+
+    void set_random(int pct, uint32_t seed) {
+        m_rate = pct < 0 ? 0 : (pct > 100 ? 100 : pct);
+        m_seed = seed ? seed : 1;
+        m_profile.clear();
+        reset();
+    }
+
+    // Pattern string, or '@file' to read the pattern from a file
+    bool set_profile(const char *profile) {
+        std::string text;
+        if (profile[0] == '@') {
+            FILE *f = fopen(profile + 1, "r");
+            if (f == NULL)
+                return false;
+            int c;
+            while ((c = fgetc(f)) != EOF)
+                text += (char)c;
+            fclose(f);
+        } else
+            text = profile;
+
+        m_profile.clear();
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '0' || text[i] == '1')
+                m_profile += text[i];
+            else if (text[i] != ' ' && text[i] != '\n' && text[i] != '\r' && text[i] != '\t' && text[i] != '_')
+                return false;
+        }
+        m_rate = 0;
+        reset();
+        return !m_profile.empty();
+    }
+
+    // Restart the pattern (same sequence for the same seed / profile)
+    void reset() {
+        m_state = m_seed;
+        m_pos = 0;
+    }
+
+    // True if the signal should be held low this cycle
+    bool stall() {
+        if (!m_profile.empty()) {
+            const bool active = m_profile[m_pos] == '1';
+            m_pos = (m_pos + 1) % m_profile.size();
+            return !active;
+        }
+        if (m_rate == 0)
+            return false;
+
+        // xorshift32
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return (m_state % 100) < (uint32_t)m_rate;
+    }
+
+private:
+    int         m_rate;     // Random stall percentage
+    uint32_t    m_seed;
+    uint32_t    m_state;
+    std::string m_profile;
+    size_t      m_pos;
+};
+
+#endif
@@ -1,4 +0,0 @@
-mv ../src_v/jpeg_idct_x.v ../src_v/jpeg_idct_x.v.aan
-mv ../src_v/jpeg_idct_x.v.nor ../src_v/jpeg_idct_x.v
-mv ../src_v/jpeg_idct_y.v ../src_v/jpeg_idct_y.v.aan
-mv ../src_v/jpeg_idct_y.v.nor ../src_v/jpeg_idct_y.v
\ No newline at end of file
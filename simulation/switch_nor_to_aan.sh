@@ -1,4 +0,0 @@
-mv ../src_v/jpeg_idct_x.v ../src_v/jpeg_idct_x.v.nor
-mv ../src_v/jpeg_idct_x.v.aan ../src_v/jpeg_idct_x.v
-mv ../src_v/jpeg_idct_y.v ../src_v/jpeg_idct_y.v.nor
-mv ../src_v/jpeg_idct_y.v.aan ../src_v/jpeg_idct_y.v
\ No newline at end of file
@@ -0,0 +1,146 @@
+// DESCRIPTION: Windowed / triggered waveform capture
+//
+// Copyright (C) 2022, Tan Bin. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+
+#ifndef WAVE_TRACE_H
+#define WAVE_TRACE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <verilated.h>
+
+// VM_TRACE / VM_TRACE_FST are set by the Verilator build (cmake -DTRACE=VCD|FST)
+#ifndef VM_TRACE
+# define VM_TRACE 0
+#endif
+#ifndef VM_TRACE_FST
+# define VM_TRACE_FST 0
+#endif
+
+#if VM_TRACE && VM_TRACE_FST
+# include <verilated_fst_c.h>
+typedef VerilatedFstC wave_file;
+# define WAVE_TRACE_EXT "fst"
+#elif VM_TRACE
+# include <verilated_vcd_c.h>
+typedef VerilatedVcdC wave_file;
+# define WAVE_TRACE_EXT "vcd"
+#endif
+
+// When to dump. Cycles are clk_i cycles after reset. Without a trigger the
+// window is [start, end); with one it opens when the trigger fires (and
+// start has been reached) and lasts 'cycles' (0 = to the end of the run).
+struct wave_config {
+    bool        enable;
+    std::string file;
+    int         depth;      // Hierarchy levels
+    uint64_t    start;
+    uint64_t    end;        // 0 = no end
+    uint64_t    cycles;     // Window length after a trigger
+    int         pixel_x;    // Trigger on output of this pixel (-1 = unused)
+    int         pixel_y;
+    int64_t     block;      // Trigger when this block enters the IDCT (-1 = unused)
+
+    wave_config() : enable(false), depth(99), start(0), end(0), cycles(0),
+                    pixel_x(-1), pixel_y(-1), block(-1) {}
+
+    bool triggered() const { return pixel_x >= 0 || block >= 0; }
+
+    static bool supported() { return VM_TRACE != 0; }
+    static const char *default_file() {
+#if VM_TRACE
+        return "decoder." WAVE_TRACE_EXT;
+#else
+        return "";
+#endif
+    }
+};
+
+// Opens the waveform file when the window starts and closes it when it
+// ends. Nothing is dumped (or attached to the model) outside the window.
+class wave_trace {
+public:
+    explicit wave_trace(const wave_config &cfg) : m_cfg(cfg), m_fired(false), m_done(false),
+                                                  m_stop(0), m_file(NULL) {}
+    ~wave_trace() { close(); }
+
+    // Restart for a new model instance
+    void reset() {
+        close();
+        m_fired = false;
+        m_done = false;
+    }
+
+    // A trigger condition was seen this cycle
+    void trigger() { m_fired = true; }
+
+    // Called once per cycle (before eval) to open / close the window
+    template <class MODEL>
+    void cycle(MODEL *model, uint64_t cycle) {
+        if (m_done)
+            return;
+        if (!m_file) {
+            if (cycle < m_cfg.start || (m_cfg.triggered() && !m_fired))
+                return;
+            m_stop = m_cfg.end;
+            if (m_cfg.cycles && (m_cfg.triggered() || !m_stop))
+                m_stop = cycle + m_cfg.cycles;
+            open(model, cycle);
+        } else if (m_stop && cycle >= m_stop) {
+            close();
+            m_done = true;
+        }
+    }
+
+    bool active() const { return m_file != NULL; }
+
+    const wave_config &config() const { return m_cfg; }
+
+    void dump(uint64_t time) {
+#if VM_TRACE
+        if (m_file)
+            m_file->dump(time);
+#endif
+    }
+
+    void close() {
+#if VM_TRACE
+        if (m_file) {
+            m_file->close();
+            delete m_file;
+        }
+#endif
+        m_file = NULL;
+    }
+
+private:
+    template <class MODEL>
+    void open(MODEL *model, uint64_t cycle) {
+#if VM_TRACE
+        m_file = new wave_file;
+        model->trace(m_file, m_cfg.depth);
+        m_file->open(m_cfg.file.c_str());
+        VL_PRINTF("Tracing to %s from cycle %" PRIu64 "\n", m_cfg.file.c_str(), cycle);
+#else
+        (void)model;
+        (void)cycle;
+        m_done = true;
+#endif
+    }
+
+    const wave_config &m_cfg;
+    bool               m_fired;
+    bool               m_done;
+    uint64_t           m_stop;
+#if VM_TRACE
+    wave_file         *m_file;
+#else
+    void              *m_file;
+#endif
+};
+
+#endif
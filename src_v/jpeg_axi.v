@@ -0,0 +1,369 @@
+//-----------------------------------------------------------------
+//                      Baseline JPEG Decoder
+//                             V0.1
+//                       Ultra-Embedded.com
+//                        Copyright 2020
+//
+//                   admin@ultra-embedded.com
+//-----------------------------------------------------------------
+//                      License: Apache 2.0
+// This IP can be freely used in commercial projects, however you may
+// want access to unreleased materials such as verification environments,
+// or test vectors, as well as changes to the IP for integration purposes.
+// If this is the case, contact the above address.
+// I am interested to hear how and where this IP is used, so please get
+// in touch!
+//-----------------------------------------------------------------
+// Copyright 2020 Ultra-Embedded.com
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------
+
+
+module jpeg_axi
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter SUPPORT_WRITABLE_DHT = 0
+    ,parameter SUPPORT_DHT_FAST_LOOKUP = 1
+    ,parameter USE_IDCT_IFAST   = 0
+    ,parameter INPUT_WIDTH      = 32    // AXI data width, 32 or 64
+    ,parameter SUPPORT_DUAL_SYMBOL = 0
+    ,parameter SUPPORT_RASTER_OUTPUT = 0
+    ,parameter RASTER_WIDTH_W   = 11
+    ,parameter SUPPORT_DC_ONLY  = 0
+    ,parameter BURST_LEN        = 16    // Max beats per burst (<= 256)
+    ,parameter RD_FIFO_DEPTH    = 64    // Read data buffer (>= BURST_LEN)
+    ,parameter RD_FIFO_ADDR_W   = 6
+    ,parameter WR_FIFO_DEPTH    = 32    // Write data buffer (>= 2 * BURST_LEN)
+    ,parameter WR_FIFO_ADDR_W   = 5
+    ,parameter AXI_ID           = 0
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
+(
+    // Inputs
+     input           clk_i
+    ,input           rst_i
+    ,input           desc_valid_i
+    ,input  [ 31:0]  desc_src_addr_i    // JPEG (aligned to the bus width)
+    ,input  [ 31:0]  desc_src_len_i     // JPEG length (bytes)
+    ,input  [ 31:0]  desc_dst_addr_i    // Frame buffer
+    ,input  [ 31:0]  desc_dst_stride_i  // Frame buffer bytes per line
+    ,input  [  1:0]  desc_format_i      // 0 = RGB24, 1 = RGBA32, 2 = BGRA32, 3 = RGB565
+    ,input           desc_dc_only_i     // 1/8 scale decode (SUPPORT_DC_ONLY=1)
+    ,input           axi_awready_i
+    ,input           axi_wready_i
+    ,input           axi_bvalid_i
+    ,input  [  1:0]  axi_bresp_i
+    ,input  [  3:0]  axi_bid_i
+    ,input           axi_arready_i
+    ,input           axi_rvalid_i
+    ,input  [INPUT_WIDTH-1:0] axi_rdata_i
+    ,input  [  1:0]  axi_rresp_i
+    ,input  [  3:0]  axi_rid_i
+    ,input           axi_rlast_i
+
+    // Outputs
+    ,output          desc_accept_o
+    ,output          axi_awvalid_o
+    ,output [ 31:0]  axi_awaddr_o
+    ,output [  3:0]  axi_awid_o
+    ,output [  7:0]  axi_awlen_o
+    ,output [  1:0]  axi_awburst_o
+    ,output          axi_wvalid_o
+    ,output [INPUT_WIDTH-1:0]   axi_wdata_o
+    ,output [INPUT_WIDTH/8-1:0] axi_wstrb_o
+    ,output          axi_wlast_o
+    ,output          axi_bready_o
+    ,output          axi_arvalid_o
+    ,output [ 31:0]  axi_araddr_o
+    ,output [  3:0]  axi_arid_o
+    ,output [  7:0]  axi_arlen_o
+    ,output [  1:0]  axi_arburst_o
+    ,output          axi_rready_o
+    ,output          done_o             // Frame decoded and written (one cycle)
+    ,output          done_error_o       // AXI error response during the frame
+    ,output [ 15:0]  done_width_o       // Output image size of the frame
+    ,output [ 15:0]  done_height_o
+    ,output          idle_o
+);
+
+//-----------------------------------------------------------------
+// Memory to memory decode: jpeg_core between an AXI4 read DMA
+// (jpeg_axi_reader) and a frame buffer writer (jpeg_axi_writer),
+// sharing one AXI4 master port. One descriptor per frame; the next
+// is accepted once the last frame's pixels have all been written
+// and acknowledged (done_o).
+//-----------------------------------------------------------------
+wire core_valid_w;
+wire core_accept_w;
+wire core_idle_w;
+wire rd_done_w;
+wire rd_error_w;
+wire wr_idle_w;
+wire wr_error_w;
+
+wire [15:0] core_width_w;
+wire [15:0] core_height_w;
+
+//-----------------------------------------------------------------
+// Frame state
+//-----------------------------------------------------------------
+reg        busy_q;      // Descriptor accepted, done_o not yet reported
+reg        started_q;   // Core left idle for the frame
+reg        finished_q;  // All pixels of the frame output by the core
+reg        done_q;
+reg [31:0] dst_addr_q;
+reg [31:0] dst_stride_q;
+reg [1:0]  format_q;
+reg        dc_only_q;
+reg [15:0] width_q;
+reg [15:0] height_q;
+
+wire desc_fire_w  = desc_valid_i && desc_accept_o;
+wire frame_done_w = finished_q && rd_done_w && wr_idle_w;
+
+assign desc_accept_o = !busy_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    busy_q     <= 1'b0;
+    started_q  <= 1'b0;
+    finished_q <= 1'b0;
+end
+else if (desc_fire_w)
+begin
+    busy_q     <= 1'b1;
+    started_q  <= 1'b0;
+    finished_q <= 1'b0;
+end
+else if (busy_q && frame_done_w)
+begin
+    busy_q     <= 1'b0;
+    started_q  <= 1'b0;
+    finished_q <= 1'b0;
+end
+else if (busy_q)
+begin
+    // Header parsed: idle_o drops
+    if (!core_idle_w)
+        started_q  <= 1'b1;
+
+    // Back to idle with the last pixel accepted
+    if (started_q && core_idle_w && !core_valid_w)
+        finished_q <= 1'b1;
+end
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    dst_addr_q   <= 32'b0;
+    dst_stride_q <= 32'b0;
+    format_q     <= 2'b0;
+    dc_only_q    <= 1'b0;
+end
+else if (desc_fire_w)
+begin
+    dst_addr_q   <= desc_dst_addr_i;
+    dst_stride_q <= desc_dst_stride_i;
+    format_q     <= desc_format_i;
+    dc_only_q    <= desc_dc_only_i;
+end
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    width_q  <= 16'b0;
+    height_q <= 16'b0;
+end
+else if (busy_q && !finished_q)
+begin
+    width_q  <= core_width_w;
+    height_q <= core_height_w;
+end
+
+always @ (posedge clk_i )
+if (rst_i)
+    done_q <= 1'b0;
+else
+    done_q <= busy_q && frame_done_w;
+
+assign done_o        = done_q;
+assign done_error_o  = rd_error_w || wr_error_w;
+assign done_width_o  = width_q;
+assign done_height_o = height_q;
+assign idle_o        = !busy_q && !done_q;
+
+//-----------------------------------------------------------------
+// JPEG read DMA
+//-----------------------------------------------------------------
+wire                     rd_valid_w;
+wire [INPUT_WIDTH-1:0]   rd_data_w;
+wire [INPUT_WIDTH/8-1:0] rd_strb_w;
+wire                     rd_last_w;
+
+jpeg_axi_reader
+#(
+     .DATA_W(INPUT_WIDTH)
+    ,.BURST_LEN(BURST_LEN)
+    ,.FIFO_DEPTH(RD_FIFO_DEPTH)
+    ,.FIFO_ADDR_W(RD_FIFO_ADDR_W)
+    ,.AXI_ID(AXI_ID)
+)
+u_reader
+(
+    // Inputs
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+    ,.desc_valid_i(desc_fire_w)
+    ,.desc_addr_i(desc_src_addr_i)
+    ,.desc_len_i(desc_src_len_i)
+    ,.axi_arready_i(axi_arready_i)
+    ,.axi_rvalid_i(axi_rvalid_i)
+    ,.axi_rdata_i(axi_rdata_i)
+    ,.axi_rresp_i(axi_rresp_i)
+    ,.axi_rid_i(axi_rid_i)
+    ,.axi_rlast_i(axi_rlast_i)
+    ,.outport_accept_i(core_accept_w)
+
+    // Outputs
+    ,.desc_accept_o()
+    ,.axi_arvalid_o(axi_arvalid_o)
+    ,.axi_araddr_o(axi_araddr_o)
+    ,.axi_arid_o(axi_arid_o)
+    ,.axi_arlen_o(axi_arlen_o)
+    ,.axi_arburst_o(axi_arburst_o)
+    ,.axi_rready_o(axi_rready_o)
+    ,.outport_valid_o(rd_valid_w)
+    ,.outport_data_o(rd_data_w)
+    ,.outport_strb_o(rd_strb_w)
+    ,.outport_last_o(rd_last_w)
+    ,.done_o(rd_done_w)
+    ,.error_o(rd_error_w)
+);
+
+//-----------------------------------------------------------------
+// Decoder
+//-----------------------------------------------------------------
+wire        pix_accept_w;
+wire [15:0] pix_x_w;
+wire [15:0] pix_y_w;
+wire [7:0]  pix_r_w;
+wire [7:0]  pix_g_w;
+wire [7:0]  pix_b_w;
+wire        pix2_valid_w;
+wire [7:0]  pix2_r_w;
+wire [7:0]  pix2_g_w;
+wire [7:0]  pix2_b_w;
+
+jpeg_core
+#(
+     .SUPPORT_WRITABLE_DHT(SUPPORT_WRITABLE_DHT)
+    ,.SUPPORT_DHT_FAST_LOOKUP(SUPPORT_DHT_FAST_LOOKUP)
+    ,.USE_IDCT_IFAST(USE_IDCT_IFAST)
+    ,.INPUT_WIDTH(INPUT_WIDTH)
+    ,.SUPPORT_DUAL_SYMBOL(SUPPORT_DUAL_SYMBOL)
+    ,.SUPPORT_RASTER_OUTPUT(SUPPORT_RASTER_OUTPUT)
+    ,.RASTER_WIDTH_W(RASTER_WIDTH_W)
+    ,.SUPPORT_DC_ONLY(SUPPORT_DC_ONLY)
+)
+u_core
+(
+    // Inputs
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+    ,.inport_valid_i(rd_valid_w)
+    ,.inport_data_i(rd_data_w)
+    ,.inport_strb_i(rd_strb_w)
+    ,.inport_last_i(rd_last_w)
+    ,.outport_accept_i(pix_accept_w)
+    ,.dc_only_i(dc_only_q)
+
+    // Outputs
+    ,.inport_accept_o(core_accept_w)
+    ,.outport_valid_o(core_valid_w)
+    ,.outport_width_o(core_width_w)
+    ,.outport_height_o(core_height_w)
+    ,.outport_pixel_x_o(pix_x_w)
+    ,.outport_pixel_y_o(pix_y_w)
+    ,.outport_pixel_r_o(pix_r_w)
+    ,.outport_pixel_g_o(pix_g_w)
+    ,.outport_pixel_b_o(pix_b_w)
+    ,.outport_pixel2_valid_o(pix2_valid_w)
+    ,.outport_pixel2_r_o(pix2_r_w)
+    ,.outport_pixel2_g_o(pix2_g_w)
+    ,.outport_pixel2_b_o(pix2_b_w)
+    ,.idle_o(core_idle_w)
+);
+
+//-----------------------------------------------------------------
+// Frame buffer writer
+//-----------------------------------------------------------------
+jpeg_axi_writer
+#(
+     .DATA_W(INPUT_WIDTH)
+    ,.BURST_LEN(BURST_LEN)
+    ,.FIFO_DEPTH(WR_FIFO_DEPTH)
+    ,.FIFO_ADDR_W(WR_FIFO_ADDR_W)
+    ,.AXI_ID(AXI_ID)
+)
+u_writer
+(
+    // Inputs
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+    ,.start_i(desc_fire_w)
+    ,.cfg_addr_i(dst_addr_q)
+    ,.cfg_stride_i(dst_stride_q)
+    ,.cfg_format_i(format_q)
+    ,.img_width_i(core_width_w)
+    ,.img_height_i(core_height_w)
+    ,.flush_i(finished_q)
+    ,.inport_valid_i(core_valid_w)
+    ,.inport_pixel_x_i(pix_x_w)
+    ,.inport_pixel_y_i(pix_y_w)
+    ,.inport_pixel_r_i(pix_r_w)
+    ,.inport_pixel_g_i(pix_g_w)
+    ,.inport_pixel_b_i(pix_b_w)
+    ,.inport_pixel2_valid_i(pix2_valid_w)
+    ,.inport_pixel2_r_i(pix2_r_w)
+    ,.inport_pixel2_g_i(pix2_g_w)
+    ,.inport_pixel2_b_i(pix2_b_w)
+    ,.axi_awready_i(axi_awready_i)
+    ,.axi_wready_i(axi_wready_i)
+    ,.axi_bvalid_i(axi_bvalid_i)
+    ,.axi_bresp_i(axi_bresp_i)
+    ,.axi_bid_i(axi_bid_i)
+
+    // Outputs
+    ,.inport_accept_o(pix_accept_w)
+    ,.axi_awvalid_o(axi_awvalid_o)
+    ,.axi_awaddr_o(axi_awaddr_o)
+    ,.axi_awid_o(axi_awid_o)
+    ,.axi_awlen_o(axi_awlen_o)
+    ,.axi_awburst_o(axi_awburst_o)
+    ,.axi_wvalid_o(axi_wvalid_o)
+    ,.axi_wdata_o(axi_wdata_o)
+    ,.axi_wstrb_o(axi_wstrb_o)
+    ,.axi_wlast_o(axi_wlast_o)
+    ,.axi_bready_o(axi_bready_o)
+    ,.idle_o(wr_idle_w)
+    ,.error_o(wr_error_w)
+);
+
+
+endmodule
@@ -0,0 +1,277 @@
+//-----------------------------------------------------------------
+//                      Baseline JPEG Decoder
+//                             V0.1
+//                       Ultra-Embedded.com
+//                        Copyright 2020
+//
+//                   admin@ultra-embedded.com
+//-----------------------------------------------------------------
+//                      License: Apache 2.0
+// This IP can be freely used in commercial projects, however you may
+// want access to unreleased materials such as verification environments,
+// or test vectors, as well as changes to the IP for integration purposes.
+// If this is the case, contact the above address.
+// I am interested to hear how and where this IP is used, so please get
+// in touch!
+//-----------------------------------------------------------------
+// Copyright 2020 Ultra-Embedded.com
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------
+
+
+module jpeg_axi_reader
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter DATA_W           = 32    // 32 or 64
+    ,parameter BURST_LEN        = 16    // Max beats per read burst (<= 256)
+    ,parameter FIFO_DEPTH       = 64    // Read data buffer (>= BURST_LEN)
+    ,parameter FIFO_ADDR_W      = 6
+    ,parameter AXI_ID           = 0
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
+(
+    // Inputs
+     input           clk_i
+    ,input           rst_i
+    ,input           desc_valid_i
+    ,input  [ 31:0]  desc_addr_i
+    ,input  [ 31:0]  desc_len_i
+    ,input           axi_arready_i
+    ,input           axi_rvalid_i
+    ,input  [DATA_W-1:0] axi_rdata_i
+    ,input  [  1:0]  axi_rresp_i
+    ,input  [  3:0]  axi_rid_i
+    ,input           axi_rlast_i
+    ,input           outport_accept_i
+
+    // Outputs
+    ,output          desc_accept_o
+    ,output          axi_arvalid_o
+    ,output [ 31:0]  axi_araddr_o
+    ,output [  3:0]  axi_arid_o
+    ,output [  7:0]  axi_arlen_o
+    ,output [  1:0]  axi_arburst_o
+    ,output          axi_rready_o
+    ,output          outport_valid_o
+    ,output [DATA_W-1:0]   outport_data_o
+    ,output [DATA_W/8-1:0] outport_strb_o
+    ,output          outport_last_o
+    ,output          done_o
+    ,output          error_o
+);
+
+//-----------------------------------------------------------------
+// DMA read of one JPEG (desc_addr_i, desc_len_i bytes) from memory
+// into the jpeg_core input stream. desc_addr_i must be aligned to
+// the bus width. Read bursts (INCR, full width beats, never across
+// a 4KB boundary) are only issued with room in the data buffer for
+// all of their beats, so RREADY is held high and several bursts can
+// be outstanding to cover the memory latency.
+// After the last word the stream carries empty last beats (no
+// strobes, outport_last_o), as jpeg_core expects at the end of a
+// stream, until the next descriptor.
+//-----------------------------------------------------------------
+localparam BYTES   = DATA_W / 8;
+localparam BYTE_W  = (DATA_W == 64) ? 3 : 2;
+localparam COUNT_W = FIFO_ADDR_W + 1;
+
+//-----------------------------------------------------------------
+// Descriptor
+//-----------------------------------------------------------------
+reg [31:0]        ar_addr_q;     // Next burst address
+reg [31:0]        ar_words_q;    // Words still to request
+reg [31:0]        out_words_q;   // Words still to output
+reg [BYTE_W-1:0]  tail_bytes_q;  // Bytes in the last word (0 = whole word)
+reg               flush_q;       // All words output, empty last beats
+reg               error_q;
+
+wire desc_fire_w = desc_valid_i && desc_accept_o;
+
+assign desc_accept_o = (ar_words_q == 32'b0) && (out_words_q == 32'b0);
+
+//-----------------------------------------------------------------
+// Read requests
+//-----------------------------------------------------------------
+// Beats up to the next 4KB boundary
+wire [12:0] page_left_w   = 13'h1000 - {1'b0, ar_addr_q[11:0]};
+wire [12:0] page_words_w  = page_left_w >> BYTE_W;
+
+reg  [8:0]  ar_beats_r;
+
+/* verilator lint_off WIDTH */
+always @ *
+begin
+    ar_beats_r = BURST_LEN;
+
+    if (ar_words_q < ar_beats_r)
+        ar_beats_r = ar_words_q[8:0];
+
+    if (page_words_w < ar_beats_r)
+        ar_beats_r = page_words_w[8:0];
+end
+/* verilator lint_on WIDTH */
+
+// Buffer entries reserved by issued requests (freed as words are output)
+reg  [COUNT_W:0] credit_q;
+
+/* verilator lint_off WIDTH */
+wire ar_space_w = (credit_q + ar_beats_r) <= FIFO_DEPTH;
+/* verilator lint_on WIDTH */
+
+reg        arvalid_q;
+reg [31:0] araddr_q;
+reg [7:0]  arlen_q;
+
+wire ar_fire_w  = axi_arvalid_o && axi_arready_i;
+wire ar_issue_w = (ar_words_q != 32'b0) && ar_space_w && (!arvalid_q || axi_arready_i);
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    arvalid_q <= 1'b0;
+    araddr_q  <= 32'b0;
+    arlen_q   <= 8'b0;
+end
+else if (ar_issue_w)
+begin
+    arvalid_q <= 1'b1;
+    araddr_q  <= ar_addr_q;
+    arlen_q   <= ar_beats_r[7:0] - 8'd1;
+end
+else if (ar_fire_w)
+    arvalid_q <= 1'b0;
+
+/* verilator lint_off WIDTH */
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    ar_addr_q  <= 32'b0;
+    ar_words_q <= 32'b0;
+end
+else if (desc_fire_w)
+begin
+    ar_addr_q  <= {desc_addr_i[31:BYTE_W], {BYTE_W{1'b0}}};
+    ar_words_q <= (desc_len_i + BYTES - 1) >> BYTE_W;
+end
+else if (ar_issue_w)
+begin
+    ar_addr_q  <= ar_addr_q + (ar_beats_r << BYTE_W);
+    ar_words_q <= ar_words_q - ar_beats_r;
+end
+/* verilator lint_on WIDTH */
+
+assign axi_arvalid_o = arvalid_q;
+assign axi_araddr_o  = araddr_q;
+assign axi_arid_o    = AXI_ID;
+assign axi_arlen_o   = arlen_q;
+assign axi_arburst_o = 2'b01; // INCR
+
+//-----------------------------------------------------------------
+// Read data buffer
+//-----------------------------------------------------------------
+wire              fifo_valid_w;
+wire [DATA_W-1:0] fifo_data_w;
+wire              word_pop_w = fifo_valid_w && outport_accept_i && !flush_q;
+
+jpeg_output_fifo
+#(
+     .WIDTH(DATA_W)
+    ,.DEPTH(FIFO_DEPTH)
+    ,.ADDR_W(FIFO_ADDR_W)
+)
+u_data
+(
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+    ,.flush_i(1'b0)
+
+    ,.push_i(axi_rvalid_i)
+    ,.data_in_i(axi_rdata_i)
+    ,.accept_o()
+
+    ,.valid_o(fifo_valid_w)
+    ,.data_out_o(fifo_data_w)
+    ,.pop_i(word_pop_w)
+);
+
+// Space for every beat was reserved when the burst was requested
+assign axi_rready_o = 1'b1;
+
+/* verilator lint_off WIDTH */
+always @ (posedge clk_i )
+if (rst_i)
+    credit_q <= {(COUNT_W+1){1'b0}};
+else if (ar_issue_w && word_pop_w)
+    credit_q <= credit_q + ar_beats_r - 1;
+else if (ar_issue_w)
+    credit_q <= credit_q + ar_beats_r;
+else if (word_pop_w)
+    credit_q <= credit_q - 1;
+/* verilator lint_on WIDTH */
+
+always @ (posedge clk_i )
+if (rst_i)
+    error_q <= 1'b0;
+else if (desc_fire_w)
+    error_q <= 1'b0;
+else if (axi_rvalid_i && axi_rresp_i != 2'b00)
+    error_q <= 1'b1;
+
+//-----------------------------------------------------------------
+// Output stream
+//-----------------------------------------------------------------
+/* verilator lint_off WIDTH */
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    out_words_q  <= 32'b0;
+    tail_bytes_q <= {BYTE_W{1'b0}};
+end
+else if (desc_fire_w)
+begin
+    out_words_q  <= (desc_len_i + BYTES - 1) >> BYTE_W;
+    tail_bytes_q <= desc_len_i[BYTE_W-1:0];
+end
+else if (word_pop_w)
+    out_words_q  <= out_words_q - 32'd1;
+/* verilator lint_on WIDTH */
+
+always @ (posedge clk_i )
+if (rst_i)
+    flush_q <= 1'b0;
+else if (desc_fire_w)
+    flush_q <= 1'b0;
+else if (word_pop_w && out_words_q == 32'd1)
+    flush_q <= 1'b1;
+
+// Strobes of the last (partial) word
+wire [BYTES-1:0] tail_strb_w = (tail_bytes_q == {BYTE_W{1'b0}}) ? {BYTES{1'b1}} :
+                               ~({BYTES{1'b1}} << tail_bytes_q);
+
+assign outport_valid_o = flush_q || fifo_valid_w;
+assign outport_data_o  = flush_q ? {DATA_W{1'b0}} : fifo_data_w;
+assign outport_strb_o  = flush_q ? {BYTES{1'b0}} :
+                         (out_words_q == 32'd1) ? tail_strb_w : {BYTES{1'b1}};
+assign outport_last_o  = flush_q;
+
+// Whole JPEG handed to the core
+assign done_o  = flush_q;
+assign error_o = error_q;
+
+
+endmodule
@@ -0,0 +1,595 @@
+//-----------------------------------------------------------------
+//                      Baseline JPEG Decoder
+//                             V0.1
+//                       Ultra-Embedded.com
+//                        Copyright 2020
+//
+//                   admin@ultra-embedded.com
+//-----------------------------------------------------------------
+//                      License: Apache 2.0
+// This IP can be freely used in commercial projects, however you may
+// want access to unreleased materials such as verification environments,
+// or test vectors, as well as changes to the IP for integration purposes.
+// If this is the case, contact the above address.
+// I am interested to hear how and where this IP is used, so please get
+// in touch!
+//-----------------------------------------------------------------
+// Copyright 2020 Ultra-Embedded.com
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------
+
+
+module jpeg_axi_writer
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter DATA_W           = 32    // 32 or 64
+    ,parameter BURST_LEN        = 16    // Max beats per write burst (<= 256)
+    ,parameter FIFO_DEPTH       = 32    // Write data buffer (>= 2 * BURST_LEN)
+    ,parameter FIFO_ADDR_W      = 5
+    ,parameter AXI_ID           = 0
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
+(
+    // Inputs
+     input           clk_i
+    ,input           rst_i
+    ,input           start_i        // New frame (clears error_o)
+    ,input  [ 31:0]  cfg_addr_i     // Frame buffer base
+    ,input  [ 31:0]  cfg_stride_i   // Bytes per line
+    ,input  [  1:0]  cfg_format_i   // 0 = RGB24, 1 = RGBA32, 2 = BGRA32, 3 = RGB565
+    ,input  [ 15:0]  img_width_i
+    ,input  [ 15:0]  img_height_i
+    ,input           flush_i        // Frame fully output, write out partial beats / bursts
+    ,input           inport_valid_i
+    ,input  [ 15:0]  inport_pixel_x_i
+    ,input  [ 15:0]  inport_pixel_y_i
+    ,input  [  7:0]  inport_pixel_r_i
+    ,input  [  7:0]  inport_pixel_g_i
+    ,input  [  7:0]  inport_pixel_b_i
+    ,input           inport_pixel2_valid_i
+    ,input  [  7:0]  inport_pixel2_r_i
+    ,input  [  7:0]  inport_pixel2_g_i
+    ,input  [  7:0]  inport_pixel2_b_i
+    ,input           axi_awready_i
+    ,input           axi_wready_i
+    ,input           axi_bvalid_i
+    ,input  [  1:0]  axi_bresp_i
+    ,input  [  3:0]  axi_bid_i
+
+    // Outputs
+    ,output          inport_accept_o
+    ,output          axi_awvalid_o
+    ,output [ 31:0]  axi_awaddr_o
+    ,output [  3:0]  axi_awid_o
+    ,output [  7:0]  axi_awlen_o
+    ,output [  1:0]  axi_awburst_o
+    ,output          axi_wvalid_o
+    ,output [DATA_W-1:0]   axi_wdata_o
+    ,output [DATA_W/8-1:0] axi_wstrb_o
+    ,output          axi_wlast_o
+    ,output          axi_bready_o
+    ,output          idle_o
+    ,output          error_o
+);
+
+//-----------------------------------------------------------------
+// Frame buffer writer for the jpeg_core pixel stream. Each pixel is
+// stored at cfg_addr_i + y * cfg_stride_i + x * bytes per pixel in
+// the same byte layout as the C model's RGB output formats. Pixels
+// are merged into bus words (byte strobes for partial words), and
+// words at consecutive addresses into INCR bursts (full width beats,
+// never across a 4KB boundary), so block order output gives a burst
+// per block row and raster order output long line bursts. Padding
+// pixels beyond the image are dropped. A burst is written once it
+// is closed (next word not consecutive, BURST_LEN beats, 4KB
+// boundary or flush_i), with W data following its AW request.
+//-----------------------------------------------------------------
+localparam BYTES    = DATA_W / 8;
+localparam BYTE_W   = (DATA_W == 64) ? 3 : 2;
+localparam BEAT_W   = 32 - BYTE_W;     // Beat (word) address
+localparam PAGE_W   = 12 - BYTE_W;     // Beat within a 4KB page
+
+localparam FMT_RGB24  = 2'd0;
+localparam FMT_RGBA32 = 2'd1;
+localparam FMT_BGRA32 = 2'd2;
+localparam FMT_RGB565 = 2'd3;
+
+//-----------------------------------------------------------------
+// Input: a raster order beat (pixel2) is split into two pixels
+//-----------------------------------------------------------------
+reg        s_valid_q;
+reg        s_phase_q;
+reg        s_pair_q;
+reg [15:0] s_x_q;
+reg [15:0] s_y_q;
+reg [23:0] s_rgb_q;
+reg [23:0] s_rgb2_q;
+
+wire        a_ready_w;
+
+wire [15:0] e_x_w      = s_x_q + {15'b0, s_phase_q};
+wire [23:0] e_rgb_w    = s_phase_q ? s_rgb2_q : s_rgb_q;
+wire        e_inside_w = (e_x_w < img_width_i) && (s_y_q < img_height_i);
+wire        e_last_w   = s_phase_q || !s_pair_q;
+wire        e_adv_w    = s_valid_q && (!e_inside_w || a_ready_w);
+
+assign inport_accept_o = !s_valid_q || (e_adv_w && e_last_w);
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    s_valid_q <= 1'b0;
+    s_phase_q <= 1'b0;
+    s_pair_q  <= 1'b0;
+    s_x_q     <= 16'b0;
+    s_y_q     <= 16'b0;
+    s_rgb_q   <= 24'b0;
+    s_rgb2_q  <= 24'b0;
+end
+else if (inport_valid_i && inport_accept_o)
+begin
+    s_valid_q <= 1'b1;
+    s_phase_q <= 1'b0;
+    s_pair_q  <= inport_pixel2_valid_i;
+    s_x_q     <= inport_pixel_x_i;
+    s_y_q     <= inport_pixel_y_i;
+    s_rgb_q   <= {inport_pixel_r_i, inport_pixel_g_i, inport_pixel_b_i};
+    s_rgb2_q  <= {inport_pixel2_r_i, inport_pixel2_g_i, inport_pixel2_b_i};
+end
+else if (e_adv_w)
+begin
+    s_valid_q <= !e_last_w;
+    s_phase_q <= 1'b1;
+end
+
+//-----------------------------------------------------------------
+// Address and byte layout
+//-----------------------------------------------------------------
+wire [7:0] e_r_w = e_rgb_w[23:16];
+wire [7:0] e_g_w = e_rgb_w[15:8];
+wire [7:0] e_b_w = e_rgb_w[7:0];
+
+reg [31:0] e_offset_r;
+reg [31:0] e_data_r;
+reg [3:0]  e_strb_r;
+
+always @ *
+begin
+    case (cfg_format_i)
+    FMT_RGBA32:
+    begin
+        e_offset_r = {14'b0, e_x_w, 2'b0};
+        e_data_r   = {8'hFF, e_b_w, e_g_w, e_r_w};
+        e_strb_r   = 4'b1111;
+    end
+    FMT_BGRA32:
+    begin
+        e_offset_r = {14'b0, e_x_w, 2'b0};
+        e_data_r   = {8'hFF, e_r_w, e_g_w, e_b_w};
+        e_strb_r   = 4'b1111;
+    end
+    FMT_RGB565:
+    begin
+        e_offset_r = {15'b0, e_x_w, 1'b0};
+        e_data_r   = {16'b0, e_r_w[7:3], e_g_w[7:2], e_b_w[7:3]};
+        e_strb_r   = 4'b0011;
+    end
+    default: // FMT_RGB24
+    begin
+        e_offset_r = {15'b0, e_x_w, 1'b0} + {16'b0, e_x_w};
+        e_data_r   = {8'h00, e_b_w, e_g_w, e_r_w};
+        e_strb_r   = 4'b0111;
+    end
+    endcase
+end
+
+reg        a_valid_q;
+reg [31:0] a_addr_q;
+reg [31:0] a_data_q;
+reg [3:0]  a_strb_q;
+
+wire       a_consume_w;
+
+assign a_ready_w = !a_valid_q || a_consume_w;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    a_valid_q <= 1'b0;
+    a_addr_q  <= 32'b0;
+    a_data_q  <= 32'b0;
+    a_strb_q  <= 4'b0;
+end
+else if (a_ready_w)
+begin
+    a_valid_q <= e_adv_w && e_inside_w;
+    a_addr_q  <= cfg_addr_i + (s_y_q * cfg_stride_i) + e_offset_r;
+    a_data_q  <= e_data_r;
+    a_strb_q  <= e_strb_r;
+end
+
+//-----------------------------------------------------------------
+// Word packer: pixels are merged into the current word, which is
+// written out when a pixel lands in a different word. A pixel
+// straddling two words (RGB24) completes the current word and
+// starts the next.
+//-----------------------------------------------------------------
+wire [BYTE_W-1:0]    a_lane_w = a_addr_q[BYTE_W-1:0];
+wire [BEAT_W-1:0]    a_beat_w = a_addr_q[31:BYTE_W];
+
+/* verilator lint_off WIDTH */
+wire [2*DATA_W-1:0]  a_sdata_w = {{(2*DATA_W-32){1'b0}}, a_data_q} << {a_lane_w, 3'b0};
+wire [2*BYTES-1:0]   a_sstrb_w = {{(2*BYTES-4){1'b0}}, a_strb_q} << a_lane_w;
+/* verilator lint_on WIDTH */
+
+wire [DATA_W-1:0]    a_lo_data_w = a_sdata_w[DATA_W-1:0];
+wire [DATA_W-1:0]    a_hi_data_w = a_sdata_w[2*DATA_W-1:DATA_W];
+wire [BYTES-1:0]     a_lo_strb_w = a_sstrb_w[BYTES-1:0];
+wire [BYTES-1:0]     a_hi_strb_w = a_sstrb_w[2*BYTES-1:BYTES];
+wire                 a_split_w   = |a_hi_strb_w;
+
+reg                  beat_valid_q;
+reg [BEAT_W-1:0]     beat_addr_q;
+reg [DATA_W-1:0]     beat_data_q;
+reg [BYTES-1:0]      beat_strb_q;
+
+wire                 beat_hit_w  = beat_valid_q && (beat_addr_q == a_beat_w);
+wire                 drain_w     = flush_i && !s_valid_q && !a_valid_q;
+
+reg                  pk_push_r;
+reg [BEAT_W-1:0]     pk_addr_r;
+reg [DATA_W-1:0]     pk_data_r;
+reg [BYTES-1:0]      pk_strb_r;
+reg                  pk_consume_r;
+
+reg                  beat_valid_r;
+reg [BEAT_W-1:0]     beat_addr_r;
+reg [DATA_W-1:0]     beat_data_r;
+reg [BYTES-1:0]      beat_strb_r;
+
+always @ *
+begin
+    pk_push_r    = 1'b0;
+    pk_addr_r    = beat_addr_q;
+    pk_data_r    = beat_data_q;
+    pk_strb_r    = beat_strb_q;
+    pk_consume_r = 1'b0;
+
+    beat_valid_r = beat_valid_q;
+    beat_addr_r  = beat_addr_q;
+    beat_data_r  = beat_data_q;
+    beat_strb_r  = beat_strb_q;
+
+    if (a_valid_q && (!beat_valid_q || beat_hit_w))
+    begin
+        // Merge into the current word (or start one)
+        pk_consume_r = 1'b1;
+        pk_addr_r    = a_beat_w;
+        pk_data_r    = (beat_valid_q ? beat_data_q : {DATA_W{1'b0}}) | a_lo_data_w;
+        pk_strb_r    = (beat_valid_q ? beat_strb_q : {BYTES{1'b0}}) | a_lo_strb_w;
+
+        if (a_split_w)
+        begin
+            pk_push_r    = 1'b1;
+            beat_valid_r = 1'b1;
+            beat_addr_r  = a_beat_w + 1;
+            beat_data_r  = a_hi_data_w;
+            beat_strb_r  = a_hi_strb_w;
+        end
+        else
+        begin
+            beat_valid_r = 1'b1;
+            beat_addr_r  = pk_addr_r;
+            beat_data_r  = pk_data_r;
+            beat_strb_r  = pk_strb_r;
+        end
+    end
+    else if (a_valid_q)
+    begin
+        // Pixel in a different word: write out the current one
+        pk_push_r = 1'b1;
+
+        if (a_split_w)
+            beat_valid_r = 1'b0; // Pixel starts a fresh word next cycle
+        else
+        begin
+            pk_consume_r = 1'b1;
+            beat_valid_r = 1'b1;
+            beat_addr_r  = a_beat_w;
+            beat_data_r  = a_lo_data_w;
+            beat_strb_r  = a_lo_strb_w;
+        end
+    end
+    else if (drain_w && beat_valid_q)
+    begin
+        pk_push_r    = 1'b1;
+        beat_valid_r = 1'b0;
+    end
+end
+
+wire pk_ready_w;
+wire pk_fire_w = !pk_push_r || pk_ready_w;
+
+assign a_consume_w = pk_consume_r && pk_fire_w;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    beat_valid_q <= 1'b0;
+    beat_addr_q  <= {BEAT_W{1'b0}};
+    beat_data_q  <= {DATA_W{1'b0}};
+    beat_strb_q  <= {BYTES{1'b0}};
+end
+else if (pk_fire_w)
+begin
+    beat_valid_q <= beat_valid_r;
+    beat_addr_q  <= beat_addr_r;
+    beat_data_q  <= beat_data_r;
+    beat_strb_q  <= beat_strb_r;
+end
+
+//-----------------------------------------------------------------
+// Burst builder: words at consecutive addresses extend the open
+// burst. It is closed by a non consecutive word (closed and the new
+// burst opened in one cycle), on reaching BURST_LEN beats or a 4KB
+// boundary, or on flush_i.
+//-----------------------------------------------------------------
+reg              open_q;
+reg [BEAT_W-1:0] open_addr_q;
+reg [8:0]        open_len_q;
+
+wire             data_accept_w;
+wire             aw_fifo_accept_w;
+wire             wl_fifo_accept_w;
+wire             cmd_accept_w = aw_fifo_accept_w && wl_fifo_accept_w;
+
+/* verilator lint_off WIDTH */
+wire             pk_contig_w = open_q && (pk_addr_r == open_addr_q + open_len_q) &&
+                               (open_len_q < BURST_LEN) && (pk_addr_r[PAGE_W-1:0] != {PAGE_W{1'b0}});
+/* verilator lint_on WIDTH */
+
+// Burst complete with this word (BURST_LEN beats, or ends a 4KB page)
+wire [8:0]       pk_len_w    = pk_contig_w ? (open_len_q + 9'd1) : 9'd1;
+/* verilator lint_off WIDTH */
+wire             pk_full_w   = (pk_len_w == BURST_LEN) || (pk_addr_r[PAGE_W-1:0] == {PAGE_W{1'b1}});
+/* verilator lint_on WIDTH */
+
+assign pk_ready_w = data_accept_w && cmd_accept_w;
+
+wire             pk_push_w   = pk_push_r && pk_ready_w;
+
+reg              cmd_push_r;
+reg [BEAT_W-1:0] cmd_addr_r;
+reg [8:0]        cmd_len_r;
+
+always @ *
+begin
+    cmd_push_r = 1'b0;
+    cmd_addr_r = open_addr_q;
+    cmd_len_r  = open_len_q;
+
+    if (pk_push_w)
+    begin
+        if (open_q && !pk_contig_w)
+        begin
+            // Close the open burst, the word opens the next
+            // (which can only be closed by a later word or flush)
+            cmd_push_r = 1'b1;
+        end
+        else if (pk_full_w)
+        begin
+            cmd_push_r = 1'b1;
+            cmd_addr_r = pk_contig_w ? open_addr_q : pk_addr_r;
+            cmd_len_r  = pk_len_w;
+        end
+    end
+    else if (drain_w && !beat_valid_q && open_q && cmd_accept_w)
+        cmd_push_r = 1'b1;
+end
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    open_q      <= 1'b0;
+    open_addr_q <= {BEAT_W{1'b0}};
+    open_len_q  <= 9'b0;
+end
+else if (pk_push_w)
+begin
+    if (open_q && !pk_contig_w)
+    begin
+        open_q      <= 1'b1;
+        open_addr_q <= pk_addr_r;
+        open_len_q  <= 9'd1;
+    end
+    else
+    begin
+        open_q      <= !pk_full_w;
+        open_addr_q <= pk_contig_w ? open_addr_q : pk_addr_r;
+        open_len_q  <= pk_len_w;
+    end
+end
+else if (cmd_push_r)
+    open_q      <= 1'b0;
+
+//-----------------------------------------------------------------
+// Write data / burst queues
+//-----------------------------------------------------------------
+wire              data_valid_w;
+wire [DATA_W-1:0] data_out_w;
+wire [BYTES-1:0]  strb_out_w;
+wire              data_pop_w;
+
+jpeg_output_fifo
+#(
+     .WIDTH(DATA_W + BYTES)
+    ,.DEPTH(FIFO_DEPTH)
+    ,.ADDR_W(FIFO_ADDR_W)
+)
+u_data
+(
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+    ,.flush_i(1'b0)
+
+    ,.push_i(pk_push_w)
+    ,.data_in_i({pk_strb_r, pk_data_r})
+    ,.accept_o(data_accept_w)
+
+    ,.valid_o(data_valid_w)
+    ,.data_out_o({strb_out_w, data_out_w})
+    ,.pop_i(data_pop_w)
+);
+
+wire              aw_valid_w;
+wire [BEAT_W-1:0] aw_addr_w;
+wire [7:0]        aw_len_w;
+
+jpeg_output_fifo
+#(
+     .WIDTH(BEAT_W + 8)
+    ,.DEPTH(4)
+    ,.ADDR_W(2)
+)
+u_aw
+(
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+    ,.flush_i(1'b0)
+
+    ,.push_i(cmd_push_r)
+    ,.data_in_i({cmd_addr_r, cmd_len_r[7:0] - 8'd1})
+    ,.accept_o(aw_fifo_accept_w)
+
+    ,.valid_o(aw_valid_w)
+    ,.data_out_o({aw_addr_w, aw_len_w})
+    ,.pop_i(axi_awready_i)
+);
+
+wire              wl_valid_w;
+wire [7:0]        wl_len_w;
+wire              w_load_w;
+
+jpeg_output_fifo
+#(
+     .WIDTH(8)
+    ,.DEPTH(4)
+    ,.ADDR_W(2)
+)
+u_wlen
+(
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+    ,.flush_i(1'b0)
+
+    ,.push_i(cmd_push_r)
+    ,.data_in_i(cmd_len_r[7:0] - 8'd1)
+    ,.accept_o(wl_fifo_accept_w)
+
+    ,.valid_o(wl_valid_w)
+    ,.data_out_o(wl_len_w)
+    ,.pop_i(w_load_w)
+);
+
+//-----------------------------------------------------------------
+// AXI write address
+//-----------------------------------------------------------------
+wire aw_fire_w = axi_awvalid_o && axi_awready_i;
+
+assign axi_awvalid_o = aw_valid_w;
+assign axi_awaddr_o  = {aw_addr_w, {BYTE_W{1'b0}}};
+assign axi_awid_o    = AXI_ID;
+assign axi_awlen_o   = aw_len_w;
+assign axi_awburst_o = 2'b01; // INCR
+
+//-----------------------------------------------------------------
+// AXI write data: a burst's beats are sent once its AW is accepted
+//-----------------------------------------------------------------
+reg       w_active_q;
+reg [7:0] w_left_q;
+reg [7:0] w_credit_q;   // Bursts with AW accepted, W not yet started
+
+wire w_fire_w = axi_wvalid_o && axi_wready_i;
+wire w_end_w  = w_fire_w && axi_wlast_o;
+
+assign w_load_w   = wl_valid_w && (w_credit_q != 8'b0) && (!w_active_q || w_end_w);
+assign data_pop_w = w_fire_w;
+
+always @ (posedge clk_i )
+if (rst_i)
+    w_credit_q <= 8'b0;
+else if (aw_fire_w && !w_load_w)
+    w_credit_q <= w_credit_q + 8'd1;
+else if (!aw_fire_w && w_load_w)
+    w_credit_q <= w_credit_q - 8'd1;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    w_active_q <= 1'b0;
+    w_left_q   <= 8'b0;
+end
+else if (w_load_w)
+begin
+    w_active_q <= 1'b1;
+    w_left_q   <= wl_len_w;
+end
+else if (w_end_w)
+    w_active_q <= 1'b0;
+else if (w_fire_w)
+    w_left_q   <= w_left_q - 8'd1;
+
+assign axi_wvalid_o = w_active_q && data_valid_w;
+assign axi_wdata_o  = data_out_w;
+assign axi_wstrb_o  = strb_out_w;
+assign axi_wlast_o  = (w_left_q == 8'b0);
+
+//-----------------------------------------------------------------
+// AXI write response
+//-----------------------------------------------------------------
+reg [15:0] outstanding_q;
+reg        error_q;
+
+wire b_fire_w = axi_bvalid_i && axi_bready_o;
+
+always @ (posedge clk_i )
+if (rst_i)
+    outstanding_q <= 16'b0;
+else if (aw_fire_w && !b_fire_w)
+    outstanding_q <= outstanding_q + 16'd1;
+else if (!aw_fire_w && b_fire_w)
+    outstanding_q <= outstanding_q - 16'd1;
+
+always @ (posedge clk_i )
+if (rst_i)
+    error_q <= 1'b0;
+else if (start_i)
+    error_q <= 1'b0;
+else if (b_fire_w && axi_bresp_i != 2'b00)
+    error_q <= 1'b1;
+
+assign axi_bready_o = 1'b1;
+assign error_o      = error_q;
+
+// All pixels written and acknowledged
+assign idle_o = !s_valid_q && !a_valid_q && !beat_valid_q && !open_q &&
+                !aw_valid_w && !wl_valid_w && !data_valid_w && !w_active_q &&
+                (outstanding_q == 16'b0);
+
+
+endmodule
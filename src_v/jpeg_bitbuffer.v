@@ -30,6 +30,15 @@
 //-----------------------------------------------------------------
 
 module jpeg_bitbuffer
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter INPUT_BYTES = 1
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
 (
     // Inputs
      input           clk_i
@@ -37,9 +46,11 @@ module jpeg_bitbuffer
     ,input           img_start_i
     ,input           img_end_i
     ,input           inport_valid_i
-    ,input  [  7:0]  inport_data_i
+    ,input  [INPUT_BYTES*8-1:0] inport_data_i
+    ,input  [  3:0]  inport_count_i
     ,input           inport_last_i
     ,input  [  5:0]  outport_pop_i
+    ,input           outport_align_i
 
     // Outputs
     ,output          inport_accept_o
@@ -50,45 +61,66 @@ module jpeg_bitbuffer
 
 
 
+//-----------------------------------------------------------------
+// Local Params
+//-----------------------------------------------------------------
+// 64 bits for a byte wide input, 128 bits for word bursts (always room
+// for a whole burst on top of a 32-bit symbol fetch)
+localparam RAM_BYTES = (INPUT_BYTES > 1) ? 16 : 8;
+localparam PTR_W     = (INPUT_BYTES > 1) ? 7 : 6;
+localparam COUNT_W   = PTR_W + 1;
+
 //-----------------------------------------------------------------
 // Registers
 //-----------------------------------------------------------------
-reg [7:0] ram_q[7:0];
-reg [5:0] rd_ptr_q;
-reg [5:0] wr_ptr_q;
-reg [6:0] count_q;
-reg       drain_q;
+reg [7:0]         ram_q[RAM_BYTES-1:0];
+reg [PTR_W-1:0]   rd_ptr_q;
+reg [PTR_W-1:0]   wr_ptr_q;
+reg [COUNT_W-1:0] count_q;
+reg               drain_q;
+
+// Restart marker: padding bits up to the next byte boundary
+wire [2:0] align_bits_w = 3'd0 - rd_ptr_q[2:0];
+
+// Bits pushed (one byte unless bursting)
+/* verilator lint_off WIDTH */
+wire [COUNT_W-1:0] push_bits_w = (INPUT_BYTES > 1) ? {inport_count_i, 3'b0} : 8;
+/* verilator lint_on WIDTH */
 
 //-----------------------------------------------------------------
 // Input side FIFO
 //-----------------------------------------------------------------
-reg [6:0] count_r; 
+reg [COUNT_W-1:0] count_r; 
 always @ *
 begin
     count_r = count_q;
 
     // Count up
     if (inport_valid_i && inport_accept_o)
-        count_r = count_r + 7'd8;
+        count_r = count_r + push_bits_w;
 
     // Count down
     if (outport_valid_o && (|outport_pop_i))
         count_r = count_r - outport_pop_i;
+    else if (outport_align_i)
+        count_r = count_r - {{(COUNT_W-3){1'b0}}, align_bits_w};
 end
 
+integer i;
+
 always @ (posedge clk_i )
 if (rst_i)
 begin
-    count_q   <= 7'b0;
-    rd_ptr_q  <= 6'b0;
-    wr_ptr_q  <= 6'b0;
+    count_q   <= {(COUNT_W) {1'b0}};
+    rd_ptr_q  <= {(PTR_W) {1'b0}};
+    wr_ptr_q  <= {(PTR_W) {1'b0}};
     drain_q   <= 1'b0;
 end
 else if (img_start_i)
 begin
-    count_q   <= 7'b0;
-    rd_ptr_q  <= 6'b0;
-    wr_ptr_q  <= 6'b0;
+    count_q   <= {(COUNT_W) {1'b0}};
+    rd_ptr_q  <= {(PTR_W) {1'b0}};
+    wr_ptr_q  <= {(PTR_W) {1'b0}};
     drain_q   <= 1'b0;
 end
 else
@@ -98,45 +130,51 @@ begin
         drain_q <= 1'b1;
 
     // Push
+    /* verilator lint_off WIDTH */
     if (inport_valid_i && inport_accept_o)
     begin
-        ram_q[wr_ptr_q[5:3]] <= inport_data_i;
-        wr_ptr_q             <= wr_ptr_q + 6'd8;
+        for (i = 0; i < INPUT_BYTES; i = i + 1)
+            if (INPUT_BYTES == 1 || i < inport_count_i)
+                ram_q[(wr_ptr_q[PTR_W-1:3] + i) % RAM_BYTES] <= inport_data_i[i*8 +: 8];
+        wr_ptr_q <= wr_ptr_q + push_bits_w;
     end
+    /* verilator lint_on WIDTH */
 
     // Pop
     if (outport_valid_o && (|outport_pop_i))
         rd_ptr_q <= rd_ptr_q + outport_pop_i;
+    else if (outport_align_i)
+        rd_ptr_q <= rd_ptr_q + {{(PTR_W-3){1'b0}}, align_bits_w};
 
     count_q <= count_r;
 end
 
-assign inport_accept_o = (count_q <= 7'd56);
+/* verilator lint_off WIDTH */
+assign inport_accept_o = (count_q <= (RAM_BYTES - INPUT_BYTES) * 8);
+/* verilator lint_on WIDTH */
 
 //-------------------------------------------------------------------
 // Output side FIFO
 //-------------------------------------------------------------------
 reg [39:0] fifo_data_r;
+integer j;
 
+// 5 bytes from the read byte onwards (32 bits at any bit offset)
+/* verilator lint_off WIDTH */
 always @ *
 begin
     fifo_data_r = 40'b0;
 
-    case (rd_ptr_q[5:3])
-    3'd0: fifo_data_r = {ram_q[0], ram_q[1], ram_q[2], ram_q[3], ram_q[4]};
-    3'd1: fifo_data_r = {ram_q[1], ram_q[2], ram_q[3], ram_q[4], ram_q[5]};
-    3'd2: fifo_data_r = {ram_q[2], ram_q[3], ram_q[4], ram_q[5], ram_q[6]};
-    3'd3: fifo_data_r = {ram_q[3], ram_q[4], ram_q[5], ram_q[6], ram_q[7]};
-    3'd4: fifo_data_r = {ram_q[4], ram_q[5], ram_q[6], ram_q[7], ram_q[0]};
-    3'd5: fifo_data_r = {ram_q[5], ram_q[6], ram_q[7], ram_q[0], ram_q[1]};
-    3'd6: fifo_data_r = {ram_q[6], ram_q[7], ram_q[0], ram_q[1], ram_q[2]};
-    3'd7: fifo_data_r = {ram_q[7], ram_q[0], ram_q[1], ram_q[2], ram_q[3]};
-    endcase
+    for (j = 0; j < 5; j = j + 1)
+        fifo_data_r[39 - j*8 -: 8] = ram_q[(rd_ptr_q[PTR_W-1:3] + j) % RAM_BYTES];
 end
+/* verilator lint_on WIDTH */
 
 wire [39:0] data_shifted_w = fifo_data_r << rd_ptr_q[2:0];
 
-assign outport_valid_o  = (count_q >= 7'd32) || (drain_q && count_q != 7'd0);
+/* verilator lint_off WIDTH */
+assign outport_valid_o  = (count_q >= 32) || (drain_q && count_q != 0);
+/* verilator lint_on WIDTH */
 assign outport_data_o   = data_shifted_w[39:8];
 assign outport_last_o   = 1'b0;
 
@@ -149,7 +187,7 @@ end
 endfunction
 function [7:0] get_data; /*verilator public*/
 begin
-    get_data = inport_data_i;
+    get_data = inport_data_i[7:0];
 end
 endfunction
 `endif
@@ -35,7 +35,14 @@ module jpeg_core
 //-----------------------------------------------------------------
 #(
      parameter SUPPORT_WRITABLE_DHT = 0,
-     parameter USE_IDCT_IFAST = 0
+     parameter SUPPORT_DHT_FAST_LOOKUP = 1, // First level lookup RAM (SUPPORT_WRITABLE_DHT=1)
+     parameter USE_IDCT_IFAST = 0,
+     parameter INPUT_WIDTH = 32,     // 32 or 64
+     parameter SUPPORT_DUAL_SYMBOL = 0, // Two AC symbols per lookup (standard DHT only)
+     parameter SUPPORT_RASTER_OUTPUT = 0, // Raster order output, 2 pixels per beat
+     parameter RASTER_WIDTH_W = 11,  // Max raster width 2^RASTER_WIDTH_W, wider in block order (SUPPORT_RASTER_OUTPUT=1)
+     parameter SUPPORT_FRAME_OVERLAP = 0, // Decode the next frame while the last is output
+     parameter SUPPORT_DC_ONLY = 0   // 1/8 scale (DC only) decode with dc_only_i (not with SUPPORT_FRAME_OVERLAP)
 )
 //-----------------------------------------------------------------
 // Ports
@@ -45,10 +52,11 @@ module jpeg_core
      input           clk_i
     ,input           rst_i
     ,input           inport_valid_i
-    ,input  [ 31:0]  inport_data_i
-    ,input  [  3:0]  inport_strb_i
+    ,input  [INPUT_WIDTH-1:0]   inport_data_i
+    ,input  [INPUT_WIDTH/8-1:0] inport_strb_i
     ,input           inport_last_i
     ,input           outport_accept_i
+    ,input           dc_only_i
 
     // Outputs
     ,output          inport_accept_o
@@ -60,18 +68,23 @@ module jpeg_core
     ,output [  7:0]  outport_pixel_r_o
     ,output [  7:0]  outport_pixel_g_o
     ,output [  7:0]  outport_pixel_b_o
+    ,output          outport_pixel2_valid_o
+    ,output [  7:0]  outport_pixel2_r_o
+    ,output [  7:0]  outport_pixel2_g_o
+    ,output [  7:0]  outport_pixel2_b_o
     ,output          idle_o
 );
 
-wire  [ 15:0]  idct_outport_data_w;
+// Stage outputs marked public_flat_rd are probed by the simulation block trace
+wire  [ 15:0]  idct_outport_data_w /*verilator public_flat_rd*/;
 wire           dqt_inport_valid_w;
 wire  [ 31:0]  dqt_inport_id_w;
-wire  [ 31:0]  output_outport_data_w;
-wire  [  5:0]  idct_inport_idx_w;
+wire  [ 31:0]  output_outport_data_w /*verilator public_flat_rd*/;
+wire  [  5:0]  idct_inport_idx_w /*verilator public_flat_rd*/;
 wire           dqt_inport_eob_w;
 wire           img_start_w;
 wire  [ 15:0]  img_height_w;
-wire           output_inport_accept_w;
+wire           output_inport_accept_w /*verilator public_flat_rd*/;
 wire  [ 15:0]  img_width_w;
 wire           dht_cfg_valid_w;
 wire           lookup_req_w;
@@ -79,40 +92,89 @@ wire           lookup_valid_w;
 wire  [  1:0]  img_dqt_table_cb_w;
 wire  [  7:0]  dht_cfg_data_w;
 wire           img_end_w;
-wire  [ 31:0]  idct_inport_id_w;
+wire  [ 31:0]  idct_inport_id_w /*verilator public_flat_rd*/;
 wire  [  4:0]  lookup_width_w;
-wire           idct_inport_accept_w;
-wire  [  5:0]  output_inport_idx_w;
+wire           idct_inport_accept_w /*verilator public_flat_rd*/;
+wire  [  5:0]  output_inport_idx_w /*verilator public_flat_rd*/;
 wire  [ 15:0]  dqt_outport_data_w;
 wire           dqt_inport_blk_space_w;
-wire           idct_inport_valid_w;
+wire           idct_inport_valid_w /*verilator public_flat_rd*/;
 wire  [  7:0]  dqt_cfg_data_w;
 wire  [  1:0]  img_dqt_table_y_w;
-wire           idct_inport_eob_w;
+wire           idct_inport_eob_w /*verilator public_flat_rd*/;
 wire           dht_cfg_accept_w;
-wire  [ 31:0]  output_inport_id_w;
-wire           output_inport_valid_w;
+wire  [ 31:0]  output_inport_id_w /*verilator public_flat_rd*/;
+wire           output_inport_valid_w /*verilator public_flat_rd*/;
 wire  [ 15:0]  lookup_input_w;
 wire           dqt_cfg_accept_w;
 wire  [  7:0]  lookup_value_w;
+wire  [ 31:0]  lookup_word_w;
+wire           lookup2_valid_w;
+wire  [  4:0]  lookup2_width_w;
+wire  [  7:0]  lookup2_value_w;
 wire  [  1:0]  lookup_table_w;
 wire           dht_cfg_last_w;
 wire  [  5:0]  dqt_inport_idx_w;
-wire  [  1:0]  img_mode_w;
+wire  [  2:0]  img_mode_w;
+wire  [ 15:0]  img_dri_w;
+wire           bb_outport_align_w;
 wire  [  1:0]  img_dqt_table_cr_w;
 wire           bb_inport_valid_w;
 wire           bb_outport_last_w;
 wire           bb_inport_last_w;
 wire  [  5:0]  bb_outport_pop_w;
-wire  [  7:0]  bb_inport_data_w;
+wire  [INPUT_WIDTH-1:0] bb_inport_data_w;
+wire  [  3:0]  bb_inport_count_w;
 wire           dqt_cfg_valid_w;
 wire           bb_outport_valid_w;
 wire           bb_inport_accept_w;
 wire  [ 31:0]  bb_outport_data_w;
 wire           dqt_cfg_last_w;
+wire           pix_valid_w;
+wire           pix_accept_w;
+wire  [ 15:0]  pix_x_w;
+wire  [ 15:0]  pix_y_w;
+wire  [  7:0]  pix_r_w;
+wire  [  7:0]  pix_g_w;
+wire  [  7:0]  pix_b_w;
+wire           output_idle_w;
+wire           mcu_valid_w;
+wire  [ 31:0]  mcu_id_w;
+wire           mcu_eob_w;
+wire           fe_start_w;
+wire           fe_end_w;
+wire  [ 15:0]  fe_width_w;
+wire  [ 15:0]  fe_height_w;
+wire  [  2:0]  fe_mode_w;
+wire  [ 15:0]  fe_dri_w;
+wire  [  1:0]  fe_dqt_table_y_w;
+wire  [  1:0]  fe_dqt_table_cb_w;
+wire  [  1:0]  fe_dqt_table_cr_w;
+wire           be_start_w;
+wire           data_enable_w;
+wire           dht_enable_w;
+wire           dqt_bank_w;
+wire           out_start_w;
+wire  [ 15:0]  out_width_w;
+wire  [ 15:0]  out_height_w;
+wire  [  2:0]  out_mode_w;
+wire           raster_idle_w;
+wire           dqt_outport_accept_w;
+wire           dc_mode_w;
+wire           dc_accept_w;
+wire           dc_valid_w;
+wire  [ 15:0]  dc_x_w;
+wire  [ 15:0]  dc_y_w;
+wire  [  7:0]  dc_r_w;
+wire  [  7:0]  dc_g_w;
+wire  [  7:0]  dc_b_w;
+wire           dc_idle_w;
 
 
 jpeg_input
+#(
+     .INPUT_WIDTH(INPUT_WIDTH)
+)
 u_jpeg_input
 (
     // Inputs
@@ -123,8 +185,8 @@ u_jpeg_input
     ,.inport_strb_i(inport_strb_i)
     ,.inport_last_i(inport_last_i)
     ,.dqt_cfg_accept_i(dqt_cfg_accept_w)
-    ,.dht_cfg_accept_i(dht_cfg_accept_w)
-    ,.data_accept_i(bb_inport_accept_w)
+    ,.dht_cfg_accept_i(dht_cfg_accept_w && dht_enable_w)
+    ,.data_accept_i(bb_inport_accept_w && data_enable_w)
 
     // Outputs
     ,.inport_accept_o(inport_accept_o)
@@ -136,6 +198,7 @@ u_jpeg_input
     ,.img_dqt_table_y_o(img_dqt_table_y_w)
     ,.img_dqt_table_cb_o(img_dqt_table_cb_w)
     ,.img_dqt_table_cr_o(img_dqt_table_cr_w)
+    ,.img_dri_o(img_dri_w)
     ,.dqt_cfg_valid_o(dqt_cfg_valid_w)
     ,.dqt_cfg_data_o(dqt_cfg_data_w)
     ,.dqt_cfg_last_o(dqt_cfg_last_w)
@@ -144,6 +207,7 @@ u_jpeg_input
     ,.dht_cfg_last_o(dht_cfg_last_w)
     ,.data_valid_o(bb_inport_valid_w)
     ,.data_data_o(bb_inport_data_w)
+    ,.data_count_o(bb_inport_count_w)
     ,.data_last_o(bb_inport_last_w)
 );
 
@@ -151,42 +215,48 @@ u_jpeg_input
 jpeg_dht
 #(
      .SUPPORT_WRITABLE_DHT(SUPPORT_WRITABLE_DHT)
+    ,.SUPPORT_DHT_FAST_LOOKUP(SUPPORT_DHT_FAST_LOOKUP)
+    ,.SUPPORT_DUAL_SYMBOL(SUPPORT_DUAL_SYMBOL)
 )
 u_jpeg_dht
 (
     // Inputs
      .clk_i(clk_i)
     ,.rst_i(rst_i)
-    ,.cfg_valid_i(dht_cfg_valid_w)
+    ,.cfg_valid_i(dht_cfg_valid_w && dht_enable_w)
     ,.cfg_data_i(dht_cfg_data_w)
     ,.cfg_last_i(dht_cfg_last_w)
     ,.lookup_req_i(lookup_req_w)
     ,.lookup_table_i(lookup_table_w)
     ,.lookup_input_i(lookup_input_w)
+    ,.lookup_word_i(lookup_word_w)
 
     // Outputs
     ,.cfg_accept_o(dht_cfg_accept_w)
     ,.lookup_valid_o(lookup_valid_w)
     ,.lookup_width_o(lookup_width_w)
     ,.lookup_value_o(lookup_value_w)
+    ,.lookup2_valid_o(lookup2_valid_w)
+    ,.lookup2_width_o(lookup2_width_w)
+    ,.lookup2_value_o(lookup2_value_w)
 );
 
 
 jpeg_idct
 #(
-    .USE_IDCT_IFAST(USE_IDCT_IFAST)
+     .USE_IDCT_IFAST(USE_IDCT_IFAST)
 )
 u_jpeg_idct
 (
     // Inputs
      .clk_i(clk_i)
     ,.rst_i(rst_i)
-    ,.img_start_i(img_start_w)
+    ,.img_start_i(be_start_w)
     ,.img_end_i(img_end_w)
-    ,.inport_valid_i(idct_inport_valid_w)
+    ,.inport_valid_i(idct_inport_valid_w && !dc_mode_w)
     ,.inport_data_i(idct_outport_data_w)
     ,.inport_idx_i(idct_inport_idx_w)
-    ,.inport_eob_i(idct_inport_eob_w)
+    ,.inport_eob_i(idct_inport_eob_w && !dc_mode_w)
     ,.inport_id_i(idct_inport_id_w)
     ,.outport_accept_i(output_inport_accept_w)
 
@@ -200,25 +270,29 @@ u_jpeg_idct
 
 
 jpeg_dqt
+#(
+     .SUPPORT_FRAME_OVERLAP(SUPPORT_FRAME_OVERLAP)
+)
 u_jpeg_dqt
 (
     // Inputs
      .clk_i(clk_i)
     ,.rst_i(rst_i)
-    ,.img_start_i(img_start_w)
+    ,.img_start_i(be_start_w)
     ,.img_end_i(img_end_w)
-    ,.img_dqt_table_y_i(img_dqt_table_y_w)
-    ,.img_dqt_table_cb_i(img_dqt_table_cb_w)
-    ,.img_dqt_table_cr_i(img_dqt_table_cr_w)
+    ,.img_dqt_table_y_i(fe_dqt_table_y_w)
+    ,.img_dqt_table_cb_i(fe_dqt_table_cb_w)
+    ,.img_dqt_table_cr_i(fe_dqt_table_cr_w)
     ,.cfg_valid_i(dqt_cfg_valid_w)
     ,.cfg_data_i(dqt_cfg_data_w)
     ,.cfg_last_i(dqt_cfg_last_w)
+    ,.cfg_bank_i(dqt_bank_w)
     ,.inport_valid_i(dqt_inport_valid_w)
     ,.inport_data_i(dqt_outport_data_w)
     ,.inport_idx_i(dqt_inport_idx_w)
     ,.inport_id_i(dqt_inport_id_w)
     ,.inport_eob_i(dqt_inport_eob_w)
-    ,.outport_accept_i(idct_inport_accept_w)
+    ,.outport_accept_i(dqt_outport_accept_w)
 
     // Outputs
     ,.cfg_accept_o(dqt_cfg_accept_w)
@@ -231,49 +305,382 @@ u_jpeg_dqt
 );
 
 
-jpeg_output
-u_jpeg_output
-(
-    // Inputs
-     .clk_i(clk_i)
-    ,.rst_i(rst_i)
-    ,.img_start_i(img_start_w)
-    ,.img_end_i(img_end_w)
-    ,.img_width_i(img_width_w)
-    ,.img_height_i(img_height_w)
-    ,.img_mode_i(img_mode_w)
-    ,.inport_valid_i(output_inport_valid_w)
-    ,.inport_data_i(output_outport_data_w)
-    ,.inport_idx_i(output_inport_idx_w)
-    ,.inport_id_i(output_inport_id_w)
-    ,.outport_accept_i(outport_accept_i)
+// DC only decode: sampled at the start of each frame. AC coefficients are
+// dropped by jpeg_mcu_proc, the IDCT / jpeg_output are bypassed and one
+// pixel per block is output (block order, never through the raster buffer).
+generate
+if (SUPPORT_DC_ONLY && SUPPORT_FRAME_OVERLAP)
+begin: PARAM_CHECK
+    // The DC only output has no per frame bank: fail elaboration (no such
+    // module) rather than quietly decoding at full scale
+    SUPPORT_DC_ONLY_requires_SUPPORT_FRAME_OVERLAP_0 u_param_check();
+end
+else if (SUPPORT_DC_ONLY)
+begin: DC_ONLY
+    reg dc_mode_q;
 
-    // Outputs
-    ,.inport_accept_o(output_inport_accept_w)
-    ,.outport_valid_o(outport_valid_o)
-    ,.outport_width_o(outport_width_o)
-    ,.outport_height_o(outport_height_o)
-    ,.outport_pixel_x_o(outport_pixel_x_o)
-    ,.outport_pixel_y_o(outport_pixel_y_o)
-    ,.outport_pixel_r_o(outport_pixel_r_o)
-    ,.outport_pixel_g_o(outport_pixel_g_o)
-    ,.outport_pixel_b_o(outport_pixel_b_o)
-    ,.idle_o(idle_o)
-);
+    always @ (posedge clk_i )
+    if (rst_i)
+        dc_mode_q <= 1'b0;
+    else if (img_start_w)
+        dc_mode_q <= dc_only_i;
+
+    assign dc_mode_w = dc_mode_q;
+
+    jpeg_output_dc
+    u_jpeg_output_dc
+    (
+        // Inputs
+         .clk_i(clk_i)
+        ,.rst_i(rst_i)
+        ,.img_start_i(img_start_w)
+        ,.img_mode_i(img_mode_w)
+        ,.inport_valid_i(idct_inport_valid_w && dc_mode_w)
+        ,.inport_data_i(idct_outport_data_w)
+        ,.inport_idx_i(idct_inport_idx_w)
+        ,.inport_id_i(idct_inport_id_w)
+        ,.inport_eob_i(idct_inport_eob_w && dc_mode_w)
+        ,.outport_accept_i(outport_accept_i)
+
+        // Outputs
+        ,.inport_accept_o(dc_accept_w)
+        ,.outport_valid_o(dc_valid_w)
+        ,.outport_pixel_x_o(dc_x_w)
+        ,.outport_pixel_y_o(dc_y_w)
+        ,.outport_pixel_r_o(dc_r_w)
+        ,.outport_pixel_g_o(dc_g_w)
+        ,.outport_pixel_b_o(dc_b_w)
+        ,.idle_o(dc_idle_w)
+    );
+end
+else
+begin: NO_DC_ONLY
+    assign dc_mode_w   = 1'b0;
+    assign dc_accept_w = 1'b1;
+    assign dc_valid_w  = 1'b0;
+    assign dc_x_w      = 16'b0;
+    assign dc_y_w      = 16'b0;
+    assign dc_r_w      = 8'b0;
+    assign dc_g_w      = 8'b0;
+    assign dc_b_w      = 8'b0;
+    assign dc_idle_w   = 1'b1;
+end
+endgenerate
+
+assign dqt_outport_accept_w = dc_mode_w ? dc_accept_w : idct_inport_accept_w;
+
+generate
+if (SUPPORT_FRAME_OVERLAP)
+begin: OVERLAP
+    wire        front_valid_w;
+    wire        front_idle_w;
+    wire        front_frame_w;
+    wire [1:0]  bank_flush_w;
+    wire [31:0] bank_width_w;
+    wire [31:0] bank_height_w;
+    wire [5:0]  bank_mode_w;
+    wire        out_frame_w;
+    wire        out_done_w;
+
+    jpeg_frame_ctrl
+    u_jpeg_frame_ctrl
+    (
+        // Inputs
+         .clk_i(clk_i)
+        ,.rst_i(rst_i)
+        ,.img_start_i(img_start_w)
+        ,.img_end_i(img_end_w)
+        ,.img_width_i(img_width_w)
+        ,.img_height_i(img_height_w)
+        ,.img_mode_i(img_mode_w)
+        ,.img_dri_i(img_dri_w)
+        ,.img_dqt_table_y_i(img_dqt_table_y_w)
+        ,.img_dqt_table_cb_i(img_dqt_table_cb_w)
+        ,.img_dqt_table_cr_i(img_dqt_table_cr_w)
+        ,.front_eof_i(mcu_eob_w && mcu_id_w[31:30] == 2'd3)
+        ,.out_done_i(out_done_w)
+
+        // Outputs
+        ,.front_start_o(fe_start_w)
+        ,.front_end_o(fe_end_w)
+        ,.front_valid_o(front_valid_w)
+        ,.front_frame_o(front_frame_w)
+        ,.front_width_o(fe_width_w)
+        ,.front_height_o(fe_height_w)
+        ,.front_mode_o(fe_mode_w)
+        ,.front_dri_o(fe_dri_w)
+        ,.front_dqt_table_y_o(fe_dqt_table_y_w)
+        ,.front_dqt_table_cb_o(fe_dqt_table_cb_w)
+        ,.front_dqt_table_cr_o(fe_dqt_table_cr_w)
+        ,.data_enable_o(data_enable_w)
+        ,.front_idle_o(front_idle_w)
+        ,.dqt_bank_o(dqt_bank_w)
+        ,.back_flush_o(be_start_w)
+        ,.bank_flush_o(bank_flush_w)
+        ,.bank_width_o(bank_width_w)
+        ,.bank_height_o(bank_height_w)
+        ,.bank_mode_o(bank_mode_w)
+        ,.out_frame_o(out_frame_w)
+        ,.out_switch_o(out_start_w)
+        ,.idle_o(output_idle_w)
+    );
+
+    // Writable Huffman tables are single buffered: the next frame's DHT waits for the MCU decode
+    assign dht_enable_w = !SUPPORT_WRITABLE_DHT || front_idle_w;
+
+    // Blocks carry their frame parity in id bit 29 (block_y is at most 13 bits)
+    assign dqt_inport_valid_w = mcu_valid_w && front_valid_w;
+    assign dqt_inport_eob_w   = mcu_eob_w && front_valid_w;
+    assign dqt_inport_id_w    = {mcu_id_w[31:30], front_frame_w, mcu_id_w[28:0]};
+
+    // One output (reorder RAMs, colour conversion) per frame parity: the next
+    // frame fills one while the last drains from the other
+    wire [1:0]  bank_accept_w;
+    wire [1:0]  bank_valid_w;
+    wire [1:0]  bank_idle_w;
+    wire [31:0] bank_x_w;
+    wire [31:0] bank_y_w;
+    wire [15:0] bank_r_w;
+    wire [15:0] bank_g_w;
+    wire [15:0] bank_b_w;
+
+    genvar b;
+    for (b = 0; b < 2; b = b + 1)
+    begin: BANK
+        /* verilator lint_off WIDTH */
+        wire push_w = output_inport_valid_w && (output_inport_id_w[29] == b);
+        wire sel_w  = (out_frame_w == b);
+        /* verilator lint_on WIDTH */
+
+        jpeg_output
+        u_jpeg_output
+        (
+            // Inputs
+             .clk_i(clk_i)
+            ,.rst_i(rst_i)
+            ,.img_start_i(bank_flush_w[b])
+            ,.img_end_i(img_end_w)
+            ,.img_width_i(bank_width_w[b*16 +: 16])
+            ,.img_height_i(bank_height_w[b*16 +: 16])
+            ,.img_mode_i(bank_mode_w[b*3 +: 3])
+            ,.inport_valid_i(push_w)
+            ,.inport_data_i(output_outport_data_w)
+            ,.inport_idx_i(output_inport_idx_w)
+            ,.inport_id_i(output_inport_id_w)
+            ,.outport_accept_i(pix_accept_w && sel_w)
+
+            // Outputs
+            ,.inport_accept_o(bank_accept_w[b])
+            ,.outport_valid_o(bank_valid_w[b])
+            ,.outport_width_o()
+            ,.outport_height_o()
+            ,.outport_pixel_x_o(bank_x_w[b*16 +: 16])
+            ,.outport_pixel_y_o(bank_y_w[b*16 +: 16])
+            ,.outport_pixel_r_o(bank_r_w[b*8 +: 8])
+            ,.outport_pixel_g_o(bank_g_w[b*8 +: 8])
+            ,.outport_pixel_b_o(bank_b_w[b*8 +: 8])
+            ,.idle_o(bank_idle_w[b])
+        );
+    end
+
+    assign output_inport_accept_w = bank_accept_w[output_inport_id_w[29]];
+
+    assign pix_valid_w  = bank_valid_w[out_frame_w];
+    assign pix_x_w      = out_frame_w ? bank_x_w[31:16] : bank_x_w[15:0];
+    assign pix_y_w      = out_frame_w ? bank_y_w[31:16] : bank_y_w[15:0];
+    assign pix_r_w      = out_frame_w ? bank_r_w[15:8]  : bank_r_w[7:0];
+    assign pix_g_w      = out_frame_w ? bank_g_w[15:8]  : bank_g_w[7:0];
+    assign pix_b_w      = out_frame_w ? bank_b_w[15:8]  : bank_b_w[7:0];
+
+    // Bank drained: EOF block at the head, last pixel taken (and out of the raster buffer)
+    assign out_done_w   = bank_idle_w[out_frame_w] && !bank_valid_w[out_frame_w] && raster_idle_w;
+
+    assign out_width_w  = out_frame_w ? bank_width_w[31:16]  : bank_width_w[15:0];
+    assign out_height_w = out_frame_w ? bank_height_w[31:16] : bank_height_w[15:0];
+    assign out_mode_w   = out_frame_w ? bank_mode_w[5:3]     : bank_mode_w[2:0];
+
+    assign outport_width_o  = out_width_w;
+    assign outport_height_o = out_height_w;
+end
+else
+begin: SINGLE
+    assign fe_start_w         = img_start_w;
+    assign fe_end_w           = img_end_w;
+    assign fe_width_w         = img_width_w;
+    assign fe_height_w        = img_height_w;
+    assign fe_mode_w          = img_mode_w;
+    assign fe_dri_w           = img_dri_w;
+    assign fe_dqt_table_y_w   = img_dqt_table_y_w;
+    assign fe_dqt_table_cb_w  = img_dqt_table_cb_w;
+    assign fe_dqt_table_cr_w  = img_dqt_table_cr_w;
+    assign be_start_w         = img_start_w;
+    assign data_enable_w      = 1'b1;
+    assign dht_enable_w       = 1'b1;
+    assign dqt_bank_w         = 1'b0;
+    assign dqt_inport_valid_w = mcu_valid_w;
+    assign dqt_inport_eob_w   = mcu_eob_w;
+    assign dqt_inport_id_w    = mcu_id_w;
+    assign out_start_w        = img_start_w;
+    assign out_width_w        = img_width_w;
+    assign out_height_w       = img_height_w;
+    assign out_mode_w         = img_mode_w;
+
+    wire        blk_valid_w;
+    wire [15:0] blk_width_w;
+    wire [15:0] blk_height_w;
+    wire [15:0] blk_x_w;
+    wire [15:0] blk_y_w;
+    wire [7:0]  blk_r_w;
+    wire [7:0]  blk_g_w;
+    wire [7:0]  blk_b_w;
+    wire        blk_idle_w;
+
+    jpeg_output
+    u_jpeg_output
+    (
+        // Inputs
+         .clk_i(clk_i)
+        ,.rst_i(rst_i)
+        ,.img_start_i(img_start_w)
+        ,.img_end_i(img_end_w)
+        ,.img_width_i(img_width_w)
+        ,.img_height_i(img_height_w)
+        ,.img_mode_i(img_mode_w)
+        ,.inport_valid_i(output_inport_valid_w)
+        ,.inport_data_i(output_outport_data_w)
+        ,.inport_idx_i(output_inport_idx_w)
+        ,.inport_id_i(output_inport_id_w)
+        ,.outport_accept_i(pix_accept_w && !dc_mode_w)
+
+        // Outputs
+        ,.inport_accept_o(output_inport_accept_w)
+        ,.outport_valid_o(blk_valid_w)
+        ,.outport_width_o(blk_width_w)
+        ,.outport_height_o(blk_height_w)
+        ,.outport_pixel_x_o(blk_x_w)
+        ,.outport_pixel_y_o(blk_y_w)
+        ,.outport_pixel_r_o(blk_r_w)
+        ,.outport_pixel_g_o(blk_g_w)
+        ,.outport_pixel_b_o(blk_b_w)
+        ,.idle_o(blk_idle_w)
+    );
+
+    // DC only: 1/8 scale image (one pixel per block, rounded up)
+    assign pix_valid_w      = dc_mode_w ? dc_valid_w : blk_valid_w;
+    assign pix_x_w          = dc_mode_w ? dc_x_w     : blk_x_w;
+    assign pix_y_w          = dc_mode_w ? dc_y_w     : blk_y_w;
+    assign pix_r_w          = dc_mode_w ? dc_r_w     : blk_r_w;
+    assign pix_g_w          = dc_mode_w ? dc_g_w     : blk_g_w;
+    assign pix_b_w          = dc_mode_w ? dc_b_w     : blk_b_w;
+    assign output_idle_w    = dc_mode_w ? dc_idle_w  : blk_idle_w;
+    assign outport_width_o  = dc_mode_w ? ((blk_width_w  + 16'd7) >> 3) : blk_width_w;
+    assign outport_height_o = dc_mode_w ? ((blk_height_w + 16'd7) >> 3) : blk_height_w;
+end
+endgenerate
+
+generate
+if (SUPPORT_RASTER_OUTPUT)
+begin: RASTER
+    wire        raster_accept_w;
+    wire        raster_valid_w;
+    wire [15:0] raster_x_w;
+    wire [15:0] raster_y_w;
+    wire [7:0]  raster_r_w;
+    wire [7:0]  raster_g_w;
+    wire [7:0]  raster_b_w;
+    wire        raster_pixel2_valid_w;
+
+    // Frames wider than the line RAM (2^RASTER_WIDTH_W pixels) bypass it in
+    // block order, one pixel per beat, with the padding pixels still dropped
+    wire        raster_wide_w   = ({1'b0, out_width_w} > (17'd1 << RASTER_WIDTH_W)) && !dc_mode_w;
+    wire        raster_pad_w    = raster_wide_w && ((pix_x_w >= out_width_w) || (pix_y_w >= out_height_w));
+    wire        raster_bypass_w = dc_mode_w || raster_wide_w;
+
+    jpeg_output_raster
+    #(
+         .WIDTH_W(RASTER_WIDTH_W)
+    )
+    u_jpeg_output_raster
+    (
+        // Inputs
+         .clk_i(clk_i)
+        ,.rst_i(rst_i)
+        ,.img_start_i(out_start_w)
+        ,.img_width_i(out_width_w)
+        ,.img_height_i(out_height_w)
+        ,.img_mode_i(out_mode_w)
+        ,.inport_valid_i(pix_valid_w && !raster_bypass_w)
+        ,.inport_pixel_x_i(pix_x_w)
+        ,.inport_pixel_y_i(pix_y_w)
+        ,.inport_pixel_r_i(pix_r_w)
+        ,.inport_pixel_g_i(pix_g_w)
+        ,.inport_pixel_b_i(pix_b_w)
+        ,.outport_accept_i(outport_accept_i)
+
+        // Outputs
+        ,.inport_accept_o(raster_accept_w)
+        ,.outport_valid_o(raster_valid_w)
+        ,.outport_pixel_x_o(raster_x_w)
+        ,.outport_pixel_y_o(raster_y_w)
+        ,.outport_pixel_r_o(raster_r_w)
+        ,.outport_pixel_g_o(raster_g_w)
+        ,.outport_pixel_b_o(raster_b_w)
+        ,.outport_pixel2_valid_o(raster_pixel2_valid_w)
+        ,.outport_pixel2_r_o(outport_pixel2_r_o)
+        ,.outport_pixel2_g_o(outport_pixel2_g_o)
+        ,.outport_pixel2_b_o(outport_pixel2_b_o)
+        ,.idle_o(raster_idle_w)
+    );
+
+    // DC only and wide frames bypass the raster buffer (block order, one per beat)
+    assign pix_accept_w           = raster_bypass_w ? (outport_accept_i || raster_pad_w) : raster_accept_w;
+    assign outport_valid_o        = raster_bypass_w ? (pix_valid_w && !raster_pad_w) : raster_valid_w;
+    assign outport_pixel_x_o      = raster_bypass_w ? pix_x_w     : raster_x_w;
+    assign outport_pixel_y_o      = raster_bypass_w ? pix_y_w     : raster_y_w;
+    assign outport_pixel_r_o      = raster_bypass_w ? pix_r_w     : raster_r_w;
+    assign outport_pixel_g_o      = raster_bypass_w ? pix_g_w     : raster_g_w;
+    assign outport_pixel_b_o      = raster_bypass_w ? pix_b_w     : raster_b_w;
+    assign outport_pixel2_valid_o = raster_pixel2_valid_w && !raster_bypass_w;
+end
+else
+begin: BLOCK
+    // Block order: one pixel per beat straight from jpeg_output
+    assign pix_accept_w           = outport_accept_i;
+    assign outport_valid_o        = pix_valid_w;
+    assign outport_pixel_x_o      = pix_x_w;
+    assign outport_pixel_y_o      = pix_y_w;
+    assign outport_pixel_r_o      = pix_r_w;
+    assign outport_pixel_g_o      = pix_g_w;
+    assign outport_pixel_b_o      = pix_b_w;
+    assign outport_pixel2_valid_o = 1'b0;
+    assign outport_pixel2_r_o     = 8'b0;
+    assign outport_pixel2_g_o     = 8'b0;
+    assign outport_pixel2_b_o     = 8'b0;
+    assign raster_idle_w          = 1'b1;
+end
+endgenerate
+
+assign idle_o = output_idle_w && raster_idle_w;
 
 
 jpeg_bitbuffer
+#(
+    // Byte at a time, or word bursts of scan data when the input is wider than 32-bits
+     .INPUT_BYTES((INPUT_WIDTH > 32) ? (INPUT_WIDTH / 8) : 1)
+)
 u_jpeg_bitbuffer
 (
     // Inputs
      .clk_i(clk_i)
     ,.rst_i(rst_i)
-    ,.img_start_i(img_start_w)
-    ,.img_end_i(img_end_w)
-    ,.inport_valid_i(bb_inport_valid_w)
-    ,.inport_data_i(bb_inport_data_w)
-    ,.inport_last_i(bb_inport_last_w)
+    ,.img_start_i(fe_start_w)
+    ,.img_end_i(fe_end_w)
+    ,.inport_valid_i(bb_inport_valid_w && data_enable_w)
+    ,.inport_data_i(bb_inport_data_w[((INPUT_WIDTH > 32) ? INPUT_WIDTH : 8)-1:0])
+    ,.inport_count_i(bb_inport_count_w)
+    ,.inport_last_i(bb_inport_last_w && data_enable_w)
     ,.outport_pop_i(bb_outport_pop_w)
+    ,.outport_align_i(bb_outport_align_w)
 
     // Outputs
     ,.inport_accept_o(bb_inport_accept_w)
@@ -284,34 +691,44 @@ u_jpeg_bitbuffer
 
 
 jpeg_mcu_proc
+#(
+     .SUPPORT_DUAL_SYMBOL(SUPPORT_DUAL_SYMBOL && !SUPPORT_WRITABLE_DHT)
+)
 u_jpeg_mcu_proc
 (
     // Inputs
      .clk_i(clk_i)
     ,.rst_i(rst_i)
-    ,.img_start_i(img_start_w)
-    ,.img_end_i(img_end_w)
-    ,.img_width_i(img_width_w)
-    ,.img_height_i(img_height_w)
-    ,.img_mode_i(img_mode_w)
+    ,.img_start_i(fe_start_w)
+    ,.img_end_i(fe_end_w)
+    ,.img_width_i(fe_width_w)
+    ,.img_height_i(fe_height_w)
+    ,.img_mode_i(fe_mode_w)
+    ,.img_dri_i(fe_dri_w)
+    ,.dc_only_i(dc_mode_w)
     ,.inport_valid_i(bb_outport_valid_w)
     ,.inport_data_i(bb_outport_data_w)
     ,.inport_last_i(bb_outport_last_w)
     ,.lookup_valid_i(lookup_valid_w)
     ,.lookup_width_i(lookup_width_w)
     ,.lookup_value_i(lookup_value_w)
+    ,.lookup2_valid_i(lookup2_valid_w)
+    ,.lookup2_width_i(lookup2_width_w)
+    ,.lookup2_value_i(lookup2_value_w)
     ,.outport_blk_space_i(dqt_inport_blk_space_w)
 
     // Outputs
     ,.inport_pop_o(bb_outport_pop_w)
+    ,.inport_align_o(bb_outport_align_w)
     ,.lookup_req_o(lookup_req_w)
     ,.lookup_table_o(lookup_table_w)
     ,.lookup_input_o(lookup_input_w)
-    ,.outport_valid_o(dqt_inport_valid_w)
+    ,.lookup_word_o(lookup_word_w)
+    ,.outport_valid_o(mcu_valid_w)
     ,.outport_data_o(dqt_outport_data_w)
     ,.outport_idx_o(dqt_inport_idx_w)
-    ,.outport_id_o(dqt_inport_id_w)
-    ,.outport_eob_o(dqt_inport_eob_w)
+    ,.outport_id_o(mcu_id_w)
+    ,.outport_eob_o(mcu_eob_w)
 );
 
 
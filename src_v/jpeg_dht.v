@@ -34,7 +34,9 @@ module jpeg_dht
 // Params
 //-----------------------------------------------------------------
 #(
-     parameter SUPPORT_WRITABLE_DHT = 0
+     parameter SUPPORT_WRITABLE_DHT    = 0
+    ,parameter SUPPORT_DHT_FAST_LOOKUP = 1
+    ,parameter SUPPORT_DUAL_SYMBOL     = 0
 )
 //-----------------------------------------------------------------
 // Ports
@@ -49,12 +51,16 @@ module jpeg_dht
     ,input           lookup_req_i
     ,input  [  1:0]  lookup_table_i
     ,input  [ 15:0]  lookup_input_i
+    ,input  [ 31:0]  lookup_word_i
 
     // Outputs
     ,output          cfg_accept_o
     ,output          lookup_valid_o
     ,output [  4:0]  lookup_width_o
     ,output [  7:0]  lookup_value_o
+    ,output          lookup2_valid_o
+    ,output [  4:0]  lookup2_width_o
+    ,output [  7:0]  lookup2_value_o
 );
 
 
@@ -177,6 +183,7 @@ begin
     reg [7:0]  j_q;
     reg [15:0] code_q;
     reg [9:0]  next_ptr_q;
+    reg        fill_busy_q; // First level lookup fill in progress
 
     always @ (posedge clk_i )
     if (rst_i)
@@ -428,13 +435,13 @@ begin
         end
     end
     // Increment through empty bit widths
-    else if (cfg_valid_i && !cfg_accept_o)
+    else if (cfg_valid_i && !cfg_accept_o && !fill_busy_q)
     begin
         i_q    <= i_q + 4'd1;
         code_q <= code_q << 1;
     end
 
-    assign cfg_accept_o = has_entries_q[i_q] || (idx_q < 12'd16) || (idx_q == 12'hFFF);
+    assign cfg_accept_o = (has_entries_q[i_q] || (idx_q < 12'd16) || (idx_q == 12'hFFF)) && !fill_busy_q;
 
     //-----------------------------------------------------------------
     // Code table write pointer
@@ -447,6 +454,85 @@ begin
     else if (alloc_entry_w)
         next_ptr_q <= next_ptr_q + 10'd1;
 
+    //-----------------------------------------------------------------
+    // First level lookup: RAM indexed by table and the top 8 input bits
+    // holding {width - 1, value} for codes of up to 8 bits, filled as the
+    // DHT loads (one entry per cycle, cfg_accept_o held low meanwhile).
+    // Canonical codes of <= 8 bits take the 8-bit prefixes [0, limit) of
+    // each table, so anything at or above the limit (longer codes, or a
+    // fill still in progress) goes through the min / max code search.
+    //-----------------------------------------------------------------
+    reg [7:0]  fill_addr_q;
+    reg [8:0]  fill_end_q;
+    reg [11:0] fill_data_q;
+    reg [1:0]  fill_table_q;
+    reg [8:0]  fast_limit_q[0:3];
+
+    wire [1:0] cfg_table_idx_w = {cfg_table_q[0], cfg_table_q[4]};
+    wire [8:0] fill_base_w     = {1'b0, code_q[7:0]} << (4'd7 - i_q);
+    wire [8:0] fill_next_w     = ({1'b0, code_q[7:0]} + 9'd1) << (4'd7 - i_q);
+
+    always @ (posedge clk_i )
+    if (rst_i)
+    begin
+        fill_busy_q  <= 1'b0;
+        fill_addr_q  <= 8'b0;
+        fill_end_q   <= 9'b0;
+        fill_data_q  <= 12'b0;
+        fill_table_q <= 2'b0;
+    end
+    else if (fill_busy_q)
+    begin
+        fill_addr_q <= fill_addr_q + 8'd1;
+        if ({1'b0, fill_addr_q} + 9'd1 == fill_end_q)
+            fill_busy_q <= 1'b0;
+    end
+    else if (SUPPORT_DHT_FAST_LOOKUP && alloc_entry_w && i_q < 4'd8)
+    begin
+        fill_busy_q  <= 1'b1;
+        fill_addr_q  <= fill_base_w[7:0];
+        fill_end_q   <= fill_next_w;
+        fill_data_q  <= {i_q, cfg_data_i};
+        fill_table_q <= cfg_table_idx_w;
+    end
+
+    always @ (posedge clk_i )
+    if (rst_i)
+    begin
+        fast_limit_q[0] <= 9'b0;
+        fast_limit_q[1] <= 9'b0;
+        fast_limit_q[2] <= 9'b0;
+        fast_limit_q[3] <= 9'b0;
+    end
+    // New table: nothing resolved by the first level until filled
+    else if (cfg_valid_i && cfg_accept_o && idx_q == 12'hFFF)
+        fast_limit_q[{cfg_data_i[0], cfg_data_i[4]}] <= 9'b0;
+    else if (fill_busy_q && {1'b0, fill_addr_q} + 9'd1 == fill_end_q)
+        fast_limit_q[fill_table_q] <= fill_end_q;
+
+    reg [11:0] fast_ram[0:1023];
+
+    always @ (posedge clk_i)
+    begin
+        if (fill_busy_q)
+            fast_ram[{fill_table_q, fill_addr_q}] <= fill_data_q;
+    end
+
+    reg [11:0] fast_data_q;
+
+    always @ (posedge clk_i)
+    begin
+        fast_data_q <= fast_ram[{lookup_table_i, lookup_input_i[15:8]}];
+    end
+
+    reg fast_hit_q;
+
+    always @ (posedge clk_i )
+    if (rst_i)
+        fast_hit_q <= 1'b0;
+    else
+        fast_hit_q <= SUPPORT_DHT_FAST_LOOKUP && ({1'b0, lookup_input_i[15:8]} < fast_limit_q[lookup_table_i]);
+
     //-----------------------------------------------------------------
     // Lookup: Match shortest bit sequence
     //-----------------------------------------------------------------
@@ -701,12 +787,13 @@ begin
     else
         lookup_valid_q <= lookup_req_i;
 
+    // Second cycle only for codes not resolved by the first level lookup
     reg lookup_valid2_q;
     always @ (posedge clk_i )
     if (rst_i)
         lookup_valid2_q <= 1'b0;
     else
-        lookup_valid2_q <= lookup_valid_q;
+        lookup_valid2_q <= lookup_valid_q && !fast_hit_q;
 
     reg [4:0]  lookup_width2_q;
 
@@ -716,9 +803,15 @@ begin
     else
         lookup_width2_q <= {1'b0, lookup_width_q} + 5'd1;
 
-    assign lookup_valid_o = lookup_valid2_q;
-    assign lookup_value_o = data_value_q;
-    assign lookup_width_o = lookup_width2_q;
+    wire fast_valid_w = lookup_valid_q && fast_hit_q;
+
+    assign lookup_valid_o = fast_valid_w || lookup_valid2_q;
+    assign lookup_value_o = fast_valid_w ? fast_data_q[7:0] : data_value_q;
+    assign lookup_width_o = fast_valid_w ? ({1'b0, fast_data_q[11:8]} + 5'd1) : lookup_width2_q;
+    // Second symbol decode only with the standard tables
+    assign lookup2_valid_o = 1'b0;
+    assign lookup2_width_o = 5'b0;
+    assign lookup2_value_o = 8'b0;
 end
 //---------------------------------------------------------------------
 // Support only standard huffman tables (from JPEG spec).
@@ -784,6 +877,19 @@ begin
     //-----------------------------------------------------------------
     // Lookup
     //-----------------------------------------------------------------
+    reg [7:0] value_r;
+    reg [4:0] width_r;
+
+    always @ *
+    begin
+        case (lookup_table_i)
+        2'd0:    begin value_r = y_dc_value_w;  width_r = y_dc_width_w;  end
+        2'd1:    begin value_r = y_ac_value_w;  width_r = y_ac_width_w;  end
+        2'd2:    begin value_r = cx_dc_value_w; width_r = cx_dc_width_w; end
+        default: begin value_r = cx_ac_value_w; width_r = cx_ac_width_w; end
+        endcase
+    end
+
     reg lookup_valid_q;
 
     always @ (posedge clk_i )
@@ -800,14 +906,7 @@ begin
     if (rst_i)
         lookup_value_q <= 8'b0;
     else
-    begin
-        case (lookup_table_i)
-        2'd0: lookup_value_q <= y_dc_value_w;
-        2'd1: lookup_value_q <= y_ac_value_w;
-        2'd2: lookup_value_q <= cx_dc_value_w;
-        2'd3: lookup_value_q <= cx_ac_value_w;
-        endcase
-    end
+        lookup_value_q <= value_r;
 
     assign lookup_value_o = lookup_value_q;
 
@@ -817,17 +916,79 @@ begin
     if (rst_i)
         lookup_width_q <= 5'b0;
     else
-    begin
-        case (lookup_table_i)
-        2'd0: lookup_width_q <= y_dc_width_w;
-        2'd1: lookup_width_q <= y_ac_width_w;
-        2'd2: lookup_width_q <= cx_dc_width_w;
-        2'd3: lookup_width_q <= cx_ac_width_w;
-        endcase
-    end
+        lookup_width_q <= width_r;
 
     assign lookup_width_o = lookup_width_q;
 
+    //-----------------------------------------------------------------
+    // Second symbol: AC lookup on the bits following the first code and
+    // its coefficient bits. Valid when the first symbol is an AC symbol
+    // other than EOB and both symbols (codes + coefficients) fit in the
+    // 32-bit lookup word.
+    //-----------------------------------------------------------------
+    if (SUPPORT_DUAL_SYMBOL)
+    begin
+        wire [5:0]  first_bits_w = {1'b0, width_r} + {2'b0, value_r[3:0]};
+        wire [31:0] second_word_w = lookup_word_i << first_bits_w;
+
+        wire [7:0] y_ac2_value_w;
+        wire [4:0] y_ac2_width_w;
+
+        jpeg_dht_std_y_ac
+        u_fixed_y_ac2
+        (
+             .lookup_input_i(second_word_w[31:16])
+            ,.lookup_value_o(y_ac2_value_w)
+            ,.lookup_width_o(y_ac2_width_w)
+        );
+
+        wire [7:0] cx_ac2_value_w;
+        wire [4:0] cx_ac2_width_w;
+
+        jpeg_dht_std_cx_ac
+        u_fixed_cx_ac2
+        (
+             .lookup_input_i(second_word_w[31:16])
+            ,.lookup_value_o(cx_ac2_value_w)
+            ,.lookup_width_o(cx_ac2_width_w)
+        );
+
+        wire [7:0] second_value_w = lookup_table_i[1] ? cx_ac2_value_w : y_ac2_value_w;
+        wire [4:0] second_width_w = lookup_table_i[1] ? cx_ac2_width_w : y_ac2_width_w;
+        wire [6:0] pair_bits_w    = {1'b0, first_bits_w} + {2'b0, second_width_w} + {3'b0, second_value_w[3:0]};
+
+        wire second_w = lookup_table_i[0] && (value_r != 8'h00) && (width_r != 5'd0) &&
+                        (second_width_w != 5'd0) && (pair_bits_w <= 7'd32);
+
+        reg       lookup2_valid_q;
+        reg [7:0] lookup2_value_q;
+        reg [4:0] lookup2_width_q;
+
+        always @ (posedge clk_i )
+        if (rst_i)
+        begin
+            lookup2_valid_q <= 1'b0;
+            lookup2_value_q <= 8'b0;
+            lookup2_width_q <= 5'b0;
+        end
+        else
+        begin
+            lookup2_valid_q <= lookup_req_i && second_w;
+            lookup2_value_q <= second_value_w;
+            lookup2_width_q <= second_width_w;
+        end
+
+        assign lookup2_valid_o = lookup2_valid_q;
+        assign lookup2_value_o = lookup2_value_q;
+        assign lookup2_width_o = lookup2_width_q;
+    end
+    else
+    begin
+        assign lookup2_valid_o = 1'b0;
+        assign lookup2_width_o = 5'b0;
+        assign lookup2_value_o = 8'b0;
+    end
+
     assign cfg_accept_o = 1'b1;
 end
 endgenerate
@@ -30,6 +30,15 @@
 //-----------------------------------------------------------------
 
 module jpeg_dqt
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter SUPPORT_FRAME_OVERLAP = 0 // Two table banks (cfg_bank_i / id bit 29)
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
 (
     // Inputs
      input           clk_i
@@ -42,6 +51,7 @@ module jpeg_dqt
     ,input           cfg_valid_i
     ,input  [  7:0]  cfg_data_i
     ,input           cfg_last_i
+    ,input           cfg_bank_i
     ,input           inport_valid_i
     ,input  [ 15:0]  inport_data_i
     ,input  [  5:0]  inport_idx_i
@@ -64,8 +74,8 @@ module jpeg_dqt
 //-----------------------------------------------------------------
 // DQT tables
 //-----------------------------------------------------------------
-// 4 * 256
-reg [7:0] table_dqt_q[0:255];
+// 4 * 256 (per bank)
+reg [7:0] table_dqt_q[0:(256 << SUPPORT_FRAME_OVERLAP)-1];
 
 //-----------------------------------------------------------------
 // Capture Index
@@ -93,7 +103,12 @@ if (rst_i)
 else if (cfg_valid_i && cfg_accept_o && idx_q == 8'hFF)
     cfg_table_q <= cfg_data_i[1:0];
 
-wire [7:0] cfg_table_addr_w = {cfg_table_q, idx_q[5:0]};
+// Frame overlap: the next frame's tables are written to the other bank
+// while blocks of the current frame are read (by their frame parity)
+wire       cfg_bank_w = SUPPORT_FRAME_OVERLAP ? cfg_bank_i : 1'b0;
+wire       rd_bank_w  = SUPPORT_FRAME_OVERLAP ? inport_id_i[29] : 1'b0;
+
+wire [8:0] cfg_table_addr_w = {cfg_bank_w, cfg_table_q, idx_q[5:0]};
 
 wire [1:0] table_src_w[3:0];
 
@@ -102,20 +117,25 @@ assign table_src_w[1] = img_dqt_table_cb_i;
 assign table_src_w[2] = img_dqt_table_cr_i;
 assign table_src_w[3] = 2'b0;
 
-wire [7:0] table_rd_idx_w   = {table_src_w[inport_id_i[31:30]], inport_idx_i};
+wire [8:0] table_rd_idx_w   = {rd_bank_w, table_src_w[inport_id_i[31:30]], inport_idx_i};
 
 wire       dqt_write_w      = cfg_valid_i && cfg_accept_o && idx_q != 8'hFF;
-wire [7:0] dqt_table_addr_w = dqt_write_w ? cfg_table_addr_w : table_rd_idx_w;
+wire [8:0] dqt_table_addr_w = dqt_write_w ? cfg_table_addr_w : table_rd_idx_w;
+
+// Single port, or separate write / read ports when tables are written during a frame
+wire [8:0] dqt_rd_addr_w    = SUPPORT_FRAME_OVERLAP ? table_rd_idx_w : dqt_table_addr_w;
 
 reg [7:0] dqt_entry_q;
 
+/* verilator lint_off WIDTH */
 always @ (posedge clk_i )
 begin
     if (dqt_write_w)
         table_dqt_q[dqt_table_addr_w] <= cfg_data_i;
 
-    dqt_entry_q <= table_dqt_q[dqt_table_addr_w];
+    dqt_entry_q <= table_dqt_q[dqt_rd_addr_w];
 end
+/* verilator lint_on WIDTH */
 
 //-----------------------------------------------------------------
 // dezigzag: Reverse zigzag process
@@ -0,0 +1,233 @@
+//-----------------------------------------------------------------
+//                      Baseline JPEG Decoder
+//                             V0.1
+//                       Ultra-Embedded.com
+//                        Copyright 2020
+//
+//                   admin@ultra-embedded.com
+//-----------------------------------------------------------------
+//                      License: Apache 2.0
+// This IP can be freely used in commercial projects, however you may
+// want access to unreleased materials such as verification environments,
+// or test vectors, as well as changes to the IP for integration purposes.
+// If this is the case, contact the above address.
+// I am interested to hear how and where this IP is used, so please get
+// in touch!
+//-----------------------------------------------------------------
+// Copyright 2020 Ultra-Embedded.com
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------
+
+
+module jpeg_frame_ctrl
+(
+    // Inputs
+     input           clk_i
+    ,input           rst_i
+    ,input           img_start_i
+    ,input           img_end_i
+    ,input  [ 15:0]  img_width_i
+    ,input  [ 15:0]  img_height_i
+    ,input  [  2:0]  img_mode_i
+    ,input  [ 15:0]  img_dri_i
+    ,input  [  1:0]  img_dqt_table_y_i
+    ,input  [  1:0]  img_dqt_table_cb_i
+    ,input  [  1:0]  img_dqt_table_cr_i
+    ,input           front_eof_i
+    ,input           out_done_i
+
+    // Outputs
+    ,output          front_start_o
+    ,output          front_end_o
+    ,output          front_valid_o
+    ,output          front_frame_o
+    ,output [ 15:0]  front_width_o
+    ,output [ 15:0]  front_height_o
+    ,output [  2:0]  front_mode_o
+    ,output [ 15:0]  front_dri_o
+    ,output [  1:0]  front_dqt_table_y_o
+    ,output [  1:0]  front_dqt_table_cb_o
+    ,output [  1:0]  front_dqt_table_cr_o
+    ,output          data_enable_o
+    ,output          front_idle_o
+    ,output          dqt_bank_o
+    ,output          back_flush_o
+    ,output [  1:0]  bank_flush_o
+    ,output [ 31:0]  bank_width_o
+    ,output [ 31:0]  bank_height_o
+    ,output [  5:0]  bank_mode_o
+    ,output          out_frame_o
+    ,output          out_switch_o
+    ,output          idle_o
+);
+
+//-----------------------------------------------------------------
+// Frame overlap: jpeg_input runs ahead into the next frame's headers
+// while the current frame is still in the decode pipeline. Frames
+// alternate between two banks (frame parity): the front end (bit
+// buffer, MCU decode) works on one frame at a time, the back end
+// (IDCT, output) can hold the tail of the previous frame as well.
+//
+// Front end: a frame starts once its headers are parsed (jpeg_input
+// in the scan), the previous frame's EOF block has left jpeg_mcu_proc
+// and its bank is free. Header values are captured into the bank on
+// start as jpeg_input moves on to the next frame.
+//
+// Back end: blocks carry their frame parity (block id bit 29), the
+// output drains one bank at a time and switches when the EOF block of
+// the bank is at its head and all pixels are out.
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Front end
+//-----------------------------------------------------------------
+reg       hdr_q;        // Headers of a new frame seen (SOI)
+reg       front_idle_q; // No frame in jpeg_mcu_proc (EOF block out)
+reg       front_end_q;  // EOI of the frame in jpeg_mcu_proc seen
+reg       front_frame_q;
+reg [1:0] in_flight_q;  // Frames started, not yet switched out
+
+wire front_start_w = hdr_q && !img_start_i && !img_end_i && front_idle_q && (in_flight_q != 2'd2);
+wire out_switch_w  = out_done_i && (in_flight_q != 2'd0);
+
+always @ (posedge clk_i )
+if (rst_i)
+    hdr_q <= 1'b0;
+else if (front_start_w)
+    hdr_q <= 1'b0;
+else if (img_start_i)
+    hdr_q <= 1'b1;
+
+always @ (posedge clk_i )
+if (rst_i)
+    front_idle_q <= 1'b1;
+else if (front_start_w)
+    front_idle_q <= 1'b0;
+else if (front_eof_i)
+    front_idle_q <= 1'b1;
+
+// img_end_i drops on the next frame's SOI, held until that frame starts
+always @ (posedge clk_i )
+if (rst_i)
+    front_end_q <= 1'b0;
+else if (front_start_w)
+    front_end_q <= 1'b0;
+else if (img_end_i)
+    front_end_q <= 1'b1;
+
+always @ (posedge clk_i )
+if (rst_i)
+    front_frame_q <= 1'b1;
+else if (front_start_w)
+    front_frame_q <= ~front_frame_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+    in_flight_q <= 2'd0;
+else if (front_start_w && !out_switch_w)
+    in_flight_q <= in_flight_q + 2'd1;
+else if (out_switch_w && !front_start_w)
+    in_flight_q <= in_flight_q - 2'd1;
+
+// jpeg_mcu_proc still presents the last push on the cycle after start
+reg front_start_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+    front_start_q <= 1'b0;
+else
+    front_start_q <= front_start_w;
+
+//-----------------------------------------------------------------
+// Per bank header values
+//-----------------------------------------------------------------
+reg [15:0] width_q[1:0];
+reg [15:0] height_q[1:0];
+reg [2:0]  mode_q[1:0];
+reg [15:0] dri_q[1:0];
+reg [5:0]  dqt_table_q[1:0];
+
+integer i;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    for (i = 0; i < 2; i = i + 1)
+    begin
+        width_q[i]     <= 16'b0;
+        height_q[i]    <= 16'b0;
+        mode_q[i]      <= 3'b0;
+        dri_q[i]       <= 16'b0;
+        dqt_table_q[i] <= 6'b0;
+    end
+end
+else if (front_start_w)
+begin
+    width_q[~front_frame_q]     <= img_width_i;
+    height_q[~front_frame_q]    <= img_height_i;
+    mode_q[~front_frame_q]      <= img_mode_i;
+    dri_q[~front_frame_q]       <= img_dri_i;
+    dqt_table_q[~front_frame_q] <= {img_dqt_table_cr_i, img_dqt_table_cb_i, img_dqt_table_y_i};
+end
+
+//-----------------------------------------------------------------
+// Back end
+//-----------------------------------------------------------------
+reg out_frame_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+    out_frame_q <= 1'b0;
+else if (out_switch_w)
+    out_frame_q <= ~out_frame_q;
+
+//-----------------------------------------------------------------
+// Outputs
+//-----------------------------------------------------------------
+assign front_start_o        = front_start_w;
+assign front_end_o          = front_end_q || img_end_i;
+assign front_valid_o        = !front_idle_q && !front_start_q;
+assign front_frame_o        = front_frame_q;
+assign front_width_o        = width_q[front_frame_q];
+assign front_height_o       = height_q[front_frame_q];
+assign front_mode_o         = mode_q[front_frame_q];
+assign front_dri_o          = dri_q[front_frame_q];
+assign front_dqt_table_y_o  = dqt_table_q[front_frame_q][1:0];
+assign front_dqt_table_cb_o = dqt_table_q[front_frame_q][3:2];
+assign front_dqt_table_cr_o = dqt_table_q[front_frame_q][5:4];
+
+// Scan data is held in jpeg_input until the frame starts (the last frame may
+// still be in jpeg_mcu_proc when the next frame's scan is reached)
+assign data_enable_o        = !front_idle_q && !hdr_q;
+assign front_idle_o         = front_idle_q;
+
+// DQT tables are double buffered, the next frame's go to the other bank
+assign dqt_bank_o           = ~front_frame_q;
+
+// Nothing in flight: the back end can be flushed on a new frame (as without overlap)
+assign back_flush_o         = img_start_i && front_idle_q && (in_flight_q == 2'd0);
+
+// Output bank reset as a frame is assigned to it
+assign bank_flush_o         = {front_start_w & ~front_frame_q, front_start_w & front_frame_q};
+assign bank_width_o         = {width_q[1], width_q[0]};
+assign bank_height_o        = {height_q[1], height_q[0]};
+assign bank_mode_o          = {mode_q[1], mode_q[0]};
+
+assign out_frame_o          = out_frame_q;
+assign out_switch_o         = out_switch_w;
+
+assign idle_o               = front_idle_q && (in_flight_q == 2'd0) && !hdr_q && !img_start_i;
+
+
+endmodule
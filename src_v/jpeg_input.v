@@ -30,13 +30,22 @@
 //-----------------------------------------------------------------
 
 module jpeg_input
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter INPUT_WIDTH = 32
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
 (
     // Inputs
      input           clk_i
     ,input           rst_i
     ,input           inport_valid_i
-    ,input  [ 31:0]  inport_data_i
-    ,input  [  3:0]  inport_strb_i
+    ,input  [INPUT_WIDTH-1:0]   inport_data_i
+    ,input  [INPUT_WIDTH/8-1:0] inport_strb_i
     ,input           inport_last_i
     ,input           dqt_cfg_accept_i
     ,input           dht_cfg_accept_i
@@ -48,10 +57,11 @@ module jpeg_input
     ,output          img_end_o
     ,output [ 15:0]  img_width_o
     ,output [ 15:0]  img_height_o
-    ,output [  1:0]  img_mode_o
+    ,output [  2:0]  img_mode_o
     ,output [  1:0]  img_dqt_table_y_o
     ,output [  1:0]  img_dqt_table_cb_o
     ,output [  1:0]  img_dqt_table_cr_o
+    ,output [ 15:0]  img_dri_o
     ,output          dqt_cfg_valid_o
     ,output [  7:0]  dqt_cfg_data_o
     ,output          dqt_cfg_last_o
@@ -59,26 +69,33 @@ module jpeg_input
     ,output [  7:0]  dht_cfg_data_o
     ,output          dht_cfg_last_o
     ,output          data_valid_o
-    ,output [  7:0]  data_data_o
+    ,output [INPUT_WIDTH-1:0] data_data_o
+    ,output [  3:0]  data_count_o
     ,output          data_last_o
 );
 
+localparam INPUT_BYTES = INPUT_WIDTH / 8;
+localparam IDX_W       = (INPUT_BYTES > 4) ? 3 : 2;
 
+// Wider than 32-bits: entropy coded words without 0xFF bytes pass to the
+// bit buffer whole, everything else goes through the byte parser
+localparam WIDE_SCAN   = (INPUT_BYTES > 4);
 
 wire inport_accept_w;
+wire wide_w;
 
 //-----------------------------------------------------------------
 // Input data read index
 //-----------------------------------------------------------------
-reg [1:0] byte_idx_q;
+reg [IDX_W-1:0] byte_idx_q;
 
 always @ (posedge clk_i )
 if (rst_i)
-    byte_idx_q <= 2'b0;
-else if (inport_valid_i && inport_accept_w && inport_last_i)
-    byte_idx_q <= 2'b0;
+    byte_idx_q <= {IDX_W{1'b0}};
+else if (inport_valid_i && inport_accept_w && (inport_last_i || wide_w))
+    byte_idx_q <= {IDX_W{1'b0}};
 else if (inport_valid_i && inport_accept_w)
-    byte_idx_q <= byte_idx_q + 2'd1;
+    byte_idx_q <= byte_idx_q + 1'b1;
 
 //-----------------------------------------------------------------
 // Data mux
@@ -87,16 +104,12 @@ reg [7:0] data_r;
 
 always @ *
 begin
-    data_r = 8'b0;
-
-    case (byte_idx_q)
-    default: data_r = {8{inport_strb_i[0]}} & inport_data_i[7:0];
-    2'd1:    data_r = {8{inport_strb_i[1]}} & inport_data_i[15:8];
-    2'd2:    data_r = {8{inport_strb_i[2]}} & inport_data_i[23:16];
-    2'd3:    data_r = {8{inport_strb_i[3]}} & inport_data_i[31:24];
-    endcase
+    data_r = {8{inport_strb_i[byte_idx_q]}} & inport_data_i[byte_idx_q*8 +: 8];
 end
 
+// Last byte of the word (kept back by the wide path, see below)
+wire [7:0] word_last_w = inport_data_i[INPUT_WIDTH-1:INPUT_WIDTH-8];
+
 //-----------------------------------------------------------------
 // Last data
 //-----------------------------------------------------------------
@@ -106,25 +119,26 @@ always @ (posedge clk_i )
 if (rst_i)
     last_b_q <= 8'b0;
 else if (inport_valid_i && inport_accept_w)
-    last_b_q <= inport_last_i ? 8'b0 : data_r;
+    last_b_q <= inport_last_i ? 8'b0 : wide_w ? word_last_w : data_r;
 
 //-----------------------------------------------------------------
-// Token decoder
+// Token decoder (valid beats only: data_r is undefined while the input
+// stalls, and a marker must change state as its byte is consumed)
 //-----------------------------------------------------------------
-wire token_soi_w  = (last_b_q == 8'hFF && data_r == 8'hd8);
-wire token_sof0_w = (last_b_q == 8'hFF && data_r == 8'hc0);
-wire token_dqt_w  = (last_b_q == 8'hFF && data_r == 8'hdb);
-wire token_dht_w  = (last_b_q == 8'hFF && data_r == 8'hc4);
-wire token_eoi_w  = (last_b_q == 8'hFF && data_r == 8'hd9);
-wire token_sos_w  = (last_b_q == 8'hFF && data_r == 8'hda);
-wire token_pad_w  = (last_b_q == 8'hFF && data_r == 8'h00);
+wire token_soi_w  = (inport_valid_i && last_b_q == 8'hFF && data_r == 8'hd8);
+wire token_sof0_w = (inport_valid_i && last_b_q == 8'hFF && data_r == 8'hc0);
+wire token_dqt_w  = (inport_valid_i && last_b_q == 8'hFF && data_r == 8'hdb);
+wire token_dht_w  = (inport_valid_i && last_b_q == 8'hFF && data_r == 8'hc4);
+wire token_eoi_w  = (inport_valid_i && last_b_q == 8'hFF && data_r == 8'hd9);
+wire token_sos_w  = (inport_valid_i && last_b_q == 8'hFF && data_r == 8'hda);
+wire token_pad_w  = (inport_valid_i && last_b_q == 8'hFF && data_r == 8'h00);
+wire token_dri_w  = (inport_valid_i && last_b_q == 8'hFF && data_r == 8'hdd);
+wire token_rst_w  = (inport_valid_i && last_b_q == 8'hFF && data_r >= 8'hd0 && data_r <= 8'hd7);
 
 // Unsupported
-wire token_sof2_w = (last_b_q == 8'hFF && data_r == 8'hc2);
-wire token_dri_w  = (last_b_q == 8'hFF && data_r == 8'hdd);
-wire token_rst_w  = (last_b_q == 8'hFF && data_r >= 8'hd0 && data_r <= 8'hd7);
-wire token_app_w  = (last_b_q == 8'hFF && data_r >= 8'he0 && data_r <= 8'hef);
-wire token_com_w  = (last_b_q == 8'hFF && data_r == 8'hfe);
+wire token_sof2_w = (inport_valid_i && last_b_q == 8'hFF && data_r == 8'hc2);
+wire token_app_w  = (inport_valid_i && last_b_q == 8'hFF && data_r >= 8'he0 && data_r <= 8'hef);
+wire token_com_w  = (inport_valid_i && last_b_q == 8'hFF && data_r == 8'hfe);
 
 //-----------------------------------------------------------------
 // FSM
@@ -148,6 +162,9 @@ localparam STATE_IMG_DATA    = 5'd14;
 localparam STATE_SOF_LENH    = 5'd15;
 localparam STATE_SOF_LENL    = 5'd16;
 localparam STATE_SOF_DATA    = 5'd17;
+localparam STATE_DRI_LENH    = 5'd18;
+localparam STATE_DRI_LENL    = 5'd19;
+localparam STATE_DRI_DATA    = 5'd20;
 
 reg [STATE_W-1:0] state_q;
 reg [15:0]        length_q;
@@ -181,9 +198,10 @@ begin
             next_state_r = STATE_IMG_LENH;
         else if (token_sof0_w)
             next_state_r = STATE_SOF_LENH;
+        else if (token_dri_w)
+            next_state_r = STATE_DRI_LENH;
         // Unsupported
         else if (token_sof2_w ||
-                 token_dri_w ||
                  token_rst_w ||
                  token_app_w ||
                  token_com_w)
@@ -250,6 +268,24 @@ begin
             next_state_r = STATE_ACTIVE;
     end
     //-------------------------------------------------------------
+    // DRI
+    //-------------------------------------------------------------
+    STATE_DRI_LENH :
+    begin
+        if (inport_valid_i)
+            next_state_r = STATE_DRI_LENL;
+    end
+    STATE_DRI_LENL :
+    begin
+        if (inport_valid_i)
+            next_state_r = STATE_DRI_DATA;
+    end
+    STATE_DRI_DATA :
+    begin
+        if (inport_valid_i && inport_accept_w && length_q <= 16'd1)
+            next_state_r = STATE_ACTIVE;
+    end
+    //-------------------------------------------------------------
     // DHT
     //-------------------------------------------------------------
     STATE_DHT_LENH :
@@ -306,18 +342,19 @@ else
 always @ (posedge clk_i )
 if (rst_i)
     length_q <= 16'b0;
-else if (state_q == STATE_UXP_LENH || state_q == STATE_DQT_LENH || 
-         state_q == STATE_DHT_LENH || state_q == STATE_IMG_LENH ||
-         state_q == STATE_SOF_LENH)
+else if ((state_q == STATE_UXP_LENH || state_q == STATE_DQT_LENH || 
+          state_q == STATE_DHT_LENH || state_q == STATE_IMG_LENH ||
+          state_q == STATE_SOF_LENH || state_q == STATE_DRI_LENH) && inport_valid_i)
     length_q <= {data_r, 8'b0};
-else if (state_q == STATE_UXP_LENL || state_q == STATE_DQT_LENL ||
-         state_q == STATE_DHT_LENL || state_q == STATE_IMG_LENL ||
-         state_q == STATE_SOF_LENL)
+else if ((state_q == STATE_UXP_LENL || state_q == STATE_DQT_LENL ||
+          state_q == STATE_DHT_LENL || state_q == STATE_IMG_LENL ||
+          state_q == STATE_SOF_LENL || state_q == STATE_DRI_LENL) && inport_valid_i)
     length_q <= {length_q[15:8], data_r} - 16'd2;
 else if ((state_q == STATE_UXP_DATA || 
           state_q == STATE_DQT_DATA ||
           state_q == STATE_DHT_DATA ||
           state_q == STATE_SOF_DATA ||
+          state_q == STATE_DRI_DATA ||
           state_q == STATE_IMG_SOS) && inport_valid_i && inport_accept_w)
     length_q <= length_q - 16'd1;
 
@@ -335,6 +372,42 @@ assign dht_cfg_valid_o = (state_q == STATE_DHT_DATA) && inport_valid_i;
 assign dht_cfg_data_o  = data_r;
 assign dht_cfg_last_o  = inport_last_i || (length_q == 16'd1);
 
+//-----------------------------------------------------------------
+// DRI: Restart interval (MCUs, 0 = no restart markers)
+//-----------------------------------------------------------------
+reg [15:0] img_dri_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+    img_dri_q <= 16'b0;
+else if (token_soi_w)
+    img_dri_q <= 16'b0;
+else if (state_q == STATE_DRI_DATA && inport_valid_i && length_q == 16'd2)
+    img_dri_q <= {data_r, 8'b0};
+else if (state_q == STATE_DRI_DATA && inport_valid_i && length_q == 16'd1)
+    img_dri_q <= {img_dri_q[15:8], data_r};
+
+assign img_dri_o = img_dri_q;
+
+//-----------------------------------------------------------------
+// Wide scan path: a whole word of entropy coded data per cycle.
+// Taken when the word starts the beat, is complete and contains no 0xFF
+// (so no stuffing or markers), and does not follow a 0xFF.
+//-----------------------------------------------------------------
+reg no_ff_r;
+integer i;
+
+always @ *
+begin
+    no_ff_r = 1'b1;
+    for (i = 0; i < INPUT_BYTES; i = i + 1)
+        if (inport_data_i[i*8 +: 8] == 8'hFF)
+            no_ff_r = 1'b0;
+end
+
+assign wide_w = WIDE_SCAN && (state_q == STATE_IMG_DATA) && (byte_idx_q == {IDX_W{1'b0}}) &&
+                inport_valid_i && !inport_last_i && (&inport_strb_i) && (last_b_q != 8'hFF) && no_ff_r;
+
 //-----------------------------------------------------------------
 // Image data
 //-----------------------------------------------------------------
@@ -342,9 +415,13 @@ reg       data_valid_q;
 reg [7:0] data_data_q;
 reg       data_last_q;
 
+// RSTn markers in the scan are dropped along with their 0xFF (held back as
+// data_data_q); jpeg_mcu_proc realigns the bit buffer at the interval end.
 always @ (posedge clk_i )
 if (rst_i)
     data_valid_q <= 1'b0;
+else if (inport_valid_i && state_q == STATE_IMG_DATA && token_rst_w)
+    data_valid_q <= 1'b0;
 else if (inport_valid_i && data_accept_i)
     data_valid_q <= (state_q == STATE_IMG_DATA) && (inport_valid_i && ~token_pad_w && ~token_eoi_w);
 else if (state_q != STATE_IMG_DATA)
@@ -354,10 +431,35 @@ always @ (posedge clk_i )
 if (rst_i)
     data_data_q <= 8'b0;
 else if (inport_valid_i && data_accept_i)
-    data_data_q <= data_r;
+    data_data_q <= wide_w ? word_last_w : data_r;
 
-assign data_valid_o = data_valid_q && inport_valid_i && !token_eoi_w;
-assign data_data_o  = data_data_q;
+// Bytes are held back by one (until the next byte shows they are not a marker prefix).
+// Wide: the held byte and all but the last byte of the word, the last is held instead.
+reg [INPUT_WIDTH-1:0] data_out_r;
+reg [3:0]             data_count_r;
+
+/* verilator lint_off WIDTH */
+always @ *
+begin
+    data_out_r   = {{(INPUT_WIDTH-8){1'b0}}, data_data_q};
+    data_count_r = 4'd1;
+
+    if (wide_w && data_valid_q)
+    begin
+        data_out_r   = {inport_data_i[INPUT_WIDTH-9:0], data_data_q};
+        data_count_r = INPUT_BYTES;
+    end
+    else if (wide_w)
+    begin
+        data_out_r   = {8'b0, inport_data_i[INPUT_WIDTH-9:0]};
+        data_count_r = INPUT_BYTES - 1;
+    end
+end
+/* verilator lint_on WIDTH */
+
+assign data_valid_o = (data_valid_q || wide_w) && inport_valid_i && !token_eoi_w && !token_rst_w;
+assign data_data_o  = data_out_r;
+assign data_count_o = data_count_r;
 
 // NOTE: Last is delayed by one cycles (not qualified by data_valid_o)
 assign data_last_o  = data_valid_q && inport_valid_i && token_eoi_w;
@@ -365,11 +467,13 @@ assign data_last_o  = data_valid_q && inport_valid_i && token_eoi_w;
 //-----------------------------------------------------------------
 // Handshaking
 //-----------------------------------------------------------------
-wire last_byte_w = (byte_idx_q == 2'd3) || inport_last_i;
+/* verilator lint_off WIDTH */
+wire last_byte_w = (byte_idx_q == INPUT_BYTES - 1) || inport_last_i || wide_w;
+/* verilator lint_on WIDTH */
 
 assign inport_accept_w =  (state_q == STATE_DQT_DATA && dqt_cfg_accept_i) ||
                           (state_q == STATE_DHT_DATA && dht_cfg_accept_i) ||
-                          (state_q == STATE_IMG_DATA && (data_accept_i || token_pad_w)) ||
+                          (state_q == STATE_IMG_DATA && (data_accept_i || token_pad_w || token_rst_w)) ||
                           (state_q != STATE_DQT_DATA && 
                            state_q != STATE_DHT_DATA && 
                            state_q != STATE_IMG_DATA);
@@ -511,12 +615,13 @@ wire [3:0] cb_vert_factor_w  = img_cb_factor_q[3:0];
 wire [3:0] cr_horiz_factor_w = img_cr_factor_q[7:4];
 wire [3:0] cr_vert_factor_w  = img_cr_factor_q[3:0];
 
-localparam JPEG_MONOCHROME  = 2'd0;
-localparam JPEG_YCBCR_444   = 2'd1;
-localparam JPEG_YCBCR_420   = 2'd2;
-localparam JPEG_UNSUPPORTED = 2'd3;
+localparam JPEG_MONOCHROME  = 3'd0;
+localparam JPEG_YCBCR_444   = 3'd1;
+localparam JPEG_YCBCR_420   = 3'd2;
+localparam JPEG_YCBCR_422   = 3'd3;
+localparam JPEG_UNSUPPORTED = 3'd4;
 
-reg [1:0] img_mode_q;
+reg [2:0] img_mode_q;
 
 always @ (posedge clk_i )
 if (rst_i)
@@ -539,6 +644,10 @@ begin
                  cb_horiz_factor_w == 4'd1 && cb_vert_factor_w == 4'd1 &&
                  cr_horiz_factor_w == 4'd1 && cr_vert_factor_w == 4'd1)
             img_mode_q <= JPEG_YCBCR_420;
+        else if (y_horiz_factor_w  == 4'd2 && y_vert_factor_w  == 4'd1 &&
+                 cb_horiz_factor_w == 4'd1 && cb_vert_factor_w == 4'd1 &&
+                 cr_horiz_factor_w == 4'd1 && cr_vert_factor_w == 4'd1)
+            img_mode_q <= JPEG_YCBCR_422;
     end
 end
 
@@ -38,7 +38,7 @@ module jpeg_mcu_id
     ,input           img_end_i
     ,input  [ 15:0]  img_width_i
     ,input  [ 15:0]  img_height_i
-    ,input  [  1:0]  img_mode_i
+    ,input  [  2:0]  img_mode_i
     ,input           start_of_block_i
     ,input           end_of_block_i
 
@@ -53,10 +53,11 @@ module jpeg_mcu_id
 //-----------------------------------------------------------------
 // Block Type (Y, Cb, Cr)
 //-----------------------------------------------------------------
-localparam JPEG_MONOCHROME  = 2'd0;
-localparam JPEG_YCBCR_444   = 2'd1;
-localparam JPEG_YCBCR_420   = 2'd2;
-localparam JPEG_UNSUPPORTED = 2'd3;
+localparam JPEG_MONOCHROME  = 3'd0;
+localparam JPEG_YCBCR_444   = 3'd1;
+localparam JPEG_YCBCR_420   = 3'd2;
+localparam JPEG_YCBCR_422   = 3'd3;
+localparam JPEG_UNSUPPORTED = 3'd4;
 
 localparam BLOCK_Y          = 2'd0;
 localparam BLOCK_CB         = 2'd1;
@@ -109,13 +110,34 @@ begin
     end
     endcase
 end
+else if (img_mode_i == JPEG_YCBCR_422 && end_of_block_i)
+begin
+    type_idx_q <= type_idx_q + 3'd1;
+
+    case (type_idx_q)
+    default:
+        block_type_q <= BLOCK_Y;
+    3'd1:
+        block_type_q <= BLOCK_CB;
+    3'd2:
+        block_type_q <= BLOCK_CR;
+    3'd3:
+    begin
+        block_type_q <= BLOCK_Y;
+        type_idx_q   <= 3'd0;
+    end
+    endcase
+end
 
 //-----------------------------------------------------------------
 // Block index
 //-----------------------------------------------------------------
 wire [15:0] width_rnd_w   = ((img_width_i+7) / 8) * 8;
 wire [15:0] block_x_max_w = width_rnd_w / 8;
-wire [15:0] img_w_div4_w  = width_rnd_w / 4;
+wire [15:0] mcu_x_max_w   = (img_width_i+15) / 16; // 4:2:0, 4:2:2
+wire [15:0] img_w_div4_w  = {mcu_x_max_w[13:0], 2'b0}; // 4:2:0 Y blocks per MCU row
+wire [15:0] block_y_max_w = (img_height_i+7) / 8;
+wire [15:0] mcu_y_max_w   = (img_height_i+15) / 16; // 4:2:0
 
 reg  [15:0] block_x_q;
 reg  [15:0] block_y_q;
@@ -124,6 +146,13 @@ reg  [15:0] x_idx_q;
 reg  [15:0] y_idx_q;
 
 wire [15:0] block_x_next_w = block_x_q + 16'd1;
+wire [15:0] block_y_next_w = block_y_q + 16'd1;
+
+// Last block row of the image. EOI may still be behind the entropy data
+// still to be decoded when the last row starts, so img_end_i alone can
+// miss the end and decode a spurious extra row.
+wire        last_row_w     = (img_mode_i == JPEG_YCBCR_420) ? (block_y_next_w == {mcu_y_max_w[14:0], 1'b0}) :
+                                                              (block_y_next_w == block_y_max_w);
 
 reg         end_of_image_q;
 
@@ -154,7 +183,7 @@ begin
     else
         block_x_q <= block_x_next_w;
 
-    if (img_end_i && block_x_next_w == block_x_max_w)
+    if ((img_end_i || last_row_w) && block_x_next_w == block_x_max_w)
         end_of_image_q <= 1'b1;
 end
 else if (start_of_block_i && img_mode_i == JPEG_YCBCR_420 && block_type_q == BLOCK_Y)
@@ -176,7 +205,32 @@ begin
 end
 else if (start_of_block_i && img_mode_i == JPEG_YCBCR_420 && block_type_q == BLOCK_CR)
 begin
-    if (img_end_i && block_x_next_w == block_x_max_w)
+    // Last MCU of a row (x_idx_q wrapped by Y3)
+    if ((img_end_i || last_row_w) && x_idx_q == 16'd0)
+        end_of_image_q <= 1'b1;
+end
+// 4:2:2: x_idx_q / y_idx_q are the MCU position (16x8), Y0 / Y1 side by side
+else if (start_of_block_i && img_mode_i == JPEG_YCBCR_422 && block_type_q == BLOCK_Y)
+begin
+    block_x_q <= {x_idx_q[14:0], type_idx_q[0]};
+    block_y_q <= y_idx_q;
+
+    // Y1: advance to the next MCU
+    if (type_idx_q[0])
+    begin
+        if ((x_idx_q + 16'd1) == mcu_x_max_w)
+        begin
+            x_idx_q <= 16'd0;
+            y_idx_q <= y_idx_q + 16'd1;
+        end
+        else
+            x_idx_q <= x_idx_q + 16'd1;
+    end
+end
+else if (start_of_block_i && img_mode_i == JPEG_YCBCR_422 && block_type_q == BLOCK_CR)
+begin
+    // Last MCU of a row (x_idx_q wrapped by Y1)
+    if ((img_end_i || last_row_w) && x_idx_q == 16'd0)
         end_of_image_q <= 1'b1;
 end
 
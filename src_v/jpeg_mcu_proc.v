@@ -30,6 +30,15 @@
 //-----------------------------------------------------------------
 
 module jpeg_mcu_proc
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter SUPPORT_DUAL_SYMBOL = 0
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
 (
     // Inputs
      input           clk_i
@@ -38,20 +47,27 @@ module jpeg_mcu_proc
     ,input           img_end_i
     ,input  [ 15:0]  img_width_i
     ,input  [ 15:0]  img_height_i
-    ,input  [  1:0]  img_mode_i
+    ,input  [  2:0]  img_mode_i
+    ,input  [ 15:0]  img_dri_i
+    ,input           dc_only_i
     ,input           inport_valid_i
     ,input  [ 31:0]  inport_data_i
     ,input           inport_last_i
     ,input           lookup_valid_i
     ,input  [  4:0]  lookup_width_i
     ,input  [  7:0]  lookup_value_i
+    ,input           lookup2_valid_i
+    ,input  [  4:0]  lookup2_width_i
+    ,input  [  7:0]  lookup2_value_i
     ,input           outport_blk_space_i
 
     // Outputs
     ,output [  5:0]  inport_pop_o
+    ,output          inport_align_o
     ,output          lookup_req_o
     ,output [  1:0]  lookup_table_o
     ,output [ 15:0]  lookup_input_o
+    ,output [ 31:0]  lookup_word_o
     ,output          outport_valid_o
     ,output [ 15:0]  outport_data_o
     ,output [  5:0]  outport_idx_o
@@ -68,10 +84,11 @@ wire start_block_w;
 wire next_block_w;
 wire end_of_image_w;
 
-localparam JPEG_MONOCHROME  = 2'd0;
-localparam JPEG_YCBCR_444   = 2'd1;
-localparam JPEG_YCBCR_420   = 2'd2;
-localparam JPEG_UNSUPPORTED = 2'd3;
+localparam JPEG_MONOCHROME  = 3'd0;
+localparam JPEG_YCBCR_444   = 3'd1;
+localparam JPEG_YCBCR_420   = 3'd2;
+localparam JPEG_YCBCR_422   = 3'd3;
+localparam JPEG_UNSUPPORTED = 3'd4;
 
 localparam BLOCK_Y          = 2'd0;
 localparam BLOCK_CB         = 2'd1;
@@ -115,12 +132,14 @@ localparam STATE_HUFF_LOOKUP = 5'd2;
 localparam STATE_OUTPUT      = 5'd3;
 localparam STATE_EOB         = 5'd4;
 localparam STATE_EOF         = 5'd5;
+localparam STATE_OUTPUT2     = 5'd6;
 
 reg [STATE_W-1:0] state_q;
 reg [STATE_W-1:0] next_state_r;
 
 reg [7:0]         code_bits_q;
 reg [7:0]         coeff_idx_q;
+wire              pair_w;
 
 always @ *
 begin
@@ -147,6 +166,13 @@ begin
             next_state_r = STATE_OUTPUT;
     end
     STATE_OUTPUT:
+    begin
+        if (pair_w)
+            next_state_r = STATE_OUTPUT2;
+        else
+            next_state_r = STATE_FETCH_WORD;
+    end
+    STATE_OUTPUT2:
     begin
         next_state_r = STATE_FETCH_WORD;
     end
@@ -230,12 +256,47 @@ if (rst_i)
 else if (state_q == STATE_HUFF_LOOKUP && lookup_valid_i)
     input_data_q <= input_shift_w[15:0];
 
+//-----------------------------------------------------------------
+// Second symbol (SUPPORT_DUAL_SYMBOL): AC symbol following the first
+// in the same lookup word, decoded alongside it by jpeg_dht.
+//-----------------------------------------------------------------
+reg        pair_q;
+reg [7:0]  code2_q;
+reg [4:0]  lookup2_width_q;
+reg [15:0] input_data2_q;
+
+wire [5:0]  pair_shift_w  = {1'b0, lookup_width_i} + {2'b0, lookup_value_i[3:0]} + {1'b0, lookup2_width_i};
+wire [31:0] input_shift2_w = inport_data_i << pair_shift_w;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    pair_q          <= 1'b0;
+    code2_q         <= 8'b0;
+    lookup2_width_q <= 5'b0;
+    input_data2_q   <= 16'b0;
+end
+else if (state_q == STATE_HUFF_LOOKUP && lookup_valid_i)
+begin
+    pair_q          <= (SUPPORT_DUAL_SYMBOL != 0) && lookup2_valid_i;
+    code2_q         <= lookup2_value_i;
+    lookup2_width_q <= lookup2_width_i;
+    input_data2_q   <= input_shift2_w[31:16];
+end
+
+// Only take the second symbol if the first leaves room for it in the block
+// (otherwise the following bits belong to the next block's DC coefficient)
+wire [7:0] first_idx_w = coeff_idx_q + {4'b0, code_q[7:4]};
+
+assign pair_w = pair_q && (coeff_idx_q != 8'd0) && (first_idx_w < 8'd63);
+
 //-----------------------------------------------------------------
 // Bit buffer pop
 //-----------------------------------------------------------------
 reg [5:0]  pop_bits_r;
 
-wire [4:0] coef_bits_w = {1'b0, code_q[3:0]};
+wire [4:0] coef_bits_w  = {1'b0, code_q[3:0]};
+wire [4:0] coef2_bits_w = {1'b0, code2_q[3:0]};
 
 always @ *
 begin
@@ -252,6 +313,10 @@ begin
             pop_bits_r = {1'b0, lookup_width_q};
         else
             pop_bits_r = {1'b0, lookup_width_q} + coef_bits_w;
+
+        // Both symbols consumed in one pop
+        if (pair_w)
+            pop_bits_r = pop_bits_r + {1'b0, lookup2_width_q} + {1'b0, coef2_bits_w};
     end
     default : ;
     endcase
@@ -259,6 +324,7 @@ end
 
 assign lookup_req_o   = (state_q == STATE_FETCH_WORD) & inport_valid_i;
 assign lookup_input_o = inport_data_i[31:16];
+assign lookup_word_o  = inport_data_i;
 assign inport_pop_o   = pop_bits_r;
 
 reg [1:0] lookup_table_r;
@@ -301,6 +367,29 @@ begin
 end
 endfunction
 
+//-----------------------------------------------------------------
+// Restart interval: count MCUs, at the end of each interval reset the
+// DC predictors and skip the bit buffer to the byte boundary (the RSTn
+// marker itself is removed by jpeg_input).
+//-----------------------------------------------------------------
+wire end_of_mcu_w = (state_q == STATE_EOB) && (img_mode_i == JPEG_MONOCHROME || block_type_w == BLOCK_CR);
+
+reg [15:0] restart_count_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+    restart_count_q <= 16'b0;
+else if (img_start_i)
+    restart_count_q <= 16'b0;
+else if (end_of_mcu_w && (restart_count_q + 16'd1) == img_dri_i)
+    restart_count_q <= 16'b0;
+else if (end_of_mcu_w)
+    restart_count_q <= restart_count_q + 16'd1;
+
+wire restart_w = end_of_mcu_w && (img_dri_i != 16'd0) && ((restart_count_q + 16'd1) == img_dri_i);
+
+assign inport_align_o = restart_w;
+
 //-----------------------------------------------------------------
 // Previous DC coeffecient
 //-----------------------------------------------------------------
@@ -317,7 +406,7 @@ begin
     prev_dc_coeff_q[2] <= 16'b0;
     prev_dc_coeff_q[3] <= 16'b0; // X
 end
-else if (img_start_i)
+else if (img_start_i || restart_w)
 begin
     prev_dc_coeff_q[0] <= 16'b0;
     prev_dc_coeff_q[1] <= 16'b0;
@@ -340,6 +429,8 @@ begin
         coeff_r = decode_number(input_data_q >> (16 - coef_bits_w), coef_bits_w);
 end
 
+wire [15:0] coeff2_w = decode_number(input_data2_q >> (16 - coef2_bits_w), coef2_bits_w);
+
 //-----------------------------------------------------------------
 // dc_coeff
 //-----------------------------------------------------------------
@@ -359,6 +450,8 @@ if (rst_i)
     coeff_q <= 16'b0;
 else if (state_q == STATE_OUTPUT)
     coeff_q <= coeff_r;
+else if (state_q == STATE_OUTPUT2)
+    coeff_q <= coeff2_w;
 
 //-----------------------------------------------------------------
 // Coeffecient index
@@ -389,6 +482,19 @@ begin
             coeff_idx_q <= coeff_idx_q + {4'b0, code_q[7:4]};
     end
 end
+// Second symbol: skip the first coefficient's index (as FETCH_WORD would)
+else if (state_q == STATE_OUTPUT2)
+begin
+    // End of block
+    if (code2_q == 8'b0)
+        coeff_idx_q <= 8'd64;
+    // ZRL - 16 zeros
+    else if (code2_q == 8'hF0)
+        coeff_idx_q <= coeff_idx_q + 8'd16;
+    // RLE number zeros (0 - 15)
+    else
+        coeff_idx_q <= coeff_idx_q + 8'd1 + {4'b0, code2_q[7:4]};
+end
 
 //-----------------------------------------------------------------
 // Output push
@@ -398,12 +504,13 @@ reg push_q;
 always @ (posedge clk_i )
 if (rst_i)
     push_q <= 1'b0;
-else if (state_q == STATE_OUTPUT || state_q == STATE_EOF)
+else if (state_q == STATE_OUTPUT || state_q == STATE_OUTPUT2 || state_q == STATE_EOF)
     push_q <= 1'b1;
 else
     push_q <= 1'b0;
 
-assign outport_valid_o = push_q && (coeff_idx_q < 8'd64);
+// DC only: AC coefficients are still decoded (to walk the bitstream) but not output
+assign outport_valid_o = push_q && (coeff_idx_q < 8'd64) && (!dc_only_i || coeff_idx_q == 8'd0);
 assign outport_data_o  = coeff_q;
 assign outport_idx_o   = coeff_idx_q[5:0];
 assign outport_eob_o   = (state_q == STATE_EOB) || 
@@ -0,0 +1,542 @@
+//-----------------------------------------------------------------
+//                      Baseline JPEG Decoder
+//                             V0.1
+//                       Ultra-Embedded.com
+//                        Copyright 2020
+//
+//                   admin@ultra-embedded.com
+//-----------------------------------------------------------------
+//                      License: Apache 2.0
+// This IP can be freely used in commercial projects, however you may
+// want access to unreleased materials such as verification environments,
+// or test vectors, as well as changes to the IP for integration purposes.
+// If this is the case, contact the above address.
+// I am interested to hear how and where this IP is used, so please get
+// in touch!
+//-----------------------------------------------------------------
+// Copyright 2020 Ultra-Embedded.com
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------
+
+
+module jpeg_multi
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter NUM_CORES        = 2
+    ,parameter CORE_W           = 1     // NUM_CORES <= 2^CORE_W
+    ,parameter DISPATCH_IDLE    = 0     // 0 = round robin, 1 = first idle core
+    ,parameter INPUT_FIFO_DEPTH = 1024  // Per core input buffer (words)
+    ,parameter INPUT_FIFO_ADDR_W = 10
+    ,parameter SUPPORT_WRITABLE_DHT = 0
+    ,parameter SUPPORT_DHT_FAST_LOOKUP = 1
+    ,parameter USE_IDCT_IFAST   = 0
+    ,parameter INPUT_WIDTH      = 32
+    ,parameter SUPPORT_DUAL_SYMBOL = 0
+    ,parameter SUPPORT_RASTER_OUTPUT = 0
+    ,parameter RASTER_WIDTH_W   = 11
+    ,parameter SUPPORT_FRAME_OVERLAP = 0
+    ,parameter MERGE_OUTPUT     = 0     // 1 = one frame ordered pixel stream on port 0
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
+(
+    // Inputs
+     input           clk_i
+    ,input           rst_i
+    ,input           inport_valid_i
+    ,input  [INPUT_WIDTH-1:0]   inport_data_i
+    ,input  [INPUT_WIDTH/8-1:0] inport_strb_i
+    ,input           inport_last_i  // Last word of each JPEG frame
+    ,input  [NUM_CORES-1:0]     outport_accept_i
+
+    // Outputs
+    ,output          inport_accept_o
+    ,output [NUM_CORES-1:0]     outport_valid_o
+    ,output [NUM_CORES*16-1:0]  outport_frame_o
+    ,output [NUM_CORES*16-1:0]  outport_width_o
+    ,output [NUM_CORES*16-1:0]  outport_height_o
+    ,output [NUM_CORES*16-1:0]  outport_pixel_x_o
+    ,output [NUM_CORES*16-1:0]  outport_pixel_y_o
+    ,output [NUM_CORES*8-1:0]   outport_pixel_r_o
+    ,output [NUM_CORES*8-1:0]   outport_pixel_g_o
+    ,output [NUM_CORES*8-1:0]   outport_pixel_b_o
+    ,output [NUM_CORES-1:0]     outport_pixel2_valid_o
+    ,output [NUM_CORES*8-1:0]   outport_pixel2_r_o
+    ,output [NUM_CORES*8-1:0]   outport_pixel2_g_o
+    ,output [NUM_CORES*8-1:0]   outport_pixel2_b_o
+    ,output          frame_done_o
+    ,output [ 15:0]  frame_done_seq_o
+    ,output          idle_o
+);
+
+//-----------------------------------------------------------------
+// NUM_CORES jpeg_core instances sharing one input stream. Whole
+// frames (inport_last_i on the last word of each) are dispatched
+// to a core with no frame in flight, round robin or to the first
+// idle core. Each core buffers its frame's input (INPUT_FIFO_DEPTH
+// words), so the shared input moves on to the next frame once the
+// rest of the current one fits in the buffer rather than at the
+// core's decode rate. Each core keeps its own pixel output port, tagged with
+// the frame sequence number, as a single merged pixel stream would
+// cap the aggregate rate at one pixel per cycle. Frame completion
+// is reported in frame order on frame_done_o / frame_done_seq_o.
+// With MERGE_OUTPUT=1 port 0 instead drains the core of the oldest
+// frame in flight until that frame completes, so the pixels leave
+// in frame order (the other ports are never valid, and only
+// outport_accept_i[0] is used); later frames still decode up to
+// their core's output stage in the meantime.
+//-----------------------------------------------------------------
+localparam ORDER_DEPTH      = 1 << CORE_W;
+
+wire [NUM_CORES-1:0] buf_accept_w;   // Input buffer has space
+wire [NUM_CORES-1:0] buf_last_w;     // Last word of the frame taken by the core
+wire [NUM_CORES-1:0] core_idle_w;
+
+// Per core pixel output ports
+wire [NUM_CORES-1:0]     core_accept_w;
+wire [NUM_CORES-1:0]     core_valid_w;
+wire [NUM_CORES*16-1:0]  core_width_w;
+wire [NUM_CORES*16-1:0]  core_height_w;
+wire [NUM_CORES*16-1:0]  core_pixel_x_w;
+wire [NUM_CORES*16-1:0]  core_pixel_y_w;
+wire [NUM_CORES*8-1:0]   core_pixel_r_w;
+wire [NUM_CORES*8-1:0]   core_pixel_g_w;
+wire [NUM_CORES*8-1:0]   core_pixel_b_w;
+wire [NUM_CORES-1:0]     core_pixel2_valid_w;
+wire [NUM_CORES*8-1:0]   core_pixel2_r_w;
+wire [NUM_CORES*8-1:0]   core_pixel2_g_w;
+wire [NUM_CORES*8-1:0]   core_pixel2_b_w;
+wire [NUM_CORES*16-1:0]  core_frame_w;
+
+reg  [NUM_CORES-1:0] busy_q;     // Frame dispatched, completion not yet reported
+reg  [NUM_CORES-1:0] started_q;  // Core left idle for the frame
+reg  [NUM_CORES-1:0] finished_q; // All pixels of the frame output
+reg  [NUM_CORES-1:0] flush_q;    // Frame input consumed, hold inport_last_i
+reg  [15:0]          frame_seq_q[NUM_CORES-1:0];
+
+//-----------------------------------------------------------------
+// Dispatch
+//-----------------------------------------------------------------
+reg              sel_active_q;
+reg [CORE_W-1:0] sel_q;
+reg [CORE_W-1:0] rr_q;
+reg [15:0]       seq_q;
+
+wire             order_accept_w;
+
+reg              cand_valid_r;
+reg [CORE_W-1:0] cand_r;
+
+integer j;
+
+always @ *
+begin
+    cand_valid_r = 1'b0;
+    cand_r       = rr_q;
+
+    if (DISPATCH_IDLE)
+    begin
+        for (j = NUM_CORES - 1; j >= 0; j = j - 1)
+            if (!busy_q[j] && core_idle_w[j])
+            begin
+                cand_valid_r = 1'b1;
+                /* verilator lint_off WIDTH */
+                cand_r       = j;
+                /* verilator lint_on WIDTH */
+            end
+    end
+    else
+        cand_valid_r = !busy_q[rr_q];
+end
+
+wire dispatch_w  = !sel_active_q && inport_valid_i && cand_valid_r && order_accept_w;
+wire frame_end_w = sel_active_q && inport_valid_i && inport_accept_o && inport_last_i;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    sel_active_q <= 1'b0;
+    sel_q        <= {CORE_W{1'b0}};
+    rr_q         <= {CORE_W{1'b0}};
+    seq_q        <= 16'b0;
+end
+else if (dispatch_w)
+begin
+    sel_active_q <= 1'b1;
+    sel_q        <= cand_r;
+    /* verilator lint_off WIDTH */
+    rr_q         <= (cand_r == NUM_CORES - 1) ? {CORE_W{1'b0}} : (cand_r + 1'b1);
+    /* verilator lint_on WIDTH */
+    seq_q        <= seq_q + 16'd1;
+end
+else if (frame_end_w)
+    sel_active_q <= 1'b0;
+
+assign inport_accept_o = sel_active_q && buf_accept_w[sel_q];
+
+//-----------------------------------------------------------------
+// Dispatch order: core of each frame in flight, oldest first
+//-----------------------------------------------------------------
+wire              head_valid_w;
+wire [CORE_W-1:0] head_w;
+wire              head_done_w = head_valid_w && finished_q[head_w];
+
+jpeg_output_fifo
+#(
+     .WIDTH(CORE_W)
+    ,.DEPTH(ORDER_DEPTH)
+    ,.ADDR_W(CORE_W)
+)
+u_order
+(
+     .clk_i(clk_i)
+    ,.rst_i(rst_i)
+
+    ,.push_i(dispatch_w)
+    ,.data_in_i(cand_r)
+    ,.accept_o(order_accept_w)
+
+    ,.valid_o(head_valid_w)
+    ,.data_out_o(head_w)
+    ,.pop_i(head_done_w)
+
+    ,.flush_i(1'b0)
+);
+
+//-----------------------------------------------------------------
+// Per core frame state
+//-----------------------------------------------------------------
+integer i;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    busy_q     <= {NUM_CORES{1'b0}};
+    started_q  <= {NUM_CORES{1'b0}};
+    finished_q <= {NUM_CORES{1'b0}};
+    flush_q    <= {NUM_CORES{1'b0}};
+end
+else
+begin
+    for (i = 0; i < NUM_CORES; i = i + 1)
+    begin
+        // Header parsed: idle_o drops
+        if (busy_q[i] && !core_idle_w[i])
+            started_q[i] <= 1'b1;
+
+        // Back to idle with the last pixel accepted, and the whole frame
+        // taken from the input buffer (the core may go idle at EOI before
+        // any trailing words are consumed)
+        if (busy_q[i] && started_q[i] && flush_q[i] && core_idle_w[i] && !core_valid_w[i])
+            finished_q[i] <= 1'b1;
+
+        if (buf_last_w[i])
+            flush_q[i] <= 1'b1;
+
+        /* verilator lint_off WIDTH */
+
+        if (head_done_w && head_w == i)
+        begin
+            busy_q[i]     <= 1'b0;
+            started_q[i]  <= 1'b0;
+            finished_q[i] <= 1'b0;
+        end
+
+        if (dispatch_w && cand_r == i)
+        begin
+            busy_q[i]  <= 1'b1;
+            flush_q[i] <= 1'b0;
+        end
+        /* verilator lint_on WIDTH */
+    end
+end
+
+integer k;
+
+always @ (posedge clk_i )
+begin
+    for (k = 0; k < NUM_CORES; k = k + 1)
+        /* verilator lint_off WIDTH */
+        if (dispatch_w && cand_r == k)
+        /* verilator lint_on WIDTH */
+            frame_seq_q[k] <= seq_q;
+end
+
+//-----------------------------------------------------------------
+// Frame completion (in frame order)
+//-----------------------------------------------------------------
+reg        done_q;
+reg [15:0] done_seq_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    done_q     <= 1'b0;
+    done_seq_q <= 16'b0;
+end
+else
+begin
+    done_q     <= head_done_w;
+    if (head_done_w)
+        done_seq_q <= frame_seq_q[head_w];
+end
+
+assign frame_done_o     = done_q;
+assign frame_done_seq_o = done_seq_q;
+
+assign idle_o = !sel_active_q && (busy_q == {NUM_CORES{1'b0}}) && !done_q;
+
+//-----------------------------------------------------------------
+// Cores
+//-----------------------------------------------------------------
+genvar g;
+generate
+for (g = 0; g < NUM_CORES; g = g + 1)
+begin: CORE
+    /* verilator lint_off WIDTH */
+    wire sel_w = sel_active_q && (sel_q == g);
+    /* verilator lint_on WIDTH */
+
+    // Input buffer: {last, strb, data}
+    wire        in_accept_w;
+    wire        fifo_valid_w;
+    wire [INPUT_WIDTH/8+INPUT_WIDTH:0] fifo_data_w;
+    wire        fifo_pop_w = fifo_valid_w && in_accept_w && !flush_q[g];
+
+    jpeg_multi_fifo
+    #(
+         .WIDTH(INPUT_WIDTH/8 + INPUT_WIDTH + 1)
+        ,.DEPTH(INPUT_FIFO_DEPTH)
+        ,.ADDR_W(INPUT_FIFO_ADDR_W)
+    )
+    u_input
+    (
+         .clk_i(clk_i)
+        ,.rst_i(rst_i)
+
+        ,.push_i(sel_w && inport_valid_i)
+        ,.data_in_i({inport_last_i, inport_strb_i, inport_data_i})
+        ,.accept_o(buf_accept_w[g])
+
+        ,.valid_o(fifo_valid_w)
+        ,.data_out_o(fifo_data_w)
+        ,.pop_i(fifo_pop_w)
+    );
+
+    assign buf_last_w[g] = fifo_pop_w && fifo_data_w[INPUT_WIDTH/8+INPUT_WIDTH];
+
+    jpeg_core
+    #(
+         .SUPPORT_WRITABLE_DHT(SUPPORT_WRITABLE_DHT)
+        ,.SUPPORT_DHT_FAST_LOOKUP(SUPPORT_DHT_FAST_LOOKUP)
+        ,.USE_IDCT_IFAST(USE_IDCT_IFAST)
+        ,.INPUT_WIDTH(INPUT_WIDTH)
+        ,.SUPPORT_DUAL_SYMBOL(SUPPORT_DUAL_SYMBOL)
+        ,.SUPPORT_RASTER_OUTPUT(SUPPORT_RASTER_OUTPUT)
+        ,.RASTER_WIDTH_W(RASTER_WIDTH_W)
+        ,.SUPPORT_FRAME_OVERLAP(SUPPORT_FRAME_OVERLAP)
+    )
+    u_core
+    (
+        // Inputs
+         .clk_i(clk_i)
+        ,.rst_i(rst_i)
+        // After its last word a frame is followed by empty last beats, as the
+        // core expects of the end of a stream, until the next frame is dispatched
+        ,.inport_valid_i(fifo_valid_w || flush_q[g])
+        ,.inport_data_i(fifo_data_w[INPUT_WIDTH-1:0])
+        ,.inport_strb_i(flush_q[g] ? {(INPUT_WIDTH/8){1'b0}} : fifo_data_w[INPUT_WIDTH +: INPUT_WIDTH/8])
+        ,.inport_last_i(flush_q[g])
+        ,.outport_accept_i(core_accept_w[g])
+        ,.dc_only_i(1'b0)
+
+        // Outputs
+        ,.inport_accept_o(in_accept_w)
+        ,.outport_valid_o(core_valid_w[g])
+        ,.outport_width_o(core_width_w[g*16 +: 16])
+        ,.outport_height_o(core_height_w[g*16 +: 16])
+        ,.outport_pixel_x_o(core_pixel_x_w[g*16 +: 16])
+        ,.outport_pixel_y_o(core_pixel_y_w[g*16 +: 16])
+        ,.outport_pixel_r_o(core_pixel_r_w[g*8 +: 8])
+        ,.outport_pixel_g_o(core_pixel_g_w[g*8 +: 8])
+        ,.outport_pixel_b_o(core_pixel_b_w[g*8 +: 8])
+        ,.outport_pixel2_valid_o(core_pixel2_valid_w[g])
+        ,.outport_pixel2_r_o(core_pixel2_r_w[g*8 +: 8])
+        ,.outport_pixel2_g_o(core_pixel2_g_w[g*8 +: 8])
+        ,.outport_pixel2_b_o(core_pixel2_b_w[g*8 +: 8])
+        ,.idle_o(core_idle_w[g])
+    );
+
+    assign core_frame_w[g*16 +: 16] = frame_seq_q[g];
+end
+endgenerate
+
+//-----------------------------------------------------------------
+// Pixel output
+//-----------------------------------------------------------------
+generate
+if (MERGE_OUTPUT)
+begin: MERGE
+    // Port 0 follows the head of the dispatch order; a core only
+    // outputs while its frame is the oldest in flight
+    reg [NUM_CORES-1:0] accept_r;
+    reg [NUM_CORES-1:0] valid_r;
+
+    always @ *
+    begin
+        accept_r = {NUM_CORES{1'b0}};
+        valid_r  = {NUM_CORES{1'b0}};
+
+        if (head_valid_w)
+        begin
+            accept_r[head_w] = outport_accept_i[0];
+            valid_r[0]       = core_valid_w[head_w];
+        end
+    end
+
+    assign core_accept_w          = accept_r;
+    assign outport_valid_o        = valid_r;
+    assign outport_frame_o        = {NUM_CORES{core_frame_w[head_w*16 +: 16]}};
+    assign outport_width_o        = {NUM_CORES{core_width_w[head_w*16 +: 16]}};
+    assign outport_height_o       = {NUM_CORES{core_height_w[head_w*16 +: 16]}};
+    assign outport_pixel_x_o      = {NUM_CORES{core_pixel_x_w[head_w*16 +: 16]}};
+    assign outport_pixel_y_o      = {NUM_CORES{core_pixel_y_w[head_w*16 +: 16]}};
+    assign outport_pixel_r_o      = {NUM_CORES{core_pixel_r_w[head_w*8 +: 8]}};
+    assign outport_pixel_g_o      = {NUM_CORES{core_pixel_g_w[head_w*8 +: 8]}};
+    assign outport_pixel_b_o      = {NUM_CORES{core_pixel_b_w[head_w*8 +: 8]}};
+    assign outport_pixel2_valid_o = {NUM_CORES{core_pixel2_valid_w[head_w]}};
+    assign outport_pixel2_r_o     = {NUM_CORES{core_pixel2_r_w[head_w*8 +: 8]}};
+    assign outport_pixel2_g_o     = {NUM_CORES{core_pixel2_g_w[head_w*8 +: 8]}};
+    assign outport_pixel2_b_o     = {NUM_CORES{core_pixel2_b_w[head_w*8 +: 8]}};
+end
+else
+begin: PER_CORE
+    assign core_accept_w          = outport_accept_i;
+    assign outport_valid_o        = core_valid_w;
+    assign outport_frame_o        = core_frame_w;
+    assign outport_width_o        = core_width_w;
+    assign outport_height_o       = core_height_w;
+    assign outport_pixel_x_o      = core_pixel_x_w;
+    assign outport_pixel_y_o      = core_pixel_y_w;
+    assign outport_pixel_r_o      = core_pixel_r_w;
+    assign outport_pixel_g_o      = core_pixel_g_w;
+    assign outport_pixel_b_o      = core_pixel_b_w;
+    assign outport_pixel2_valid_o = core_pixel2_valid_w;
+    assign outport_pixel2_r_o     = core_pixel2_r_w;
+    assign outport_pixel2_g_o     = core_pixel2_g_w;
+    assign outport_pixel2_b_o     = core_pixel2_b_w;
+end
+endgenerate
+
+
+endmodule
+
+//-----------------------------------------------------------------
+// Input buffer: FIFO with a synchronous read RAM (block RAM) and
+// an output register
+//-----------------------------------------------------------------
+module jpeg_multi_fifo
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter WIDTH            = 8
+    ,parameter DEPTH            = 4
+    ,parameter ADDR_W           = 2
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
+(
+    // Inputs
+     input           clk_i
+    ,input           rst_i
+    ,input  [WIDTH-1:0]  data_in_i
+    ,input           push_i
+    ,input           pop_i
+
+    // Outputs
+    ,output [WIDTH-1:0]  data_out_o
+    ,output          accept_o
+    ,output          valid_o
+);
+
+//-----------------------------------------------------------------
+// Local Params
+//-----------------------------------------------------------------
+localparam COUNT_W = ADDR_W + 1;
+
+//-----------------------------------------------------------------
+// Registers
+//-----------------------------------------------------------------
+reg [WIDTH-1:0]   ram_q[DEPTH-1:0];
+reg [ADDR_W-1:0]  rd_ptr_q;
+reg [ADDR_W-1:0]  wr_ptr_q;
+reg [COUNT_W-1:0] count_q;      // Words in the RAM
+reg [WIDTH-1:0]   data_q;
+reg               valid_q;
+
+wire push_w = push_i & accept_o;
+wire read_w = (count_q != {(COUNT_W){1'b0}}) && (!valid_q || pop_i);
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    count_q   <= {(COUNT_W) {1'b0}};
+    rd_ptr_q  <= {(ADDR_W) {1'b0}};
+    wr_ptr_q  <= {(ADDR_W) {1'b0}};
+    valid_q   <= 1'b0;
+end
+else
+begin
+    if (push_w)
+        wr_ptr_q <= wr_ptr_q + 1;
+
+    if (read_w)
+        rd_ptr_q <= rd_ptr_q + 1;
+
+    if (push_w && !read_w)
+        count_q <= count_q + 1;
+    else if (!push_w && read_w)
+        count_q <= count_q - 1;
+
+    if (read_w)
+        valid_q <= 1'b1;
+    else if (pop_i)
+        valid_q <= 1'b0;
+end
+
+// Synchronous write / read
+always @ (posedge clk_i)
+begin
+    if (push_w)
+        ram_q[wr_ptr_q] <= data_in_i;
+
+    if (read_w)
+        data_q <= ram_q[rd_ptr_q];
+end
+
+//-----------------------------------------------------------------
+// Combinatorial
+//-----------------------------------------------------------------
+/* verilator lint_off WIDTH */
+assign accept_o      = (count_q != DEPTH);
+/* verilator lint_on WIDTH */
+assign valid_o       = valid_q;
+assign data_out_o    = data_q;
+
+endmodule
@@ -38,7 +38,7 @@ module jpeg_output
     ,input           img_end_i
     ,input  [ 15:0]  img_width_i
     ,input  [ 15:0]  img_height_i
-    ,input  [  1:0]  img_mode_i
+    ,input  [  2:0]  img_mode_i
     ,input           inport_valid_i
     ,input  [ 31:0]  inport_data_i
     ,input  [  5:0]  inport_idx_i
@@ -65,10 +65,11 @@ localparam BLOCK_CB         = 2'd1;
 localparam BLOCK_CR         = 2'd2;
 localparam BLOCK_EOF        = 2'd3;
 
-localparam JPEG_MONOCHROME  = 2'd0;
-localparam JPEG_YCBCR_444   = 2'd1;
-localparam JPEG_YCBCR_420   = 2'd2;
-localparam JPEG_UNSUPPORTED = 2'd3;
+localparam JPEG_MONOCHROME  = 3'd0;
+localparam JPEG_YCBCR_444   = 3'd1;
+localparam JPEG_YCBCR_420   = 3'd2;
+localparam JPEG_YCBCR_422   = 3'd3;
+localparam JPEG_UNSUPPORTED = 3'd4;
 
 reg valid_r;
 wire output_space_w = (!outport_valid_o || outport_accept_i);
@@ -116,6 +117,7 @@ u_ram_cb
     ,.flush_i(img_start_i)
     ,.level_o(cb_level_w)
     ,.mode420_i(img_mode_i == JPEG_YCBCR_420)
+    ,.mode422_i(img_mode_i == JPEG_YCBCR_422)
 
     ,.push_i(inport_valid_i && (inport_id_i[31:30] == BLOCK_CB || inport_id_i[31:30] == BLOCK_EOF))
     ,.wr_idx_i(inport_idx_i)
@@ -143,6 +145,7 @@ u_ram_cr
     ,.flush_i(img_start_i)
     ,.level_o(cr_level_w)
     ,.mode420_i(img_mode_i == JPEG_YCBCR_420)
+    ,.mode422_i(img_mode_i == JPEG_YCBCR_422)
 
     ,.push_i(inport_valid_i && (inport_id_i[31:30] == BLOCK_CR || inport_id_i[31:30] == BLOCK_EOF))
     ,.wr_idx_i(inport_idx_i)
@@ -197,7 +200,7 @@ else if (valid_r && output_space_w)
     idx_q <= idx_q + 6'd1;
 
 //-----------------------------------------------------------------
-// Subsampling counter (420 chroma subsampling)
+// Subsampling counter (420 / 422 chroma subsampling): Y block of the MCU
 //-----------------------------------------------------------------
 reg [1:0] subsmpl_q;
 
@@ -208,6 +211,8 @@ else if (img_start_i)
     subsmpl_q <= 2'b0;
 else if (valid_r && output_space_w && img_mode_i == JPEG_YCBCR_420 && idx_q == 6'd63)
     subsmpl_q <= subsmpl_q + 2'd1;
+else if (valid_r && output_space_w && img_mode_i == JPEG_YCBCR_422 && idx_q == 6'd63)
+    subsmpl_q <= {1'b0, ~subsmpl_q[0]};
 
 //-----------------------------------------------------------------
 // YUV -> RGB
@@ -225,8 +230,10 @@ begin
         active_q <= (y_level_w >= 32'd64);
     else if (img_mode_i == JPEG_YCBCR_444)
         active_q <= (y_level_w >= 32'd64) && (cb_level_w >= 32'd64) && (cr_level_w >= 32'd64);
-    else if (subsmpl_q != 2'b0) // 420
+    else if (subsmpl_q != 2'b0) // 420 / 422
         active_q <= 1'b1;
+    else if (img_mode_i == JPEG_YCBCR_422)
+        active_q <= (y_level_w >= 32'd128) && (cb_level_w >= 32'd128) && (cr_level_w >= 32'd128);
     else // 420
         active_q <= (y_level_w >= 32'd256) && (cb_level_w >= 32'd256) && (cr_level_w >= 32'd256);
 end
@@ -285,7 +292,8 @@ else if (output_space_w)
     valid_q <= valid_r && (id_value_w[31:30] != BLOCK_EOF);
 
 wire [31:0] x_start_w = {13'b0, id_value_w[15:0],3'b0};
-wire [31:0] y_start_w = {15'b0, id_value_w[29:16],3'b0};
+// Block y is 13 bits (bit 29 is the frame parity with jpeg_core SUPPORT_FRAME_OVERLAP)
+wire [31:0] y_start_w = {16'b0, id_value_w[28:16],3'b0};
 
 always @ (posedge clk_i )
 if (rst_i)
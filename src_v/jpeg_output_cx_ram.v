@@ -38,6 +38,7 @@ module jpeg_output_cx_ram
     ,input  [ 31:0]  data_in_i
     ,input           push_i
     ,input           mode420_i
+    ,input           mode422_i
     ,input           pop_i
     ,input           flush_i
 
@@ -94,14 +95,21 @@ else if (read_ok_w && ((!valid_o) || (valid_o && pop_i)))
     rd_ptr_q <= rd_ptr_next_w;
 
 //-------------------------------------------------------------------
-// Chroma subsampling (420) sample addressing
+// Chroma subsampling (420 / 422) sample addressing
 //-------------------------------------------------------------------
 reg [7:0] cx_idx_q;
 
 reg [5:0] cx_rd_ptr_r;
 
+// 422: luma pixel n of the Y0, Y1 pair (n[6] = block, n[5:3] = row,
+// n[2:0] = column) uses chroma sample {row, block, column / 2}
+wire [6:0] cx_422_next_w = cx_idx_q[6:0] + 7'd1;
+
 always @ *
 begin
+    if (mode422_i)
+        cx_rd_ptr_r = {cx_422_next_w[5:3], cx_422_next_w[6], cx_422_next_w[2:1]};
+    else
     case (cx_idx_q)
     8'd0: cx_rd_ptr_r = 6'd0;
     8'd1: cx_rd_ptr_r = 6'd1;
@@ -377,7 +385,7 @@ if (rst_i)
     cx_half_q    <= 2'b0;
 else if (flush_i)
     cx_half_q    <= 2'b0;
-else if (read_ok_w && ((!valid_o) || (valid_o && pop_i)) && cx_idx_q == 8'd255)
+else if (read_ok_w && ((!valid_o) || (valid_o && pop_i)) && (mode422_i ? (cx_idx_q[6:0] == 7'd127) : (cx_idx_q == 8'd255)))
     cx_half_q    <= cx_half_q + 2'd1;
 
 reg [5:0] cx_rd_ptr_q;
@@ -385,10 +393,12 @@ reg [5:0] cx_rd_ptr_q;
 always @ (posedge clk_i )
 if (rst_i)
     cx_rd_ptr_q <= 6'b0;
+else if (flush_i)
+    cx_rd_ptr_q <= 6'b0;
 else if (read_ok_w && ((!valid_o) || (valid_o && pop_i)))
     cx_rd_ptr_q <= cx_rd_ptr_r;
 
-wire [7:0] rd_addr_w = mode420_i ? {cx_half_q, cx_rd_ptr_q} : rd_ptr_q;
+wire [7:0] rd_addr_w = (mode420_i || mode422_i) ? {cx_half_q, cx_rd_ptr_q} : rd_ptr_q;
 
 //-------------------------------------------------------------------
 // Read Skid Buffer
@@ -467,7 +477,7 @@ begin
         count_r = count_r - 32'd1;
 
     if (push_i)
-        count_r = count_r + (mode420_i ? 32'd4 : 32'd1);
+        count_r = count_r + (mode420_i ? 32'd4 : mode422_i ? 32'd2 : 32'd1);
 end
 
 always @ (posedge clk_i )
@@ -0,0 +1,322 @@
+//-----------------------------------------------------------------
+//                      Baseline JPEG Decoder
+//                             V0.1
+//                       Ultra-Embedded.com
+//                        Copyright 2020
+//
+//                   admin@ultra-embedded.com
+//-----------------------------------------------------------------
+//                      License: Apache 2.0
+// This IP can be freely used in commercial projects, however you may
+// want access to unreleased materials such as verification environments,
+// or test vectors, as well as changes to the IP for integration purposes.
+// If this is the case, contact the above address.
+// I am interested to hear how and where this IP is used, so please get
+// in touch!
+//-----------------------------------------------------------------
+// Copyright 2020 Ultra-Embedded.com
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------
+
+
+module jpeg_output_dc
+(
+    // Inputs
+     input           clk_i
+    ,input           rst_i
+    ,input           img_start_i
+    ,input  [  2:0]  img_mode_i
+    ,input           inport_valid_i
+    ,input  [ 15:0]  inport_data_i
+    ,input  [  5:0]  inport_idx_i
+    ,input  [ 31:0]  inport_id_i
+    ,input           inport_eob_i
+    ,input           outport_accept_i
+
+    // Outputs
+    ,output          inport_accept_o
+    ,output          outport_valid_o
+    ,output [ 15:0]  outport_pixel_x_o
+    ,output [ 15:0]  outport_pixel_y_o
+    ,output [  7:0]  outport_pixel_r_o
+    ,output [  7:0]  outport_pixel_g_o
+    ,output [  7:0]  outport_pixel_b_o
+    ,output          idle_o
+);
+
+//-----------------------------------------------------------------
+// DC only (1/8 scale) output: one pixel per block, taken from the
+// dequantised DC coefficient (jpeg_dqt output, no IDCT). A block
+// with only a DC term has a flat IDCT output of DC / 8.
+// Pixel (x, y) is the block position, MCUs output in decode order.
+//-----------------------------------------------------------------
+localparam BLOCK_Y          = 2'd0;
+localparam BLOCK_CB         = 2'd1;
+localparam BLOCK_CR         = 2'd2;
+localparam BLOCK_EOF        = 2'd3;
+
+localparam JPEG_MONOCHROME  = 3'd0;
+localparam JPEG_YCBCR_444   = 3'd1;
+localparam JPEG_YCBCR_420   = 3'd2;
+localparam JPEG_YCBCR_422   = 3'd3;
+localparam JPEG_UNSUPPORTED = 3'd4;
+
+wire output_space_w = (!outport_valid_o || outport_accept_i);
+
+//-----------------------------------------------------------------
+// DC capture
+//-----------------------------------------------------------------
+wire dc_valid_w = inport_valid_i && (inport_idx_i == 6'd0);
+
+reg [15:0] dc_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+    dc_q <= 16'b0;
+else if (dc_valid_w)
+    dc_q <= inport_data_i;
+
+wire [15:0] blk_dc_w    = dc_valid_w ? inport_data_i : dc_q;
+
+// DC / 8, rounded (not level shifted)
+wire [16:0] blk_round_w = {blk_dc_w[15], blk_dc_w} + 17'd4;
+wire [13:0] blk_value_w = blk_round_w[16:3];
+
+wire [1:0]  blk_type_w  = inport_id_i[31:30];
+wire        blk_end_w   = inport_eob_i && (blk_type_w != BLOCK_EOF);
+wire        y_end_w     = blk_end_w && (blk_type_w == BLOCK_Y);
+
+// Last block of the MCU
+wire        mcu_end_w   = (img_mode_i == JPEG_MONOCHROME) ? y_end_w : (blk_end_w && blk_type_w == BLOCK_CR);
+
+//-----------------------------------------------------------------
+// MCU capture: Y0-Y3 (value, block position), Cb, Cr
+//-----------------------------------------------------------------
+reg [2:0]  y_cnt_q;
+reg [13:0] y_value_q[0:3];
+reg [15:0] y_bx_q[0:3];
+reg [12:0] y_by_q[0:3];
+reg [13:0] cb_value_q;
+reg [13:0] cr_value_q;
+reg [1:0]  mcu_last_q;
+reg        pending_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+    y_cnt_q <= 3'b0;
+else if (img_start_i || mcu_end_w)
+    y_cnt_q <= 3'b0;
+else if (y_end_w)
+    y_cnt_q <= y_cnt_q + 3'd1;
+
+always @ (posedge clk_i )
+if (y_end_w)
+begin
+    y_value_q[y_cnt_q[1:0]] <= blk_value_w;
+    y_bx_q[y_cnt_q[1:0]]    <= inport_id_i[15:0];
+    y_by_q[y_cnt_q[1:0]]    <= inport_id_i[28:16];
+end
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    cb_value_q <= 14'b0;
+    cr_value_q <= 14'b0;
+end
+else if (blk_end_w && blk_type_w == BLOCK_CB)
+    cb_value_q <= blk_value_w;
+else if (blk_end_w && blk_type_w == BLOCK_CR)
+    cr_value_q <= blk_value_w;
+
+// Index of the last Y block (pixel) of the MCU
+always @ (posedge clk_i )
+if (rst_i)
+    mcu_last_q <= 2'b0;
+else if (mcu_end_w)
+    mcu_last_q <= (img_mode_i == JPEG_MONOCHROME) ? 2'd0 : (y_cnt_q[1:0] - 2'd1);
+
+//-----------------------------------------------------------------
+// Output buffer: holds the last MCU while the next is captured
+//-----------------------------------------------------------------
+reg        full_q;
+reg [1:0]  out_idx_q;
+reg [1:0]  out_last_q;
+reg        out_mono_q;
+reg [13:0] out_y_q[0:3];
+reg [15:0] out_bx_q[0:3];
+reg [12:0] out_by_q[0:3];
+reg [13:0] out_cb_q;
+reg [13:0] out_cr_q;
+
+wire load_w     = pending_q && !full_q;
+wire pop_w      = full_q && output_space_w;
+wire pop_last_w = pop_w && (out_idx_q == out_last_q);
+
+// MCU complete, waiting for the output buffer
+always @ (posedge clk_i )
+if (rst_i)
+    pending_q <= 1'b0;
+else if (img_start_i)
+    pending_q <= 1'b0;
+else if (mcu_end_w)
+    pending_q <= 1'b1;
+else if (load_w)
+    pending_q <= 1'b0;
+
+always @ (posedge clk_i )
+if (rst_i)
+    full_q <= 1'b0;
+else if (img_start_i)
+    full_q <= 1'b0;
+else if (load_w)
+    full_q <= 1'b1;
+else if (pop_last_w)
+    full_q <= 1'b0;
+
+always @ (posedge clk_i )
+if (rst_i)
+    out_idx_q <= 2'b0;
+else if (img_start_i || load_w)
+    out_idx_q <= 2'b0;
+else if (pop_w)
+    out_idx_q <= out_idx_q + 2'd1;
+
+integer i;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    out_last_q <= 2'b0;
+    out_mono_q <= 1'b0;
+    out_cb_q   <= 14'b0;
+    out_cr_q   <= 14'b0;
+end
+else if (load_w)
+begin
+    out_last_q <= mcu_last_q;
+    out_mono_q <= (img_mode_i == JPEG_MONOCHROME);
+    out_cb_q   <= cb_value_q;
+    out_cr_q   <= cr_value_q;
+end
+
+always @ (posedge clk_i )
+if (load_w)
+begin
+    for (i=0;i<4;i=i+1)
+    begin
+        out_y_q[i]  <= y_value_q[i];
+        out_bx_q[i] <= y_bx_q[i];
+        out_by_q[i] <= y_by_q[i];
+    end
+end
+
+// Blocks are only started (jpeg_dqt inport_blk_space_o) while there is room for the MCU
+assign inport_accept_o = !pending_q;
+
+//-----------------------------------------------------------------
+// YUV -> RGB (as jpeg_output)
+//-----------------------------------------------------------------
+wire signed [31:0] y_value_w  = {{18{out_y_q[out_idx_q][13]}}, out_y_q[out_idx_q]};
+wire signed [31:0] cb_value_w = {{18{out_cb_q[13]}}, out_cb_q};
+wire signed [31:0] cr_value_w = {{18{out_cr_q[13]}}, out_cr_q};
+
+wire signed [31:0] cr_1_402_w = (cr_value_w * 5743) >>> 12; // cr_value_w * 1.402
+wire signed [31:0] cr_0_714_w = (cr_value_w * 2925) >>> 12; // cr_value_w * 0.71414
+wire signed [31:0] cb_0_344_w = (cb_value_w * 1410) >>> 12; // cb_value_w * 0.34414
+wire signed [31:0] cb_1_772_w = (cb_value_w * 7258) >>> 12; // cb_value_w * 1.772
+
+reg signed [31:0] r_conv_r;
+reg signed [31:0] g_conv_r;
+reg signed [31:0] b_conv_r;
+
+always @ *
+begin
+    r_conv_r = 32'b0;
+    g_conv_r = 32'b0;
+    b_conv_r = 32'b0;
+
+    if (out_mono_q)
+    begin
+        r_conv_r = 128 + y_value_w;
+        g_conv_r = 128 + y_value_w;
+        b_conv_r = 128 + y_value_w;
+    end
+    else
+    begin
+        r_conv_r = 128 + y_value_w + cr_1_402_w;
+        g_conv_r = 128 + y_value_w - cb_0_344_w - cr_0_714_w;
+        b_conv_r = 128 + y_value_w + cb_1_772_w;
+    end
+end
+
+//-----------------------------------------------------------------
+// Outputs
+//-----------------------------------------------------------------
+reg        valid_q;
+reg [15:0] pixel_x_q;
+reg [15:0] pixel_y_q;
+reg [7:0]  pixel_r_q;
+reg [7:0]  pixel_g_q;
+reg [7:0]  pixel_b_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+    valid_q <= 1'b0;
+else if (img_start_i)
+    valid_q <= 1'b0;
+else if (output_space_w)
+    valid_q <= full_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    pixel_x_q <= 16'b0;
+    pixel_y_q <= 16'b0;
+    pixel_r_q <= 8'b0;
+    pixel_g_q <= 8'b0;
+    pixel_b_q <= 8'b0;
+end
+else if (pop_w)
+begin
+    pixel_x_q <= out_bx_q[out_idx_q];
+    pixel_y_q <= {3'b0, out_by_q[out_idx_q]};
+    pixel_r_q <= (|r_conv_r[31:8]) ? (r_conv_r[31:24] ^ 8'hff) : r_conv_r[7:0];
+    pixel_g_q <= (|g_conv_r[31:8]) ? (g_conv_r[31:24] ^ 8'hff) : g_conv_r[7:0];
+    pixel_b_q <= (|b_conv_r[31:8]) ? (b_conv_r[31:24] ^ 8'hff) : b_conv_r[7:0];
+end
+
+assign outport_valid_o   = valid_q;
+assign outport_pixel_x_o = pixel_x_q;
+assign outport_pixel_y_o = pixel_y_q;
+assign outport_pixel_r_o = pixel_r_q;
+assign outport_pixel_g_o = pixel_g_q;
+assign outport_pixel_b_o = pixel_b_q;
+
+//-----------------------------------------------------------------
+// Idle: EOF block seen and the last MCU output
+//-----------------------------------------------------------------
+reg eof_q;
+
+always @ (posedge clk_i )
+if (rst_i)
+    eof_q <= 1'b1;
+else if (img_start_i)
+    eof_q <= 1'b0;
+else if (inport_valid_i && inport_eob_i && blk_type_w == BLOCK_EOF)
+    eof_q <= 1'b1;
+
+assign idle_o = eof_q && !pending_q && !full_q && !valid_q;
+
+
+endmodule
@@ -0,0 +1,238 @@
+//-----------------------------------------------------------------
+//                      Baseline JPEG Decoder
+//                             V0.1
+//                       Ultra-Embedded.com
+//                        Copyright 2020
+//
+//                   admin@ultra-embedded.com
+//-----------------------------------------------------------------
+//                      License: Apache 2.0
+// This IP can be freely used in commercial projects, however you may
+// want access to unreleased materials such as verification environments,
+// or test vectors, as well as changes to the IP for integration purposes.
+// If this is the case, contact the above address.
+// I am interested to hear how and where this IP is used, so please get
+// in touch!
+//-----------------------------------------------------------------
+// Copyright 2020 Ultra-Embedded.com
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//-----------------------------------------------------------------
+
+
+module jpeg_output_raster
+//-----------------------------------------------------------------
+// Params
+//-----------------------------------------------------------------
+#(
+     parameter WIDTH_W          = 11    // Max image width = 2^WIDTH_W (jpeg_core bypasses wider frames)
+)
+//-----------------------------------------------------------------
+// Ports
+//-----------------------------------------------------------------
+(
+    // Inputs
+     input           clk_i
+    ,input           rst_i
+    ,input           img_start_i
+    ,input  [ 15:0]  img_width_i
+    ,input  [ 15:0]  img_height_i
+    ,input  [  2:0]  img_mode_i
+    ,input           inport_valid_i
+    ,input  [ 15:0]  inport_pixel_x_i
+    ,input  [ 15:0]  inport_pixel_y_i
+    ,input  [  7:0]  inport_pixel_r_i
+    ,input  [  7:0]  inport_pixel_g_i
+    ,input  [  7:0]  inport_pixel_b_i
+    ,input           outport_accept_i
+
+    // Outputs
+    ,output          inport_accept_o
+    ,output          outport_valid_o
+    ,output [ 15:0]  outport_pixel_x_o
+    ,output [ 15:0]  outport_pixel_y_o
+    ,output [  7:0]  outport_pixel_r_o
+    ,output [  7:0]  outport_pixel_g_o
+    ,output [  7:0]  outport_pixel_b_o
+    ,output          outport_pixel2_valid_o
+    ,output [  7:0]  outport_pixel2_r_o
+    ,output [  7:0]  outport_pixel2_g_o
+    ,output [  7:0]  outport_pixel2_b_o
+    ,output          idle_o
+);
+
+//-----------------------------------------------------------------
+// Reorders the block ordered pixel stream from jpeg_output into
+// raster order, two pixels (an even / odd x pair) per beat.
+// One MCU row (8 or 16 lines) is collected in a bank of the line
+// RAM while the previous row is streamed out of the other bank.
+// Padding pixels outside the image are accepted and dropped.
+//-----------------------------------------------------------------
+localparam JPEG_YCBCR_420   = 3'd2;
+
+localparam RAM_ADDR_W       = 1 + 4 + WIDTH_W - 1;
+localparam RAM_DEPTH        = 1 << RAM_ADDR_W;
+
+wire [15:0] mcu_h_mask_w    = (img_mode_i == JPEG_YCBCR_420) ? 16'd15 : 16'd7;
+
+// Last line of an MCU row (or of the image)
+function row_last_f;
+    input [15:0] y;
+begin
+    row_last_f = ((y + 16'd1) == img_height_i) || ((y & mcu_h_mask_w) == mcu_h_mask_w);
+end
+endfunction
+
+//-----------------------------------------------------------------
+// Fill: pixels from jpeg_output -> line RAM
+//-----------------------------------------------------------------
+reg [1:0]  bank_full_q;
+reg        wr_bank_q;
+
+wire drop_w    = (inport_pixel_x_i >= img_width_i) || (inport_pixel_y_i >= img_height_i);
+wire wr_fire_w = inport_valid_i && inport_accept_o;
+wire wr_w      = wr_fire_w && !drop_w;
+
+// The bottom right pixel of an MCU row is the last one of the row inside the image
+wire wr_last_w = wr_w && ((inport_pixel_x_i + 16'd1) == img_width_i) && row_last_f(inport_pixel_y_i);
+
+assign inport_accept_o = drop_w || !bank_full_q[wr_bank_q];
+
+always @ (posedge clk_i )
+if (rst_i)
+    wr_bank_q <= 1'b0;
+else if (img_start_i)
+    wr_bank_q <= 1'b0;
+else if (wr_last_w)
+    wr_bank_q <= ~wr_bank_q;
+
+wire [RAM_ADDR_W-1:0] wr_addr_w = {wr_bank_q, inport_pixel_y_i[3:0], inport_pixel_x_i[WIDTH_W-1:1]};
+wire [23:0]           wr_data_w = {inport_pixel_r_i, inport_pixel_g_i, inport_pixel_b_i};
+
+//-----------------------------------------------------------------
+// Drain: line RAM -> raster output
+//-----------------------------------------------------------------
+reg        rd_bank_q;
+reg [15:0] rd_x_q;
+reg [15:0] rd_y_q;
+
+reg        valid_q;
+reg [15:0] pixel_x_q;
+reg [15:0] pixel_y_q;
+reg        pixel2_q;
+
+wire rd_w        = bank_full_q[rd_bank_q] && (!valid_q || outport_accept_i);
+wire rd_line_w   = (rd_x_q + 16'd2) >= img_width_i;
+wire rd_last_w   = rd_line_w && row_last_f(rd_y_q);
+
+wire [RAM_ADDR_W-1:0] rd_addr_w = {rd_bank_q, rd_y_q[3:0], rd_x_q[WIDTH_W-1:1]};
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    rd_bank_q <= 1'b0;
+    rd_x_q    <= 16'b0;
+    rd_y_q    <= 16'b0;
+end
+else if (img_start_i)
+begin
+    rd_bank_q <= 1'b0;
+    rd_x_q    <= 16'b0;
+    rd_y_q    <= 16'b0;
+end
+else if (rd_w)
+begin
+    rd_x_q    <= rd_line_w ? 16'b0 : (rd_x_q + 16'd2);
+    rd_y_q    <= rd_y_q + {15'b0, rd_line_w};
+    rd_bank_q <= rd_bank_q ^ rd_last_w;
+end
+
+always @ (posedge clk_i )
+if (rst_i)
+    bank_full_q <= 2'b0;
+else if (img_start_i)
+    bank_full_q <= 2'b0;
+else
+begin
+    if (rd_w && rd_last_w)
+        bank_full_q[rd_bank_q] <= 1'b0;
+
+    if (wr_last_w)
+        bank_full_q[wr_bank_q] <= 1'b1;
+end
+
+always @ (posedge clk_i )
+if (rst_i)
+    valid_q <= 1'b0;
+else if (img_start_i)
+    valid_q <= 1'b0;
+else if (rd_w)
+    valid_q <= 1'b1;
+else if (outport_accept_i)
+    valid_q <= 1'b0;
+
+always @ (posedge clk_i )
+if (rst_i)
+begin
+    pixel_x_q <= 16'b0;
+    pixel_y_q <= 16'b0;
+    pixel2_q  <= 1'b0;
+end
+else if (rd_w)
+begin
+    pixel_x_q <= rd_x_q;
+    pixel_y_q <= rd_y_q;
+    pixel2_q  <= (rd_x_q + 16'd1) < img_width_i;
+end
+
+//-----------------------------------------------------------------
+// Line RAM: even / odd x, read data held while the output stalls
+//-----------------------------------------------------------------
+reg [23:0] ram_even_q[RAM_DEPTH-1:0];
+reg [23:0] ram_odd_q[RAM_DEPTH-1:0];
+reg [23:0] rd_even_q;
+reg [23:0] rd_odd_q;
+
+always @ (posedge clk_i)
+begin
+    if (wr_w && !inport_pixel_x_i[0])
+        ram_even_q[wr_addr_w] <= wr_data_w;
+    if (wr_w && inport_pixel_x_i[0])
+        ram_odd_q[wr_addr_w] <= wr_data_w;
+end
+
+always @ (posedge clk_i)
+if (rd_w)
+begin
+    rd_even_q <= ram_even_q[rd_addr_w];
+    rd_odd_q  <= ram_odd_q[rd_addr_w];
+end
+
+//-----------------------------------------------------------------
+// Outputs
+//-----------------------------------------------------------------
+assign outport_valid_o        = valid_q;
+assign outport_pixel_x_o      = pixel_x_q;
+assign outport_pixel_y_o      = pixel_y_q;
+assign outport_pixel_r_o      = rd_even_q[23:16];
+assign outport_pixel_g_o      = rd_even_q[15:8];
+assign outport_pixel_b_o      = rd_even_q[7:0];
+assign outport_pixel2_valid_o = valid_q && pixel2_q;
+assign outport_pixel2_r_o     = rd_odd_q[23:16];
+assign outport_pixel2_g_o     = rd_odd_q[15:8];
+assign outport_pixel2_b_o     = rd_odd_q[7:0];
+
+assign idle_o = !inport_valid_i && !valid_q && (bank_full_q == 2'b0);
+
+
+endmodule